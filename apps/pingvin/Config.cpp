@@ -90,6 +90,15 @@ namespace {
         static pugi::xml_node add_node(const Config::Stream &stream, pugi::xml_node &node) {
             auto stream_node = node.append_child("stream");
             stream_node.append_attribute("key").set_value(stream.key.c_str());
+            if (stream.channel_capacity)
+                stream_node.append_attribute("channel_capacity").set_value((long long unsigned int)stream.channel_capacity);
+            auto &budget = stream.compute_budget;
+            if (!budget.cores.empty())
+                stream_node.append_attribute("cores").set_value(Gadgetron::Core::format_cpu_list(budget.cores).c_str());
+            if (budget.numa_node >= 0)
+                stream_node.append_attribute("numa_node").set_value(budget.numa_node);
+            if (budget.threads)
+                stream_node.append_attribute("threads").set_value((long long unsigned int)budget.threads);
             for (auto n : stream.nodes) {
                 visit([&stream_node](auto &typed_node) { add_node(typed_node, stream_node); }, n);
             }
@@ -99,6 +108,10 @@ namespace {
         static pugi::xml_node add_node(const Config::ParallelProcess& parallelProcess, pugi::xml_node & node){
             auto parallel_node = node.append_child("parallelprocess");
             parallel_node.append_attribute("workers").set_value((long long unsigned int)parallelProcess.workers);
+            if (parallelProcess.max_in_flight)
+                parallel_node.append_attribute("max_in_flight").set_value((long long unsigned int)parallelProcess.max_in_flight);
+            if (!parallelProcess.ordered)
+                parallel_node.append_attribute("ordered").set_value(false);
             add_node(parallelProcess.stream, parallel_node);
             return parallel_node;
         }
@@ -361,7 +374,22 @@ namespace {
             for (auto &node : stream_node.children()) {
                 nodes.push_back(node_parsers.at(node.name())(node));
             }
-            return Config::Stream{stream_node.attribute("key").value(), nodes};
+            return Config::Stream{stream_node.attribute("key").value(), nodes, parse_channel_capacity(stream_node),
+                                  parse_compute_budget(stream_node)};
+        }
+
+        static Gadgetron::Core::ComputeBudget parse_compute_budget(const pugi::xml_node &stream_node) {
+            Gadgetron::Core::ComputeBudget budget;
+            if (auto cores = stream_node.attribute("cores")) budget.cores = Gadgetron::Core::parse_cpu_list(cores.value());
+            budget.numa_node = stream_node.attribute("numa_node").as_int(-1);
+            budget.threads = stream_node.attribute("threads").as_ullong(0);
+            return budget;
+        }
+
+        static size_t parse_channel_capacity(const pugi::xml_node &stream_node) {
+            auto capacity = stream_node.attribute("channel_capacity");
+            if (!capacity) return 0;
+            return std::stoul(capacity.value());
         }
 
         Config::PureStream parse_purestream(const pugi::xml_node &purestream_node){
@@ -374,7 +402,9 @@ namespace {
         Config::ParallelProcess parse_parallelprocess(const pugi::xml_node& parallelprocess_node)
         {
             size_t workers = std::stoul(parallelprocess_node.attribute("workers").value());
-            return Config::ParallelProcess{workers,parse_purestream(parallelprocess_node.child("purestream"))};
+            size_t max_in_flight = parallelprocess_node.attribute("max_in_flight").as_ullong(0);
+            bool ordered = parallelprocess_node.attribute("ordered").as_bool(true);
+            return Config::ParallelProcess{workers,parse_purestream(parallelprocess_node.child("purestream")),max_in_flight,ordered};
         }
 
     };
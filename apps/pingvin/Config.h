@@ -5,6 +5,8 @@
 #include <vector>
 #include <variant>
 
+#include "ComputeBudget.h"
+
 
 namespace Gadgetron::Main {
 
@@ -23,6 +25,8 @@ namespace Gadgetron::Main {
         struct Stream {
             std::string key;
             std::vector<Node> nodes;
+            size_t channel_capacity = 0; // Capacity of the channels between nodes; 0 means unbounded.
+            Core::ComputeBudget compute_budget; // CPUs and OpenMP team size of the stream; unrestricted by default.
         };
 
         struct PureStream{
@@ -50,6 +54,8 @@ namespace Gadgetron::Main {
         struct ParallelProcess {
             size_t workers = 0;
             PureStream stream;
+            size_t max_in_flight = 0; // Maximum number of messages submitted but not yet emitted; 0 means unbounded.
+            bool ordered = true;      // Emit results in input order, or as soon as they complete.
         };
 
         Stream stream;
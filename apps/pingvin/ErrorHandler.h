@@ -8,6 +8,7 @@
 #include "io/primitives.h"
 #include "Channel.h"
 #include "Context.h"
+#include "ComputeBudget.h"
 
 namespace Gadgetron::Main {
 
@@ -67,11 +68,14 @@ namespace Gadgetron::Main {
 
         template<class F, class... ARGS>
         std::thread run(F fn, ARGS &&... args) {
+            // The thread computes under the budget of the thread starting it.
             return std::thread(
-                    []( auto handler, auto fn, auto &&... iargs) {
+                    []( auto handler, auto budget, auto fn, auto &&... iargs) {
+                        Core::Compute::Scope scope{budget};
                         handler.handle(fn, std::forward<ARGS>(iargs)...);
                     },
                     *this,
+                    Core::Compute::current(),
                     std::forward<F>(fn),
                     std::forward<ARGS>(args)...
             );
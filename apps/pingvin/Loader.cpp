@@ -1,14 +1,31 @@
 #include "Loader.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include "nodes/Stream.h"
 
 namespace Gadgetron::Main {
 
+    namespace {
+        // Libraries stay loaded for the life of the process, so later streams skip the search and symbol resolution.
+        // Never destroyed, so nothing is unloaded while static destructors from those libraries may still run.
+        std::mutex library_mutex;
+        auto& loaded_libraries = *new std::map<std::string, boost::dll::shared_library>();
+    }
+
     Loader::Loader(const Core::StreamContext &context) : context(context) {}
 
     boost::dll::shared_library Loader::load_library(const std::string &shared_library_name) {
+        std::lock_guard<std::mutex> guard(library_mutex);
+
+        auto loaded = loaded_libraries.find(shared_library_name);
+        if (loaded != loaded_libraries.end()) {
+            libraries.push_back(loaded->second);
+            return loaded->second;
+        }
+
         try
         {
             auto lib = boost::dll::shared_library(
@@ -17,6 +34,7 @@ namespace Gadgetron::Main {
                     boost::dll::load_mode::rtld_global |
                     boost::dll::load_mode::search_system_folders
             );
+            loaded_libraries.emplace(shared_library_name, lib);
             libraries.push_back(lib);
             return lib;
         }
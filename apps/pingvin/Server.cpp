@@ -0,0 +1,128 @@
+#include "Server.h"
+
+#include <csignal>
+#include <thread>
+
+#include <boost/asio.hpp>
+#include <boost/filesystem.hpp>
+#include <unistd.h>
+
+#include "initialization.h"
+#include "log.h"
+
+#include "StreamConsumer.h"
+
+using boost::asio::local::stream_protocol;
+
+namespace Gadgetron::Main {
+
+    Server::Server(const boost::program_options::variables_map& args, std::string socket_path)
+        : args(args), socket_path(std::move(socket_path)) {}
+
+    Server::~Server() {
+        join_streams(true);
+    }
+
+    void Server::serve() {
+        // A client hanging up mid-stream must fail that stream, not take the server down.
+        std::signal(SIGPIPE, SIG_IGN);
+
+        // Remove the socket left behind by a previous server.
+        boost::system::error_code error;
+        if (boost::filesystem::status(socket_path, error).type() == boost::filesystem::socket_file)
+            boost::filesystem::remove(socket_path, error);
+
+        boost::asio::io_context io_context;
+        stream_protocol::acceptor acceptor(io_context, stream_protocol::endpoint(socket_path));
+        GINFO_STREAM("Listening for streams on " << socket_path);
+
+        boost::asio::signal_set signals(io_context, SIGINT, SIGTERM);
+        signals.async_wait([&](const boost::system::error_code& error, int signal) {
+            if (error)
+                return;
+            GINFO_STREAM("Received signal " << signal << "; no longer accepting streams");
+            acceptor.close();
+        });
+
+        accept(acceptor, 1);
+        io_context.run();
+
+        if (active_streams > 0)
+            GINFO_STREAM("Waiting for " << active_streams << " streams to finish");
+        join_streams(true);
+
+        boost::filesystem::remove(socket_path, error);
+
+        save_fft_wisdom(args);
+        report_memory_statistics();
+    }
+
+    void Server::accept(stream_protocol::acceptor& acceptor, size_t id) {
+        acceptor.async_accept([this, &acceptor, id](const boost::system::error_code& error, stream_protocol::socket socket) {
+            if (error == boost::asio::error::operation_aborted)
+                return;
+
+            join_streams(false);
+
+            if (error) {
+                GERROR_STREAM("Failed to accept stream " << id << ": " << error.message());
+            } else {
+                std::lock_guard<std::mutex> guard(connections_mutex);
+                auto connection = connections.emplace(connections.end());
+                connection->thread = std::thread(
+                    [this, id, connection](stream_protocol::socket socket) {
+                        handle(std::move(socket), id);
+                        std::lock_guard<std::mutex> guard(connections_mutex);
+                        connection->finished = true;
+                    },
+                    std::move(socket));
+            }
+
+            accept(acceptor, id + 1);
+        });
+    }
+
+    void Server::join_streams(bool wait) {
+        std::list<Connection> joinable;
+        {
+            std::lock_guard<std::mutex> guard(connections_mutex);
+            for (auto it = connections.begin(); it != connections.end();) {
+                auto next = std::next(it);
+                if (wait || it->finished)
+                    joinable.splice(joinable.end(), connections, it);
+                it = next;
+            }
+        }
+        for (auto& connection : joinable)
+            connection.thread.join();
+    }
+
+    void Server::handle(stream_protocol::socket socket, size_t id) {
+        GINFO_STREAM("Stream " << id << " connected; " << ++active_streams << " active");
+        try {
+            // Reading and writing go through separate descriptors, so neither blocks the other's buffer.
+            stream_protocol::socket output_socket(socket.get_executor());
+            output_socket.assign(stream_protocol(), ::dup(socket.native_handle()));
+
+            stream_protocol::iostream input(std::move(socket));
+            stream_protocol::iostream output(std::move(output_socket));
+
+            std::string config;
+            std::getline(input, config);
+            if (config.empty() && args.count("config"))
+                config = args["config"].as<std::string>();
+            if (config.empty())
+                throw std::runtime_error("No config named by the client, and no default given with --config");
+
+            StreamConsumer consumer(args);
+            consumer.consume(input, output, config);
+            std::flush(output);
+            output.socket().shutdown(stream_protocol::socket::shutdown_send);
+
+            GINFO_STREAM("Stream " << id << " finished");
+        } catch (const std::exception& e) {
+            GERROR_STREAM("Stream " << id << " failed: " << e.what());
+        }
+        --active_streams;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+namespace Gadgetron::Main {
+
+    /**
+     * Serves any number of concurrent MRD streams on a local (Unix domain) socket, each through its own
+     * StreamConsumer. Gadget libraries, parsed configurations, FFTW plans and the thread pool are kept between
+     * streams, so only the first stream pays for setting them up.
+     *
+     * A connection starts with a line naming the configuration to use, which may be empty to use --config, followed
+     * by the MRD stream. The output stream is written back over the same connection.
+     *
+     * SIGINT or SIGTERM stops the server from accepting connections. It then waits for the streams in progress,
+     * saves FFTW wisdom and reports memory statistics, once for the whole session.
+     */
+    class Server {
+    public:
+        Server(const boost::program_options::variables_map& args, std::string socket_path);
+        ~Server();
+
+        void serve();
+
+    private:
+        struct Connection {
+            std::thread thread;
+            bool finished = false;
+        };
+
+        void accept(boost::asio::local::stream_protocol::acceptor& acceptor, size_t id);
+        void handle(boost::asio::local::stream_protocol::socket socket, size_t id);
+
+        // Joins the threads of finished streams, or of all streams when wait is set.
+        void join_streams(bool wait);
+
+        const boost::program_options::variables_map args;
+        const std::string socket_path;
+        std::atomic<size_t> active_streams{ 0 };
+
+        std::mutex connections_mutex;
+        std::list<Connection> connections;
+    };
+}
@@ -1,6 +1,11 @@
+#pragma once
+
 #include <filesystem>
+#include <fstream>
 #include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 
@@ -13,6 +18,8 @@
 #include "Channel.h"
 #include "ErrorHandler.h"
 #include "Loader.h"
+#include "Tracing.h"
+#include "pingvin_config.h"
 
 using namespace Gadgetron::Core;
 using namespace Gadgetron::Main;
@@ -62,20 +69,16 @@ public:
         mrd::Header hdr = consume_mrd_header(mrd_reader, mrd_writer);
 
         auto context = StreamContext(hdr, paths, args_);
+        if (args_.count("trace")) context.trace = std::make_shared<Tracing::Trace>();
         auto loader = Loader(context);
         auto config_path = find_config_path(args_["home"].as<boost::filesystem::path>().string(), config_xml_name);
+        auto config = load_config(config_path);
 
-        GINFO_STREAM("Loading configuration from: " << config_path.string());
-        std::ifstream file(config_path, std::ios::in | std::ios::binary);
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file at path: " + config_path.string());
-        }
-
-        auto config = Config::parse(file);
-        file.close();
-
-        auto stream = loader.load(config.stream);
-        auto input_channel = make_channel<MessageChannel>();
+        auto stream = loader.load(config->stream);
+        // Bound the reader as well, so it cannot queue the whole scan ahead of the first node.
+        auto input_channel = config->stream.channel_capacity
+                                 ? make_channel<BoundedMessageChannel>(config->stream.channel_capacity)
+                                 : make_channel<MessageChannel>();
         auto output_channel = make_channel<MessageChannel>();
         std::atomic<bool> processing = true;
 
@@ -119,10 +122,54 @@ public:
         input_future.get();
         output_future.get();
         process_future.get();
+
+        if (context.trace) write_trace(*context.trace);
     }
 
   private:
 
+    void write_trace(const Tracing::Trace& trace)
+    {
+        std::stringstream summary;
+        trace.write_summary(summary);
+        GINFO_STREAM("Stream summary:\n" << summary.str());
+
+        auto trace_path = args_["trace"].as<std::string>();
+        std::ofstream file(trace_path);
+        trace.write_chrome_trace(file);
+        if (!file) {
+            GERROR_STREAM("Failed to write trace to " << trace_path);
+        } else {
+            GINFO_STREAM("Trace written to " << trace_path);
+        }
+    }
+
+    // Parsed configurations are kept for the life of the process, and reparsed only if the file changes, so streams
+    // served by a long-running process share them.
+    static std::shared_ptr<const Config> load_config(const std::filesystem::path& config_path)
+    {
+        static std::mutex mutex;
+        static std::map<std::string, std::pair<std::filesystem::file_time_type, std::shared_ptr<const Config>>> configs;
+
+        auto modified = std::filesystem::last_write_time(config_path);
+
+        std::lock_guard<std::mutex> guard(mutex);
+        auto& cached = configs[config_path.string()];
+        if (cached.second && cached.first == modified) {
+            GDEBUG_STREAM("Using cached configuration from: " << config_path.string());
+            return cached.second;
+        }
+
+        GINFO_STREAM("Loading configuration from: " << config_path.string());
+        std::ifstream file(config_path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file at path: " + config_path.string());
+        }
+
+        cached = { modified, std::make_shared<const Config>(Config::parse(file)) };
+        return cached.second;
+    }
+
     mrd::Header consume_mrd_header(mrd::binary::MrdReader& mrd_reader, mrd::binary::MrdWriter& mrd_writer)
     {
         std::optional<mrd::Header> hdr;
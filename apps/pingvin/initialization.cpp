@@ -6,6 +6,11 @@
 #include <string>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include "hoMemoryPool.h"
+#include "hoNDFFT.h"
+#include "pingvin_config.h"
 
 #ifdef FORCE_LIMIT_OPENBLAS_NUM_THREADS
 #include <cblas.h>
@@ -27,6 +32,53 @@ namespace Gadgetron::Main {
     }
 
 
+    namespace {
+        boost::filesystem::path wisdom_directory(const boost::program_options::variables_map &args) {
+            return args["home"].as<boost::filesystem::path>() / PINGVIN_FFTW_WISDOM_PATH;
+        }
+
+        FFT::PlanningMode planning_mode(const boost::program_options::variables_map &args) {
+            auto mode = boost::algorithm::to_lower_copy(args["fft-planning"].as<std::string>());
+            if (mode == "estimate") return FFT::PlanningMode::Estimate;
+            if (mode == "measure") return FFT::PlanningMode::Measure;
+            if (mode == "patient") return FFT::PlanningMode::Patient;
+            throw std::runtime_error("Unknown FFT planning mode: " + mode);
+        }
+    }
+
+    void configure_fft(const boost::program_options::variables_map &args) {
+        FFT::set_planning_mode(planning_mode(args));
+
+        auto directory = wisdom_directory(args);
+        if (FFT::import_wisdom(directory.string())) {
+            GDEBUG_STREAM("Imported FFTW wisdom from " << directory);
+        }
+    }
+
+    void save_fft_wisdom(const boost::program_options::variables_map &args) {
+        // Estimated plans carry no wisdom worth keeping.
+        if (FFT::get_planning_mode() == FFT::PlanningMode::Estimate) return;
+
+        auto directory = wisdom_directory(args);
+        boost::system::error_code error;
+        boost::filesystem::create_directories(directory, error);
+
+        if (error || !FFT::export_wisdom(directory.string())) {
+            GWARN_STREAM("Failed to export FFTW wisdom to " << directory);
+        }
+    }
+
+    void configure_memory_pool(const boost::program_options::variables_map &args) {
+        MemoryPool::set_cache_limit(args["memory-pool"].as<size_t>() << 20);
+    }
+
+    void report_memory_statistics() {
+        auto stats = MemoryPool::statistics();
+        GDEBUG("Array memory: %zu allocations, %zu reused, %zu from the system; peak %.1f MB in use, %.1f MB cached\n",
+               stats.allocations, stats.reused, stats.system_allocations,
+               stats.peak_bytes_in_use / 1048576.0, stats.bytes_cached / 1048576.0);
+    }
+
     void check_environment_variables() {
 
         auto get_policy = []() -> std::string {
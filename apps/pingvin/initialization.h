@@ -1,8 +1,18 @@
 #pragma once
 
+#include <boost/program_options/variables_map.hpp>
+
 namespace Gadgetron::Main {
     void configure_blas_libraries();
 
+    void configure_fft(const boost::program_options::variables_map &args);
+
+    void save_fft_wisdom(const boost::program_options::variables_map &args);
+
+    void configure_memory_pool(const boost::program_options::variables_map &args);
+
+    void report_memory_statistics();
+
     void check_environment_variables();
 
     void set_locale();
@@ -9,6 +9,7 @@
 #include "system_info.h"
 #include "pingvin_config.h"
 
+#include "Server.h"
 #include "StreamConsumer.h"
 
 
@@ -53,6 +54,22 @@ int main(int argc, char *argv[]) {
             ("config,c",
                 value<std::string>(),
                 "Filename of the desired Pingvin reconstruction config.")
+            ("listen,l",
+                value<std::string>(),
+                "Serve streams on this local socket rather than a single stream on the input and output. Each "
+                "connection sends a line naming its config (empty to use --config), followed by the MRD stream, "
+                "and receives the output stream in return.")
+            ("trace",
+                value<std::string>(),
+                "Record what every node of the stream spends its time on, log a summary at the end of the stream, "
+                "and write the timeline to this file (Chrome trace format, for chrome://tracing or Perfetto).")
+            ("fft-planning",
+                value<std::string>()->default_value("estimate"),
+                "FFTW planning effort: estimate, measure or patient. Wisdom gathered with measure or patient "
+                "is kept under the Pingvin home directory and reused by later runs.")
+            ("memory-pool",
+                value<size_t>()->default_value(1024),
+                "Megabytes of freed array storage kept for reuse between reconstructions. Set to 0 to disable pooling.")
             ("parameter",
                 value<std::vector<gadget_parameter>>(),
                 "Parameter to be passed to the Pingvin reconstruction config. Multiple parameters can be passed."
@@ -84,6 +101,16 @@ int main(int argc, char *argv[]) {
 
         GINFO("Pingvin %s [%s]\n", PINGVIN_VERSION_STRING, PINGVIN_GIT_SHA1_HASH);
 
+        configure_fft(args);
+        configure_memory_pool(args);
+
+        if (args.count("listen"))
+        {
+            Server server(args, args["listen"].as<std::string>());
+            server.serve();
+            return 0;
+        }
+
         if (!args.count("config"))
         {
             GERROR_STREAM("No config file provided. Use --config/-c");
@@ -116,6 +143,9 @@ int main(int argc, char *argv[]) {
         consumer.consume(input, output, cfg);
         std::flush(output);
 
+        save_fft_wisdom(args);
+        report_memory_statistics();
+
         GDEBUG_STREAM("Finished consuming stream");
     }
     catch (std::exception &e)
@@ -1,60 +1,198 @@
 #include "ParallelProcess.h"
 
 #include "ThreadPool.h"
+#include "log.h"
 
 using namespace Gadgetron::Core;
 
+namespace {
+    template<class T>
+    void update_max(std::atomic<T> &maximum, T value) {
+        T current = maximum.load();
+        while (current < value && !maximum.compare_exchange_weak(current, value)) {}
+    }
+
+    double to_ms(std::chrono::steady_clock::rep ticks) {
+        using namespace std::chrono;
+        return duration<double, std::milli>(steady_clock::duration(ticks)).count();
+    }
+}
+
 namespace Gadgetron::Main::Nodes {
 
-    void ParallelProcess::process_input(GenericInputChannel input, Queue &queue) {
+    bool ParallelProcess::Window::acquire() {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&]() { return closed || !capacity || in_flight < capacity; });
+        if (closed) return false;
+        in_flight++;
+        return true;
+    }
+
+    void ParallelProcess::Window::release() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            in_flight--;
+        }
+        cv.notify_all();
+    }
+
+    void ParallelProcess::Window::close() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            closed = true;
+        }
+        cv.notify_all();
+    }
+
+    void ParallelProcess::Outstanding::add() {
+        std::lock_guard<std::mutex> guard(m);
+        count++;
+    }
+
+    void ParallelProcess::Outstanding::done() {
+        // Notify while holding the lock; the waiter owns this object and may destroy it as soon as it wakes.
+        std::lock_guard<std::mutex> guard(m);
+        if (--count == 0) cv.notify_all();
+    }
+
+    void ParallelProcess::Outstanding::wait() {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&]() { return count == 0; });
+    }
+
+    Message ParallelProcess::process_message(Message message, ThreadPool &pool, Statistics &statistics) const {
+        auto &worker = statistics.workers[pool.worker_index().value_or(statistics.workers.size() - 1)];
+        auto start = Clock::now();
+        auto result = pureStream.process_function(std::move(message));
+        worker.busy += (Clock::now() - start).count();
+        worker.messages++;
+        return result;
+    }
 
-        ThreadPool pool(workers ? workers : std::thread::hardware_concurrency());
+    void ParallelProcess::process_input(GenericInputChannel input, Queue &queue, Window &window, Outstanding &outstanding,
+                                        ThreadPool &pool, Statistics &statistics) {
 
         for (auto message : input) {
-            queue.push(
-                pool.async(
-                        [&](auto message) { return pureStream.process_function(std::move(message)); },
-                        std::move(message)
-                )
-            );
+            if (!window.acquire()) break;
+            auto submitted = Clock::now();
+            outstanding.add();
+
+            if (ordered) {
+                queue.push(Result{
+                    pool.async(
+                            [&](auto message) {
+                                struct Done { Outstanding &outstanding; ~Done() { outstanding.done(); } } done{outstanding};
+                                return this->process_message(std::move(message), pool, statistics);
+                            },
+                            std::move(message)
+                    ),
+                    submitted
+                });
+                continue;
+            }
+
+            // Unordered; the result is queued by the task itself, as soon as it is ready.
+            pool.post([&, submitted, message = std::move(message)]() mutable {
+                Promise<Message> promise;
+                try {
+                    promise.set_value(this->process_message(std::move(message), pool, statistics));
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                }
+                queue.push(Result{promise.get_future(), submitted});
+                outstanding.done();
+            });
         }
 
-        pool.join(); queue.close();
+        // Unordered tasks queue their own results; they must all have done so before the queue is closed.
+        if (!ordered) outstanding.wait();
+        queue.close();
     }
 
-    void ParallelProcess::process_output(OutputChannel output, Queue &queue) {
-        while(true) output.push_message(queue.pop().get());
+    void ParallelProcess::process_output(OutputChannel output, Queue &queue, Window &window, Statistics &statistics) {
+        struct WindowCloser {
+            Window &window;
+            ~WindowCloser() { window.close(); }
+        } closer{window};
+
+        while(true) {
+            auto result = queue.pop();
+            output.push_message(result.message.get());
+
+            auto latency = (Clock::now() - result.submitted).count();
+            statistics.emitted++;
+            statistics.total_latency += latency;
+            update_max(statistics.max_latency, latency);
+
+            window.release();
+        }
+    }
+
+    void ParallelProcess::report(const Statistics &statistics, Clock::duration elapsed) const {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        auto emitted = statistics.emitted.load();
+        if (!emitted) return;
+
+        GDEBUG("ParallelProcess emitted %zu messages in %.1f ms (%.1f messages/s); latency mean %.2f ms, max %.2f ms\n",
+               emitted, seconds * 1e3, emitted / seconds,
+               to_ms(statistics.total_latency.load()) / emitted, to_ms(statistics.max_latency.load()));
+
+        for (size_t i = 0; i < statistics.workers.size(); i++) {
+            auto &worker = statistics.workers[i];
+            auto messages = worker.messages.load();
+            if (!messages) continue;
+            GDEBUG("ParallelProcess worker %zu: %zu messages, busy %.1f ms, %.2f ms per message\n",
+                   i, messages, to_ms(worker.busy.load()), to_ms(worker.busy.load()) / messages);
+        }
     }
 
     void ParallelProcess::process(GenericInputChannel input,
             OutputChannel output,
             ErrorHandler& error_handler
     ) {
+        // Without an explicit worker count, share the process-wide pool rather than spawning one per stream.
+        auto own_pool = workers ? std::make_unique<ThreadPool>(workers) : nullptr;
+        auto& pool = own_pool ? *own_pool : ThreadPool::global();
+
         Queue queue;
+        Window window{max_in_flight};
+        Outstanding outstanding;
+        Statistics statistics{pool.size()};
+        auto start = Clock::now();
 
         auto input_thread = error_handler.run(
-                [&](auto input) { this->process_input(std::move(input), queue); },
+                [&](auto input) { this->process_input(std::move(input), queue, window, outstanding, pool, statistics); },
                 std::move(input)
         );
 
         auto output_thread = error_handler.run(
-                [&](auto output) { this->process_output(std::move(output), queue); },
+                [&](auto output) { this->process_output(std::move(output), queue, window, statistics); },
                 std::move(output)
         );
 
         input_thread.join(); output_thread.join();
+        outstanding.wait();
+        if (own_pool) own_pool->join();
+
+        report(statistics, Clock::now() - start);
     }
 
     ParallelProcess::ParallelProcess(
             const Config::ParallelProcess& conf,
             const Context& context,
             Loader& loader
-    ) : pureStream{ conf.stream, context, loader }, workers{ conf.workers } {}
+    ) : ParallelProcess(conf, PureStream{ conf.stream, context, loader }) {}
+
+    ParallelProcess::ParallelProcess(
+            const Config::ParallelProcess& conf,
+            PureStream pureStream
+    ) : workers{ conf.workers },
+        max_in_flight{ conf.max_in_flight },
+        ordered{ conf.ordered },
+        pureStream{ std::move(pureStream) } {}
 
     const std::string& ParallelProcess::name() {
         const static std::string n = "ParallelProcess";
         return n;
     }
 }
-
-
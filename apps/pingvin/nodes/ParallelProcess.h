@@ -2,24 +2,85 @@
 
 #include "PureStream.h"
 #include "Processable.h"
+#include "ThreadPool.h"
 
-#include <future>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 namespace Gadgetron::Main::Nodes {
     class ParallelProcess : public Processable {
 
     public:
         ParallelProcess(const Config::ParallelProcess& conf, const Core::Context& context, Loader& loader);
+        ParallelProcess(const Config::ParallelProcess& conf, PureStream pureStream);
         void process(Core::GenericInputChannel input, Core::OutputChannel output, ErrorHandler& error_handler) override;
         const std::string& name() override;
     private:
 
-        using Queue = Core::MPMCChannel<std::future<Core::Message>>;
+        using Clock = std::chrono::steady_clock;
 
-        void process_input(Core::GenericInputChannel input, Queue &queue);
-        void process_output(Core::OutputChannel output, Queue &queue);
+        struct Result {
+            Core::Future<Core::Message> message;
+            Clock::time_point submitted;
+        };
+
+        using Queue = Core::MPMCChannel<Result>;
+
+        // Limits the number of messages submitted, but not yet emitted. Closed when the output side stops,
+        // so a blocked input side is released rather than left waiting forever.
+        class Window {
+        public:
+            explicit Window(size_t capacity) : capacity{capacity} {}
+            bool acquire();
+            void release();
+            void close();
+
+        private:
+            const size_t capacity;
+            size_t in_flight = 0;
+            bool closed = false;
+            std::mutex m;
+            std::condition_variable cv;
+        };
+
+        // Counts tasks still running on the pool, which may be shared and thus outlive this node's threads.
+        class Outstanding {
+        public:
+            void add();
+            void done();
+            void wait();
+
+        private:
+            size_t count = 0;
+            std::mutex m;
+            std::condition_variable cv;
+        };
+
+        struct WorkerStatistics {
+            std::atomic<size_t> messages{0};
+            std::atomic<Clock::rep> busy{0};
+        };
+
+        struct Statistics {
+            explicit Statistics(size_t workers) : workers(workers + 1) {}
+            std::vector<WorkerStatistics> workers; // Last entry counts work done outside the pool's workers.
+            std::atomic<size_t> emitted{0};
+            std::atomic<Clock::rep> total_latency{0};
+            std::atomic<Clock::rep> max_latency{0};
+        };
+
+        void process_input(Core::GenericInputChannel input, Queue &queue, Window &window, Outstanding &outstanding,
+                           Core::ThreadPool &pool, Statistics &statistics);
+        void process_output(Core::OutputChannel output, Queue &queue, Window &window, Statistics &statistics);
+
+        Core::Message process_message(Core::Message message, Core::ThreadPool &pool, Statistics &statistics) const;
+        void report(const Statistics &statistics, Clock::duration elapsed) const;
 
         const size_t workers;
+        const size_t max_in_flight;
+        const bool ordered;
         const PureStream pureStream;
     };
 }
@@ -34,7 +34,11 @@ Gadgetron::Main::Nodes::PureStream::PureStream(
     const Gadgetron::Main::Config::PureStream& conf,
     const Gadgetron::Core::Context& context,
     Loader& loader
-) : pure_gadgets{ load_pure_gadgets(conf.gadgets, context, loader) } {}
+) : PureStream(load_pure_gadgets(conf.gadgets, context, loader)) {}
+
+Gadgetron::Main::Nodes::PureStream::PureStream(
+    std::vector<std::unique_ptr<Gadgetron::Core::GenericPureGadget>> pure_gadgets
+) : pure_gadgets{ std::move(pure_gadgets) } {}
 
 Gadgetron::Core::Message Gadgetron::Main::Nodes::PureStream::process_function(
     Gadgetron::Core::Message message
@@ -8,9 +8,10 @@ namespace Gadgetron::Main::Nodes {
     class PureStream {
     public:
         PureStream(const Config::PureStream&, const Core::Context&, Loader&);
+        explicit PureStream(std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets);
         Core::Message process_function(Core::Message) const;
 
     private:
-        const std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets;
+        std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets;
     };
 }
@@ -60,7 +60,13 @@ namespace {
 
 namespace Gadgetron::Main::Nodes {
 
-    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader) : key(config.key) {
+    Stream::Stream(const Config::Stream &config, const Core::StreamContext &context, Loader &loader) : key(config.key), channel_capacity(config.channel_capacity), trace(context.trace) {
+        if (!config.compute_budget.unrestricted()) {
+            budget = std::make_shared<const Core::ComputeBudget>(config.compute_budget);
+            GDEBUG("Stream %s computes on CPUs %s with %zu OpenMP threads\n", name().c_str(),
+                   Core::format_cpu_list(budget->cpus()).c_str(), budget->team_size());
+        }
+
         for (auto &node_config : config.nodes) {
             nodes.emplace_back(
                     std::visit([&](auto n) { return load_node(n, context, loader); }, node_config)
@@ -74,18 +80,23 @@ namespace Gadgetron::Main::Nodes {
     ) {
         if (empty()) return;
 
+        // The threads of the nodes inherit the budget from this one.
+        Core::Compute::Scope scope{budget ? budget : Core::Compute::current()};
+
         std::vector<GenericInputChannel> input_channels{};
         input_channels.emplace_back(std::move(input));
         std::vector<OutputChannel> output_channels{};
 
         for (auto i = 0; i < nodes.size()-1; i++) {
-            auto channel = make_channel<MessageChannel>();
+            auto channel = make_node_channel();
             input_channels.emplace_back(std::move(channel.input));
             output_channels.emplace_back(std::move(channel.output));
         }
 
         output_channels.emplace_back(std::move(output));
 
+        if (trace) trace_channels(input_channels, output_channels);
+
         ErrorHandler nested_handler{error_handler, name()};
 
         std::vector<std::thread> threads(nodes.size());
@@ -103,6 +114,28 @@ namespace Gadgetron::Main::Nodes {
         }
     }
 
+    ChannelPair Stream::make_node_channel() const {
+        if (channel_capacity) return make_channel<BoundedMessageChannel>(channel_capacity);
+        return make_channel<MessageChannel>();
+    }
+
+    void Stream::trace_channels(std::vector<GenericInputChannel> &inputs, std::vector<OutputChannel> &outputs) {
+        auto node_name = [&](size_t i) { return key.empty() ? nodes[i]->name() : key + "/" + nodes[i]->name(); };
+
+        for (size_t i = 0; i < nodes.size(); i++) {
+            auto &node = trace->node(node_name(i));
+
+            // The channels between nodes are traced at both ends; the input and output of the stream only at ours.
+            Core::Tracing::ChannelMetrics *input_channel = nullptr;
+            if (i > 0) input_channel = &trace->channel(node_name(i - 1) + " -> " + node.name);
+            Core::Tracing::ChannelMetrics *output_channel = nullptr;
+            if (i + 1 < nodes.size()) output_channel = &trace->channel(node.name + " -> " + node_name(i + 1));
+
+            inputs[i] = Core::Tracing::trace_input(std::move(inputs[i]), trace, node, input_channel);
+            outputs[i] = Core::Tracing::trace_output(std::move(outputs[i]), trace, node, output_channel);
+        }
+    }
+
     bool Stream::empty() const { return nodes.empty(); }
 }
 
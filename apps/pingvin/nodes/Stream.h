@@ -9,7 +9,9 @@
 #include "Processable.h"
 
 #include "Channel.h"
+#include "ComputeBudget.h"
 #include "Context.h"
+#include "Tracing.h"
 
 namespace Gadgetron::Main {
     class Loader;
@@ -32,6 +34,12 @@ namespace Gadgetron::Main::Nodes {
         const std::string &name() override;
 
     private:
+        Core::ChannelPair make_node_channel() const;
+        void trace_channels(std::vector<Core::GenericInputChannel> &inputs, std::vector<Core::OutputChannel> &outputs);
+
         std::vector<std::shared_ptr<Processable>> nodes;
+        const size_t channel_capacity;
+        const std::shared_ptr<Core::Tracing::Trace> trace;
+        std::shared_ptr<const Core::ComputeBudget> budget; // Null if the stream computes under its parent's budget.
     };
 }
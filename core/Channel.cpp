@@ -28,6 +28,24 @@ namespace Gadgetron::Core {
        channel.close();
     }
 
+    BoundedMessageChannel::BoundedMessageChannel(size_t capacity) : channel{capacity} {}
+
+    Message BoundedMessageChannel::pop() {
+        return channel.pop();
+    }
+
+    std::optional<Message> BoundedMessageChannel::try_pop() {
+        return channel.try_pop();
+    }
+
+    void BoundedMessageChannel::push_message(Message message) {
+        channel.push(std::move(message));
+    }
+
+    void BoundedMessageChannel::close() {
+        channel.close();
+    }
+
     Message GenericInputChannel::pop() {
         return channel->pop();
     }
@@ -121,6 +121,28 @@ namespace Gadgetron { namespace Core {
         MPMCChannel<Message> channel;
     };
 
+    /**
+     * A MessageChannel holding at most a fixed number of messages. Pushing to a full channel blocks until
+     * the consumer catches up, bounding the memory a fast producer can queue ahead of a slow consumer.
+     *
+     * Created with make_channel<BoundedMessageChannel>(capacity).
+     */
+    class BoundedMessageChannel : public Channel {
+    public:
+        explicit BoundedMessageChannel(size_t capacity);
+
+    protected:
+        Message pop() override;
+
+        std::optional<Message> try_pop() override;
+
+        void close() override;
+
+        void push_message(Message) override;
+
+        BoundedMPMCChannel<Message> channel;
+    };
+
     /***
      * Creates a ChannelPair
      * @tparam ChannelType Type of Channel, typically MessageChannel
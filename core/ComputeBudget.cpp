@@ -0,0 +1,195 @@
+#include "ComputeBudget.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace {
+    using namespace Gadgetron::Core;
+
+    thread_local std::shared_ptr<const ComputeBudget> current_budget;
+
+    // The CPUs and OpenMP team size of the process as it was started, restored for threads leaving a budget.
+    struct ProcessDefaults {
+        ProcessDefaults() {
+#ifdef __linux__
+            CPU_ZERO(&cpus);
+            sched_getaffinity(0, sizeof(cpus), &cpus);
+#endif
+#ifdef USE_OMP
+            threads = omp_get_max_threads();
+#endif
+        }
+
+#ifdef __linux__
+        cpu_set_t cpus;
+#endif
+        int threads = 1;
+    };
+
+    const ProcessDefaults process_defaults;
+
+    std::vector<unsigned int> numa_node_cpus(int node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!std::getline(file, list))
+            throw std::runtime_error("NUMA node " + std::to_string(node) + " not found");
+        return parse_cpu_list(list);
+    }
+
+    void pin(const std::vector<unsigned int> &cpus) {
+#ifdef __linux__
+        cpu_set_t set;
+        if (cpus.empty()) {
+            set = process_defaults.cpus;
+        } else {
+            CPU_ZERO(&set);
+            for (auto cpu : cpus) {
+                if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+            }
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            throw std::runtime_error("Could not pin thread to CPUs " + format_cpu_list(cpus));
+#endif
+    }
+
+    void set_team_size(int threads) {
+#ifdef USE_OMP
+        omp_set_num_threads(threads);
+#else
+        (void)threads;
+#endif
+    }
+
+    void enter(std::shared_ptr<const ComputeBudget> budget) {
+        if (budget) {
+            pin(budget->cpus());
+            auto team_size = budget->team_size();
+            set_team_size(team_size ? int(team_size) : process_defaults.threads);
+        } else {
+            pin({});
+            set_team_size(process_defaults.threads);
+        }
+        current_budget = std::move(budget);
+    }
+}
+
+namespace Gadgetron::Core {
+
+    std::vector<unsigned int> ComputeBudget::cpus() const {
+        if (cores.empty() && numa_node < 0) return {};
+
+        std::vector<unsigned int> result = cores;
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+
+        if (numa_node >= 0) {
+            auto node = numa_node_cpus(numa_node);
+            if (result.empty()) {
+                result = node;
+            } else {
+                std::vector<unsigned int> both;
+                std::set_intersection(result.begin(), result.end(), node.begin(), node.end(), std::back_inserter(both));
+                result = both;
+            }
+        }
+
+        if (result.empty())
+            throw std::runtime_error("Compute budget leaves no CPUs to run on");
+        return result;
+    }
+
+    size_t ComputeBudget::team_size() const {
+        return threads ? threads : cpus().size();
+    }
+
+    std::vector<unsigned int> parse_cpu_list(const std::string &list) {
+        std::vector<unsigned int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+            if (range.empty()) continue;
+
+            auto dash = range.find('-');
+            try {
+                size_t end;
+                unsigned long first = std::stoul(range.substr(0, dash), &end);
+                if (end != range.substr(0, dash).size()) throw std::invalid_argument(range);
+                unsigned long last = first;
+                if (dash != std::string::npos) {
+                    last = std::stoul(range.substr(dash + 1), &end);
+                    if (end != range.size() - dash - 1) throw std::invalid_argument(range);
+                }
+                if (last < first) throw std::invalid_argument(range);
+                for (auto cpu = first; cpu <= last; cpu++) cpus.push_back((unsigned int)cpu);
+            } catch (const std::logic_error &) {
+                throw std::invalid_argument("Invalid CPU list: " + list);
+            }
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    std::string format_cpu_list(const std::vector<unsigned int> &cpus) {
+        std::stringstream stream;
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+            if (i) stream << ',';
+            stream << cpus[i];
+            if (j > i) stream << '-' << cpus[j];
+            i = j + 1;
+        }
+        return stream.str();
+    }
+
+    namespace Compute {
+
+        std::shared_ptr<const ComputeBudget> current() { return current_budget; }
+
+        int max_threads() {
+#ifdef USE_OMP
+            return omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+        void limit_threads(size_t threads) {
+            set_team_size(std::max(1, std::min(int(threads), max_threads())));
+        }
+
+        ThreadLimit::ThreadLimit(size_t threads) : previous(max_threads()) { limit_threads(threads); }
+
+        ThreadLimit::~ThreadLimit() { set_team_size(previous); }
+
+        void release() { enter(nullptr); }
+
+        Scope::Scope(std::shared_ptr<const ComputeBudget> budget)
+            : previous(current_budget), entered(budget != current_budget) {
+            if (entered) enter(std::move(budget));
+        }
+
+        Scope::~Scope() {
+            if (!entered) return;
+            try {
+                enter(previous);
+            } catch (...) {
+                // The previous budget was entered before, so this does not fail in practice.
+            }
+        }
+    }
+}
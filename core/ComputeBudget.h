@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Gadgetron::Core {
+
+    /**
+     * The part of the machine a stream computes on: the CPUs its threads may run on, and the size of the OpenMP
+     * teams they start. Declared on a stream in the configuration, e.g.
+     *
+     *     <stream key="main" cores="0-15" threads="16"> ... </stream>
+     *     <stream key="main" numa_node="1"> ... </stream>
+     *
+     * Every thread of the stream, nodes and nested streams included, is pinned to the budget's CPUs, and so are the
+     * OpenMP teams those threads start. With numa_node, memory the stream touches first is allocated on that node.
+     */
+    struct ComputeBudget {
+        std::vector<unsigned int> cores; ///< CPUs the threads may run on; empty for any.
+        int numa_node = -1;              ///< Restricts the CPUs to those of a NUMA node; -1 for any.
+        size_t threads = 0;              ///< OpenMP team size; 0 for one thread per CPU of the budget.
+
+        bool unrestricted() const { return cores.empty() && numa_node < 0 && threads == 0; }
+
+        /// The CPUs the budget allows, empty if it does not restrict them. Throws if none are left.
+        std::vector<unsigned int> cpus() const;
+
+        /// OpenMP team size under the budget; 0 if it does not set one.
+        size_t team_size() const;
+    };
+
+    /// Parses a CPU list in the format of /sys/devices/system/cpu, e.g. "0-7,16-23".
+    std::vector<unsigned int> parse_cpu_list(const std::string &list);
+
+    std::string format_cpu_list(const std::vector<unsigned int> &cpus);
+
+    /**
+     * Runtime side of compute budgets. Nodes ask here how many threads they may use, rather than changing the
+     * OpenMP state of the process.
+     */
+    namespace Compute {
+
+        /// Budget of the calling thread; null if it runs unrestricted.
+        std::shared_ptr<const ComputeBudget> current();
+
+        /// OpenMP team size for parallel regions started by the calling thread.
+        int max_threads();
+
+        /// Caps the OpenMP team size of the calling thread, within its budget. For nodes that do not scale.
+        void limit_threads(size_t threads);
+
+        /**
+         * Caps the OpenMP team size of the calling thread for the lifetime of the scope, restoring it afterwards.
+         * Nodes that do not scale hold one in process(), which runs on the node's own thread; their constructors
+         * run on the thread loading the stream.
+         */
+        class ThreadLimit {
+        public:
+            explicit ThreadLimit(size_t threads);
+            ~ThreadLimit();
+
+            ThreadLimit(const ThreadLimit &) = delete;
+            ThreadLimit &operator=(const ThreadLimit &) = delete;
+
+        private:
+            int previous;
+        };
+
+        /// Releases the calling thread from any budget: it runs on all CPUs of the process again, with the default
+        /// OpenMP team size.
+        void release();
+
+        /**
+         * Runs the calling thread under a budget for the lifetime of the scope, restoring its previous budget
+         * afterwards. Threads started by the nodes of a stream inherit the budget of the thread starting them.
+         */
+        class Scope {
+        public:
+            explicit Scope(std::shared_ptr<const ComputeBudget> budget);
+            ~Scope();
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            std::shared_ptr<const ComputeBudget> previous;
+            bool entered;
+        };
+    }
+}
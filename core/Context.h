@@ -4,8 +4,14 @@
 
 #include <mrd/types.h>
 
+#include <memory>
+
 namespace Gadgetron::Core {
 
+    namespace Tracing {
+        class Trace;
+    }
+
     struct Context {
         using Header = mrd::Header;
 
@@ -35,6 +41,9 @@ namespace Gadgetron::Core {
 
         Args args;
 
+        /// Records the activity of the stream's nodes when set; see Tracing::Trace.
+        std::shared_ptr<Tracing::Trace> trace;
+
         private:
         static std::map<std::string, std::string> GetParameters(const boost::program_options::variables_map& args) {
             std::map<std::string, std::string> parameters;
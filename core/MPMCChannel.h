@@ -1,9 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
-#include <list>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 
 namespace Gadgetron::Core {
 
@@ -22,12 +29,75 @@ namespace Gadgetron::Core {
 
     private:
         T pop_impl(std::unique_lock<std::mutex> lock);
-        std::list<T> queue;
+        std::deque<T> queue;
         bool is_closed = false;
         std::mutex m;
         std::condition_variable cv;
     };
 
+    /**
+     * A fixed capacity MPMC channel backed by a lock-free ring buffer.
+     *
+     * Push and pop are lock- and allocation-free as long as the buffer is neither full nor empty. Producers
+     * hitting a full buffer (and consumers hitting an empty one) spin briefly before parking on a condition
+     * variable, so a slow consumer applies backpressure to its producers instead of letting the queue grow.
+     * The capacity is rounded up to the nearest power of two.
+     */
+    template <class T> class BoundedMPMCChannel {
+    public:
+        explicit BoundedMPMCChannel(size_t capacity);
+        ~BoundedMPMCChannel();
+
+        BoundedMPMCChannel(const BoundedMPMCChannel&) = delete;
+        BoundedMPMCChannel& operator=(const BoundedMPMCChannel&) = delete;
+
+        void push(T);
+
+        template <class... ARGS> void emplace(ARGS&&... args);
+
+        T pop();
+        std::optional<T> try_pop();
+
+        void close();
+
+        size_t capacity() const { return mask + 1; }
+
+    private:
+        static_assert(std::is_nothrow_move_constructible_v<T>,
+                      "BoundedMPMCChannel requires a nothrow move constructible type");
+
+        static constexpr size_t spin_limit = 128;
+        static constexpr size_t cache_line = 64;
+
+        struct Cell {
+            std::atomic<size_t> sequence;
+            std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+        };
+
+        bool try_push_impl(T& message);
+        std::optional<T> try_pop_impl();
+
+        static size_t ring_size(size_t capacity);
+
+        bool has_space() const;
+        bool has_data() const;
+
+        void wake(std::condition_variable& cv, std::atomic<size_t>& waiting);
+
+        const size_t mask;
+        std::unique_ptr<Cell[]> buffer;
+
+        alignas(cache_line) std::atomic<size_t> enqueue_pos{0};
+        alignas(cache_line) std::atomic<size_t> dequeue_pos{0};
+        alignas(cache_line) std::atomic<bool> is_closed{false};
+
+        std::atomic<size_t> waiting_producers{0};
+        std::atomic<size_t> waiting_consumers{0};
+        std::mutex m;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+    };
+
     class ChannelClosed : public std::runtime_error {
     public:
         ChannelClosed() : std::runtime_error("Channel was closed"){};
@@ -90,4 +160,147 @@ namespace Gadgetron::Core {
         other.is_closed = true;
     }
 
+    template <class T>
+    BoundedMPMCChannel<T>::BoundedMPMCChannel(size_t capacity)
+        : mask{ ring_size(capacity) - 1 }, buffer{ new Cell[mask + 1] } {
+        for (size_t i = 0; i <= mask; i++)
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <class T> size_t BoundedMPMCChannel<T>::ring_size(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+    template <class T> BoundedMPMCChannel<T>::~BoundedMPMCChannel() {
+        while (try_pop_impl()) {}
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::try_push_impl(T& message) {
+        Cell* cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer[pos & mask];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::move(message));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T> std::optional<T> BoundedMPMCChannel<T>::try_pop_impl() {
+        Cell* cell;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer[pos & mask];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        auto item = std::launder(reinterpret_cast<T*>(&cell->storage));
+        std::optional<T> message{ std::move(*item) };
+        item->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return message;
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::has_space() const {
+        auto pos = enqueue_pos.load(std::memory_order_relaxed);
+        return buffer[pos & mask].sequence.load(std::memory_order_acquire) == pos;
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::has_data() const {
+        auto pos = dequeue_pos.load(std::memory_order_relaxed);
+        return buffer[pos & mask].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    template <class T>
+    void BoundedMPMCChannel<T>::wake(std::condition_variable& cv, std::atomic<size_t>& waiting) {
+        // Pairs with the fence taken by a thread before it parks; either it sees our update, or we see it waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) == 0)
+            return;
+        { std::lock_guard<std::mutex> guard(m); }
+        cv.notify_all();
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::push(T message) {
+        if (is_closed.load(std::memory_order_acquire))
+            throw ChannelClosed();
+        for (size_t spin = 0; !try_push_impl(message); spin++) {
+            if (is_closed.load(std::memory_order_acquire))
+                throw ChannelClosed();
+            if (spin < spin_limit) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m);
+            waiting_producers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            not_full.wait(lock, [this]() { return has_space() || is_closed.load(std::memory_order_acquire); });
+            waiting_producers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        wake(not_empty, waiting_consumers);
+    }
+
+    template <class T> template <class... ARGS> void BoundedMPMCChannel<T>::emplace(ARGS&&... args) {
+        push(T(std::forward<ARGS>(args)...));
+    }
+
+    template <class T> T BoundedMPMCChannel<T>::pop() {
+        for (size_t spin = 0;; spin++) {
+            if (auto message = try_pop_impl()) {
+                wake(not_full, waiting_producers);
+                return std::move(*message);
+            }
+            if (is_closed.load(std::memory_order_acquire)) {
+                if (auto message = try_pop_impl())
+                    return std::move(*message);
+                throw ChannelClosed();
+            }
+            if (spin < spin_limit) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m);
+            waiting_consumers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            not_empty.wait(lock, [this]() { return has_data() || is_closed.load(std::memory_order_acquire); });
+            waiting_consumers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <class T> std::optional<T> BoundedMPMCChannel<T>::try_pop() {
+        auto message = try_pop_impl();
+        if (message)
+            wake(not_full, waiting_producers);
+        return message;
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::close() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            is_closed.store(true, std::memory_order_release);
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
 }
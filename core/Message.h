@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <typeindex>
@@ -7,6 +8,8 @@
 #include <optional>
 #include <variant>
 
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+
 namespace Gadgetron {
 
     namespace Core {
@@ -37,6 +40,7 @@ namespace Gadgetron {
 
             std::vector<std::unique_ptr<MessageChunk>> take_messages();
 
+            /// Returns a message sharing the payloads of this one; see Shared.
             Message clone();
 
         private:
@@ -63,12 +67,67 @@ namespace Gadgetron {
         std::optional<T> unpack(Message &&message);
 
 
+        /**
+         * An immutable, reference counted message payload. Copying a Shared copies the reference, not the payload, so
+         * a message sent down several branches is stored once. The payload is only copied when it is mutated or taken
+         * while someone else still holds it.
+         *
+         * Unpacking a message as Shared<T> rather than T gives read-only access without copying. Pushing a Shared<T>
+         * sends a message of type T.
+         */
+        template<class T>
+        class Shared {
+        public:
+            template<class... ARGS>
+            explicit Shared(std::in_place_t, ARGS &&... xs) : payload(new Payload(std::forward<ARGS>(xs)...)) {}
+
+            explicit Shared(T value) : payload(new Payload(std::move(value))) {}
+
+            const T &operator*() const { return payload->value; }
+
+            const T *operator->() const { return &payload->value; }
+
+            const T &get() const { return payload->value; }
+
+            /// True if no other message or branch holds this payload.
+            bool unique() const { return payload && payload->owners.load(std::memory_order_acquire) == 1; }
+
+            /// Mutable access to the payload, copying it first if it is held elsewhere.
+            T &mutate();
+
+            /// Takes the payload, moving it out if this is the only reference and copying it otherwise.
+            T take() &&;
+
+        private:
+            // Counted by hand rather than through shared_ptr, whose use_count() is a relaxed load. Here the acquire
+            // in unique() pairs with the release by the last other holder, so a branch on another thread has
+            // finished copying the payload before this one moves out of it.
+            struct Payload {
+                template<class... ARGS>
+                explicit Payload(ARGS &&... xs) : value(std::forward<ARGS>(xs)...) {}
+
+                T value;
+                std::atomic<size_t> owners{0};
+
+                friend void intrusive_ptr_add_ref(Payload *p) { p->owners.fetch_add(1, std::memory_order_relaxed); }
+
+                friend void intrusive_ptr_release(Payload *p) {
+                    if (p->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) delete p;
+                }
+            };
+
+            boost::intrusive_ptr<Payload> payload;
+        };
+
+
         template<class T>
         class TypedMessageChunk : public MessageChunk {
         public:
 
             template<class... ARGS>
-            explicit TypedMessageChunk(ARGS &&... xs) : data(std::forward<ARGS>(xs)...) {}
+            explicit TypedMessageChunk(ARGS &&... xs) : data(std::in_place, std::forward<ARGS>(xs)...) {}
+
+            explicit TypedMessageChunk(Shared<T> shared) : data(std::move(shared)) {}
 
             TypedMessageChunk(TypedMessageChunk &&other) = default;
 
@@ -82,9 +141,26 @@ namespace Gadgetron {
 
             ~TypedMessageChunk() override = default;
 
-            T data;
+            Shared<T> data;
 
         };
+
+        /**
+         * The type to unpack a shared T as. A message holds a single alternative of a variant, so a variant is
+         * unpacked as a variant of shared alternatives rather than as a shared variant.
+         */
+        template<class T>
+        struct shared_payload {
+            using type = Shared<T>;
+        };
+
+        template<class... VTYPES>
+        struct shared_payload<std::variant<VTYPES...>> {
+            using type = std::variant<Shared<VTYPES>...>;
+        };
+
+        template<class T>
+        using SharedPayload = typename shared_payload<T>::type;
     }
 }
 
@@ -8,6 +8,18 @@
 namespace Gadgetron::Core {
 
 
+    template<class T>
+    T &Shared<T>::mutate() {
+        if (!unique()) payload = new Payload(payload->value);
+        return payload->value;
+    }
+
+    template<class T>
+    T Shared<T>::take() && {
+        if (unique()) return std::move(payload->value);
+        return payload->value;
+    }
+
     template<class T>
     std::unique_ptr<MessageChunk> TypedMessageChunk<T>::clone() const {
         return std::make_unique<TypedMessageChunk<T>>(data);
@@ -18,7 +30,12 @@ namespace Gadgetron::Core {
 
             template<class T>
             std::unique_ptr<MessageChunk> make_message(T &&input) {
-                return std::make_unique<TypedMessageChunk<std::remove_reference_t<T>>>(std::forward<T>(input));
+                return std::make_unique<TypedMessageChunk<std::remove_cv_t<std::remove_reference_t<T>>>>(std::forward<T>(input));
+            }
+
+            template<class T>
+            std::unique_ptr<MessageChunk> make_message(Shared<T> input) {
+                return std::make_unique<TypedMessageChunk<T>>(std::move(input));
             }
 
             struct MessageMaker {
@@ -46,6 +63,13 @@ namespace Gadgetron::Core {
                     add_messages(messages, std::forward<REST>(args)...);
                 }
 
+                template<class T, class ...REST>
+                static void
+                add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages, Shared<T> shared, REST &&... args) {
+                    messages.emplace_back(make_message(std::move(shared)));
+                    add_messages(messages, std::forward<REST>(args)...);
+                }
+
                 template<class T, class ...REST>
                 static void
                 add_messages(std::vector<std::unique_ptr<MessageChunk>> &messages, T &&arg, REST &&... args) {
@@ -75,6 +99,31 @@ namespace Gadgetron::Core {
 
             namespace hana = boost::hana;
 
+            // Unpacking as T takes the payload out of the chunk; unpacking as Shared<T> takes the reference.
+            template<class T>
+            struct payload {
+                using type = T;
+
+                static T extract(MessageChunk &chunk) {
+                    return std::move(static_cast<TypedMessageChunk<T> &>(chunk).data).take();
+                }
+            };
+
+            template<class T>
+            struct payload<Shared<T>> {
+                using type = T;
+
+                static Shared<T> extract(MessageChunk &chunk) {
+                    return std::move(static_cast<TypedMessageChunk<T> &>(chunk).data);
+                }
+            };
+
+            // No chunk holds a variant, only one of its alternatives; such messages are unpacked as SharedPayload.
+            template<class... VTYPES>
+            struct payload<Shared<std::variant<VTYPES...>>> {
+                static_assert(sizeof...(VTYPES) == 0, "Unpack a variant as SharedPayload<std::variant<...>>, not as a Shared variant");
+            };
+
             struct detail {
                 template<class Iterator>
                 static bool convertible(Iterator it, const Iterator &it_end) {
@@ -85,7 +134,7 @@ namespace Gadgetron::Core {
                 static bool convertible(Iterator it, const Iterator &it_end, const hana::basic_type<T> &,
                                         const hana::basic_type<TYPES> &... xs) {
                     if (it == it_end) return false;
-                    if (typeid(TypedMessageChunk<T>) == typeid(**it)) {
+                    if (typeid(TypedMessageChunk<typename payload<T>::type>) == typeid(**it)) {
                         return convertible(++it, it_end, xs...);
                     }
                     return false;
@@ -129,28 +178,23 @@ namespace Gadgetron::Core {
                 }
 
 
-                template<class T>
-                static TypedMessageChunk <T> &reinterpret_message(MessageChunk &message) {
-                    return static_cast<TypedMessageChunk<T> &>(message);
-                }
-
                 template<class Iterator, class T>
                 static T convert(Iterator &it, const Iterator &it_end, const hana::basic_type<T>&) {
-                    return std::move(reinterpret_message<T>(**it).data);
+                    return payload<T>::extract(**it);
                 }
 
                 template<class Iterator, class T>
                 static std::optional <T> convert(Iterator &it, const Iterator &it_end, const hana::basic_type<std::optional < T>>
 
                 ) {
-                    if (convertible(it, it_end, hana::type_c<T>)) return reinterpret_message<T>(**it).data;
+                    if (convertible(it, it_end, hana::type_c<T>)) return payload<T>::extract(**it);
                     return std::optional<T>();
                 }
 
                 template<class Iterator, class T, class... TYPES>
                 static hana::tuple<T, TYPES...> convert(Iterator &it, const Iterator &it_end, const hana::basic_type<T>&,
                                                         const hana::basic_type<TYPES> &...xs) {
-                    auto &value = reinterpret_message<T>(**it).data;
+                    auto value = payload<T>::extract(**it);
                     return combine(std::move(value), convert(++it, it_end, xs...));
                 }
 
@@ -162,7 +206,7 @@ namespace Gadgetron::Core {
                 ) {
 
                     if (convertible(it, it_end, hana::basic_type<T>(), xs...)) {
-                        auto &val = reinterpret_message<T>(**it).data;
+                        auto val = payload<T>::extract(**it);
                         return combine(std::optional<T>(std::move(val)), convert(++it, it_end, xs...));
                     }
                     return combine(std::optional<T>(), convert(it, it_end, xs...));
@@ -181,7 +225,8 @@ namespace Gadgetron::Core {
                 convert(Iterator it, const Iterator &it_end, const hana::basic_type<std::variant < VTYPES...>>&) {
 
                     constexpr auto vtypes = hana::tuple_t<VTYPES...>;
-                    std::variant < VTYPES...> variation;
+                    // Optional, as the alternatives need not be default constructible (e.g. Shared).
+                    std::optional<std::variant < VTYPES...>> variation;
                     bool variant_found = hana::fold(vtypes, false, [&](bool result, auto type) {
                         if (result) return true;
                         if (convertible(it, it_end, type)) {
@@ -194,7 +239,7 @@ namespace Gadgetron::Core {
                         throw std::runtime_error("Tried to convert message to variant, but no legal type was found");
 
 
-                    return variation;
+                    return std::move(*variation);
                 }
 
 
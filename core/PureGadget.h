@@ -27,7 +27,9 @@ public:
         return  Message(process_function(force_unpack<INPUT>(std::move(message))));
     }
     /***
-     * Takes in an input of type INPUT and returns an output message with type RETURN
+     * Takes in an input of type INPUT and returns an output message with type RETURN.
+     * A payload shared with other branches is copied when unpacked as INPUT, unless it is the last reference.
+     * Gadgets that only read their input can take a Shared<INPUT> instead, which never copies.
      * @param args Input argument
      * @return The processed message
      */
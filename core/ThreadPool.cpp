@@ -0,0 +1,150 @@
+#include "ThreadPool.h"
+
+#include "ComputeBudget.h"
+
+namespace Gadgetron::Core {
+
+    thread_local ThreadPool* ThreadPool::current_pool = nullptr;
+    thread_local size_t ThreadPool::current_index = 0;
+
+    ThreadPool::ThreadPool(unsigned int n_workers) {
+        for (auto i = 0u; i < n_workers; i++)
+            workers.push_back(std::make_unique<Worker>());
+        // Workers compute under the budget of the thread creating the pool.
+        auto budget = Compute::current();
+        for (auto i = 0u; i < n_workers; i++)
+            threads.emplace_back([this, i, budget]() {
+                Compute::Scope scope{budget};
+                this->worker_loop(i);
+            });
+    }
+
+    ThreadPool::~ThreadPool() {
+        if (!stopping)
+            stop();
+    }
+
+    ThreadPool& ThreadPool::global() {
+        // Shared by all streams, so its workers run outside of the budget of whichever stream happens to create it.
+        static std::unique_ptr<ThreadPool> pool = []() {
+            Compute::Scope unrestricted{nullptr};
+            return std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+        }();
+        return *pool;
+    }
+
+    bool ThreadPool::is_worker_of(const ThreadPool* pool) {
+        return pool != nullptr && current_pool == pool;
+    }
+
+    std::optional<size_t> ThreadPool::worker_index() const {
+        if (!is_worker_of(this))
+            return std::nullopt;
+        return current_index;
+    }
+
+    void ThreadPool::submit(Task task) {
+        if (stopping.load(std::memory_order_acquire))
+            throw ChannelClosed();
+
+        auto& queue = is_worker_of(this) ? *workers[current_index] : injection;
+        {
+            std::lock_guard<std::mutex> guard(queue.m);
+            queue.tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1);
+
+        if (sleeping.load() > 0) {
+            { std::lock_guard<std::mutex> guard(sleep_mutex); }
+            wakeup.notify_one();
+        }
+    }
+
+    std::optional<Task> ThreadPool::next_task(size_t index) {
+        auto take = [this](Worker& worker, bool back) -> std::optional<Task> {
+            std::lock_guard<std::mutex> guard(worker.m);
+            if (worker.tasks.empty())
+                return std::nullopt;
+            Task task = back ? std::move(worker.tasks.back()) : std::move(worker.tasks.front());
+            back ? worker.tasks.pop_back() : worker.tasks.pop_front();
+            queued.fetch_sub(1);
+            return task;
+        };
+
+        if (queued.load() == 0)
+            return std::nullopt;
+
+        if (auto task = take(*workers[index], true))
+            return task;
+        if (auto task = take(injection, false))
+            return task;
+        for (size_t offset = 1; offset < workers.size(); offset++) {
+            if (auto task = take(*workers[(index + offset) % workers.size()], false))
+                return task;
+        }
+        return std::nullopt;
+    }
+
+    bool ThreadPool::run_pending_task() {
+        auto task = next_task(current_index);
+        if (!task)
+            return false;
+        run(*task);
+        return true;
+    }
+
+    void ThreadPool::run(Task& task) {
+        // Only posted work gets here with an exception; async catches its own and hands it to the Future.
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(error_mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    void ThreadPool::worker_loop(size_t index) {
+        current_pool  = this;
+        current_index = index;
+
+        while (true) {
+            if (auto task = next_task(index)) {
+                run(*task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleeping.fetch_add(1);
+            wakeup.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+            sleeping.fetch_sub(1);
+
+            if (stopping.load() && queued.load() == 0)
+                return;
+        }
+    }
+
+    void ThreadPool::join() {
+        stop();
+
+        std::exception_ptr posted_error;
+        {
+            std::lock_guard<std::mutex> guard(error_mutex);
+            std::swap(posted_error, error);
+        }
+        if (posted_error)
+            std::rethrow_exception(posted_error);
+    }
+
+    void ThreadPool::stop() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_mutex);
+            stopping.store(true);
+        }
+        wakeup.notify_all();
+        for (auto& thread : threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+}
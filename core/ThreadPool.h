@@ -4,102 +4,377 @@
 
 #pragma once
 #include "MPMCChannel.h"
-#include <boost/hana.hpp>
-#include <future>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 namespace Gadgetron::Core {
 
+    /**
+     * Move-only, type erased nullary callable. Closures up to inline_size bytes are stored in place, so
+     * submitting them to a ThreadPool does not allocate; larger closures fall back to the heap.
+     */
+    class Task {
+    public:
+        Task() = default;
+
+        template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+        Task(F&& f);
+
+        Task(Task&& other) noexcept;
+        Task& operator=(Task&& other) noexcept;
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task();
+
+        void operator()();
+        explicit operator bool() const { return ops != nullptr; }
+
+        static constexpr size_t inline_size = 64 - sizeof(void*);
 
-    class ThreadPool {
     private:
-        class Work {
-        public:
-            virtual void execute() = 0;
-            virtual ~Work()        = default;
+        struct Operations {
+            void (*invoke)(void*);
+            void (*move)(void* from, void* to);
+            void (*destroy)(void*);
         };
 
-        template <class F, class... ARGS> class Storage{
-        public:
-            explicit Storage(F&& f, ARGS&&... args)
-                : f{ std::forward<F>(f) }, args{ std::forward<ARGS>(args)... } {}
-        protected:
-            F f;
-            boost::hana::tuple<std::decay_t<ARGS>...> args;
-        public:
-            using R = decltype(boost::hana::unpack(std::move(args),f));
-        protected:
-            std::promise<R> promise;
+        template <class F> struct InlineOperations;
+        template <class F> struct HeapOperations;
 
+        template <class F>
+        static constexpr bool fits_inline = sizeof(F) <= inline_size && alignof(F) <= alignof(std::max_align_t) &&
+                                            std::is_nothrow_move_constructible_v<F>;
 
-        public:
-            std::future<R> get_future() {
-                return promise.get_future();
-            }
-        };
-        template<class F, bool IS_VOID, class... ARGS> class ConcreteWorkImpl{};
+        void reset();
+
+        alignas(std::max_align_t) unsigned char storage[inline_size];
+        const Operations* ops = nullptr;
+    };
 
-        template<class F, class... ARGS> class ConcreteWorkImpl<F,false,ARGS...> : public Work, public Storage<F,ARGS...> {
+    class ThreadPool;
+
+    namespace detail {
+        template <class R> class FutureState {
         public:
-            using Storage<F,ARGS...>::Storage;
-
-            void execute() override {
-                try {
-                    auto val = boost::hana::unpack(std::move(this->args),this->f);
-                    this->promise.set_value(std::move(val));
-                } catch (...){
-                    this->promise.set_exception(std::current_exception());
+            using Value = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+            template <class... ARGS> void set_value(ARGS&&... args) {
+                {
+                    std::lock_guard<std::mutex> guard(m);
+                    value.emplace(std::forward<ARGS>(args)...);
+                    done.store(true, std::memory_order_release);
                 }
+                cv.notify_all();
             }
-        };
-        template<class F, class... ARGS> class ConcreteWorkImpl<F,true,ARGS...> : public Work, public Storage<F,ARGS...> {
-        public:
-            using Storage<F,ARGS...>::Storage;
-
-            void execute() override {
-                try {
-                    boost::hana::unpack(std::move(this->args),this->f);
-                    this->promise.set_value();
-                } catch (...){
-                    this->promise.set_exception(std::current_exception());
+
+            void set_exception(std::exception_ptr exception) {
+                {
+                    std::lock_guard<std::mutex> guard(m);
+                    error = std::move(exception);
+                    done.store(true, std::memory_order_release);
                 }
+                cv.notify_all();
             }
-        };
 
-    template<class F, class... ARGS> class ConcreteWork : public ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...> {
-        public:
-            using ConcreteWorkImpl<F, std::is_same<typename Storage<F,ARGS...>::R,void>::value,ARGS...>::ConcreteWorkImpl;
+            bool ready() const { return done.load(std::memory_order_acquire); }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [this]() { return ready(); });
+            }
+
+            template <class DURATION> void wait_for(DURATION duration) {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait_for(lock, duration, [this]() { return ready(); });
+            }
+
+            Value take() {
+                if (error)
+                    std::rethrow_exception(error);
+                return std::move(*value);
+            }
+
+        private:
+            std::atomic<bool> done{ false };
+            std::optional<Value> value;
+            std::exception_ptr error;
+            std::mutex m;
+            std::condition_variable cv;
         };
+    }
+
+    /**
+     * Completion handle for work submitted through ThreadPool::async. The result and the closure share a
+     * single allocation. Waiting on a Future from one of the pool's own workers executes other queued work
+     * while waiting, so nested parallelism does not deadlock the pool.
+     */
+    template <class R> class Future {
+    public:
+        Future() = default;
+
+        R get();
+        void wait() const;
+        bool ready() const { return state->ready(); }
+        bool valid() const { return bool(state); }
+
+    private:
+        friend ThreadPool;
+        template <class> friend class Promise;
+        explicit Future(std::shared_ptr<detail::FutureState<R>> state) : state{ std::move(state) } {}
+
+        std::shared_ptr<detail::FutureState<R>> state;
+    };
 
+    /**
+     * Producing end of a Future, for work whose result is not simply the return value of a task.
+     */
+    template <class R> class Promise {
     public:
-        explicit ThreadPool(unsigned int workers) {
-            for (auto i = 0u; i < workers; i++) {
-                threads.emplace_back([this]() {
-                    try {
-                        while (true)
-                            this->work_queue.pop()->execute();
-                    } catch (const ChannelClosed&) {
-                    }
-                });
+        Promise() : state{ std::make_shared<detail::FutureState<R>>() } {}
+
+        Future<R> get_future() const { return Future<R>(state); }
+
+        template <class... ARGS> void set_value(ARGS&&... args) { state->set_value(std::forward<ARGS>(args)...); }
+        void set_exception(std::exception_ptr exception) { state->set_exception(std::move(exception)); }
+
+    private:
+        std::shared_ptr<detail::FutureState<R>> state;
+    };
+
+    /**
+     * Work-stealing thread pool.
+     *
+     * Each worker owns a deque; work submitted from a worker goes to the back of its own deque and is
+     * executed LIFO, while idle workers steal from the front of their siblings' deques. Work submitted from
+     * outside the pool goes to a shared injection queue. A single process-wide pool is available through
+     * ThreadPool::global(), which is what should normally be used to avoid oversubscribing the machine.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned int workers);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// Runs f(args...) on the pool, returning a Future holding the result.
+        template <class F, class... ARGS> auto async(F&& f, ARGS&&... args);
+
+        /**
+         * Runs f on the pool without a completion handle. Small closures are submitted without allocating.
+         * An exception thrown by f is kept, and the first one kept is rethrown by join().
+         */
+        template <class F> void post(F&& f);
+
+        /**
+         * Calls f(i) for every i in [begin, end), split in chunks across the pool. The calling thread takes part
+         * in the work, and the call returns once all iterations are done. The first exception thrown is rethrown.
+         */
+        template <class F> void parallel_for(size_t begin, size_t end, F&& f);
+
+        /// Finishes queued work, then stops and joins the workers. Rethrows the first exception thrown by posted work.
+        void join();
+
+        size_t size() const { return workers.size(); }
+
+        /// Index of the calling thread among this pool's workers, if it is one.
+        std::optional<size_t> worker_index() const;
+
+        /// The process-wide pool, sized to the hardware concurrency.
+        static ThreadPool& global();
+
+    private:
+        struct Worker {
+            std::mutex m;
+            std::deque<Task> tasks;
+        };
+
+        template <class R> friend class Future;
+
+        void submit(Task task);
+        std::optional<Task> next_task(size_t index);
+        bool run_pending_task();
+        void run(Task& task);
+        void worker_loop(size_t index);
+        void stop();
+
+        static bool is_worker_of(const ThreadPool* pool);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        Worker injection;
+        std::vector<std::thread> threads;
+
+        std::atomic<size_t> queued{ 0 };
+        std::atomic<size_t> sleeping{ 0 };
+        std::atomic<bool> stopping{ false };
+        std::mutex sleep_mutex;
+        std::condition_variable wakeup;
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        static thread_local ThreadPool* current_pool;
+        static thread_local size_t current_index;
+    };
+
+    /** Implementation **/
+
+    template <class F> struct Task::InlineOperations {
+        static void invoke(void* p) { (*static_cast<F*>(p))(); }
+        static void move(void* from, void* to) {
+            new (to) F(std::move(*static_cast<F*>(from)));
+            static_cast<F*>(from)->~F();
+        }
+        static void destroy(void* p) { static_cast<F*>(p)->~F(); }
+        static constexpr Operations operations{ invoke, move, destroy };
+    };
+
+    template <class F> struct Task::HeapOperations {
+        static void invoke(void* p) { (**static_cast<F**>(p))(); }
+        static void move(void* from, void* to) { *static_cast<F**>(to) = *static_cast<F**>(from); }
+        static void destroy(void* p) { delete *static_cast<F**>(p); }
+        static constexpr Operations operations{ invoke, move, destroy };
+    };
+
+    template <class F, class> Task::Task(F&& f) {
+        using Callable = std::decay_t<F>;
+        if constexpr (fits_inline<Callable>) {
+            new (storage) Callable(std::forward<F>(f));
+            ops = &InlineOperations<Callable>::operations;
+        } else {
+            *reinterpret_cast<Callable**>(storage) = new Callable(std::forward<F>(f));
+            ops = &HeapOperations<Callable>::operations;
+        }
+    }
+
+    inline Task::Task(Task&& other) noexcept : ops{ other.ops } {
+        if (ops) {
+            ops->move(other.storage, storage);
+            other.ops = nullptr;
+        }
+    }
+
+    inline Task& Task::operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops) {
+                ops->move(other.storage, storage);
+                other.ops = nullptr;
             }
         }
+        return *this;
+    }
+
+    inline Task::~Task() { reset(); }
+
+    inline void Task::reset() {
+        if (ops)
+            ops->destroy(storage);
+        ops = nullptr;
+    }
+
+    inline void Task::operator()() { ops->invoke(storage); }
+
+    template <class R> void Future<R>::wait() const {
+        if (!ThreadPool::current_pool) {
+            state->wait();
+            return;
+        }
+        while (!state->ready()) {
+            if (!ThreadPool::current_pool->run_pending_task())
+                state->wait_for(std::chrono::microseconds(100));
+        }
+    }
 
-        template <class F, class... ARGS> auto async(F&& f, ARGS&&... args) {
-            auto work = std::make_unique<ConcreteWork<F, ARGS...>>(std::forward<F>(f), std::forward<ARGS>(args)...);
-            auto future_result = work->get_future();
-            work_queue.push(std::move(work));
-            return std::move(future_result);
+    template <class R> R Future<R>::get() {
+        wait();
+        auto local_state = std::move(state);
+        if constexpr (std::is_void_v<R>) {
+            local_state->take();
+        } else {
+            return local_state->take();
         }
+    }
+
+    template <class F, class... ARGS> auto ThreadPool::async(F&& f, ARGS&&... args) {
+        using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<ARGS>...>;
+
+        Promise<R> promise;
+        auto future = promise.get_future();
+        submit(Task([promise, f = std::forward<F>(f), args = std::make_tuple(std::forward<ARGS>(args)...)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    std::apply(f, std::move(args));
+                    promise.set_value();
+                } else {
+                    promise.set_value(std::apply(f, std::move(args)));
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }));
+        return future;
+    }
+
+    template <class F> void ThreadPool::post(F&& f) {
+        submit(Task(std::forward<F>(f)));
+    }
+
+    template <class F> void ThreadPool::parallel_for(size_t begin, size_t end, F&& f) {
+        if (begin >= end)
+            return;
 
-        void join(){
-            work_queue.close();
-            for (auto& thread : threads){
-                thread.join();
+        const size_t count = end - begin;
+        const size_t chunk = std::max<size_t>(1, count / (4 * (size() + 1)));
+        std::atomic<size_t> next{ begin };
+
+        auto run_chunks = [&]() {
+            for (size_t start = next.fetch_add(chunk); start < end; start = next.fetch_add(chunk)) {
+                for (size_t i = start; i < std::min(start + chunk, end); i++)
+                    f(i);
             }
+        };
+
+        const size_t helpers = std::min(size(), (count + chunk - 1) / chunk - 1);
+        std::vector<Future<void>> futures;
+        futures.reserve(helpers);
+        for (size_t i = 0; i < helpers; i++)
+            futures.push_back(async(run_chunks));
+
+        std::exception_ptr error;
+        try {
+            run_chunks();
+        } catch (...) {
+            error = std::current_exception();
+            next.store(end);
         }
 
-    private:
-        MPMCChannel<std::unique_ptr<Work>> work_queue;
-        std::vector<std::thread> threads;
-    };
+        for (auto& future : futures) {
+            try {
+                future.get();
+            } catch (...) {
+                if (!error)
+                    error = std::current_exception();
+                next.store(end);
+            }
+        }
 
+        if (error)
+            std::rethrow_exception(error);
+    }
 }
@@ -0,0 +1,316 @@
+#include "Tracing.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include <mrd/types.h>
+
+#include "hoMemoryPool.h"
+
+namespace Gadgetron::Core::Tracing {
+
+    namespace {
+        int64_t nanoseconds(Clock::duration duration) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        }
+
+        void update_max(std::atomic<int64_t> &maximum, int64_t value) {
+            int64_t current = maximum.load();
+            while (current < value && !maximum.compare_exchange_weak(current, value)) {}
+        }
+
+        std::string escape(const std::string &text) {
+            std::string escaped;
+            for (char c : text) {
+                if (c == '"' || c == '\\') escaped += '\\';
+                if (static_cast<unsigned char>(c) < 0x20) continue;
+                escaped += c;
+            }
+            return escaped;
+        }
+
+        template<class T>
+        size_t array_bytes(const hoNDArray<T> &array) {
+            return array.get_number_of_elements() * sizeof(T);
+        }
+
+        size_t payload_bytes(const mrd::Acquisition &acquisition) {
+            return array_bytes(acquisition.data) + array_bytes(acquisition.trajectory);
+        }
+
+        size_t payload_bytes(const mrd::WaveformUint32 &waveform) {
+            return array_bytes(waveform.data);
+        }
+
+        size_t payload_bytes(const mrd::ReconBuffer &buffer) {
+            return array_bytes(buffer.data) + array_bytes(buffer.trajectory) +
+                   (buffer.density ? array_bytes(*buffer.density) : 0);
+        }
+
+        size_t payload_bytes(const mrd::ReconData &recon_data) {
+            size_t bytes = 0;
+            for (auto &assembly : recon_data.buffers) {
+                bytes += payload_bytes(assembly.data);
+                if (assembly.ref) bytes += payload_bytes(*assembly.ref);
+            }
+            return bytes;
+        }
+
+        size_t payload_bytes(const mrd::ImageArray &image_array) {
+            return array_bytes(image_array.data);
+        }
+
+        template<class T>
+        size_t payload_bytes(const mrd::Image<T> &image) {
+            return array_bytes(image.data);
+        }
+
+        template<class T>
+        bool add_bytes(const MessageChunk &chunk, size_t &bytes) {
+            auto typed = dynamic_cast<const TypedMessageChunk<T> *>(&chunk);
+            if (typed) bytes += payload_bytes(typed->data.get());
+            return typed;
+        }
+
+        // A node's input. Waiting in pop is idle time; the time between returning a message and asking for the next
+        // is time spent processing it.
+        class InputProbe : public Channel {
+        public:
+            InputProbe(GenericInputChannel input, std::shared_ptr<Trace> trace, NodeMetrics &node,
+                       ChannelMetrics *channel)
+                : input(std::move(input)), trace(std::move(trace)), node(node), channel(channel) {}
+
+        protected:
+            Message pop() override {
+                auto start = Clock::now();
+                finish_message(start);
+                auto message = input.pop();
+                auto end = Clock::now();
+                node.idle_ns += nanoseconds(end - start);
+                received(message, end);
+                return message;
+            }
+
+            std::optional<Message> try_pop() override {
+                auto now = Clock::now();
+                finish_message(now);
+                auto message = input.try_pop();
+                if (message) received(*message, now);
+                return message;
+            }
+
+            void push_message(Message) override {
+                throw std::logic_error("Cannot push to the input of a node");
+            }
+
+            void close() override {}
+
+        private:
+            void finish_message(Clock::time_point now) {
+                if (!last_received) return;
+                auto busy = nanoseconds(now - *last_received) - (node.blocked_ns.load() - blocked_at_receive);
+                node.busy_ns += std::max<int64_t>(busy, 0);
+                node.allocated_bytes += MemoryPool::thread_allocated_bytes() - allocated_at_receive;
+                trace->span(node.name, "node", *last_received, now);
+                last_received.reset();
+            }
+
+            void received(const Message &message, Clock::time_point now) {
+                auto bytes = message_bytes(message);
+                node.messages_in++;
+                node.bytes_in += bytes;
+                if (channel) {
+                    trace->counter(channel->name, --channel->depth, now);
+                }
+                last_received = now;
+                blocked_at_receive = node.blocked_ns.load();
+                allocated_at_receive = MemoryPool::thread_allocated_bytes();
+            }
+
+            GenericInputChannel input;
+            std::shared_ptr<Trace> trace;
+            NodeMetrics &node;
+            ChannelMetrics *channel;
+
+            std::optional<Clock::time_point> last_received;
+            int64_t blocked_at_receive = 0;
+            size_t allocated_at_receive = 0;
+        };
+
+        // A node's output. Waiting in push, for a bounded channel with no room, is blocked time.
+        class OutputProbe : public Channel {
+        public:
+            OutputProbe(OutputChannel output, std::shared_ptr<Trace> trace, NodeMetrics &node, ChannelMetrics *channel)
+                : output(std::move(output)), trace(std::move(trace)), node(node), channel(channel) {}
+
+        protected:
+            Message pop() override {
+                throw std::logic_error("Cannot pop from the output of a node");
+            }
+
+            std::optional<Message> try_pop() override {
+                throw std::logic_error("Cannot pop from the output of a node");
+            }
+
+            void push_message(Message message) override {
+                auto bytes = message_bytes(message);
+
+                auto start = Clock::now();
+                output.push_message(std::move(message));
+                auto end = Clock::now();
+
+                auto blocked = nanoseconds(end - start);
+                node.blocked_ns += blocked;
+                node.messages_out++;
+                node.bytes_out += bytes;
+                if (blocked > minimum_blocked_span_ns) trace->span(node.name + " blocked", "blocked", start, end);
+
+                if (channel) {
+                    channel->messages++;
+                    channel->bytes += bytes;
+                    auto depth = ++channel->depth;
+                    update_max(channel->max_depth, depth);
+                    trace->counter(channel->name, depth, end);
+                }
+            }
+
+            void close() override {}
+
+        private:
+            static constexpr int64_t minimum_blocked_span_ns = 50000;
+
+            OutputChannel output;
+            std::shared_ptr<Trace> trace;
+            NodeMetrics &node;
+            ChannelMetrics *channel;
+        };
+    }
+
+    Trace::Trace() : origin(Clock::now()) {}
+
+    NodeMetrics &Trace::node(const std::string &name) {
+        std::lock_guard<std::mutex> guard(m);
+        auto existing = std::find_if(nodes.begin(), nodes.end(), [&](auto &node) { return node.name == name; });
+        if (existing != nodes.end()) return *existing;
+        return nodes.emplace_back(name);
+    }
+
+    ChannelMetrics &Trace::channel(const std::string &name) {
+        std::lock_guard<std::mutex> guard(m);
+        auto existing = std::find_if(channels.begin(), channels.end(), [&](auto &channel) { return channel.name == name; });
+        if (existing != channels.end()) return *existing;
+        return channels.emplace_back(name);
+    }
+
+    void Trace::span(const std::string &name, const char *category, Clock::time_point start, Clock::time_point end) {
+        std::lock_guard<std::mutex> guard(m);
+        auto thread = thread_index(name, std::string(category) == "node");
+        events.push_back(Event{name, category, 'X', microseconds(start), microseconds(end) - microseconds(start), 0, thread});
+    }
+
+    void Trace::counter(const std::string &name, int64_t value, Clock::time_point time) {
+        std::lock_guard<std::mutex> guard(m);
+        events.push_back(Event{name, "channel", 'C', microseconds(time), 0, value, 0});
+    }
+
+    size_t Trace::thread_index(const std::string &name, bool names_thread) {
+        auto [iterator, inserted] = threads.try_emplace(std::this_thread::get_id(), thread_names.size() + 1);
+        if (inserted) thread_names.emplace_back();
+        auto &thread_name = thread_names[iterator->second - 1];
+        if (names_thread && thread_name.empty()) thread_name = name;
+        return iterator->second;
+    }
+
+    int64_t Trace::microseconds(Clock::time_point time) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time - origin).count();
+    }
+
+    void Trace::write_chrome_trace(std::ostream &stream) const {
+        std::lock_guard<std::mutex> guard(m);
+
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        auto separator = [&]() -> std::ostream & {
+            if (!first) stream << ",\n";
+            first = false;
+            return stream;
+        };
+
+        for (size_t i = 0; i < thread_names.size(); i++) {
+            auto name = thread_names[i].empty() ? "thread " + std::to_string(i + 1) : thread_names[i];
+            separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i + 1
+                        << ",\"args\":{\"name\":\"" << escape(name) << "\"}}";
+        }
+
+        for (auto &event : events) {
+            if (event.phase == 'X') {
+                separator() << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"" << event.category
+                            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.timestamp_us
+                            << ",\"dur\":" << event.duration_us << "}";
+            } else {
+                separator() << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\"" << event.category
+                            << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << event.timestamp_us
+                            << ",\"args\":{\"depth\":" << event.value << "}}";
+            }
+        }
+        stream << "\n]}\n";
+    }
+
+    void Trace::write_summary(std::ostream &stream) const {
+        std::lock_guard<std::mutex> guard(m);
+
+        std::vector<const NodeMetrics *> sorted;
+        for (auto &node : nodes) sorted.push_back(&node);
+        std::stable_sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->busy_ns > b->busy_ns; });
+
+        auto ms = [](int64_t ns) { return ns / 1e6; };
+        auto mb = [](size_t bytes) { return bytes / 1048576.0; };
+
+        stream << std::fixed << std::setprecision(1);
+        stream << std::left << std::setw(40) << "Node" << std::right << std::setw(10) << "In" << std::setw(10) << "Out"
+               << std::setw(12) << "MB in" << std::setw(12) << "MB out" << std::setw(12) << "Busy ms" << std::setw(8)
+               << "Busy %" << std::setw(12) << "Idle ms" << std::setw(12) << "Blocked ms" << std::setw(14)
+               << "Allocated MB" << "\n";
+
+        for (auto node : sorted) {
+            auto total = node->busy_ns + node->idle_ns + node->blocked_ns;
+            stream << std::left << std::setw(40) << node->name << std::right << std::setw(10) << node->messages_in
+                   << std::setw(10) << node->messages_out << std::setw(12) << mb(node->bytes_in) << std::setw(12)
+                   << mb(node->bytes_out) << std::setw(12) << ms(node->busy_ns) << std::setw(8)
+                   << (total ? 100.0 * node->busy_ns / total : 0.0) << std::setw(12) << ms(node->idle_ns)
+                   << std::setw(12) << ms(node->blocked_ns) << std::setw(14) << mb(node->allocated_bytes) << "\n";
+        }
+
+        if (channels.empty()) return;
+
+        stream << "\n" << std::left << std::setw(80) << "Channel" << std::right << std::setw(10) << "Messages"
+               << std::setw(12) << "MB" << std::setw(12) << "Max depth" << "\n";
+        for (auto &channel : channels) {
+            stream << std::left << std::setw(80) << channel.name << std::right << std::setw(10) << channel.messages
+                   << std::setw(12) << mb(channel.bytes) << std::setw(12) << channel.max_depth << "\n";
+        }
+    }
+
+    GenericInputChannel trace_input(GenericInputChannel input, std::shared_ptr<Trace> trace, NodeMetrics &node,
+                                    ChannelMetrics *channel) {
+        return make_channel<InputProbe>(std::move(input), std::move(trace), node, channel).input;
+    }
+
+    OutputChannel trace_output(OutputChannel output, std::shared_ptr<Trace> trace, NodeMetrics &node,
+                               ChannelMetrics *channel) {
+        return std::move(make_channel<OutputProbe>(std::move(output), std::move(trace), node, channel).output);
+    }
+
+    size_t message_bytes(const Message &message) {
+        size_t bytes = 0;
+        for (auto &chunk : message.messages()) {
+            add_bytes<mrd::Acquisition>(*chunk, bytes) || add_bytes<mrd::WaveformUint32>(*chunk, bytes) ||
+                add_bytes<mrd::ReconData>(*chunk, bytes) || add_bytes<mrd::ImageArray>(*chunk, bytes) ||
+                add_bytes<mrd::Image<std::complex<float>>>(*chunk, bytes) || add_bytes<mrd::Image<float>>(*chunk, bytes) ||
+                add_bytes<mrd::Image<uint16_t>>(*chunk, bytes) || add_bytes<mrd::Image<int16_t>>(*chunk, bytes) ||
+                add_bytes<mrd::Image<uint32_t>>(*chunk, bytes) || add_bytes<mrd::Image<int32_t>>(*chunk, bytes) ||
+                add_bytes<mrd::Image<double>>(*chunk, bytes) || add_bytes<mrd::Image<std::complex<double>>>(*chunk, bytes);
+        }
+        return bytes;
+    }
+}
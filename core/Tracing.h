@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Channel.h"
+
+namespace Gadgetron::Core::Tracing {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Counters for one node of a stream. Time is split into idle (waiting for input), blocked (waiting for room
+     * downstream) and busy (everything else). Allocations are the bytes of array storage allocated by the node's
+     * thread while busy; work handed to other threads is not counted.
+     */
+    struct NodeMetrics {
+        explicit NodeMetrics(std::string name) : name(std::move(name)) {}
+
+        const std::string name;
+        std::atomic<int64_t> busy_ns{0};
+        std::atomic<int64_t> idle_ns{0};
+        std::atomic<int64_t> blocked_ns{0};
+        std::atomic<size_t> messages_in{0};
+        std::atomic<size_t> messages_out{0};
+        std::atomic<size_t> bytes_in{0};
+        std::atomic<size_t> bytes_out{0};
+        std::atomic<size_t> allocated_bytes{0};
+    };
+
+    /**
+     * Counters for a channel between two nodes.
+     */
+    struct ChannelMetrics {
+        explicit ChannelMetrics(std::string name) : name(std::move(name)) {}
+
+        const std::string name;
+        std::atomic<int64_t> depth{0};
+        std::atomic<int64_t> max_depth{0};
+        std::atomic<size_t> messages{0};
+        std::atomic<size_t> bytes{0};
+    };
+
+    /**
+     * Collects the metrics and timeline of a stream. A Stream given a Trace (through its StreamContext) records
+     * what each of its nodes spends its time on; a stream without one takes no measurements at all.
+     *
+     * The timeline is written in the Chrome trace event format, which chrome://tracing and Perfetto open.
+     */
+    class Trace {
+    public:
+        Trace();
+
+        /// Metrics of the named node, created on first use.
+        NodeMetrics &node(const std::string &name);
+
+        /// Metrics of the named channel, created on first use.
+        ChannelMetrics &channel(const std::string &name);
+
+        /// Adds a span on the timeline of the calling thread.
+        void span(const std::string &name, const char *category, Clock::time_point start, Clock::time_point end);
+
+        /// Adds a sample of a counter, such as the depth of a channel, to the timeline.
+        void counter(const std::string &name, int64_t value, Clock::time_point time);
+
+        void write_chrome_trace(std::ostream &stream) const;
+
+        /// A table of the node and channel metrics, busiest node first.
+        void write_summary(std::ostream &stream) const;
+
+    private:
+        struct Event {
+            std::string name;
+            const char *category;
+            char phase;
+            int64_t timestamp_us;
+            int64_t duration_us;
+            int64_t value;
+            size_t thread;
+        };
+
+        size_t thread_index(const std::string &name, bool names_thread);
+        int64_t microseconds(Clock::time_point time) const;
+
+        const Clock::time_point origin;
+
+        mutable std::mutex m;
+        std::deque<NodeMetrics> nodes;
+        std::deque<ChannelMetrics> channels;
+        std::vector<Event> events;
+        std::map<std::thread::id, size_t> threads;
+        std::vector<std::string> thread_names;
+    };
+
+    /**
+     * Wraps the input of a node so that the time the node spends waiting for and processing each message is
+     * recorded. channel may be null when the other end of the channel is not traced.
+     */
+    GenericInputChannel trace_input(GenericInputChannel input, std::shared_ptr<Trace> trace, NodeMetrics &node,
+                                    ChannelMetrics *channel);
+
+    /**
+     * Wraps the output of a node so that the time the node spends waiting for room downstream is recorded.
+     */
+    OutputChannel trace_output(OutputChannel output, std::shared_ptr<Trace> trace, NodeMetrics &node,
+                               ChannelMetrics *channel);
+
+    /// Bytes of array data held by the message; zero for types it does not know.
+    size_t message_bytes(const Message &message);
+}
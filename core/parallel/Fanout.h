@@ -9,11 +9,16 @@
 
 namespace Gadgetron::Core::Parallel {
 
+    /**
+     * Sends every message to all of the branches. The branches share a single copy of the payload (see Shared), which
+     * is only copied for a branch that takes or modifies it while others still hold it. A variant, such as
+     * mrd::AnyImage, is fanned out whichever of its alternatives the message holds.
+     */
     template<class ...ARGS>
-    class Fanout : public TypedBranch<ARGS...> {
+    class Fanout : public TypedBranch<SharedPayload<ARGS>...> {
     public:
         Fanout(const Context &context, const GadgetProperties &props);
-        void process(InputChannel<ARGS...> &, std::map<std::string, OutputChannel>) override;
+        void process(InputChannel<SharedPayload<ARGS>...> &, std::map<std::string, OutputChannel>) override;
     };
 
     using AcquisitionFanout = Core::Parallel::Fanout<mrd::Acquisition>;
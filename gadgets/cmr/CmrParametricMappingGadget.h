@@ -55,6 +55,12 @@ namespace Gadgetron {
         NODE_PROPERTY(std_thres_masking, double, "Number of noise std for masking", 3.0);
         NODE_PROPERTY(mapping_with_masking, bool, "Whether to compute and apply a mask for mapping", true);
 
+        NODE_PROPERTY(batched_fitting, bool, "Whether to fit pixels in batches by Levenberg-Marquardt instead of one at a time by simplex, if the model supports it", false);
+
+        NODE_PROPERTY(dictionary_matching, bool, "Whether to match pixels against a dictionary of signals instead of fitting them", false);
+        NODE_PROPERTY(dictionary_size, size_t, "Number of dictionary atoms, spaced logarithmically up to the maximal map value", 1000);
+        NODE_PROPERTY(dictionary_refinement_iter, size_t, "Number of fitting iterations refining the dictionary match; 0 to use the match as it is", 5);
+
         // ------------------------------------------------------------------------------------
 
     protected:
@@ -94,6 +94,12 @@ namespace Gadgetron {
             t1_sr.thres_fun_ = thres_func;
             t1_sr.max_map_value_ = max_T1;
 
+            t1_sr.batched_fitting_ = batched_fitting;
+
+            t1_sr.dictionary_matching_ = dictionary_matching;
+            t1_sr.dictionary_size_ = dictionary_size;
+            t1_sr.dictionary_refinement_iter_ = dictionary_refinement_iter;
+
             t1_sr.verbose_ = verbose;
             t1_sr.debug_folder_ = debug_folder_full_path_;
             t1_sr.perform_timing_ = perform_timing;
@@ -105,6 +105,12 @@ namespace Gadgetron {
             t2_mapper.thres_fun_ = thres_func;
             t2_mapper.max_map_value_ = max_T2;
 
+            t2_mapper.batched_fitting_ = batched_fitting;
+
+            t2_mapper.dictionary_matching_ = dictionary_matching;
+            t2_mapper.dictionary_size_ = dictionary_size;
+            t2_mapper.dictionary_refinement_iter_ = dictionary_refinement_iter;
+
             t2_mapper.verbose_ = verbose;
             t2_mapper.debug_folder_ = debug_folder_full_path_;
             t2_mapper.perform_timing_ = perform_timing;
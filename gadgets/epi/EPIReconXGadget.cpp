@@ -1,4 +1,5 @@
 #include "EPIReconXGadget.h"
+#include "ComputeBudget.h"
 #include "hoNDArray_utils.h"
 #include "hoNDFFT.h"
 
@@ -85,14 +86,12 @@ namespace Gadgetron {
             reconx_other.dwellTime_ = 1.0;
             reconx_other.computeTrajectory();
         }
-
-#ifdef USE_OMP
-        omp_set_num_threads(1);
-#endif // USE_OMP
     }
 
     void EPIReconXGadget::process(Core::InputChannel<mrd::Acquisition>& input, Core::OutputChannel& out)
     {
+        Core::Compute::ThreadLimit single_thread(1);
+
         for (auto acq : input) {
             auto& hdr_in = acq.head;
             auto& data_in = acq.data;
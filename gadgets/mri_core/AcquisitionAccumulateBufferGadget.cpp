@@ -0,0 +1,211 @@
+#include "AcquisitionAccumulateBufferGadget.h"
+#include "log.h"
+#include "mri_core_utility.h"
+
+namespace Gadgetron {
+    using TriggerDimension = AcquisitionAccumulateTriggerGadget::TriggerDimension;
+
+    namespace {
+        void fix_limit(std::optional<mrd::LimitType>& limit, const std::optional<uint32_t>& value) {
+            if (!value)
+                return;
+            limit          = mrd::LimitType{};
+            limit->minimum = *value;
+            limit->maximum = *value;
+            limit->center  = *value;
+        }
+
+        // Every acquisition in a bucket shares its index along the sorting dimension, and along the trigger dimension
+        // when triggering on equality, so the statistics of the bucket span a single value there.
+        void fix_dimension(mrd::EncodingLimitsType& stats, TriggerDimension dimension, const mrd::EncodingCounters& idx) {
+            switch (dimension) {
+            case TriggerDimension::kspace_encode_step_1: fix_limit(stats.kspace_encoding_step_1, idx.kspace_encode_step_1); break;
+            case TriggerDimension::kspace_encode_step_2: fix_limit(stats.kspace_encoding_step_2, idx.kspace_encode_step_2); break;
+            case TriggerDimension::average: fix_limit(stats.average, idx.average); break;
+            case TriggerDimension::slice: fix_limit(stats.slice, idx.slice); break;
+            case TriggerDimension::contrast: fix_limit(stats.contrast, idx.contrast); break;
+            case TriggerDimension::phase: fix_limit(stats.phase, idx.phase); break;
+            case TriggerDimension::repetition: fix_limit(stats.repetition, idx.repetition); break;
+            case TriggerDimension::set: fix_limit(stats.set, idx.set); break;
+            case TriggerDimension::segment: fix_limit(stats.segment, idx.segment); break;
+            default: break;
+            }
+        }
+
+        size_t line_index(const mrd::ReconBuffer& buffer, const ReconBufferLayout::Slot& slot) {
+            const auto& headers = buffer.headers;
+            return slot.e1
+                   + headers.get_size(0)
+                         * (slot.e2 + headers.get_size(1) * (slot.n + headers.get_size(2) * (slot.s + headers.get_size(3) * slot.loc)));
+        }
+    }
+
+    AcquisitionAccumulateBufferGadget::AcquisitionAccumulateBufferGadget(
+        const Core::Context& context, const Core::GadgetProperties& props)
+        : AcquisitionAccumulateTriggerGadget(context, props), layout{ context.header, props } {
+        if (compression_tolerance > 0)
+            GWARN("compression_tolerance is ignored; readouts are written straight into the recon buffers\n");
+    }
+
+    mrd::EncodingLimitsType AcquisitionAccumulateBufferGadget::predict_stats(
+        const mrd::EncodingType& encoding, size_t espace, bool forref, const mrd::EncodingCounters& idx) const {
+        // The previous bucket is a better guess than the header, which rarely describes separate reference lines.
+        auto previous = previous_stats.find({ espace, forref });
+        auto stats = previous != previous_stats.end() ? previous->second : encoding.encoding_limits;
+        fix_dimension(stats, trigger_dimension, idx);
+        fix_dimension(stats, sorting_dimension, idx);
+        return stats;
+    }
+
+    void AcquisitionAccumulateBufferGadget::add_acquisition(unsigned int sorting_index, mrd::Acquisition acq) {
+        auto [iterator, created] = pending.try_emplace(sorting_index);
+        PendingBucket& bucket    = iterator->second;
+        if (created)
+            bucket.idx = acq.head.idx;
+
+        // Same split as add_acquisition_to_bucket
+        auto espace = size_t{ acq.head.encoding_space_ref.value_or(0) };
+        bool for_data = !(acq.head.flags.HasFlags(mrd::AcquisitionFlags::kIsParallelCalibration) ||
+                          acq.head.flags.HasFlags(mrd::AcquisitionFlags::kIsPhasecorrData));
+
+        if (acq.head.flags.HasFlags(mrd::AcquisitionFlags::kIsParallelCalibration) ||
+            acq.head.flags.HasFlags(mrd::AcquisitionFlags::kIsParallelCalibrationAndImaging)) {
+            if (bucket.refstats.size() < (espace + 1)) {
+                bucket.refstats.resize(espace + 1);
+            }
+            add_stats_to_bucket(bucket.refstats[espace], acq);
+            // Only lines that also go into the data buffer need a copy.
+            if (for_data)
+                place(bucket, acq, true);
+            else
+                place(bucket, std::move(acq), true);
+        }
+        if (for_data) {
+            if (bucket.datastats.size() < (espace + 1)) {
+                bucket.datastats.resize(espace + 1);
+            }
+            add_stats_to_bucket(bucket.datastats[espace], acq);
+            place(bucket, std::move(acq), false);
+        }
+    }
+
+    void AcquisitionAccumulateBufferGadget::place(PendingBucket& bucket, mrd::Acquisition acq, bool forref) {
+        uint32_t espace = acq.head.encoding_space_ref.value_or(0);
+        const auto& encoding = layout.header.encoding[espace];
+
+        auto& assemblies = bucket.assemblies[layout.getKey(acq.head.idx)];
+        if (assemblies.size() < (espace + 1)) {
+            assemblies.resize(espace + 1);
+        }
+        auto& pending_buffer = forref ? assemblies[espace].ref : assemblies[espace].data;
+
+        bool first = !pending_buffer;
+        if (first) {
+            pending_buffer.emplace();
+            pending_buffer->predicted_stats = predict_stats(encoding, espace, forref, bucket.idx);
+            pending_buffer->buffer   = layout.makeDataBuffer(acq, encoding, pending_buffer->predicted_stats, forref);
+            pending_buffer->occupied = std::vector<bool>(pending_buffer->buffer.headers.get_number_of_elements(), false);
+        }
+
+        auto slot = layout.find_slot(
+            pending_buffer->buffer, acq.head, acq.Samples(), encoding, pending_buffer->predicted_stats, forref, true);
+
+        if (slot && !pending_buffer->occupied[line_index(pending_buffer->buffer, *slot)]) {
+            pending_buffer->occupied[line_index(pending_buffer->buffer, *slot)] = true;
+            ReconBufferLayout::copy_to_slot(pending_buffer->buffer, *slot, acq);
+            pending_buffer->lines.push_back(Line{ acq.head, uint32_t(acq.Samples()), slot, std::nullopt });
+        } else if (first) {
+            pending_buffer->lines.push_back(Line{ acq.head, uint32_t(acq.Samples()), std::nullopt, acq });
+        } else {
+            pending_buffer->lines.push_back(Line{ acq.head, uint32_t(acq.Samples()), std::nullopt, std::move(acq) });
+        }
+
+        if (first)
+            pending_buffer->first = std::move(acq);
+    }
+
+    mrd::ReconBuffer AcquisitionAccumulateBufferGadget::finish(PendingBuffer& pending_buffer,
+        const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) {
+
+        auto dims   = layout.dimensions(pending_buffer.first, encoding, stats, forref);
+        bool direct = dims == pending_buffer.buffer.data.dimensions();
+
+        std::optional<mrd::ReconBuffer> repacked;
+        if (!direct)
+            repacked = layout.makeDataBuffer(pending_buffer.first, encoding, stats, forref);
+        const auto& target = repacked ? *repacked : pending_buffer.buffer;
+
+        // Placing the lines against the complete statistics warns about, or rejects, the same lines BucketToBufferGadget would.
+        std::vector<std::optional<ReconBufferLayout::Slot>> slots;
+        slots.reserve(pending_buffer.lines.size());
+        for (auto& line : pending_buffer.lines) {
+            slots.push_back(layout.find_slot(target, line.head, line.samples, encoding, stats, forref));
+            direct = direct && slots.back() == line.slot;
+        }
+
+        if (direct) {
+            direct_buffers++;
+            return std::move(pending_buffer.buffer);
+        }
+
+        if (!repacked)
+            repacked = layout.makeDataBuffer(pending_buffer.first, encoding, stats, forref);
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!slots[i])
+                continue;
+            auto& line = pending_buffer.lines[i];
+            if (line.acquisition)
+                ReconBufferLayout::copy_to_slot(*repacked, *slots[i], *line.acquisition);
+            else
+                ReconBufferLayout::copy_slot(pending_buffer.buffer, *line.slot, *repacked, *slots[i]);
+        }
+
+        repacked_buffers++;
+        return std::move(*repacked);
+    }
+
+    void AcquisitionAccumulateBufferGadget::send_data(Core::OutputChannel& out, std::vector<mrd::WaveformUint32>& waveforms) {
+        trigger_events++;
+        GDEBUG_STREAM("Trigger " << trigger_events << " occurred, sending out " << pending.size() << " buckets, " << waveforms.size() << " waveforms ... ");
+
+        for (auto& [sorting_index, bucket] : pending) {
+            std::map<ReconBufferLayout::BufferKey, mrd::ReconData> recon_data_buffers;
+
+            for (auto& [key, assemblies] : bucket.assemblies) {
+                auto& recon_data = recon_data_buffers[key];
+                recon_data.buffers.resize(assemblies.size());
+
+                for (size_t espace = 0; espace < assemblies.size(); espace++) {
+                    const auto& encoding = layout.header.encoding[espace];
+                    if (assemblies[espace].ref) {
+                        recon_data.buffers[espace].ref
+                            = finish(*assemblies[espace].ref, encoding, bucket.refstats[espace], true);
+                        previous_stats[{ espace, true }] = bucket.refstats[espace];
+                    }
+                    if (assemblies[espace].data) {
+                        recon_data.buffers[espace].data
+                            = finish(*assemblies[espace].data, encoding, bucket.datastats[espace], false);
+                        previous_stats[{ espace, false }] = bucket.datastats[espace];
+                    }
+                }
+            }
+
+            GDEBUG("End of bucket reached, sending out %d ReconData buffers\n", recon_data_buffers.size());
+
+            // As with AcquisitionAccumulateTriggerGadget, the waveforms go with the first bucket.
+            for (auto& recon_data_buffer : recon_data_buffers) {
+                if (waveforms.empty())
+                    out.push(std::move(recon_data_buffer.second));
+                else
+                    out.push(std::move(recon_data_buffer.second), waveforms);
+            }
+            waveforms.clear();
+        }
+
+        GDEBUG_STREAM("Buffers sent directly: " << direct_buffers << ", repacked: " << repacked_buffers);
+        pending.clear();
+    }
+
+    GADGETRON_GADGET_EXPORT(AcquisitionAccumulateBufferGadget);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "AcquisitionAccumulateTriggerGadget.h"
+#include "ReconBufferLayout.h"
+
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Does the work of AcquisitionAccumulateTriggerGadget followed by BucketToBufferGadget, and takes the properties
+     * of both. Rather than holding on to every acquisition until the trigger and then copying them into buffers,
+     * acquisitions are written into their mrd::ReconBuffer as they arrive.
+     *
+     * Buffers are sized when their first acquisition arrives, from the statistics of the previous buffer of the same
+     * kind or, for the first one, the encoding limits in the header, with the trigger and sorting dimensions fixed to
+     * the value they have in the bucket. When the statistics of the complete bucket call for a different size, or
+     * place any acquisition elsewhere, the buffer is repacked at trigger time. The output is identical to that of the
+     * two gadgets either way.
+     */
+    class AcquisitionAccumulateBufferGadget : public AcquisitionAccumulateTriggerGadget {
+    public:
+        AcquisitionAccumulateBufferGadget(const Core::Context& context, const Core::GadgetProperties& props);
+
+        // Buffers sent as filled, and buffers that had to be repacked.
+        size_t direct_buffers   = 0;
+        size_t repacked_buffers = 0;
+
+    protected:
+        const ReconBufferLayout layout;
+
+        void add_acquisition(unsigned int sorting_index, mrd::Acquisition acq) override;
+        void send_data(Core::OutputChannel& out, std::vector<mrd::WaveformUint32>& waveforms) override;
+
+    private:
+        struct Line {
+            mrd::AcquisitionHeader head;
+            uint32_t samples;
+            std::optional<ReconBufferLayout::Slot> slot;
+            // Lines that could not be placed in the buffer, or would overwrite an earlier line, are kept aside.
+            std::optional<mrd::Acquisition> acquisition;
+        };
+
+        struct PendingBuffer {
+            mrd::Acquisition first;
+            mrd::EncodingLimitsType predicted_stats;
+            mrd::ReconBuffer buffer;
+            std::vector<bool> occupied;
+            std::vector<Line> lines;
+        };
+
+        struct PendingAssembly {
+            std::optional<PendingBuffer> ref;
+            std::optional<PendingBuffer> data;
+        };
+
+        struct PendingBucket {
+            mrd::EncodingCounters idx;
+            std::vector<mrd::EncodingLimitsType> refstats;
+            std::vector<mrd::EncodingLimitsType> datastats;
+            std::map<ReconBufferLayout::BufferKey, std::vector<PendingAssembly>> assemblies;
+        };
+
+        void place(PendingBucket& bucket, mrd::Acquisition acq, bool forref);
+        mrd::ReconBuffer finish(PendingBuffer& pending, const mrd::EncodingType& encoding,
+            const mrd::EncodingLimitsType& stats, bool forref);
+        mrd::EncodingLimitsType predict_stats(
+            const mrd::EncodingType& encoding, size_t espace, bool forref, const mrd::EncodingCounters& idx) const;
+
+        std::map<unsigned int, PendingBucket> pending;
+
+        // Statistics of the last buffer sent for each encoding space, reference buffers separately.
+        std::map<std::pair<size_t, bool>, mrd::EncodingLimitsType> previous_stats;
+    };
+}
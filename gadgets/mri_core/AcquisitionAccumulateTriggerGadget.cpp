@@ -2,6 +2,7 @@
 #include "log.h"
 #include "mri_core_utility.h"
 #include <boost/algorithm/string.hpp>
+#include <chrono>
 
 namespace Gadgetron {
     using TriggerDimension = AcquisitionAccumulateTriggerGadget::TriggerDimension;
@@ -118,9 +119,42 @@ namespace Gadgetron {
         }
     }
 
-    void AcquisitionAccumulateTriggerGadget::send_data(Core::OutputChannel& out, std::map<unsigned int, mrd::AcquisitionBucket>& buckets,
-                                                       std::vector<mrd::WaveformUint32>& waveforms)
+    void AcquisitionAccumulateTriggerGadget::add_acquisition(unsigned int sorting_index, mrd::Acquisition acq)
     {
+        if (compression_tolerance > 0) {
+            auto start = std::chrono::steady_clock::now();
+            auto& compressed = compressed_buckets[sorting_index].emplace_back(
+                std::move(acq), compression_tolerance * noise_standard_deviation);
+            compression_statistics.compression_seconds
+                += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            compression_statistics.readouts++;
+            compression_statistics.compressed_readouts += compressed.is_compressed();
+            compression_statistics.uncompressed_bytes += compressed.uncompressed_bytes();
+            compression_statistics.compressed_bytes += compressed.compressed_bytes();
+            return;
+        }
+
+        mrd::AcquisitionBucket& bucket = buckets[sorting_index];
+        Gadgetron::add_acquisition_to_bucket(bucket, std::move(acq));
+    }
+
+    void AcquisitionAccumulateTriggerGadget::decompress_buckets()
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (auto& [sorting_index, compressed] : compressed_buckets) {
+            mrd::AcquisitionBucket& bucket = buckets[sorting_index];
+            for (auto& acq : compressed)
+                Gadgetron::add_acquisition_to_bucket(bucket, acq.decompress());
+        }
+        compressed_buckets.clear();
+        compression_statistics.decompression_seconds
+            += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void AcquisitionAccumulateTriggerGadget::send_data(Core::OutputChannel& out, std::vector<mrd::WaveformUint32>& waveforms)
+    {
+        decompress_buckets();
         trigger_events++;
         GDEBUG_STREAM("Trigger " << trigger_events << " occurred, sending out " << buckets.size() << " buckets, " << waveforms.size() << " waveforms ... ");
         if(!waveforms.empty()) {
@@ -136,7 +170,6 @@ namespace Gadgetron {
     void AcquisitionAccumulateTriggerGadget::process(Core::InputChannel<std::variant<mrd::Acquisition, mrd::WaveformUint32>>& in, Core::OutputChannel& out)
     {
         auto waveforms = std::vector<mrd::WaveformUint32>{};
-        auto buckets   = std::map<unsigned int, mrd::AcquisitionBucket>{};
         auto trigger   = get_trigger(*this);
 
         size_t count = 0;
@@ -152,21 +185,30 @@ namespace Gadgetron {
             }
 
             if (trigger_before(trigger, acq)) {
-                send_data(out, buckets, waveforms);
+                send_data(out, waveforms);
             }
             // It is enough to put the first one, since they are linked
             auto sorting_index = get_index(acq.head, sorting_dimension);
 
-            mrd::AcquisitionBucket& bucket = buckets[sorting_index];
-            Gadgetron::add_acquisition_to_bucket(bucket, std::move(acq));
+            add_acquisition(sorting_index, std::move(acq));
 
             if (trigger_after(trigger, acq)) {
-                send_data(out, buckets, waveforms);
+                send_data(out, waveforms);
             }
             count++;
         }
         GDEBUG_STREAM("AcquisitionAccumulateTriggerGadget processed " << count << " Acquisitions total");
-        send_data(out, buckets, waveforms);
+        send_data(out, waveforms);
+
+        if (compression_statistics.readouts > 0) {
+            const auto& stats = compression_statistics;
+            const double megabytes = stats.uncompressed_bytes / (1024.0 * 1024.0);
+            GINFO_STREAM("Compressed " << stats.compressed_readouts << " of " << stats.readouts << " buffered readouts, "
+                << megabytes << " MB to " << stats.compressed_bytes / (1024.0 * 1024.0) << " MB (ratio "
+                << double(stats.uncompressed_bytes) / std::max<size_t>(stats.compressed_bytes, 1) << "); compression "
+                << megabytes / std::max(stats.compression_seconds, 1e-9) << " MB/s, decompression "
+                << megabytes / std::max(stats.decompression_seconds, 1e-9) << " MB/s");
+        }
     }
     GADGETRON_GADGET_EXPORT(AcquisitionAccumulateTriggerGadget);
 
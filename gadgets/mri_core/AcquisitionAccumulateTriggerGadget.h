@@ -1,5 +1,6 @@
 #pragma once
 
+#include "CompressedAcquisition.h"
 #include "Node.h"
 #include "hoNDArray.h"
 
@@ -43,10 +44,33 @@ namespace Gadgetron {
         NODE_PROPERTY(n_acquisitions_before_trigger, unsigned long, "Number of acquisition before first trigger", 40);
         NODE_PROPERTY(n_acquisitions_before_ongoing_trigger, unsigned long, "Number of acquisition before ongoing triggers", 40);
 
+        NODE_PROPERTY(compression_tolerance, float,
+            "Keep buffered readouts compressed to within this many noise standard deviations; 0 disables compression", 0.0f);
+        NODE_PROPERTY(noise_standard_deviation, float,
+            "Noise standard deviation of the real and imaginary parts of incoming readouts; about 1 after NoiseAdjustGadget", 1.0f);
+
+        struct CompressionStatistics {
+            size_t readouts = 0;
+            size_t compressed_readouts = 0;
+            size_t uncompressed_bytes = 0;
+            size_t compressed_bytes = 0;
+            double compression_seconds = 0;
+            double decompression_seconds = 0;
+        };
+
         size_t trigger_events = 0;
+        CompressionStatistics compression_statistics;
+
+    protected:
+        virtual void add_acquisition(unsigned int sorting_index, mrd::Acquisition acq);
+        virtual void send_data(Core::OutputChannel& out, std::vector<mrd::WaveformUint32>& waveforms);
+
+        std::map<unsigned int, mrd::AcquisitionBucket> buckets;
+
     private:
-        void send_data(Core::OutputChannel& out, std::map<unsigned int, mrd::AcquisitionBucket>& buckets,
-                       std::vector<mrd::WaveformUint32>& waveforms);
+        void decompress_buckets();
+
+        std::map<unsigned int, std::vector<CompressedAcquisition>> compressed_buckets;
     };
 
     void from_string(const std::string& str, AcquisitionAccumulateTriggerGadget::TriggerDimension& val);
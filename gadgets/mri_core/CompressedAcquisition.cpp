@@ -0,0 +1,50 @@
+#include "CompressedAcquisition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace Gadgetron {
+
+    CompressedAcquisition::CompressedAcquisition(mrd::Acquisition acq, float tolerance)
+        : acquisition{ std::move(acq) }, dimensions{ acquisition.data.dimensions() } {
+
+        const auto* samples = reinterpret_cast<const float*>(acquisition.data.get_data_ptr());
+        std::vector<float> values(samples, samples + 2 * acquisition.data.get_number_of_elements());
+
+        if (values.empty() || tolerance <= 0 || std::all_of(values.begin(), values.end(), [](float v) { return v == 0; }))
+            return;
+
+        buffer.reset(NHLBI::CompressedFloatBuffer::createCompressedBuffer());
+        try {
+            buffer->compress(values, tolerance);
+        } catch (const std::runtime_error&) {
+            buffer.reset();
+            return;
+        }
+
+        acquisition.data = hoNDArray<std::complex<float>>();
+    }
+
+    mrd::Acquisition CompressedAcquisition::decompress() const {
+        auto result = acquisition;
+        if (buffer) {
+            result.data = hoNDArray<std::complex<float>>(dimensions);
+            buffer->decompress(reinterpret_cast<float*>(result.data.get_data_ptr()));
+        }
+        return result;
+    }
+
+    size_t CompressedAcquisition::uncompressed_bytes() const {
+        size_t elements = 1;
+        for (auto d : dimensions)
+            elements *= d;
+        return elements * sizeof(std::complex<float>);
+    }
+
+    size_t CompressedAcquisition::compressed_bytes() const {
+        if (!buffer)
+            return uncompressed_bytes();
+        return static_cast<size_t>(std::lround(buffer->size() * sizeof(float) / buffer->getCompressionRatio()));
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "NHLBICompression.h"
+
+#include <mrd/types.h>
+
+#include <memory>
+
+namespace Gadgetron {
+
+    /**
+     * An mrd::Acquisition whose samples are held in an NHLBI::CompressedFloatBuffer. The header and trajectory are
+     * kept as they are. Every real and imaginary component is reproduced to within the given absolute tolerance.
+     *
+     * Readouts the tolerance cannot be met for (e.g. because it is tiny compared to the largest sample) and all-zero
+     * readouts are kept uncompressed.
+     */
+    class CompressedAcquisition {
+    public:
+        CompressedAcquisition(mrd::Acquisition acq, float tolerance);
+
+        mrd::Acquisition decompress() const;
+
+        const mrd::AcquisitionHeader& head() const { return acquisition.head; }
+
+        bool is_compressed() const { return bool(buffer); }
+
+        size_t uncompressed_bytes() const;
+        size_t compressed_bytes() const;
+
+    private:
+        // Holds everything but the samples when compressed.
+        mrd::Acquisition acquisition;
+        std::vector<size_t> dimensions;
+        std::unique_ptr<NHLBI::CompressedFloatBuffer> buffer;
+    };
+}
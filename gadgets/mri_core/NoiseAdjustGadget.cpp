@@ -1,4 +1,7 @@
 #include "NoiseAdjustGadget.h"
+#include "NoiseCovarianceCache.h"
+#include "ComputeBudget.h"
+#include "cpp_blas.h"
 #include "hoArmadillo.h"
 #include "hoMatrix.h"
 #include "hoNDArray_elemwise.h"
@@ -16,6 +19,8 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <optional>
+#include <sstream>
 #include <typeinfo>
 
 using namespace std::string_literals;
@@ -38,7 +43,41 @@ namespace Gadgetron {
             return ""s;
         }
 
+        std::string noise_dependency_from_header(const mrd::Header& header) {
+            if (header.measurement_information) {
+                for (auto& dependency : header.measurement_information->measurement_dependency) {
+                    if (boost::algorithm::iequals(dependency.dependency_type, "Noise"))
+                        return dependency.measurement_id;
+                }
+            }
+            return ""s;
+        }
+
+        // Number of noise samples collected before they are folded into the covariance matrix.
+        constexpr size_t noise_block_samples = 4096;
+
+        void hermitian_rank_k_update(hoNDArray<std::complex<float>>& covariance, const std::complex<float>* data,
+            size_t samples, size_t stride) {
+            size_t channels = covariance.get_size(0);
+            BLAS::herk(true, true, channels, samples, 1.0f, data, stride, 1.0f, covariance.data(), channels);
+
+            // Only the upper triangle is updated; mirror it into the lower.
+            for (size_t j = 0; j < channels; j++) {
+                for (size_t i = j + 1; i < channels; i++) {
+                    covariance(i, j) = std::conj(covariance(j, i));
+                }
+            }
+        }
+
+        void flush_noise_block(NoiseGatherer& ng) {
+            if (ng.block_samples == 0)
+                return;
+            hermitian_rank_k_update(ng.tmp_covariance, ng.noise_block.data(), ng.block_samples, ng.noise_block.get_size(0));
+            ng.block_samples = 0;
+        }
+
         void normalize_covariance(NoiseGatherer& ng){
+            flush_noise_block(ng);
             if (ng.total_number_of_samples > 1) {
                 ng.tmp_covariance /= std::complex<float>(ng.total_number_of_samples - 1);
                 ng.normalized_number_of_samples = 1;
@@ -182,6 +221,7 @@ namespace Gadgetron {
         , current_mrd_header(context.header)
         , receiver_noise_bandwidth{ bandwidth_from_header(context.header) }
         , measurement_id{ measurement_id_from_header(context.header) }
+        , noise_dependency_id{ noise_dependency_from_header(context.header) }
     {
 
         if (!perform_noise_adjust)
@@ -191,10 +231,6 @@ namespace Gadgetron {
         GDEBUG("pass_nonconformant_data_ is %d\n", pass_nonconformant_data);
         GDEBUG("receiver_noise_bandwidth_ is %f\n", receiver_noise_bandwidth);
 
-#ifdef USE_OMP
-        omp_set_num_threads(1);
-#endif // USE_OMP
-
         if (context.parameters.find("noisecovariancein") != context.parameters.end()) {
             noise_covariance_in = context.parameters.at("noisecovariancein");
             GDEBUG_STREAM("Input noise covariance matrix is provided as a parameter: " << noise_covariance_in);
@@ -245,7 +281,8 @@ namespace Gadgetron {
                         }
                     }
                 }
-                return LoadedNoise{noise_covariance->matrix, noise_covariance->noise_dwell_time_us};
+                return LoadedNoise{noise_covariance->matrix, noise_covariance->noise_dwell_time_us,
+                    noise_cache_key(noise_dependency_id)};
 
             } else if (current_mrd_header.acquisition_system_information) {
                 GERROR("Noise covariance matrix is malformed. Number of labels does not match number of channels.");
@@ -275,9 +312,27 @@ namespace Gadgetron {
             ng.noise_dwell_time_us = acq.head.sample_time_us.value_or(0);
         }
 
-        auto dataM = as_arma_matrix(acq.data);
-        auto covariance = as_arma_matrix(ng.tmp_covariance);
-        covariance += dataM.t()*dataM;
+        auto channels = ng.tmp_covariance.get_size(0);
+        auto samples  = acq.Samples();
+        if (acq.Coils() != channels) {
+            throw std::runtime_error("Noise acquisitions have inconsistent number of channels");
+        }
+
+        if (ng.block_samples + samples > noise_block_samples) {
+            flush_noise_block(ng);
+        }
+
+        if (samples > noise_block_samples) {
+            hermitian_rank_k_update(ng.tmp_covariance, acq.data.data(), samples, samples);
+        } else {
+            if (ng.noise_block.empty()) {
+                ng.noise_block = hoNDArray<std::complex<float>>(noise_block_samples, channels);
+            }
+            for (size_t c = 0; c < channels; c++) {
+                std::copy_n(&acq.data(0, c), samples, &ng.noise_block(ng.block_samples, c));
+            }
+            ng.block_samples += samples;
+        }
 
         ng.total_number_of_samples += acq.Samples();
     }
@@ -305,6 +360,8 @@ namespace Gadgetron {
         noise_covariance.receiver_noise_bandwidth = receiver_noise_bandwidth;
         noise_covariance.matrix = ng.tmp_covariance;
 
+        NoiseCovarianceCache::instance().store(noise_cache_key(measurement_id), noise_covariance, noise_cache_directory);
+
         if (!noise_covariance_out.empty()) {
             std::ofstream os(noise_covariance_out, std::ios::out | std::ios::binary);
             if (os.is_open()) {
@@ -355,23 +412,19 @@ namespace Gadgetron {
             return std::move(ng);
         }
 
-        this->save_noisedata(ng);
+        flush_noise_block(ng);
 
-        auto masked_covariance = mask_channels(ng.tmp_covariance, scale_only_channels);
+        this->save_noisedata(ng);
 
-        auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
-        prewhitening_matrix
-            *= calculate_scale_factor(acq.head.sample_time_us.value_or(0), ng.noise_dwell_time_us, receiver_noise_bandwidth);
+        auto prewhitening_matrix
+            = prewhitener(noise_cache_key(measurement_id), ng.tmp_covariance, ng.noise_dwell_time_us, acq);
         return handle_acquisition(Prewhitener{ prewhitening_matrix }, acq);
     }
 
     template <>
     NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisition(
         LoadedNoise ln, mrd::Acquisition& acq)  {
-        auto masked_covariance   = mask_channels(std::move(ln.covariance), scale_only_channels);
-        auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
-        prewhitening_matrix
-            *= calculate_scale_factor(acq.head.sample_time_us.value_or(0), ln.noise_dwell_time_us, receiver_noise_bandwidth);
+        auto prewhitening_matrix = prewhitener(ln.cache_key, ln.covariance, ln.noise_dwell_time_us, acq);
         return handle_acquisition(Prewhitener{ prewhitening_matrix }, acq);
     }
 
@@ -381,27 +434,149 @@ namespace Gadgetron {
         return std::visit([&](auto var) { return this->handle_acquisition<decltype(var)>(std::move(var), acq); }, std::move(nh));
     }
 
+    void NoiseAdjustGadget::prewhiten(Prewhitener& pw, std::vector<mrd::Acquisition>::iterator begin,
+        std::vector<mrd::Acquisition>::iterator end) const {
+
+        const size_t channels = pw.prewhitening_matrix.get_size(0);
+
+        size_t total_samples = 0;
+        for (auto it = begin; it != end; ++it) {
+            if (it->Coils() == channels) {
+                total_samples += it->Samples();
+            } else if (!this->pass_nonconformant_data) {
+                throw std::runtime_error("Input data has different number of channels from noise data");
+            }
+        }
+        if (total_samples == 0)
+            return;
+
+        // Lines are stacked into one (samples x channels) matrix, so the whole batch is a single GEMM.
+        if (pw.workspace.get_number_of_elements() < 2 * total_samples * channels) {
+            MemoryPool::UninitializedScope uninitialized;
+            pw.workspace = hoNDArray<std::complex<float>>(2 * total_samples * channels);
+        }
+        std::complex<float>* gathered = pw.workspace.data();
+        std::complex<float>* whitened = gathered + total_samples * channels;
+
+        size_t offset = 0;
+        for (auto it = begin; it != end; ++it) {
+            if (it->Coils() != channels)
+                continue;
+            auto samples = it->Samples();
+            for (size_t c = 0; c < channels; c++) {
+                std::copy_n(&it->data(0, c), samples, gathered + c * total_samples + offset);
+            }
+            offset += samples;
+        }
+
+        BLAS::gemm(false, false, total_samples, channels, channels, std::complex<float>(1), gathered, total_samples,
+            pw.prewhitening_matrix.data(), channels, std::complex<float>(0), whitened, total_samples);
+
+        offset = 0;
+        for (auto it = begin; it != end; ++it) {
+            if (it->Coils() != channels)
+                continue;
+            auto samples = it->Samples();
+            for (size_t c = 0; c < channels; c++) {
+                std::copy_n(whitened + c * total_samples + offset, samples, &it->data(0, c));
+            }
+            offset += samples;
+        }
+    }
+
+    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisitions(
+        NoiseHandler nh, std::vector<mrd::Acquisition>& acqs) {
+
+        // Acquisitions are handled one at a time until a prewhitener is in place; the first of them builds it.
+        auto it = acqs.begin();
+        for (; it != acqs.end() && !std::holds_alternative<Prewhitener>(nh); ++it) {
+            nh = handle_acquisition(std::move(nh), *it);
+        }
+
+        if (auto pw = std::get_if<Prewhitener>(&nh)) {
+            prewhiten(*pw, it, acqs.end());
+        }
+        return nh;
+    }
+
     void NoiseAdjustGadget::process(Core::InputChannel<mrd::Acquisition>& input, Core::OutputChannel& output) {
 
+        std::optional<Core::Compute::ThreadLimit> single_thread;
+        if (perform_noise_adjust)
+            single_thread.emplace(1);
+
         scale_only_channels = current_mrd_header.acquisition_system_information
                                   ? find_scale_only_channels(scale_only_channels_by_name,
                                       current_mrd_header.acquisition_system_information->coil_label)
                                   : std::vector<size_t>{};
 
+        std::vector<mrd::Acquisition> batch;
+        auto flush_batch = [&]() {
+            if (batch.empty())
+                return;
+            noisehandler = handle_acquisitions(std::move(noisehandler), batch);
+            for (auto& acq : batch)
+                output.push(std::move(acq));
+            batch.clear();
+        };
+
         for (auto acq : input) {
             if (is_noise(acq)) {
+                // Noise must see the handler as it would have been without batching.
+                flush_batch();
                 add_noise(noisehandler, acq);
                 continue;
             }
-            noisehandler = handle_acquisition(std::move(noisehandler), acq);
-            output.push(std::move(acq));
+
+            if (prewhitening_batch_size <= 1) {
+                noisehandler = handle_acquisition(std::move(noisehandler), acq);
+                output.push(std::move(acq));
+                continue;
+            }
+
+            batch.push_back(std::move(acq));
+            if (batch.size() >= prewhitening_batch_size)
+                flush_batch();
         }
+        flush_batch();
 
         this->save_noisedata(noisehandler);
     }
 
-    /** Returns NoiseCovariance if loaded from file/stream, otherwise None */
+    std::string NoiseAdjustGadget::noise_cache_key(const std::string& id) const {
+        if (!current_mrd_header.acquisition_system_information)
+            return NoiseCovarianceCache::key(id, {});
+        return NoiseCovarianceCache::key(id, current_mrd_header.acquisition_system_information->coil_label);
+    }
+
+    hoNDArray<std::complex<float>> NoiseAdjustGadget::prewhitener(const std::string& cache_key,
+        const hoNDArray<std::complex<float>>& covariance, float noise_dwell_time_us, const mrd::Acquisition& acq) const {
+
+        auto scale_factor = calculate_scale_factor(acq.head.sample_time_us.value_or(0), noise_dwell_time_us, receiver_noise_bandwidth);
+
+        // Everything besides the cached covariance that the prewhitener depends on.
+        std::stringstream variant;
+        variant << std::hexfloat << scale_factor << ';';
+        for (auto channel : scale_only_channels)
+            variant << channel << ',';
+        variant << ';';
+        if (current_mrd_header.acquisition_system_information) {
+            for (auto& label : current_mrd_header.acquisition_system_information->coil_label)
+                variant << label.coil_name << '\n';
+        }
+
+        return NoiseCovarianceCache::instance().prewhitener(cache_key, variant.str(), [&]() {
+            auto masked_covariance   = mask_channels(covariance, scale_only_channels);
+            auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
+            prewhitening_matrix *= scale_factor;
+            return prewhitening_matrix;
+        });
+    }
+
+    /** Returns NoiseCovariance if loaded from file/stream or the noise cache, otherwise None */
     std::optional<mrd::NoiseCovariance> NoiseAdjustGadget::load_noisedata() const {
+        auto cache_key = noise_cache_key(noise_dependency_id);
+
         if (!noise_covariance_in.empty()) {
             std::ifstream file(noise_covariance_in, std::ios::binary);
             if (!file) {
@@ -415,10 +590,11 @@ namespace Gadgetron {
             reader.ReadNoiseCovariance(noise_covariance);
             reader.Close();
             file.close();
+            NoiseCovarianceCache::instance().store(cache_key, noise_covariance);
             return noise_covariance;
         }
 
-        return std::nullopt;
+        return NoiseCovarianceCache::instance().find(cache_key, noise_cache_directory);
     }
 
     GADGETRON_GADGET_EXPORT(NoiseAdjustGadget)
@@ -13,15 +13,23 @@ namespace Gadgetron {
         size_t normalized_number_of_samples = 0;
         size_t total_number_of_samples = 0;
         float noise_dwell_time_us = 0;
+
+        // Noise lines are collected here and added to the covariance in one Hermitian rank-k update.
+        hoNDArray<std::complex<float>> noise_block;
+        size_t block_samples = 0;
     };
 
     struct Prewhitener {
         hoNDArray<std::complex<float>> prewhitening_matrix;
+
+        // Scratch space for batched prewhitening; holds the gathered lines and the product.
+        hoNDArray<std::complex<float>> workspace;
     };
 
     struct LoadedNoise {
         hoNDArray<std::complex<float>> covariance;
         float noise_dwell_time_us;
+        std::string cache_key;
     };
 
     struct IgnoringNoise {};
@@ -39,10 +47,13 @@ namespace Gadgetron {
         NODE_PROPERTY(pass_nonconformant_data, bool, "Whether to pass data that does not conform", true);
         NODE_PROPERTY(noise_dwell_time_us_preset, float, "Preset dwell time for noise measurement", 0.0);
         NODE_PROPERTY(scale_only_channels_by_name, std::string, "List of named channels that should only be scaled", "");
+        NODE_PROPERTY(prewhitening_batch_size, size_t, "Number of acquisitions prewhitened together in a single matrix product", 1);
+        NODE_PROPERTY(noise_cache_directory, std::string, "Directory in which gathered noise covariances are cached across runs; in-memory only if empty", "");
 
         const float receiver_noise_bandwidth;
 
         const std::string measurement_id;
+        const std::string noise_dependency_id;
         std::vector<size_t> scale_only_channels;
 
         // We will store/load a copy of the noise scans XML header to enable us to check which coil layout, etc.
@@ -56,8 +67,17 @@ namespace Gadgetron {
         template<class NOISEHANDLER>
         NoiseHandler handle_acquisition(NOISEHANDLER nh, mrd::Acquisition&);
 
+        NoiseHandler handle_acquisitions(NoiseHandler nh, std::vector<mrd::Acquisition>&);
+
+        void prewhiten(Prewhitener& pw, std::vector<mrd::Acquisition>::iterator begin, std::vector<mrd::Acquisition>::iterator end) const;
+
         std::optional<mrd::NoiseCovariance> load_noisedata() const;
 
+        std::string noise_cache_key(const std::string& id) const;
+
+        hoNDArray<std::complex<float>> prewhitener(const std::string& cache_key,
+            const hoNDArray<std::complex<float>>& covariance, float noise_dwell_time_us, const mrd::Acquisition& acq) const;
+
         template<class NOISEHANDLER>
         void save_noisedata(NOISEHANDLER& nh);
 
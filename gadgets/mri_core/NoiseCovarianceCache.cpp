@@ -0,0 +1,194 @@
+#include "NoiseCovarianceCache.h"
+
+#include "log.h"
+
+#include <mrd/binary/protocols.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+namespace bf = boost::filesystem;
+
+namespace Gadgetron {
+
+    namespace {
+        // FNV-1a; unlike std::hash it is stable across builds, which the file names rely on.
+        uint64_t fnv1a(const std::string& text) {
+            uint64_t hash = 14695981039346656037ull;
+            for (unsigned char c : text) {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        bf::path file_for(const bf::path& directory, const std::string& key) {
+            return directory / (key + ".noise");
+        }
+    }
+
+    NoiseCovarianceCache& NoiseCovarianceCache::instance() {
+        static NoiseCovarianceCache cache;
+        return cache;
+    }
+
+    std::string NoiseCovarianceCache::key(const std::string& measurement_id, const std::vector<mrd::CoilLabelType>& coils) {
+        if (measurement_id.empty())
+            return "";
+
+        std::vector<std::string> names;
+        for (auto& coil : coils)
+            names.push_back(coil.coil_name);
+        std::sort(names.begin(), names.end());
+
+        std::string description = measurement_id;
+        for (auto& name : names)
+            description += '\n' + name;
+
+        char digest[17];
+        std::snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(fnv1a(description)));
+        return digest;
+    }
+
+    std::optional<mrd::NoiseCovariance> NoiseCovarianceCache::find(const std::string& key, const bf::path& directory) {
+        if (key.empty())
+            return std::nullopt;
+
+        {
+            std::lock_guard<std::mutex> guard(m);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                entries.splice(entries.begin(), entries, it->second);
+                return it->second->second.covariance;
+            }
+        }
+
+        if (directory.empty())
+            return std::nullopt;
+
+        auto file = file_for(directory, key);
+        auto covariance = read(file);
+        if (!covariance)
+            return std::nullopt;
+
+        GDEBUG_STREAM("Loaded cached noise covariance from " << file);
+        boost::system::error_code error;
+        bf::last_write_time(file, std::time(nullptr), error);
+
+        insert(key, *covariance);
+        return covariance;
+    }
+
+    void NoiseCovarianceCache::store(const std::string& key, const mrd::NoiseCovariance& covariance,
+        const bf::path& directory) {
+        if (key.empty())
+            return;
+
+        insert(key, covariance);
+
+        if (directory.empty())
+            return;
+
+        try {
+            bf::create_directories(directory);
+            write(file_for(directory, key), covariance);
+            evict_files(directory);
+        } catch (const std::exception& e) {
+            GWARN_STREAM("Unable to cache noise covariance in " << directory << ": " << e.what());
+        }
+    }
+
+    hoNDArray<std::complex<float>> NoiseCovarianceCache::prewhitener(const std::string& key, const std::string& variant,
+        const std::function<hoNDArray<std::complex<float>>()>& compute) {
+        if (!key.empty()) {
+            std::lock_guard<std::mutex> guard(m);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                auto& prewhiteners = it->second->second.prewhiteners;
+                auto found = prewhiteners.find(variant);
+                if (found != prewhiteners.end())
+                    return found->second;
+            }
+        }
+
+        // Computed without holding the lock; concurrent streams may both compute it, but will agree on the result.
+        auto result = compute();
+
+        if (!key.empty()) {
+            std::lock_guard<std::mutex> guard(m);
+            auto it = index.find(key);
+            if (it != index.end())
+                it->second->second.prewhiteners.emplace(variant, result);
+        }
+        return result;
+    }
+
+    void NoiseCovarianceCache::insert(const std::string& key, mrd::NoiseCovariance covariance) {
+        std::lock_guard<std::mutex> guard(m);
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.erase(it->second);
+            index.erase(it);
+        }
+
+        entries.emplace_front(key, Entry{ std::move(covariance), {} });
+        index[key] = entries.begin();
+
+        while (entries.size() > max_entries) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    std::optional<mrd::NoiseCovariance> NoiseCovarianceCache::read(const bf::path& file) {
+        if (!bf::exists(file))
+            return std::nullopt;
+
+        try {
+            std::ifstream stream(file.string(), std::ios::binary);
+            mrd::binary::MrdNoiseCovarianceReader reader(stream);
+            mrd::NoiseCovariance covariance;
+            reader.ReadNoiseCovariance(covariance);
+            reader.Close();
+            return covariance;
+        } catch (const std::exception& e) {
+            GWARN_STREAM("Ignoring unreadable cached noise covariance " << file << ": " << e.what());
+            return std::nullopt;
+        }
+    }
+
+    void NoiseCovarianceCache::write(const bf::path& file, const mrd::NoiseCovariance& covariance) {
+        // Written next to its final name and renamed into place, so readers never see a partial file.
+        auto temporary = file;
+        temporary += "." + bf::unique_path().string();
+        {
+            std::ofstream stream(temporary.string(), std::ios::out | std::ios::binary);
+            if (!stream.is_open())
+                throw std::runtime_error("Unable to open " + temporary.string());
+            mrd::binary::MrdNoiseCovarianceWriter writer(stream);
+            writer.WriteNoiseCovariance(covariance);
+            writer.Close();
+        }
+        bf::rename(temporary, file);
+    }
+
+    void NoiseCovarianceCache::evict_files(const bf::path& directory) {
+        std::vector<std::pair<std::time_t, bf::path>> files;
+        for (auto& entry : bf::directory_iterator(directory)) {
+            if (entry.path().extension() == ".noise")
+                files.emplace_back(bf::last_write_time(entry.path()), entry.path());
+        }
+        if (files.size() <= max_files)
+            return;
+
+        std::sort(files.begin(), files.end());
+        for (size_t i = 0; i < files.size() - max_files; i++) {
+            boost::system::error_code error;
+            bf::remove(files[i].second, error);
+        }
+    }
+}
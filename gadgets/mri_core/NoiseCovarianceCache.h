@@ -0,0 +1,73 @@
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <boost/filesystem.hpp>
+#include <mrd/types.h>
+
+#include <complex>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Process-wide cache of noise covariance matrices, and of the prewhiteners derived from them.
+     *
+     * Covariances are addressed by a digest of the noise measurement ID and its coil layout, so streams that
+     * depend on the same noise scan share a single entry. Each entry also holds the prewhiteners computed from
+     * it, keyed by everything that goes into them beyond the covariance, so the Cholesky factorisation is done
+     * once per session rather than once per stream. The least recently used entries are evicted beyond
+     * max_entries. When given a directory, covariances are also persisted there, one file per key, and the
+     * least recently used files are removed beyond max_files.
+     */
+    class NoiseCovarianceCache {
+    public:
+        static NoiseCovarianceCache& instance();
+
+        /**
+         * Cache key for the noise gathered in the named measurement with the given coils. Coil order does not
+         * matter; covariances are reordered to the data by the caller. Returns an empty key if measurement_id is empty.
+         */
+        static std::string key(const std::string& measurement_id, const std::vector<mrd::CoilLabelType>& coils);
+
+        std::optional<mrd::NoiseCovariance> find(const std::string& key, const boost::filesystem::path& directory = {});
+
+        void store(const std::string& key, const mrd::NoiseCovariance& covariance,
+            const boost::filesystem::path& directory = {});
+
+        /**
+         * Returns the prewhitener stored for key under variant, calling compute to produce it if there is none.
+         * Without an entry for key, the result is computed but not stored.
+         */
+        hoNDArray<std::complex<float>> prewhitener(const std::string& key, const std::string& variant,
+            const std::function<hoNDArray<std::complex<float>>()>& compute);
+
+        static constexpr size_t max_entries = 16;
+        static constexpr size_t max_files = 64;
+
+    private:
+        struct Entry {
+            mrd::NoiseCovariance covariance;
+            std::map<std::string, hoNDArray<std::complex<float>>> prewhiteners;
+        };
+
+        using Entries = std::list<std::pair<std::string, Entry>>;
+
+        void insert(const std::string& key, mrd::NoiseCovariance covariance);
+
+        static std::optional<mrd::NoiseCovariance> read(const boost::filesystem::path& file);
+        static void write(const boost::filesystem::path& file, const mrd::NoiseCovariance& covariance);
+        static void evict_files(const boost::filesystem::path& directory);
+
+        std::mutex m;
+        Entries entries;
+        std::unordered_map<std::string, Entries::iterator> index;
+    };
+}
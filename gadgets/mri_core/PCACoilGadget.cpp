@@ -10,7 +10,9 @@
 #include "hoNDArray_fileio.h"
 #include "hoNDKLT.h"
 #include "hoNDArray_linalg.h"
+#include "ComputeBudget.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
 
@@ -58,28 +60,12 @@ namespace Gadgetron {
         // present_uncombined_channels.value((int)uncombined_channels_.size());
         // GDEBUG("Number of uncombined channels (present_uncombined_channels) set to %d\n", uncombined_channels_.size());
 
-#ifdef USE_OMP
-        omp_set_num_threads(1);
-#endif // USE_OMP
-
     }
 
-    PCACoilGadget::~PCACoilGadget()
-    {
-        std::map<int, hoNDKLT<std::complex<float> >* >::iterator it;
-        it = pca_coefficients_.begin();
-        while (it != pca_coefficients_.end()) {
-            if (it->second) {
-                delete it->second;
-                it->second = 0;
-            }
-            it++;
-        }
-    }
-
-
     void PCACoilGadget::process(Core::InputChannel<mrd::Acquisition>& input, Core::OutputChannel& output)
     {
+        Core::Compute::ThreadLimit single_thread(1);
+
         for (auto acq : input) {
             bool is_noise = acq.head.flags.HasFlags(mrd::AcquisitionFlags::kIsNoiseMeasurement);
 
@@ -97,32 +83,39 @@ namespace Gadgetron {
 
             if (is_buffering)
             {
-                buffer_[location].push_back(acq);
+                if (use_covariance) {
+                    accumulate_covariance(location, acq);
+                }
 
                 bool is_last_scan_in_slice = acq.head.flags.HasFlags(mrd::AcquisitionFlags::kLastInSlice);
+                buffer_[location].push_back(std::move(acq));
                 size_t profiles_available = buffer_[location].size();
 
                 //Are we ready for calculating PCA
                 if (is_last_scan_in_slice || (profiles_available >= max_buffered_profiles_))
                 {
-                    calculate_coefficients(location);
+                    if (use_covariance) {
+                        calculate_coefficients_from_covariance(location);
+                    } else {
+                        calculate_coefficients(location);
+                    }
 
                     //Now we should pump all the profiles that we have buffered back through the system
-                    for (size_t p = 0; p < profiles_available; p++) {
-                        auto& acq = buffer_[location][p];
-                        do_pca(acq);
-                        output.push(std::move(acq));
+                    auto& buffer = buffer_[location];
+                    do_pca(location, buffer.data(), buffer.size());
+                    for (auto& buffered : buffer) {
+                        output.push(std::move(buffered));
                     }
 
                     //Switch off buffering for this slice
                     buffering_mode_[location] = false;
-                    //Remove references in this buffer
-                    buffer_[location].clear();
+                    //Release this buffer
+                    std::vector<mrd::Acquisition>().swap(buffer);
                 }
             }
             else {
                 // GDEBUG_STREAM("Not buffering location " << location << " anymore");
-                do_pca(acq);
+                do_pca(location, &acq, 1);
                 output.push(std::move(acq));
             }
         }
@@ -197,8 +190,7 @@ namespace Gadgetron {
 
         //Collected data for temp matrix, now let's calculate SVD coefficients
 
-        pca_coefficients_[location] = new hoNDKLT < std::complex<float> > ;
-        hoNDKLT< std::complex<float> >* VT = pca_coefficients_[location];
+        hoNDKLT< std::complex<float> > VT;
 
         GDEBUG_STREAM("Preparing VT");
         //We will create a new matrix that explicitly preserves the uncombined channels
@@ -210,28 +202,179 @@ namespace Gadgetron {
                 untransformed[un] = uncombined_channels_[un];
             }
 
-            VT->prepare(A, (size_t)1, untransformed, (size_t)0, false);
+            VT.prepare(A, (size_t)1, untransformed, (size_t)0, false);
 
         }
         else
         {
-            VT->prepare(A, (size_t)1, (size_t)0, false);
+            VT.prepare(A, (size_t)1, (size_t)0, false);
         }
         GDEBUG_STREAM("Finished VT->prepare")
+
+        VT.KL_transformation(pca_coefficients_[location]);
+    }
+
+    void PCACoilGadget::ChannelCovariance::add(const mrd::Acquisition& acq, size_t first_sample, size_t samples_to_add)
+    {
+        size_t samples_per_profile = acq.Samples();
+        size_t channels = acq.Coils();
+
+        if (covariance.empty()) {
+            covariance.create(channels, channels);
+            covariance.fill(std::complex<double>(0.0, 0.0));
+            sum.create(channels);
+            sum.fill(std::complex<double>(0.0, 0.0));
+        }
+        if (sum.get_number_of_elements() != channels) {
+            throw std::runtime_error("PCACoilGadget: number of channels changed while buffering");
+        }
+
+        // Lower triangle of A'*A, with the samples along the rows of A
+        const std::complex<float>* data = acq.data.data() + first_sample;
+        for (size_t j = 0; j < channels; j++) {
+            const std::complex<float>* xj = data + j * samples_per_profile;
+
+            std::complex<double> s(0.0, 0.0);
+            for (size_t k = 0; k < samples_to_add; k++) {
+                s += std::complex<double>(xj[k]);
+            }
+            sum(j) += s;
+
+            for (size_t i = j; i < channels; i++) {
+                const std::complex<float>* xi = data + i * samples_per_profile;
+
+                std::complex<double> c(0.0, 0.0);
+                for (size_t k = 0; k < samples_to_add; k++) {
+                    c += std::conj(std::complex<double>(xi[k])) * std::complex<double>(xj[k]);
+                }
+                covariance(i, j) += c;
+            }
+        }
+
+        samples += samples_to_add;
+    }
+
+    void PCACoilGadget::ChannelCovariance::add(const ChannelCovariance& other)
+    {
+        if (other.covariance.empty()) return;
+        if (covariance.empty()) {
+            *this = other;
+            return;
+        }
+
+        covariance += other.covariance;
+        sum += other.sum;
+        samples += other.samples;
+    }
+
+    void PCACoilGadget::accumulate_covariance(int location, const mrd::Acquisition& acq)
+    {
+        size_t samples_per_profile = acq.Samples();
+        size_t samples_to_use = std::min(samples_per_profile, samples_to_use_);
+
+        size_t data_offset = 0;
+        size_t center_sample = acq.head.center_sample.value_or(0);
+        if (center_sample >= (samples_to_use >> 1)) {
+            data_offset = std::min(center_sample - (samples_to_use >> 1), samples_per_profile - samples_to_use);
+        }
+
+        //Whether only the central samples are used is known once buffering ends, so the others are accumulated apart
+        center_covariance_[location].add(acq, data_offset, samples_to_use);
+
+        ChannelCovariance& outer = outer_covariance_[location];
+        outer.add(acq, 0, data_offset);
+        outer.add(acq, data_offset + samples_to_use, samples_per_profile - data_offset - samples_to_use);
     }
 
-    void PCACoilGadget::do_pca(mrd::Acquisition& acq)
+    void PCACoilGadget::calculate_coefficients_from_covariance(int location)
     {
-        auto location = get_location(acq);
+        size_t profiles_available = buffer_[location].size();
+
+        ChannelCovariance& total = center_covariance_[location];
+
+        //For some sequences there is so little data, we should just use it all.
+        if (profiles_available < 16) {
+            total.add(outer_covariance_[location]);
+        }
+
+        hoNDArray<std::complex<double>>& C = total.covariance;
+        size_t channels = C.get_size(0);
 
-        hoNDArray<std::complex<float>> data_out(acq.data.dimensions());
+        GDEBUG("Calculating PCA coefficients from the covariance of %d samples for %d coils\n", total.samples, channels);
 
-        if (pca_coefficients_[location] != 0)
+        //Subtract off mean
+        for (size_t j = 0; j < channels; j++) {
+            for (size_t i = j; i < channels; i++) {
+                C(i, j) -= std::conj(total.sum(i)) * total.sum(j) / double(total.samples);
+            }
+        }
+
+        hoNDKLT< std::complex<double> > VT;
+        if (uncombined_channels_.size())
+        {
+            std::vector<size_t> untransformed(uncombined_channels_.begin(), uncombined_channels_.end());
+            VT.prepare_from_covariance(C, untransformed, (size_t)0);
+        }
+        else
         {
-            pca_coefficients_[location]->transform(acq.data, data_out, 1);
+            VT.prepare_from_covariance(C, (size_t)0);
+        }
+
+        hoNDArray<std::complex<double>> M;
+        VT.KL_transformation(M);
+        pca_coefficients_[location] = hoNDArray<std::complex<float>>(M);
+
+        center_covariance_.erase(location);
+        outer_covariance_.erase(location);
+    }
+
+    void PCACoilGadget::do_pca(int location, mrd::Acquisition* acqs, size_t count)
+    {
+        const hoNDArray<std::complex<float>>& M = pca_coefficients_[location];
+        size_t channels = M.get_size(0);
+        size_t modes = M.get_size(1);
+
+        size_t rows = 0;
+        for (size_t a = 0; a < count; a++) {
+            if (acqs[a].Coils() != channels) {
+                throw std::runtime_error("PCACoilGadget: number of channels does not match the PCA coefficients");
+            }
+            rows += acqs[a].Samples();
+        }
+
+        pca_input_.resize(rows * channels);
+        pca_output_.resize(rows * modes);
+
+        //Stack the profiles into one [samples channels] matrix
+        for (size_t c = 0; c < channels; c++) {
+            std::complex<float>* column = pca_input_.data() + c * rows;
+            for (size_t a = 0; a < count; a++) {
+                size_t samples = acqs[a].Samples();
+                const std::complex<float>* in = acqs[a].data.data() + c * samples;
+                column = std::copy(in, in + samples, column);
+            }
         }
 
-        acq.data = data_out;
+        hoNDArray<std::complex<float>> in2D(rows, channels, pca_input_.data());
+        hoNDArray<std::complex<float>> out2D(rows, modes, pca_output_.data());
+        Gadgetron::gemm(out2D, in2D, false, M, false);
+
+        //The transformed profiles replace the data in place
+        for (size_t a = 0; a < count; a++) {
+            mrd::Acquisition& acq = acqs[a];
+            size_t samples = acq.Samples();
+            if (modes != channels) {
+                acq.data.create(samples, modes);
+            }
+        }
+        for (size_t c = 0; c < modes; c++) {
+            const std::complex<float>* column = pca_output_.data() + c * rows;
+            for (size_t a = 0; a < count; a++) {
+                size_t samples = acqs[a].data.get_size(0);
+                std::copy(column, column + samples, acqs[a].data.data() + c * samples);
+                column += samples;
+            }
+        }
     }
 
     GADGETRON_GADGET_EXPORT(PCACoilGadget)
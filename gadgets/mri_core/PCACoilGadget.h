@@ -13,16 +13,28 @@ namespace Gadgetron {
   {
   public:
     PCACoilGadget(const Core::Context& context, const Core::GadgetProperties& props);
-    ~PCACoilGadget() override;
 
     void process(Core::InputChannel<mrd::Acquisition>& input, Core::OutputChannel& output) override;
 
   protected:
     NODE_PROPERTY(uncombined_channels_by_name, std::string, "List of comma separated channels by name", "");
+    NODE_PROPERTY(use_covariance, bool, "Compute the coefficients from the channel covariance, accumulated as profiles arrive, instead of from an SVD of the buffered profiles", false);
     // GADGET_PROPERTY(present_uncombined_channels, int, "Number of uncombined channels found", 0);
 
+    // Channel covariance of a set of samples, without the mean removed
+    struct ChannelCovariance {
+        hoNDArray<std::complex<double>> covariance; // [CHA CHA], lower triangle
+        hoNDArray<std::complex<double>> sum;        // [CHA]
+        size_t samples = 0;
+
+        void add(const mrd::Acquisition& acq, size_t first_sample, size_t samples_to_add);
+        void add(const ChannelCovariance& other);
+    };
+
+    void accumulate_covariance(int location, const mrd::Acquisition& acq);
     void calculate_coefficients(int location);
-    void do_pca(mrd::Acquisition& acq);
+    void calculate_coefficients_from_covariance(int location);
+    void do_pca(int location, mrd::Acquisition* acqs, size_t count);
 
     std::vector<unsigned int> uncombined_channels_;
 
@@ -32,8 +44,16 @@ namespace Gadgetron {
     //Keep track of whether we are buffering for a particular location
     std::map< int, bool> buffering_mode_;
 
-    //Map for storing PCA coefficients for each location
-    std::map<int, hoNDKLT<std::complex<float> >* > pca_coefficients_;
+    //Map for storing the PCA transformation matrix [CHA CHA] for each location
+    std::map<int, hoNDArray<std::complex<float> > > pca_coefficients_;
+
+    //Covariance of the central samples of the profiles, and of the others, accumulated while buffering
+    std::map<int, ChannelCovariance> center_covariance_;
+    std::map<int, ChannelCovariance> outer_covariance_;
+
+    //Work space for applying the transform to a batch of profiles with one gemm
+    std::vector<std::complex<float> > pca_input_;
+    std::vector<std::complex<float> > pca_output_;
 
     const size_t max_buffered_profiles_ = 100;
     const size_t samples_to_use_ = 16;
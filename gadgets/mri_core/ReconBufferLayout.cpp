@@ -0,0 +1,583 @@
+#include "ReconBufferLayout.h"
+#include "hoNDArray_elemwise.h"
+#include "log.h"
+#include <boost/algorithm/string.hpp>
+
+namespace Gadgetron {
+    using BufferKey = ReconBufferLayout::BufferKey;
+
+    namespace {
+        uint32_t getLimitSize(std::optional<mrd::LimitType> const& limit) {
+            if (limit) {
+                return limit->maximum - limit->minimum + 1;
+            }
+            return 1;
+        }
+
+        void clear(ReconBufferLayout::Dimension dim, BufferKey& idx) {
+            switch (dim) {
+
+            case ReconBufferLayout::Dimension::average: idx.average = 0; break;
+            case ReconBufferLayout::Dimension::contrast: idx.contrast = 0; break;
+            case ReconBufferLayout::Dimension::phase: idx.phase = 0; break;
+            case ReconBufferLayout::Dimension::repetition: idx.repetition = 0; break;
+            case ReconBufferLayout::Dimension::set: idx.set = 0; break;
+            case ReconBufferLayout::Dimension::segment: idx.segment = 0; break;
+            case ReconBufferLayout::Dimension::slice: break;
+            case ReconBufferLayout::Dimension::none: break;
+            default: throw std::runtime_error("Invalid enum encountered");
+            }
+        }
+
+        size_t getDimensionKey(ReconBufferLayout::Dimension dim, const mrd::EncodingCounters& idx) {
+            switch (dim) {
+
+            case ReconBufferLayout::Dimension::average: return idx.average.value_or(0);
+            case ReconBufferLayout::Dimension::contrast: return idx.contrast.value_or(0);
+            case ReconBufferLayout::Dimension::phase: return idx.phase.value_or(0);
+            case ReconBufferLayout::Dimension::repetition: return idx.repetition.value_or(0);
+            case ReconBufferLayout::Dimension::set: return idx.set.value_or(0);
+            case ReconBufferLayout::Dimension::segment: return idx.segment.value_or(0);
+            case ReconBufferLayout::Dimension::slice: return 0;
+            case ReconBufferLayout::Dimension::none: return 0;
+            default: throw std::runtime_error("Invalid enum encountered");
+            }
+        }
+    }
+
+    BufferKey ReconBufferLayout::getKey(const mrd::EncodingCounters& idx) const {
+        BufferKey key(idx);
+        clear(N_dimension, key);
+        clear(S_dimension, key);
+        if (!split_slices)
+            key.slice = 0;
+        if (ignore_segment)
+            key.segment = 0;
+        return key;
+    }
+
+    namespace {
+        uint32_t getSizeFromDimension(ReconBufferLayout::Dimension dimension, const mrd::EncodingLimitsType& stats) {
+            switch (dimension) {
+            case ReconBufferLayout::Dimension::phase:
+                if (stats.phase) {
+                    return stats.phase->maximum - stats.phase->minimum + 1;
+                }
+            case ReconBufferLayout::Dimension::contrast:
+                if (stats.contrast) {
+                    return stats.contrast->maximum - stats.contrast->minimum + 1;
+                }
+            case ReconBufferLayout::Dimension::repetition:
+                if (stats.repetition) {
+                    return stats.repetition->maximum - stats.repetition->minimum + 1;
+                }
+            case ReconBufferLayout::Dimension::set:
+                if (stats.set) {
+                    return stats.set->maximum - stats.set->minimum + 1;
+                }
+            case ReconBufferLayout::Dimension::segment: // TODO: Is this an intentional fallthrough? See 3b643b814b3b9a88c7dbc48879471ce718c7ab56
+            case ReconBufferLayout::Dimension::average:
+                if (stats.average) {
+                    return stats.average->maximum - stats.average->minimum + 1;
+                }
+            case ReconBufferLayout::Dimension::slice:
+                if (stats.slice) {
+                    return stats.slice->maximum - stats.slice->minimum + 1;
+                }
+            case ReconBufferLayout::Dimension::none:;
+                return 1;
+            default: throw std::runtime_error("Illegal enum value.");
+            }
+
+            return 1;
+        }
+    }
+
+    std::vector<size_t> ReconBufferLayout::dimensions(const mrd::Acquisition& acq,
+        const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) const
+    {
+        // 7D,  fixed order [E0, E1, E2, CHA, N, S, LOC]
+        return { getNE0(acq, encoding), getNE1(encoding, stats, forref), getNE2(encoding, stats, forref), acq.Coils(),
+            getSizeFromDimension(N_dimension, stats), getSizeFromDimension(S_dimension, stats), getNLOC(encoding, stats) };
+    }
+
+    mrd::ReconBuffer ReconBufferLayout::makeDataBuffer(const mrd::Acquisition& acq,
+        mrd::EncodingType encoding, const mrd::EncodingLimitsType& stats, bool forref) const
+    {
+        // Allocate the reference data array
+        // 7D,  fixed order [E0, E1, E2, CHA, N, S, LOC]
+        // 11D, fixed order [E0, E1, E2, CHA, SLC, PHS, CON, REP, SET, SEG, AVE]
+        const auto dims = dimensions(acq, encoding, stats, forref);
+        const size_t NE0 = dims[0];
+        const size_t NE1 = dims[1];
+        const size_t NE2 = dims[2];
+        const size_t NCHA = dims[3];
+        const size_t NN = dims[4];
+        const size_t NS = dims[5];
+        const size_t NLOC = dims[6];
+
+        GDEBUG_CONDITION_STREAM(verbose, "Data dimensions [RO E1 E2 CHA N S SLC] : ["
+                                             << NE0 << " " << NE1 << " " << NE2 << " " << NCHA << " " << NN << " " << NS
+                                             << " " << NLOC << "]");
+
+        mrd::ReconBuffer buffer;
+
+        // Allocate the array for the data
+        buffer.data = hoNDArray<std::complex<float>>(NE0, NE1, NE2, NCHA, NN, NS, NLOC);
+        clear(&buffer.data);
+
+        // Allocate the array for the headers
+        buffer.headers = hoNDArray<mrd::AcquisitionHeader>(NE1, NE2, NN, NS, NLOC);
+
+        // Allocate the array for the trajectories
+        if (acq.TrajectoryDimensions() > 0 && acq.TrajectorySamples() > 0) {
+            auto basis = acq.TrajectoryDimensions();
+            auto samples = acq.TrajectorySamples();
+            buffer.trajectory = hoNDArray<float>(samples, basis, NE1, NE2, NN, NS, NLOC);
+            clear(&buffer.trajectory);
+        }
+
+        // Add the sampling description
+        buffer.sampling = createSamplingDescription(encoding, stats, acq, forref);
+
+        return buffer;
+    }
+
+    uint32_t ReconBufferLayout::getNLOC(
+        const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats) const {
+        uint32_t NLOC;
+        if (split_slices) {
+            NLOC = 1;
+        } else {
+            if (encoding.encoding_limits.slice.has_value()) {
+                NLOC = encoding.encoding_limits.slice->maximum - encoding.encoding_limits.slice->minimum + 1;
+            } else {
+                NLOC = 1;
+            }
+
+            // if the AcquisitionAccumulateTriggerGadget sort by SLC, then the stats should be used to determine NLOC
+            // size_t NLOC_received = stats.slice ? stats.slice->maximum - stats.slice->minimum + 1 : 1;
+            size_t NLOC_received = getLimitSize(stats.slice); // TODO: Clean up
+            if (NLOC_received < NLOC) {
+                NLOC = NLOC_received;
+            }
+        }
+        return NLOC;
+    }
+    uint32_t ReconBufferLayout::getNE2(
+        const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) const {
+        uint32_t NE2;
+
+        /** TODO: This is ugly... */
+
+        if (encoding.trajectory == mrd::Trajectory::kCartesian || encoding.trajectory == mrd::Trajectory::kEpi) {
+            if (encoding.parallel_imaging) {
+                if (forref && encoding.parallel_imaging->calibration_mode &&
+                        (encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kSeparate ||
+                        encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kExternal)) {
+                    NE2 = encoding.encoding_limits.kspace_encoding_step_2->maximum
+                          - encoding.encoding_limits.kspace_encoding_step_2->minimum + 1;
+                } else {
+                    NE2 = encoding.encoded_space.matrix_size.z;
+                }
+            } else {
+                if (encoding.encoding_limits.kspace_encoding_step_2.has_value()) {
+                    NE2 = encoding.encoding_limits.kspace_encoding_step_2->maximum
+                          - encoding.encoding_limits.kspace_encoding_step_2->minimum + 1;
+                } else {
+                    NE2 = encoding.encoded_space.matrix_size.z;
+                }
+            }
+        } else {
+            if (encoding.encoding_limits.kspace_encoding_step_2.has_value()) {
+                NE2 = encoding.encoding_limits.kspace_encoding_step_2->maximum
+                      - encoding.encoding_limits.kspace_encoding_step_2->minimum + 1;
+            } else {
+                NE2 = getLimitSize(stats.kspace_encoding_step_2);
+            }
+        }
+        return NE2;
+    }
+    uint32_t ReconBufferLayout::getNE1(
+        const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) const {
+        uint32_t NE1;
+
+        /** TODO: This is also ugly... */
+
+        if (encoding.trajectory == mrd::Trajectory::kCartesian || encoding.trajectory == mrd::Trajectory::kEpi) {
+            if (encoding.parallel_imaging) {
+                if (forref && encoding.parallel_imaging->calibration_mode &&
+                        (encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kSeparate ||
+                        encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kExternal)) {
+                    NE1 = stats.kspace_encoding_step_1 ? stats.kspace_encoding_step_1->maximum - stats.kspace_encoding_step_1->minimum + 1 : 1;
+                } else {
+                    NE1 = encoding.encoded_space.matrix_size.y;
+                }
+            } else {
+                if (encoding.encoding_limits.kspace_encoding_step_1.has_value()) {
+                    NE1 = encoding.encoding_limits.kspace_encoding_step_1->maximum
+                          - encoding.encoding_limits.kspace_encoding_step_1->minimum + 1;
+                } else {
+                    NE1 = encoding.encoded_space.matrix_size.y;
+                }
+            }
+        } else {
+            if (encoding.encoding_limits.kspace_encoding_step_1.has_value()) {
+                NE1 = encoding.encoding_limits.kspace_encoding_step_1->maximum
+                      - encoding.encoding_limits.kspace_encoding_step_1->minimum + 1;
+            } else {
+                NE1 = getLimitSize(stats.kspace_encoding_step_1);
+            }
+        }
+        return NE1;
+    }
+    uint32_t ReconBufferLayout::getNE0(
+        const mrd::Acquisition& acq, const mrd::EncodingType& encoding) const {
+        uint32_t NE0;
+        if (encoding.trajectory == mrd::Trajectory::kCartesian || encoding.trajectory == mrd::Trajectory::kEpi) {
+            // if separate or external calibration mode, using the acq length for NE0
+            if (encoding.parallel_imaging) {
+                NE0 = acq.Samples();
+            } else {
+                NE0 = acq.Samples() - acq.head.discard_pre.value_or(0) - acq.head.discard_post.value_or(0);
+            }
+        } else {
+            NE0 = acq.Samples() - acq.head.discard_pre.value_or(0) - acq.head.discard_post.value_or(0);
+        }
+        return NE0;
+    }
+
+    mrd::SamplingDescription ReconBufferLayout::createSamplingDescription(const mrd::EncodingType& encoding,
+        const mrd::EncodingLimitsType& stats, const mrd::Acquisition& acq, bool forref) const
+    {
+        mrd::SamplingDescription sampling;
+        sampling.encoded_fov    = encoding.encoded_space.field_of_view_mm;
+        sampling.encoded_matrix = encoding.encoded_space.matrix_size;
+        sampling.recon_fov      = encoding.recon_space.field_of_view_mm;
+        sampling.recon_matrix   = encoding.recon_space.matrix_size;
+
+        sampling.sampling_limits.kspace_encoding_step_0.minimum = 0;
+        sampling.sampling_limits.kspace_encoding_step_0.maximum = acq.Samples() - 1;
+        sampling.sampling_limits.kspace_encoding_step_0.center = acq.Samples() / 2;
+
+        sampling.sampling_limits.kspace_encoding_step_1.minimum = encoding.encoding_limits.kspace_encoding_step_1->minimum;
+        sampling.sampling_limits.kspace_encoding_step_1.maximum = encoding.encoding_limits.kspace_encoding_step_1->maximum;
+        sampling.sampling_limits.kspace_encoding_step_1.center = encoding.encoding_limits.kspace_encoding_step_1->center;
+
+        sampling.sampling_limits.kspace_encoding_step_2.minimum = encoding.encoding_limits.kspace_encoding_step_2->minimum;
+        sampling.sampling_limits.kspace_encoding_step_2.maximum = encoding.encoding_limits.kspace_encoding_step_2->maximum;
+        sampling.sampling_limits.kspace_encoding_step_2.center = encoding.encoding_limits.kspace_encoding_step_2->center;
+
+        if (verbose) {
+            GDEBUG_STREAM("Encoding space : " << acq.head.encoding_space_ref.value_or(0) << " - "
+                          << int(encoding.trajectory) << " - FOV : [ " << encoding.encoded_space.field_of_view_mm.x << " "
+                          << encoding.encoded_space.field_of_view_mm.y << " " << encoding.encoded_space.field_of_view_mm.z
+                          << " ] "
+                          << " - Matris size : [ " << encoding.encoded_space.matrix_size.x << " "
+                          << encoding.encoded_space.matrix_size.y << " " << encoding.encoded_space.matrix_size.z << " ] ");
+
+            GDEBUG_STREAM("Sampling limits : "
+                          << "- RO : [ " << sampling.sampling_limits.kspace_encoding_step_0.minimum << " "
+                          << sampling.sampling_limits.kspace_encoding_step_0.center << " " << sampling.sampling_limits.kspace_encoding_step_0.maximum
+                          << " ] - E1 : [ " << sampling.sampling_limits.kspace_encoding_step_1.minimum << " "
+                          << sampling.sampling_limits.kspace_encoding_step_1.center << " " << sampling.sampling_limits.kspace_encoding_step_1.maximum
+                          << " ] - E2 : [ " << sampling.sampling_limits.kspace_encoding_step_2.minimum << " "
+                          << sampling.sampling_limits.kspace_encoding_step_2.center << " " << sampling.sampling_limits.kspace_encoding_step_2.maximum << " ]");
+        }
+
+        // For cartesian trajectories, assume that any oversampling has been removed.
+        if (encoding.trajectory == mrd::Trajectory::kCartesian) {
+            sampling.encoded_fov.x    = encoding.recon_space.field_of_view_mm.x;
+            sampling.encoded_matrix.x = encoding.recon_space.matrix_size.x;
+        } else {
+            sampling.encoded_fov.x    = encoding.encoded_space.field_of_view_mm.x;
+            sampling.encoded_matrix.x = encoding.encoded_space.matrix_size.x;
+        }
+
+        // For cartesian trajectories, assume that any oversampling has been removed.
+        if (((encoding.trajectory == mrd::Trajectory::kCartesian)) || (encoding.trajectory == mrd::Trajectory::kEpi)) {
+            sampling.sampling_limits.kspace_encoding_step_0.minimum = acq.head.discard_pre.value_or(0);
+            sampling.sampling_limits.kspace_encoding_step_0.maximum = acq.Samples() - acq.head.discard_post.value_or(0) - 1;
+            sampling.sampling_limits.kspace_encoding_step_0.center  = acq.Samples() / 2;
+        } else {
+            sampling.sampling_limits.kspace_encoding_step_0.minimum = 0;
+            sampling.sampling_limits.kspace_encoding_step_0.maximum = encoding.encoded_space.matrix_size.x - 1;
+            sampling.sampling_limits.kspace_encoding_step_0.center  = encoding.encoded_space.matrix_size.x / 2;
+        }
+
+        // if the scan is cartesian
+        if (((encoding.trajectory == mrd::Trajectory::kCartesian) &&
+                (!forref ||
+                    (forref && encoding.parallel_imaging && encoding.parallel_imaging->calibration_mode &&
+                    (encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kEmbedded))))
+            || ((encoding.trajectory == mrd::Trajectory::kEpi) && !forref)) {
+
+            int32_t space_matrix_offset_E1 = 0;
+            if (encoding.encoding_limits.kspace_encoding_step_1.has_value()) {
+                space_matrix_offset_E1 = (int32_t)encoding.encoded_space.matrix_size.y / 2
+                                         - (int32_t)encoding.encoding_limits.kspace_encoding_step_1->center;
+            }
+
+            int32_t space_matrix_offset_E2 = 0;
+            if (encoding.encoding_limits.kspace_encoding_step_2.has_value() && encoding.encoded_space.matrix_size.z > 1) {
+                space_matrix_offset_E2 = (int32_t)encoding.encoded_space.matrix_size.z / 2
+                                         - (int32_t)encoding.encoding_limits.kspace_encoding_step_2->center;
+            }
+
+            // E1
+            sampling.sampling_limits.kspace_encoding_step_1.minimum
+                = encoding.encoding_limits.kspace_encoding_step_1->minimum + space_matrix_offset_E1;
+            sampling.sampling_limits.kspace_encoding_step_1.maximum
+                = encoding.encoding_limits.kspace_encoding_step_1->maximum + space_matrix_offset_E1;
+            sampling.sampling_limits.kspace_encoding_step_1.center = sampling.encoded_matrix.y / 2;
+
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_1.minimum < encoding.encoded_space.matrix_size.y);
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_1.maximum >= sampling.sampling_limits.kspace_encoding_step_1.minimum);
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_1.center >= sampling.sampling_limits.kspace_encoding_step_1.minimum);
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_1.center <= sampling.sampling_limits.kspace_encoding_step_1.maximum);
+
+            // E2
+            sampling.sampling_limits.kspace_encoding_step_2.minimum
+                = encoding.encoding_limits.kspace_encoding_step_2->minimum + space_matrix_offset_E2;
+            sampling.sampling_limits.kspace_encoding_step_2.maximum
+                = encoding.encoding_limits.kspace_encoding_step_2->maximum + space_matrix_offset_E2;
+            sampling.sampling_limits.kspace_encoding_step_2.center = sampling.encoded_matrix.z / 2;
+
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_2.minimum < encoding.encoded_space.matrix_size.y);
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_2.maximum >= sampling.sampling_limits.kspace_encoding_step_2.minimum);
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_2.center >= sampling.sampling_limits.kspace_encoding_step_2.minimum);
+            GADGET_CHECK_THROW(sampling.sampling_limits.kspace_encoding_step_2.center <= sampling.sampling_limits.kspace_encoding_step_2.maximum);
+        } else {
+            sampling.sampling_limits.kspace_encoding_step_1.minimum    = encoding.encoding_limits.kspace_encoding_step_1->minimum;
+            sampling.sampling_limits.kspace_encoding_step_1.maximum    = encoding.encoding_limits.kspace_encoding_step_1->maximum;
+            sampling.sampling_limits.kspace_encoding_step_1.center = encoding.encoding_limits.kspace_encoding_step_1->center;
+
+            sampling.sampling_limits.kspace_encoding_step_2.minimum    = encoding.encoding_limits.kspace_encoding_step_2->minimum;
+            sampling.sampling_limits.kspace_encoding_step_2.maximum    = encoding.encoding_limits.kspace_encoding_step_2->maximum;
+            sampling.sampling_limits.kspace_encoding_step_2.center = encoding.encoding_limits.kspace_encoding_step_2->center;
+        }
+
+        if (verbose) {
+            GDEBUG_STREAM("Encoding space : "
+                          << int(encoding.trajectory) << " - FOV : [ " << encoding.encoded_space.field_of_view_mm.x << " "
+                          << encoding.encoded_space.field_of_view_mm.y << " " << encoding.encoded_space.field_of_view_mm.z
+                          << " ] "
+                          << " - Matrix size : [ " << encoding.encoded_space.matrix_size.x << " "
+                          << encoding.encoded_space.matrix_size.y << " " << encoding.encoded_space.matrix_size.z << " ] ");
+
+            GDEBUG_STREAM("Sampling limits : "
+                          << "- kspace_encoding_step_0 : [ " << sampling.sampling_limits.kspace_encoding_step_0.minimum << " "
+                          << sampling.sampling_limits.kspace_encoding_step_0.center << " " << sampling.sampling_limits.kspace_encoding_step_0.maximum
+                          << " ] - kspace_encoding_step_1 : [ " << sampling.sampling_limits.kspace_encoding_step_1.minimum << " "
+                          << sampling.sampling_limits.kspace_encoding_step_1.center << " " << sampling.sampling_limits.kspace_encoding_step_1.maximum
+                          << " ] - kspace_encoding_step_2 : [ " << sampling.sampling_limits.kspace_encoding_step_2.minimum << " "
+                          << sampling.sampling_limits.kspace_encoding_step_2.center << " " << sampling.sampling_limits.kspace_encoding_step_2.maximum << " ]");
+        }
+        return sampling;
+    }
+
+    std::optional<ReconBufferLayout::Slot> ReconBufferLayout::find_slot(const mrd::ReconBuffer& dataBuffer,
+        const mrd::AcquisitionHeader& head, uint32_t samples, const mrd::EncodingType& encoding,
+        const mrd::EncodingLimitsType& stats, bool forref, bool quiet) const {
+
+        uint16_t NE0  = (uint16_t)dataBuffer.data.get_size(0);
+        uint16_t NE1  = (uint16_t)dataBuffer.data.get_size(1);
+        uint16_t NE2  = (uint16_t)dataBuffer.data.get_size(2);
+        uint16_t NN   = (uint16_t)dataBuffer.data.get_size(4);
+        uint16_t NS   = (uint16_t)dataBuffer.data.get_size(5);
+        uint16_t NLOC = (uint16_t)dataBuffer.data.get_size(6);
+
+        const size_t slice_loc = split_slices || NLOC == 1 ? 0 : head.idx.slice.value_or(0);
+
+        uint32_t npts_to_copy = samples - head.discard_pre.value_or(0) - head.discard_post.value_or(0);
+        long long offset;
+        if (encoding.trajectory == mrd::Trajectory::kCartesian || encoding.trajectory == mrd::Trajectory::kEpi) {
+            if ((samples == NE0)
+                && ((head.center_sample == samples / 2) || head.center_sample >= samples))
+            {
+                // acq has been corrected for center, e.g. by asymmetric handling
+                offset = head.discard_pre.value_or(0);
+            } else {
+                offset = (long long)dataBuffer.sampling.sampling_limits.kspace_encoding_step_0.center - (long long)head.center_sample.value_or(0);
+            }
+        } else {
+            // TODO what about EPI with asymmetric readouts?
+            // TODO any other sort of trajectory?
+            offset = 0;
+        }
+
+        long long roffset = (long long)NE0 - npts_to_copy - offset;
+
+        if ((offset < 0) | (roffset < 0)) {
+            if (quiet)
+                return std::nullopt;
+            throw std::runtime_error("Acquired reference data does not fit into the reference data buffer.\n");
+        }
+
+        uint32_t NUsed = (uint32_t)getDimensionKey(N_dimension, head.idx);
+        if (NUsed >= NN)
+            NUsed = NN - 1;
+
+        uint32_t SUsed = (uint32_t)getDimensionKey(S_dimension, head.idx);
+        if (SUsed >= NS)
+            SUsed = NS - 1;
+
+        int32_t e1 = (int32_t)head.idx.kspace_encode_step_1.value_or(0);
+        int32_t e2 = (int32_t)head.idx.kspace_encode_step_2.value_or(0);
+
+        bool is_cartesian_sampling = (encoding.trajectory == mrd::Trajectory::kCartesian);
+        bool is_epi_sampling       = (encoding.trajectory == mrd::Trajectory::kEpi);
+        if (is_cartesian_sampling || is_epi_sampling) {
+            if (!forref || (forref &&
+                    encoding.parallel_imaging &&
+                    encoding.parallel_imaging->calibration_mode &&
+                    (encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kEmbedded)))
+            {
+                // compute the center offset for E1 and E2
+                int32_t space_matrix_offset_E1 = 0;
+                if (encoding.encoding_limits.kspace_encoding_step_1.has_value()) {
+                    space_matrix_offset_E1 = (int32_t)encoding.encoded_space.matrix_size.y / 2
+                                             - (int32_t)encoding.encoding_limits.kspace_encoding_step_1->center;
+                }
+
+                int32_t space_matrix_offset_E2 = 0;
+                if (encoding.encoding_limits.kspace_encoding_step_2.has_value()
+                    && encoding.encoded_space.matrix_size.z > 1) {
+                    space_matrix_offset_E2 = (int32_t)encoding.encoded_space.matrix_size.z / 2
+                                             - (int32_t)encoding.encoding_limits.kspace_encoding_step_2->center;
+                }
+
+                // compute the used e1 and e2 indices and make sure they are in the valid range
+                e1 = (int32_t)head.idx.kspace_encode_step_1.value_or(0) + space_matrix_offset_E1;
+                e2 = (int32_t)head.idx.kspace_encode_step_2.value_or(0) + space_matrix_offset_E2;
+            }
+
+            // for external or separate mode, it is possible the starting numbers of ref lines are not zero, therefore
+            // it is needed to subtract the staring ref line number because the ref array size is set up by the actual
+            // number of lines acquired only assumption for external or separate ref line mode is that all ref lines are
+            // numbered sequentially the acquisition order of ref line can be arbitrary
+            if (forref &&
+                    encoding.parallel_imaging && encoding.parallel_imaging->calibration_mode &&
+                    ((encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kSeparate)
+                        || (encoding.parallel_imaging->calibration_mode.value() == mrd::CalibrationMode::kExternal)))
+            {
+                if (stats.kspace_encoding_step_1 && stats.kspace_encoding_step_1->minimum > 0) {
+                    e1 = head.idx.kspace_encode_step_1.value_or(0) - stats.kspace_encoding_step_1->minimum;
+                }
+
+                if (stats.kspace_encoding_step_2 && stats.kspace_encoding_step_2->minimum > 0) {
+                    e2 = head.idx.kspace_encode_step_2.value_or(0) - stats.kspace_encoding_step_2->minimum;
+                }
+            }
+
+            if (e1 < 0 || e1 >= (int32_t)NE1) {
+                if (quiet)
+                    return std::nullopt;
+
+                // if the incoming line is outside the encoding limits, something is wrong
+                GADGET_CHECK_THROW(
+                    head.idx.kspace_encode_step_1.value_or(0) >= encoding.encoding_limits.kspace_encoding_step_1->minimum
+                    && head.idx.kspace_encode_step_1.value_or(0) <= encoding.encoding_limits.kspace_encoding_step_1->maximum);
+
+                // if the incoming line is inside encoding limits but outside the encoded matrix, do not include the data
+                GWARN_STREAM(
+                    "incoming readout "
+                    << head.scan_counter.value_or(0)
+                    << " is inside the encoding limits, but outside the encoded matrix for kspace_encode_step_1 : "
+                    << e1 << " out of " << NE1);
+                return std::nullopt;
+            }
+
+            if (e2 < 0 || e2 >= (int32_t)NE2) {
+                if (quiet)
+                    return std::nullopt;
+
+                GADGET_CHECK_THROW(
+                    head.idx.kspace_encode_step_2.value_or(0) >= encoding.encoding_limits.kspace_encoding_step_2->minimum
+                    && head.idx.kspace_encode_step_2.value_or(0) <= encoding.encoding_limits.kspace_encoding_step_2->maximum);
+
+                GWARN_STREAM(
+                    "incoming readout "
+                    << head.scan_counter.value_or(0)
+                    << " is inside the encoding limits, but outside the encoded matrix for kspace_encode_step_2 : "
+                    << e2 << " out of " << NE2);
+                return std::nullopt;
+            }
+        }
+
+        return Slot{ offset, npts_to_copy, e1, e2, NUsed, SUsed, slice_loc };
+    }
+
+    void ReconBufferLayout::add_acquisition(mrd::ReconBuffer& dataBuffer, const mrd::Acquisition& acq,
+        const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) const {
+        if (auto slot = find_slot(dataBuffer, acq.head, acq.Samples(), encoding, stats, forref))
+            copy_to_slot(dataBuffer, *slot, acq);
+    }
+
+    void ReconBufferLayout::copy_to_slot(mrd::ReconBuffer& dataBuffer, const Slot& slot, const mrd::Acquisition& acq) {
+        const size_t NE0  = dataBuffer.data.get_size(0);
+        const size_t NE1  = dataBuffer.data.get_size(1);
+        const size_t NE2  = dataBuffer.data.get_size(2);
+        const size_t NCHA = dataBuffer.data.get_size(3);
+
+        // Stuff the data
+        std::complex<float>* pData = &dataBuffer.data(slot.offset, slot.e1, slot.e2, 0, slot.n, slot.s, slot.loc);
+
+        for (size_t cha = 0; cha < NCHA; cha++) {
+            auto dataptr = pData + cha * NE0 * NE1 * NE2;
+            auto fromptr = &acq.data(acq.head.discard_pre.value_or(0), cha);
+            std::copy(fromptr, fromptr + slot.samples, dataptr);
+        }
+
+        // Stuff the header
+        dataBuffer.headers(slot.e1, slot.e2, slot.n, slot.s, slot.loc) = acq.head;
+
+        if (acq.TrajectoryDimensions() > 0 && acq.TrajectorySamples() > 0) {
+            // Stuff the trajectory
+            float* trajptr = &dataBuffer.trajectory(slot.offset, 0, slot.e1, slot.e2, slot.n, slot.s, slot.loc);
+            auto* fromptr  = &acq.trajectory(acq.head.discard_pre.value_or(0), 0);
+            std::copy(fromptr, fromptr + slot.samples * acq.TrajectoryDimensions(), trajptr);
+        }
+    }
+
+    void ReconBufferLayout::copy_slot(
+        const mrd::ReconBuffer& from, const Slot& from_slot, mrd::ReconBuffer& to, const Slot& to_slot) {
+        const size_t from_stride = from.data.get_size(0) * from.data.get_size(1) * from.data.get_size(2);
+        const size_t to_stride   = to.data.get_size(0) * to.data.get_size(1) * to.data.get_size(2);
+        const size_t NCHA        = to.data.get_size(3);
+
+        auto fromptr = &from.data(from_slot.offset, from_slot.e1, from_slot.e2, 0, from_slot.n, from_slot.s, from_slot.loc);
+        auto toptr   = &to.data(to_slot.offset, to_slot.e1, to_slot.e2, 0, to_slot.n, to_slot.s, to_slot.loc);
+        for (size_t cha = 0; cha < NCHA; cha++)
+            std::copy(fromptr + cha * from_stride, fromptr + cha * from_stride + to_slot.samples, toptr + cha * to_stride);
+
+        to.headers(to_slot.e1, to_slot.e2, to_slot.n, to_slot.s, to_slot.loc)
+            = from.headers(from_slot.e1, from_slot.e2, from_slot.n, from_slot.s, from_slot.loc);
+
+        if (!to.trajectory.empty()) {
+            // Trajectories are stored [samples, basis, ...], so the whole line is contiguous.
+            const size_t basis = to.trajectory.get_size(1);
+            auto trajptr = &from.trajectory(from_slot.offset, 0, from_slot.e1, from_slot.e2, from_slot.n, from_slot.s, from_slot.loc);
+            std::copy(trajptr, trajptr + to_slot.samples * basis,
+                &to.trajectory(to_slot.offset, 0, to_slot.e1, to_slot.e2, to_slot.n, to_slot.s, to_slot.loc));
+        }
+    }
+
+    ReconBufferLayout::ReconBufferLayout(const mrd::Header& header, const Core::GadgetProperties& props)
+        : PropertyMixin(props), header{ header } {}
+
+    namespace {
+        using Dimension = ReconBufferLayout::Dimension;
+        const std::map<std::string, ReconBufferLayout::Dimension> dimension_from_name
+            = { { "average", Dimension::average }, { "contrast", Dimension::contrast }, { "phase", Dimension::phase },
+                { "repetition", Dimension::repetition }, { "set", Dimension::set }, { "segment", Dimension::segment },
+                { "slice", Dimension::slice }, { "", Dimension::none }, { "none", Dimension::none }
+              };
+    }
+
+    void from_string(const std::string& str, ReconBufferLayout::Dimension& dim) {
+        auto lower = str;
+        boost::to_lower(lower);
+        dim = dimension_from_name.at(lower);
+    }
+}
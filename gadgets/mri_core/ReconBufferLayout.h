@@ -0,0 +1,122 @@
+#pragma once
+
+#include "PropertyMixin.h"
+#include "hoNDArray.h"
+
+#include <mrd/types.h>
+
+#include <complex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace Gadgetron {
+
+    // Lays out kspace readouts in mrd::ReconBuffers, as used by BucketToBufferGadget and AcquisitionAccumulateBufferGadget.
+    // For the cartesian sampling, the filled kspace ensures its center (N/2) is aligned with the specified center in
+    // the encoding limits For the non-cartesian sampling, this "center alignment" constraint is not applied and kspace
+    // lines are filled as their E1 and E2 indexes
+
+    // TODO the ignore_segment_ flag is a hack for some EPI sequences
+    // should be fixed on the converter side.
+
+    class ReconBufferLayout : public Core::PropertyMixin {
+    public:
+        ReconBufferLayout(const mrd::Header& header, const Core::GadgetProperties& props);
+
+        enum class Dimension { average, contrast, phase, repetition, set, segment, slice, none };
+
+        struct BufferKey {
+            uint32_t average,slice,contrast,phase,repetition,set,segment;
+            BufferKey(const BufferKey&) = default;
+            BufferKey(const mrd::EncodingCounters& idx)
+                : average{idx.average.value_or(0)}
+                , slice{idx.slice.value_or(0)}
+                , contrast{idx.contrast.value_or(0)}
+                , phase{idx.phase.value_or(0)}
+                , repetition{idx.repetition.value_or(0)}
+                , set{idx.set.value_or(0)}
+                , segment{idx.segment.value_or(0)}
+            { }
+        };
+
+        // Position of a readout within a ReconBuffer; the samples [offset, offset + samples) of line (e1, e2, n, s, loc).
+        struct Slot {
+            long long offset;
+            uint32_t samples;
+            int32_t e1, e2;
+            uint32_t n, s;
+            size_t loc;
+
+            bool operator==(const Slot& other) const {
+                return offset == other.offset && samples == other.samples && e1 == other.e1 && e2 == other.e2
+                       && n == other.n && s == other.s && loc == other.loc;
+            }
+            bool operator!=(const Slot& other) const { return !(*this == other); }
+        };
+
+        NODE_PROPERTY(N_dimension, Dimension, "N-Dimensions", Dimension::none);
+        NODE_PROPERTY(S_dimension, Dimension, "S-Dimensions", Dimension::none);
+
+        NODE_PROPERTY(split_slices, bool, "Split slices", false);
+        NODE_PROPERTY(ignore_segment, bool, "Ignore segment", false);
+        NODE_PROPERTY(verbose, bool, "Whether to print more information", false);
+
+        const mrd::Header header;
+
+        BufferKey getKey(const mrd::EncodingCounters& idx) const;
+
+        // Dimensions [E0, E1, E2, CHA, N, S, LOC] of the buffer makeDataBuffer would allocate.
+        std::vector<size_t> dimensions(const mrd::Acquisition& acq, const mrd::EncodingType& encoding,
+            const mrd::EncodingLimitsType& stats, bool forref) const;
+
+        mrd::ReconBuffer makeDataBuffer(const mrd::Acquisition& acq, mrd::EncodingType encoding,
+            const mrd::EncodingLimitsType& stats, bool forref) const;
+
+        /**
+         * Finds the slot of a readout with the given header and number of samples. Returns nothing if the readout is
+         * inside the encoding limits but outside the encoded matrix, in which case it is dropped with a warning; throws
+         * if it does not fit at all. With quiet set, both cases just return nothing.
+         */
+        std::optional<Slot> find_slot(const mrd::ReconBuffer& dataBuffer, const mrd::AcquisitionHeader& head,
+            uint32_t samples, const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref,
+            bool quiet = false) const;
+
+        void add_acquisition(mrd::ReconBuffer& dataBuffer, const mrd::Acquisition& acq, const mrd::EncodingType& encoding,
+            const mrd::EncodingLimitsType& stats, bool forref) const;
+
+        static void copy_to_slot(mrd::ReconBuffer& dataBuffer, const Slot& slot, const mrd::Acquisition& acq);
+        static void copy_slot(const mrd::ReconBuffer& from, const Slot& from_slot, mrd::ReconBuffer& to, const Slot& to_slot);
+
+    protected:
+        mrd::SamplingDescription createSamplingDescription(const mrd::EncodingType& encoding,
+            const mrd::EncodingLimitsType& stats, const mrd::Acquisition& acq, bool forref) const;
+
+        uint32_t getNE0(const mrd::Acquisition& acq, const mrd::EncodingType& encoding) const;
+        uint32_t getNE1(const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) const;
+        uint32_t getNE2(const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats, bool forref) const;
+        uint32_t getNLOC(const mrd::EncodingType& encoding, const mrd::EncodingLimitsType& stats) const;
+    };
+
+    void from_string(const std::string&, ReconBufferLayout::Dimension&);
+}
+
+namespace std {
+    template<>
+    struct less<Gadgetron::ReconBufferLayout::BufferKey>{
+        using BufferKey = Gadgetron::ReconBufferLayout::BufferKey;
+        bool operator()(const BufferKey& idx1, const BufferKey& idx2) const {
+            return std::tie(idx1.average,idx1.slice,idx1.contrast,idx1.phase,idx1.repetition,idx1.set,idx1.segment) <
+                std::tie(idx2.average,idx2.slice,idx2.contrast,idx2.phase,idx2.repetition,idx2.set,idx2.segment);
+        }
+    };
+
+    template<> struct equal_to<Gadgetron::ReconBufferLayout::BufferKey>{
+        using BufferKey = Gadgetron::ReconBufferLayout::BufferKey;
+        bool operator()(const BufferKey& idx1, const BufferKey& idx2) const {
+            return idx1.average == idx2.average
+                   && idx1.slice == idx2.slice && idx1.contrast == idx2.contrast && idx1.phase == idx2.phase
+                   && idx1.repetition == idx2.repetition && idx1.set == idx2.set && idx1.segment == idx2.segment;
+        }
+    };
+}
@@ -1,4 +1,5 @@
 #include "RemoveROOversamplingGadget.h"
+#include "ComputeBudget.h"
 
 #include <mri_core_utility.h>
 
@@ -23,11 +24,6 @@ RemoveROOversamplingGadget::RemoveROOversamplingGadget(const Core::Context& cont
     reconNx_ = r_space.matrix_size.x;
     reconFOV_ = r_space.field_of_view_mm.x;
 
-#ifdef USE_OMP  // TODO: Should this be removed? Its from the old version
-    omp_set_num_threads(1);
-    GDEBUG_STREAM("RemoveROOversamplingGadget:omp_set_num_threads(1) ... ");
-#endif // USE_OMP
-
     // If the encoding and recon matrix size and FOV are the same
     // then the data is not oversampled and we can safely pass
     // the data onto the next gadget
@@ -39,6 +35,8 @@ RemoveROOversamplingGadget::RemoveROOversamplingGadget(const Core::Context& cont
 }
 
 void RemoveROOversamplingGadget::process(Core::InputChannel<mrd::Acquisition>& in, Core::OutputChannel& out) {
+    Core::Compute::ThreadLimit single_thread(1);
+
     for (auto acq : in) {
         if (dowork_) {
             auto data_in_dims = acq.data.dimensions();
@@ -4,6 +4,7 @@
 #include "hoNDArray_reductions.h"
 #include "hoSPIRIT2DOperator.h"
 #include "hoLsqrSolver.h"
+#include "hoCgSolver.h"
 #include "mri_core_grappa.h"
 
 namespace Gadgetron {
@@ -617,6 +618,8 @@ namespace Gadgetron {
             size_t iter_max = this->spirit_iter_max;
             double iter_thres = this->spirit_iter_thres;
             bool print_iter = this->spirit_print_iter;
+            bool use_cg = this->spirit_use_cg;
+            double cg_iter_thres = this->spirit_cg_iter_thres;
 
             size_t RO = kspace.get_size(0);
             size_t E1 = kspace.get_size(1);
@@ -650,7 +653,7 @@ namespace Gadgetron {
             dim[1] = E1;
             dim[2] = CHA;
 
-#pragma omp parallel default(none) private(ii) shared(num, N, S, RO, E1, CHA, dim, ref_N, ref_S, kspace, res, kspace_Shifted, ker_Shifted, iter_max, iter_thres, print_iter) num_threads(numThreads) if(num>1)
+#pragma omp parallel default(none) private(ii) shared(num, N, S, RO, E1, CHA, dim, ref_N, ref_S, kspace, res, kspace_Shifted, ker_Shifted, iter_max, iter_thres, print_iter, use_cg, cg_iter_thres) num_threads(numThreads) if(num>1)
             {
                 boost::shared_ptr< hoSPIRIT2DOperator< std::complex<float> > > oper(new hoSPIRIT2DOperator< std::complex<float> >(dim));
                 hoSPIRIT2DOperator< std::complex<float> >& spirit = *oper;
@@ -663,10 +666,17 @@ namespace Gadgetron {
                     spirit.set_forward_kernel(*ker, false);
                 }
 
-                hoLsqrSolver< std::complex<float> > cgSolver;
-                cgSolver.set_tc_tolerance((float)iter_thres);
+                hoLsqrSolver< std::complex<float> > lsqrSolver;
+                lsqrSolver.set_tc_tolerance((float)iter_thres);
+                lsqrSolver.set_max_iterations(iter_max);
+                lsqrSolver.set_output_mode(print_iter ? hoLsqrSolver< std::complex<float> >::OUTPUT_VERBOSE : hoLsqrSolver< std::complex<float> >::OUTPUT_SILENT);
+                lsqrSolver.set_encoding_operator(oper);
+
+                // cg applies (G-I)'(G-I) in one pass through the image domain, where lsqr applies (G-I) and (G-I)' in turn
+                hoCgSolver< std::complex<float> > cgSolver;
+                cgSolver.set_tc_tolerance((float)cg_iter_thres);
                 cgSolver.set_max_iterations(iter_max);
-                cgSolver.set_output_mode(print_iter ? hoLsqrSolver< std::complex<float> >::OUTPUT_VERBOSE : hoLsqrSolver< std::complex<float> >::OUTPUT_SILENT);
+                cgSolver.set_output_mode(print_iter ? hoCgSolver< std::complex<float> >::OUTPUT_VERBOSE : hoCgSolver< std::complex<float> >::OUTPUT_SILENT);
                 cgSolver.set_encoding_operator(oper);
 
                 hoNDArray< std::complex<float> > b(RO, E1, CHA);
@@ -708,21 +718,25 @@ namespace Gadgetron {
 
                     boost::shared_ptr< hoNDArray< std::complex<float> > > acq(new hoNDArray< std::complex<float> >(RO, E1, CHA, pKpaceShifted));
                     spirit.set_acquired_points(*acq);
-                    cgSolver.set_x0(acq);
 
-                    if (ref_N == 1 && ref_S == 1)
-                    {
-                        spirit.compute_righ_hand_side(*acq, b);
-                        cgSolver.solve(&unwarppedKSpace, &b);
-                    }
-                    else
+                    if (ref_N != 1 || ref_S != 1)
                     {
                         std::complex<float>* pKer = &(ker_Shifted(0, 0, 0, 0, kernelN, kernelS, slc));
                         boost::shared_ptr<hoNDArray< std::complex<float> > > ker(new hoNDArray< std::complex<float> >(RO, E1, CHA, CHA, pKer));
                         spirit.set_forward_kernel(*ker, false);
+                    }
 
-                        spirit.compute_righ_hand_side(*acq, b);
-                        cgSolver.solve(&unwarppedKSpace, &b);
+                    spirit.compute_righ_hand_side(*acq, b);
+
+                    if (use_cg)
+                    {
+                        cgSolver.set_x0(acq);
+                        unwarppedKSpace = *cgSolver.solve(&b);
+                    }
+                    else
+                    {
+                        lsqrSolver.set_x0(acq);
+                        lsqrSolver.solve(&unwarppedKSpace, &b);
                     }
 
                     // restore the acquired points
@@ -77,6 +77,8 @@ namespace Gadgetron {
         NODE_PROPERTY_NON_CONST(spirit_iter_max, int, "Spirit maximal number of iterations", 0);
         NODE_PROPERTY_NON_CONST(spirit_iter_thres, double, "Spirit threshold to stop iteration", 0);
         NODE_PROPERTY(spirit_print_iter, bool, "Spirit print out iterations", false);
+        NODE_PROPERTY(spirit_use_cg, bool, "Spirit solves the normal equations with conjugate gradient instead of using LSQR", false);
+        NODE_PROPERTY(spirit_cg_iter_thres, double, "Spirit threshold on the relative squared residual of the normal equations to stop conjugate gradient", 1e-8);
 
     protected:
 
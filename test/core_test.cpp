@@ -2,6 +2,12 @@
 #include <gtest/gtest.h>
 #include "Message.h"
 #include "Channel.h"
+#include "Tracing.h"
+#include "ComputeBudget.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <thread>
 
 TEST(TypeTests, multitype) {
     using namespace Gadgetron::Core;
@@ -225,4 +231,218 @@ TEST(TypeTests, tupletype3) {
     EXPECT_EQ(std::get<1>(converted), 1.0f);
 }
 
+TEST(TypeTests, sharedtype) {
+    using namespace Gadgetron::Core;
+    auto channel = make_channel<MessageChannel>();
+    GenericInputChannel inputChannel = std::move(channel.input);
+    OutputChannel outputChannel = std::move(channel.output);
+
+    auto shared = Shared<std::vector<int>>(std::vector<int>{1, 2, 3});
+    outputChannel.push(shared, int(42));
+    outputChannel.push(shared);
+
+    auto first = inputChannel.pop();
+    EXPECT_TRUE((convertible_to<std::vector<int>, int>(first)));
+    EXPECT_TRUE((convertible_to<Shared<std::vector<int>>, int>(first)));
+
+    auto [received, value] = force_unpack<Shared<std::vector<int>>, int>(std::move(first));
+    EXPECT_EQ(&received.get(), &shared.get());
+    EXPECT_EQ(value, 42);
+
+    // The payload is still held by the second message, so mutating copies it.
+    received.mutate().push_back(4);
+    EXPECT_EQ(received->size(), 4);
+    EXPECT_EQ(shared->size(), 3);
+
+    auto second = force_unpack<std::vector<int>>(inputChannel.pop());
+    EXPECT_EQ(second, std::vector<int>({1, 2, 3}));
+    EXPECT_EQ(shared->size(), 3);
+}
+
+TEST(TypeTests, sharedclone) {
+    using namespace Gadgetron::Core;
+
+    auto message = Message(std::vector<int>{1, 2, 3});
+    auto clone = message.clone();
+
+    auto original = force_unpack<Shared<std::vector<int>>>(std::move(message));
+    EXPECT_FALSE(original.unique());
+
+    auto cloned = force_unpack<Shared<std::vector<int>>>(std::move(clone));
+    EXPECT_EQ(&original.get(), &cloned.get());
+
+    const auto* payload = cloned->data();
+    original = Shared<std::vector<int>>(std::vector<int>{});
+    EXPECT_TRUE(cloned.unique());
+
+    // The last holder takes the payload without copying it.
+    auto taken = std::move(cloned).take();
+    EXPECT_EQ(taken.data(), payload);
+}
+
+TEST(TypeTests, sharedtake_threads) {
+    using namespace Gadgetron::Core;
+
+    // As with Fanout: each branch takes the same payload on its own thread. Whichever sees itself as the last
+    // holder moves the payload out, which must not overlap with another branch still copying it.
+    for (int iteration = 0; iteration < 500; iteration++) {
+        auto original = Message(std::vector<int>(1000, iteration));
+        std::vector<Message> branches;
+        for (int i = 0; i < 3; i++) branches.push_back(original.clone());
+        original = Message();
+
+        std::vector<std::vector<int>> taken(branches.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < branches.size(); i++) {
+            threads.emplace_back([&, i]() {
+                auto shared = force_unpack<Shared<std::vector<int>>>(std::move(branches[i]));
+                taken[i] = std::move(shared).take();
+            });
+        }
+        for (auto &thread : threads) thread.join();
+
+        for (auto &result : taken) EXPECT_EQ(result, std::vector<int>(1000, iteration));
+    }
+}
+
+
+
+TEST(BoundedChannelTests, fifo) {
+    using namespace Gadgetron::Core;
+
+    BoundedMPMCChannel<int> channel(4);
+    EXPECT_EQ(channel.capacity(), 4);
+    EXPECT_FALSE(channel.try_pop());
+
+    for (int i = 0; i < 4; i++) channel.push(i);
+    for (int i = 0; i < 4; i++) EXPECT_EQ(channel.pop(), i);
+
+    EXPECT_FALSE(channel.try_pop());
+}
+
+TEST(BoundedChannelTests, close) {
+    using namespace Gadgetron::Core;
+
+    BoundedMPMCChannel<std::unique_ptr<int>> channel(2);
+    channel.push(std::make_unique<int>(42));
+    channel.close();
+
+    EXPECT_EQ(*channel.pop(), 42);
+    EXPECT_THROW(channel.pop(), ChannelClosed);
+    EXPECT_THROW(channel.push(std::make_unique<int>(1)), ChannelClosed);
+}
+
+TEST(BoundedChannelTests, backpressure) {
+    using namespace Gadgetron::Core;
+
+    constexpr int producers = 4;
+    constexpr int messages = 10000;
+
+    BoundedMPMCChannel<int> channel(8);
 
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            for (int i = 1; i <= messages; i++) channel.push(i);
+        });
+    }
+
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 2; c++) {
+        consumers.emplace_back([&]() {
+            try {
+                while (true) sum += channel.pop();
+            } catch (const ChannelClosed&) {
+            }
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+    channel.close();
+    for (auto& thread : consumers) thread.join();
+
+    EXPECT_EQ(sum.load(), producers * (long long)messages * (messages + 1) / 2);
+}
+
+TEST(BoundedChannelTests, messagechannel) {
+    using namespace Gadgetron::Core;
+
+    auto channel = make_channel<BoundedMessageChannel>(2);
+    GenericInputChannel inputChannel = std::move(channel.input);
+    OutputChannel outputChannel = std::move(channel.output);
+
+    outputChannel.push(std::string("test"), int(4));
+
+    auto message = inputChannel.pop();
+    EXPECT_TRUE((convertible_to<std::string, int>(message)));
+}
+
+TEST(TracingTests, counts_messages_and_depth) {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Core::Tracing;
+
+    auto trace = std::make_shared<Trace>();
+    auto& producer = trace->node("producer");
+    auto& consumer = trace->node("consumer");
+    auto& channel_metrics = trace->channel("producer -> consumer");
+
+    auto channel = make_channel<MessageChannel>();
+    auto input = trace_input(std::move(channel.input), trace, consumer, &channel_metrics);
+    {
+        auto output = trace_output(std::move(channel.output), trace, producer, &channel_metrics);
+        for (int i = 0; i < 5; i++) output.push(i);
+    }
+
+    int received = 0;
+    for (auto message : input) {
+        EXPECT_EQ(force_unpack<int>(std::move(message)), received);
+        received++;
+    }
+
+    EXPECT_EQ(received, 5);
+    EXPECT_EQ(producer.messages_out, 5);
+    EXPECT_EQ(consumer.messages_in, 5);
+    EXPECT_EQ(channel_metrics.messages, 5);
+    EXPECT_EQ(channel_metrics.max_depth, 5);
+    EXPECT_EQ(channel_metrics.depth, 0);
+
+    std::stringstream timeline;
+    trace->write_chrome_trace(timeline);
+    EXPECT_NE(timeline.str().find("\"name\":\"consumer\",\"cat\":\"node\""), std::string::npos);
+
+    std::stringstream summary;
+    trace->write_summary(summary);
+    EXPECT_NE(summary.str().find("producer -> consumer"), std::string::npos);
+}
+
+TEST(ComputeBudgetTests, cpu_lists) {
+    using namespace Gadgetron::Core;
+
+    auto cpus = parse_cpu_list("8, 0-3,10-11,2");
+    EXPECT_EQ(cpus, (std::vector<unsigned int>{ 0, 1, 2, 3, 8, 10, 11 }));
+    EXPECT_EQ(format_cpu_list(cpus), "0-3,8,10-11");
+    EXPECT_THROW(parse_cpu_list("3-1"), std::invalid_argument);
+    EXPECT_THROW(parse_cpu_list("one"), std::invalid_argument);
+}
+
+TEST(ComputeBudgetTests, scope_is_inherited_by_pools) {
+    using namespace Gadgetron::Core;
+
+    auto budget = std::make_shared<ComputeBudget>();
+    budget->cores = { 0 };
+    budget->threads = 1;
+
+    EXPECT_EQ(Compute::current(), nullptr);
+    {
+        Compute::Scope scope{budget};
+        EXPECT_EQ(Compute::current(), budget);
+        EXPECT_EQ(Compute::max_threads(), 1);
+
+        ThreadPool pool{2};
+        auto worker_budget = pool.async([]() { return Compute::current(); }).get();
+        EXPECT_EQ(worker_budget, budget);
+        pool.join();
+    }
+    EXPECT_EQ(Compute::current(), nullptr);
+}
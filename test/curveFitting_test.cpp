@@ -14,6 +14,7 @@
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
 #include "cmr_t1_mapping.h"
+#include "cmr_t2_mapping.h"
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
 
@@ -233,3 +234,132 @@ TYPED_TEST(curveFitting_test, T1SRMapping)
     // test hole filling
     EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.36963, 1.0);
 }
+
+TYPED_TEST(curveFitting_test, T1SRMappingBatched)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = true;
+    t1_sr.max_size_of_holes_ = 20;
+    t1_sr.hole_marking_value_ = 0;
+    t1_sr.compute_SD_maps_ = true;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+    t1_sr.max_map_value_ = 4000;
+
+    t1_sr.batched_fitting_ = true;
+
+    size_t RO = 64;
+    size_t E1 = 48;
+    size_t N = t1_sr.ti_.size();
+
+    float y[11] = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    t1_sr.data_.create(RO, E1, N, 1, 1);
+    for (size_t n = 0; n < N; n++)
+    {
+        Gadgetron::hoNDArray<float> data2D(RO, E1, &(t1_sr.data_(0, 0, n, 0, 0)));
+        Gadgetron::fill(data2D, y[n]);
+    }
+
+    t1_sr.mask_for_mapping_.create(RO, E1, 1);
+    Gadgetron::fill(t1_sr.mask_for_mapping_, (float)1);
+    t1_sr.mask_for_mapping_(12, 23, 0) = 0;
+    t1_sr.mask_for_mapping_(12, 24, 0) = 0;
+    t1_sr.mask_for_mapping_(13, 23, 0) = 0;
+
+    t1_sr.perform_parametric_mapping();
+
+    // the data has an exact fit: A = 471.06362, T1 = 1122.36307
+    EXPECT_NEAR(t1_sr.para_(0, 0, 0, 0, 0), 471.06362, 0.003);
+    EXPECT_NEAR(t1_sr.para_(RO / 2, E1 / 2, 0, 0, 0), 471.06362, 0.003);
+
+    EXPECT_NEAR(t1_sr.map_(0, 0, 0, 0), 1122.36307, 0.003);
+    EXPECT_NEAR(t1_sr.map_(RO - 1, E1 - 1, 0, 0), 1122.36307, 0.003);
+    EXPECT_NEAR(t1_sr.map_(37, 41, 0, 0), 1122.36307, 0.003);
+
+    // test hole filling
+    EXPECT_NEAR(t1_sr.map_(12, 23, 0, 0), 1122.36307, 1.0);
+}
+
+TYPED_TEST(curveFitting_test, T2MappingBatched)
+{
+    Gadgetron::CmrT2Mapping<float> t2;
+    t2.compute_SD_maps_ = true;
+
+    t2.ti_ = { 0, 25, 55, 80 };
+
+    const size_t W = Gadgetron::CmrT2Mapping<float>::batch_size;
+    size_t num = t2.ti_.size();
+
+    // noise-free decays with T2 from 20 to 95 ms, except for the last lane, which is fitted like the per-pixel path
+    std::vector<float> yi(num * W), bi(2 * W), sd(2 * W), map_v(W), map_sd(W);
+    for (size_t l = 0; l < W; l++)
+    {
+        float A = 500 + 20 * l;
+        float T2 = 20 + 5 * l;
+        for (size_t n = 0; n < num; n++) yi[n * W + l] = A * std::exp(-t2.ti_[n] / T2);
+    }
+
+    std::vector<float> yv = { 738.33f, 436.36f, 244.88f, 160.1f };
+    for (size_t n = 0; n < num; n++) yi[n * W + W - 1] = yv[n];
+
+    t2.compute_map_batch(t2.ti_, yi.data(), W, bi.data(), map_v.data(), sd.data(), map_sd.data());
+
+    for (size_t l = 0; l + 1 < W; l++)
+    {
+        EXPECT_NEAR(bi[l], 500 + 20 * l, 0.01 * (500 + 20 * l));
+        EXPECT_NEAR(map_v[l], 20 + 5 * l, 0.001 * (20 + 5 * l));
+    }
+
+    std::vector<float> guess, b, s;
+    float map_single(0), sd_single(0);
+    t2.get_initial_guess(t2.ti_, yv, guess);
+    t2.compute_map(t2.ti_, yv, guess, b, map_single);
+    t2.compute_sd(t2.ti_, yv, b, s, sd_single);
+
+    EXPECT_NEAR(map_v[W - 1], map_single, 0.001 * map_single);
+    EXPECT_NEAR(map_sd[W - 1], sd_single, 0.01 * sd_single);
+}
+
+TYPED_TEST(curveFitting_test, T1SRMappingDictionary)
+{
+    Gadgetron::CmrT1SRMapping<float> t1_sr;
+
+    t1_sr.fill_holes_in_maps_ = false;
+    t1_sr.compute_SD_maps_ = true;
+    t1_sr.dictionary_matching_ = true;
+
+    t1_sr.ti_.resize(11, 545);
+    t1_sr.ti_[10] = 10000;
+    t1_sr.max_map_value_ = 4000;
+
+    size_t RO = 32;
+    size_t E1 = 24;
+    size_t N = t1_sr.ti_.size();
+
+    float y[11] = { 178, 185, 182, 189, 178, 180, 187, 179, 177, 177, 471 };
+
+    t1_sr.data_.create(RO, E1, N, 1, 1);
+    for (size_t n = 0; n < N; n++)
+    {
+        Gadgetron::hoNDArray<float> data2D(RO, E1, &(t1_sr.data_(0, 0, n, 0, 0)));
+        Gadgetron::fill(data2D, y[n]);
+    }
+
+    // without refinement, the map is the nearest atom, less than a grid step away
+    t1_sr.dictionary_refinement_iter_ = 0;
+    t1_sr.perform_parametric_mapping();
+
+    EXPECT_NEAR(t1_sr.map_(0, 0, 0, 0), 1122.36307, 0.01 * 1122.36307);
+    EXPECT_NEAR(t1_sr.map_(RO - 1, E1 - 1, 0, 0), 1122.36307, 0.01 * 1122.36307);
+
+    // refinement reaches the exact fit
+    t1_sr.dictionary_refinement_iter_ = 5;
+    t1_sr.perform_parametric_mapping();
+
+    EXPECT_NEAR(t1_sr.para_(0, 0, 0, 0, 0), 471.06362, 0.003);
+    EXPECT_NEAR(t1_sr.map_(0, 0, 0, 0), 1122.36307, 0.003);
+    EXPECT_NEAR(t1_sr.map_(RO - 1, E1 - 1, 0, 0), 1122.36307, 0.003);
+}
@@ -0,0 +1,131 @@
+#include "patch_distances.h"
+#include "non_local_means.h"
+
+#include <complex>
+#include <random>
+#include <gtest/gtest.h>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Denoise;
+
+namespace {
+
+    template <class T> T random_value(std::mt19937& rng);
+
+    template <> float random_value<float>(std::mt19937& rng) {
+        return std::normal_distribution<float>()(rng);
+    }
+
+    template <> std::complex<float> random_value<std::complex<float>>(std::mt19937& rng) {
+        std::normal_distribution<float> normal;
+        return { normal(rng), normal(rng) };
+    }
+
+    template <class T> hoNDArray<T> random_image(size_t width, size_t height, unsigned int seed) {
+        std::mt19937 rng(seed);
+        hoNDArray<T> image(width, height);
+        for (auto& value : image)
+            value = random_value<T>(rng);
+        return image;
+    }
+
+    int wrap(int i, int n) {
+        return ((i % n) + n) % n;
+    }
+
+    template <class T>
+    double direct_distance(const hoNDArray<T>& image, int x, int y, int dx, int dy, int patch_size) {
+        const int width = image.get_size(0);
+        const int height = image.get_size(1);
+        double distance = 0;
+        for (int j = -patch_size / 2; j <= patch_size / 2; j++)
+            for (int i = -patch_size / 2; i <= patch_size / 2; i++)
+                distance += std::norm(std::complex<double>(image(wrap(x + i, width), wrap(y + j, height)))
+                    - std::complex<double>(image(wrap(x + dx + i, width), wrap(y + dy + j, height))));
+        return distance;
+    }
+
+    template <class T>
+    void expect_direct_distances(const hoNDArray<T>& image, int patch_size, int y_begin, int y_end, int search_radius) {
+        const int width = image.get_size(0);
+        PatchDistances<T> patch_distances(image, patch_size, y_begin, y_end);
+
+        for (int dy = -search_radius; dy < search_radius; dy++) {
+            for (int dx = -search_radius; dx < search_radius; dx++) {
+                const float* distances = patch_distances.compute(dx, dy);
+                for (int y = y_begin; y < y_end; y++) {
+                    for (int x = 0; x < width; x++) {
+                        double expected = direct_distance(image, x, y, dx, dy, patch_size);
+                        ASSERT_NEAR(distances[x + (y - y_begin) * width], expected, 1e-5 * expected + 1e-5)
+                            << "offset (" << dx << ", " << dy << ") at (" << x << ", " << y << ")";
+                    }
+                }
+            }
+        }
+    }
+
+    // The per-pixel D x D loops non-local means used before its summed-area tables.
+    template <class T> hoNDArray<T> direct_non_local_means(const hoNDArray<T>& image, float noise_std, int search_radius) {
+        constexpr int D = 5;
+        const int width = image.get_size(0);
+        const int height = image.get_size(1);
+
+        hoNDArray<T> result(image.dimensions());
+        for (int ky = 0; ky < height; ky++) {
+            for (int kx = 0; kx < width; kx++) {
+                double sum_weight = 0;
+                std::complex<double> sum_value = 0;
+                for (int dy = -search_radius; dy < search_radius; dy++) {
+                    for (int dx = -search_radius; dx < search_radius; dx++) {
+                        double weight = std::exp(-direct_distance(image, kx, ky, dx, dy, D) / (noise_std * noise_std * D * D));
+                        sum_weight += weight;
+                        sum_value += weight * std::complex<double>(image(wrap(kx + dx, width), wrap(ky + dy, height)));
+                    }
+                }
+                std::complex<double> value = sum_value / sum_weight;
+                if constexpr (std::is_same_v<T, float>)
+                    result(kx, ky) = float(value.real());
+                else
+                    result(kx, ky) = T(value);
+            }
+        }
+        return result;
+    }
+}
+
+template <typename T> class PatchDistances_test : public ::testing::Test {};
+
+typedef ::testing::Types<float, std::complex<float>> PatchDistancesTypes;
+TYPED_TEST_SUITE(PatchDistances_test, PatchDistancesTypes);
+
+TYPED_TEST(PatchDistances_test, matches_direct_distances) {
+    auto image = random_image<TypeParam>(37, 29, 3);
+
+    expect_direct_distances(image, 5, 0, 29, 6);
+    expect_direct_distances(image, 5, 8, 16, 6);
+    expect_direct_distances(image, 3, 27, 29, 6);
+}
+
+TYPED_TEST(PatchDistances_test, wraps_images_smaller_than_search_window) {
+    // Both the patches and the offsets wrap around the image more than once.
+    auto image = random_image<TypeParam>(6, 4, 5);
+
+    expect_direct_distances(image, 5, 0, 4, 10);
+    expect_direct_distances(image, 5, 1, 3, 10);
+}
+
+TYPED_TEST(PatchDistances_test, non_local_means_matches_direct_loops) {
+    auto image = random_image<TypeParam>(40, 36, 7);
+    for (int ky = 10; ky < 26; ky++)
+        for (int kx = 12; kx < 30; kx++)
+            image(kx, ky) += TypeParam(4);
+
+    for (int search_radius : { 3, 5 }) {
+        auto expected = direct_non_local_means(image, 1.0f, search_radius);
+        auto actual = non_local_means(image, 1.0f, search_radius);
+
+        ASSERT_EQ(actual.dimensions(), expected.dimensions());
+        for (size_t i = 0; i < expected.size(); i++)
+            EXPECT_NEAR(std::abs(actual[i] - expected[i]), 0.0f, 1e-4f * std::abs(expected[i]) + 1e-5f) << i;
+    }
+}
@@ -0,0 +1,85 @@
+from __future__ import annotations
+
+import os
+import signal
+import socket
+import subprocess
+import threading
+import time
+
+import pytest
+
+from conftest import Spec
+from test_e2e import extract_image_data, validate_image_data
+
+
+CASE = 'cases/cpu_grappa_simple.yml'
+CONCURRENT_STREAMS = 3
+
+
+def stream_through_server(socket_path: str, input_file: str, output_file: str) -> None:
+    """Sends one MRD stream over the server socket, using the server's default config, and stores the output."""
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+        connection.connect(socket_path)
+
+        def send():
+            connection.sendall(b'\n')
+            with open(input_file, 'rb') as f:
+                for chunk in iter(lambda: f.read(1 << 20), b''):
+                    connection.sendall(chunk)
+            connection.shutdown(socket.SHUT_WR)
+
+        sender = threading.Thread(target=send)
+        sender.start()
+        with open(output_file, 'wb') as f:
+            for chunk in iter(lambda: connection.recv(1 << 20), b''):
+                f.write(chunk)
+        sender.join()
+
+
+@pytest.fixture
+def server_spec(request, pingvin_capabilities, fetch_test_data) -> Spec:
+    spec = Spec.fromfile(CASE)
+    if not request.config.getoption("--download-all"):
+        fetch_test_data(spec.test_data_files())
+    return spec
+
+
+def test_server_concurrent_streams(server_spec, local_test_data_path, tmp_path):
+    """Concurrent streams through one server match the reference, and the server shuts down cleanly on SIGTERM."""
+    job = server_spec.reconstruction
+    input_file = local_test_data_path(job.datafile)
+    socket_path = os.path.join(tmp_path, 'pingvin.sock')
+
+    log_filename = os.path.join(tmp_path, 'pingvin_server.log.err')
+    with open(log_filename, 'w') as log:
+        server = subprocess.Popen(['pingvin', '--listen', socket_path] + job.args[0].split(),
+                                  stderr=log, cwd=tmp_path)
+        try:
+            deadline = time.monotonic() + 30
+            while not os.path.exists(socket_path):
+                if server.poll() is not None or time.monotonic() > deadline:
+                    pytest.fail(f"Pingvin server did not start. See {log_filename} for details.")
+                time.sleep(0.1)
+
+            output_files = [os.path.join(tmp_path, f'stream_{i}.output.mrd') for i in range(CONCURRENT_STREAMS)]
+            streams = [threading.Thread(target=stream_through_server, args=(socket_path, input_file, output_file))
+                       for output_file in output_files]
+            for stream in streams:
+                stream.start()
+            for stream in streams:
+                stream.join()
+
+            server.send_signal(signal.SIGTERM)
+            assert server.wait(timeout=60) == 0
+            assert not os.path.exists(socket_path)
+        finally:
+            if server.poll() is None:
+                server.kill()
+
+    reference_images = extract_image_data(local_test_data_path(server_spec.validation.reference))
+    for output_file in output_files:
+        output_images = extract_image_data(output_file)
+        for test in server_spec.validation.image_series_tests:
+            validate_image_data(output_images[test.image_series]['data'], reference_images[test.image_series]['data'],
+                                test.scale_comparison_threshold, test.value_comparison_threshold)
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "parallel/Fanout.h"
+
+#include <mrd/types.h>
+
+using namespace Gadgetron::Core;
+
+namespace {
+    template<class T>
+    mrd::Image<T> make_image(T value) {
+        mrd::Image<T> image;
+        image.data.create(4, 3);
+        std::fill(image.data.begin(), image.data.end(), value);
+        return image;
+    }
+}
+
+TEST(FanoutTest, images_reach_every_branch) {
+    Parallel::ImageFanout fanout{Context{}, GadgetProperties{}};
+
+    auto input = make_channel<MessageChannel>();
+    auto bypass = make_channel<MessageChannel>();
+    std::map<std::string, OutputChannel> outputs;
+    std::vector<GenericInputChannel> branches;
+    for (auto name : {"first", "second", "third"}) {
+        auto channel = make_channel<MessageChannel>();
+        outputs.emplace(name, std::move(channel.output));
+        branches.push_back(std::move(channel.input));
+    }
+
+    {
+        auto images = std::move(input.output);
+        images.push(make_image(2.0f));
+        images.push(make_image(std::complex<float>(1.0f, -1.0f)));
+        images.push(mrd::Acquisition{});
+        images.push(make_image(uint16_t(7)));
+    }
+
+    Parallel::Branch &branch = fanout;
+    branch.process(std::move(input.input), std::move(outputs), std::move(bypass.output));
+
+    std::vector<const void *> float_payloads, complex_payloads, ushort_payloads;
+    for (auto &received : branches) {
+        auto float_image = force_unpack<Shared<mrd::Image<float>>>(received.pop());
+        EXPECT_EQ(float_image->data(3, 2), 2.0f);
+        float_payloads.push_back(&float_image.get());
+
+        auto complex_image = force_unpack<Shared<mrd::Image<std::complex<float>>>>(received.pop());
+        EXPECT_EQ(complex_image->data(0, 0), std::complex<float>(1.0f, -1.0f));
+        complex_payloads.push_back(&complex_image.get());
+
+        auto ushort_image = force_unpack<Shared<mrd::Image<uint16_t>>>(received.pop());
+        EXPECT_EQ(ushort_image->data(1, 1), 7);
+        ushort_payloads.push_back(&ushort_image.get());
+
+        EXPECT_THROW(received.pop(), ChannelClosed);
+    }
+
+    // Each image is stored once and shared by all of the branches.
+    for (auto *payloads : {&float_payloads, &complex_payloads, &ushort_payloads})
+        EXPECT_EQ(std::count(payloads->begin(), payloads->end(), payloads->front()), 3);
+
+    // Only what is not an image goes to the bypass.
+    EXPECT_TRUE(convertible_to<mrd::Acquisition>(bypass.input.pop()));
+    EXPECT_THROW(bypass.input.pop(), ChannelClosed);
+}
@@ -0,0 +1,213 @@
+#include "../../gadgets/mri_core/AcquisitionAccumulateBufferGadget.h"
+#include "../../gadgets/mri_core/BucketToBufferGadget.h"
+#include "mri_core_utility.h"
+#include "setup_gadget.h"
+#include <future>
+#include <gtest/gtest.h>
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+using namespace std::chrono_literals;
+
+namespace {
+    Core::Context context_with_contrasts(uint32_t contrasts) {
+        auto context = generate_context();
+        auto& limits = context.header.encoding[0].encoding_limits;
+        limits.kspace_encoding_step_2 = mrd::LimitType{};
+        limits.contrast = mrd::LimitType{};
+        limits.contrast->maximum = contrasts - 1;
+        limits.slice = mrd::LimitType{};
+        limits.slice->maximum = 1;
+        return context;
+    }
+
+    std::vector<mrd::Acquisition> generate_acquisitions(uint32_t slices, uint32_t contrasts) {
+        std::vector<mrd::Acquisition> acquisitions;
+        for (uint32_t slice = 0; slice < slices; slice++) {
+            for (uint32_t e1 = 0; e1 < 192; e1 += 3) {
+                for (uint32_t contrast = 0; contrast < contrasts; contrast++) {
+                    auto acq = generate_acquisition(192, 4);
+                    acq.head.idx.kspace_encode_step_1 = e1;
+                    acq.head.idx.kspace_encode_step_2 = 0;
+                    acq.head.idx.slice = slice;
+                    acq.head.idx.contrast = contrast;
+                    acq.head.scan_counter = uint32_t(acquisitions.size());
+                    for (size_t i = 0; i < acq.data.size(); i++)
+                        acq.data[i] = std::complex<float>(float(acquisitions.size()), float(i));
+                    acquisitions.push_back(std::move(acq));
+                }
+            }
+        }
+        return acquisitions;
+    }
+
+    std::vector<mrd::ReconData> receive(Core::GenericInputChannel& output, size_t count) {
+        std::vector<mrd::ReconData> result;
+        for (size_t i = 0; i < count; i++) {
+            auto message_future = std::async([&]() { return output.pop(); });
+            if (message_future.wait_for(1000ms) != std::future_status::ready)
+                break;
+            auto message = message_future.get();
+            if (!Core::convertible_to<mrd::ReconData>(message))
+                break;
+            result.push_back(Core::force_unpack<mrd::ReconData>(std::move(message)));
+        }
+        return result;
+    }
+
+    std::vector<mrd::ReconData> bucket_to_buffer(const std::vector<mrd::Acquisition>& acquisitions,
+        const Core::GadgetProperties& properties, const Core::Context& context) {
+        auto channels = setup_gadget<BucketToBufferGadget>(properties, context);
+        std::map<uint32_t, mrd::AcquisitionBucket> buckets;
+        for (auto& acq : acquisitions)
+            add_acquisition_to_bucket(buckets[acq.head.idx.slice.value_or(0)], acq);
+        for (auto& bucket : buckets)
+            channels.input.push(std::move(bucket.second));
+        return receive(channels.output, buckets.size());
+    }
+
+    std::vector<mrd::ReconData> accumulate_buffer(const std::vector<mrd::Acquisition>& acquisitions,
+        const Core::GadgetProperties& properties, const Core::Context& context, size_t expected) {
+        auto channels = setup_gadget<AcquisitionAccumulateBufferGadget>(properties, context);
+        {
+            auto input = std::move(channels.input);
+            for (auto& acq : acquisitions)
+                input.push(acq);
+        }
+        return receive(channels.output, expected);
+    }
+
+    void expect_equal(const std::vector<mrd::ReconData>& expected, const std::vector<mrd::ReconData>& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            auto& expected_buffer = expected[i].buffers[0].data;
+            auto& actual_buffer = actual[i].buffers[0].data;
+            ASSERT_EQ(expected_buffer.data.dimensions(), actual_buffer.data.dimensions());
+            EXPECT_TRUE(std::equal(expected_buffer.data.begin(), expected_buffer.data.end(), actual_buffer.data.begin()));
+            ASSERT_EQ(expected_buffer.headers.dimensions(), actual_buffer.headers.dimensions());
+            for (size_t j = 0; j < expected_buffer.headers.size(); j++)
+                EXPECT_EQ(expected_buffer.headers[j].scan_counter.value_or(~0u), actual_buffer.headers[j].scan_counter.value_or(~0u));
+        }
+    }
+}
+
+TEST(AcquisitionAccumulateBufferTest, matches_bucket_to_buffer) {
+    Core::GadgetProperties properties{ { "trigger_dimension"s, "slice"s }, { "N_dimension"s, "contrast"s } };
+    auto context = context_with_contrasts(2);
+    auto acquisitions = generate_acquisitions(2, 2);
+
+    auto expected = bucket_to_buffer(acquisitions, properties, context);
+    ASSERT_EQ(expected.size(), 2u);
+    EXPECT_EQ(expected[0].buffers[0].data.data.get_size(4), 2u);
+
+    expect_equal(expected, accumulate_buffer(acquisitions, properties, context, expected.size()));
+}
+
+TEST(AcquisitionAccumulateBufferTest, repacks_when_limits_overestimate) {
+    // The header promises four contrasts, but only two are acquired; the buffer must shrink to match.
+    Core::GadgetProperties properties{ { "trigger_dimension"s, "slice"s }, { "N_dimension"s, "contrast"s } };
+    auto context = context_with_contrasts(4);
+    auto acquisitions = generate_acquisitions(2, 2);
+
+    auto expected = bucket_to_buffer(acquisitions, properties, context);
+    ASSERT_EQ(expected.size(), 2u);
+    EXPECT_EQ(expected[0].buffers[0].data.data.get_size(4), 2u);
+
+    expect_equal(expected, accumulate_buffer(acquisitions, properties, context, expected.size()));
+}
+
+namespace {
+    Core::Context context_with_separate_calibration() {
+        auto context = context_with_contrasts(1);
+        context.header.encoding[0].encoding_limits.slice->maximum = 2;
+        context.header.encoding[0].parallel_imaging = mrd::ParallelImagingType{};
+        context.header.encoding[0].parallel_imaging->acceleration_factor.kspace_encoding_step_1 = 3;
+        context.header.encoding[0].parallel_imaging->acceleration_factor.kspace_encoding_step_2 = 1;
+        context.header.encoding[0].parallel_imaging->calibration_mode = mrd::CalibrationMode::kSeparate;
+        return context;
+    }
+
+    std::vector<mrd::Acquisition> generate_calibrated_acquisitions(uint32_t slices) {
+        std::vector<mrd::Acquisition> acquisitions;
+        for (uint32_t slice = 0; slice < slices; slice++) {
+            for (uint32_t e1 = 80; e1 < 112; e1++) {
+                auto acq = generate_acquisition(192, 4);
+                acq.head.idx.kspace_encode_step_1 = e1;
+                acq.head.idx.kspace_encode_step_2 = 0;
+                acq.head.idx.slice = slice;
+                acq.head.idx.contrast = 0;
+                acq.head.scan_counter = uint32_t(acquisitions.size());
+                acq.head.flags.SetFlags(mrd::AcquisitionFlags::kIsParallelCalibration);
+                for (size_t i = 0; i < acq.data.size(); i++)
+                    acq.data[i] = std::complex<float>(float(acquisitions.size()), -float(i));
+                acquisitions.push_back(std::move(acq));
+            }
+        }
+        auto data = generate_acquisitions(slices, 1);
+        for (auto& acq : data) {
+            acq.head.scan_counter = uint32_t(acquisitions.size());
+            acquisitions.push_back(std::move(acq));
+        }
+        std::stable_sort(acquisitions.begin(), acquisitions.end(),
+            [](const auto& a, const auto& b) { return a.head.idx.slice.value_or(0) < b.head.idx.slice.value_or(0); });
+        return acquisitions;
+    }
+
+    struct Counted {
+        std::vector<mrd::ReconData> output;
+        size_t direct_buffers;
+        size_t repacked_buffers;
+    };
+
+    Counted accumulate_buffer_counted(const std::vector<mrd::Acquisition>& acquisitions,
+        const Core::GadgetProperties& properties, const Core::Context& context, size_t expected) {
+        auto input = Core::make_channel();
+        auto output = Core::make_channel();
+        AcquisitionAccumulateBufferGadget gadget(context, properties);
+
+        std::thread thread(
+            [&gadget](auto in, auto out) {
+                try {
+                    Core::Node& node = gadget;
+                    node.process(in, out);
+                } catch (const Core::ChannelClosed&) {}
+            },
+            std::move(input.input), std::move(output.output));
+        {
+            auto to_gadget = std::move(input.output);
+            for (auto& acq : acquisitions)
+                to_gadget.push(acq);
+        }
+
+        auto result = receive(output.input, expected);
+        thread.join();
+        return { std::move(result), gadget.direct_buffers, gadget.repacked_buffers };
+    }
+}
+
+TEST(AcquisitionAccumulateBufferTest, separate_reference_reuses_previous_layout) {
+    // The header limits span the full matrix; the reference lines only the calibration region. The first
+    // reference buffer must be repacked to fit, after which the learned layout is used as is.
+    Core::GadgetProperties properties{ { "trigger_dimension"s, "slice"s } };
+    auto context = context_with_separate_calibration();
+    auto acquisitions = generate_calibrated_acquisitions(3);
+
+    auto expected = bucket_to_buffer(acquisitions, properties, context);
+    ASSERT_EQ(expected.size(), 3u);
+    ASSERT_TRUE(expected[0].buffers[0].ref.has_value());
+    EXPECT_EQ(expected[0].buffers[0].ref->data.get_size(1), 32u);
+
+    auto actual = accumulate_buffer_counted(acquisitions, properties, context, expected.size());
+    expect_equal(expected, actual.output);
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_TRUE(actual.output[i].buffers[0].ref.has_value());
+        auto& expected_ref = expected[i].buffers[0].ref->data;
+        auto& actual_ref = actual.output[i].buffers[0].ref->data;
+        ASSERT_EQ(expected_ref.dimensions(), actual_ref.dimensions());
+        EXPECT_TRUE(std::equal(expected_ref.begin(), expected_ref.end(), actual_ref.begin()));
+    }
+
+    // Three data buffers and two reference buffers go out as filled; only the first reference buffer is repacked.
+    EXPECT_EQ(actual.repacked_buffers, 1u);
+    EXPECT_EQ(actual.direct_buffers, 5u);
+}
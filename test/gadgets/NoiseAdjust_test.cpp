@@ -0,0 +1,138 @@
+#include "../../gadgets/mri_core/NoiseAdjustGadget.h"
+#include "setup_gadget.h"
+#include <mrd/binary/protocols.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <random>
+#include <gtest/gtest.h>
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+
+namespace {
+    constexpr size_t noise_channels = 8;
+
+    Core::Context context_with_noise(const std::string& measurement_id) {
+        auto context = generate_context();
+        context.header.measurement_information = mrd::MeasurementInformationType{};
+        context.header.measurement_information->measurement_id = measurement_id;
+        context.header.acquisition_system_information = mrd::AcquisitionSystemInformationType{};
+        for (uint32_t c = 0; c < noise_channels; c++) {
+            mrd::CoilLabelType label;
+            label.coil_number = c;
+            label.coil_name = "coil" + std::to_string(c);
+            context.header.acquisition_system_information->coil_label.push_back(label);
+        }
+        return context;
+    }
+
+    mrd::Acquisition line(std::mt19937& rng, size_t samples, bool noise) {
+        // Correlated channels, so the prewhitener is far from the identity.
+        auto acq = random_acquisition(rng, samples, noise_channels, 0.25f);
+        if (noise)
+            acq.head.flags.SetFlags(mrd::AcquisitionFlags::kIsNoiseMeasurement);
+        return acq;
+    }
+
+    std::vector<mrd::Acquisition> noise_lines(bool noise) {
+        std::mt19937 rng(7);
+        std::vector<mrd::Acquisition> acquisitions;
+        // Short lines spanning several covariance blocks, and one line longer than a block.
+        for (size_t i = 0; i < 40; i++)
+            acquisitions.push_back(line(rng, 256, noise));
+        acquisitions.push_back(line(rng, 5000, noise));
+        for (size_t i = 0; i < 8; i++)
+            acquisitions.push_back(line(rng, 128, noise));
+        return acquisitions;
+    }
+
+    std::vector<mrd::Acquisition> generate_stream(size_t data_lines) {
+        std::mt19937 rng(42);
+        auto acquisitions = noise_lines(true);
+        for (size_t i = 0; i < data_lines; i++)
+            acquisitions.push_back(line(rng, 192, false));
+        return acquisitions;
+    }
+
+    hoNDArray<std::complex<double>> direct_covariance(const std::vector<mrd::Acquisition>& acquisitions) {
+        hoNDArray<std::complex<double>> covariance(noise_channels, noise_channels);
+        std::fill(covariance.begin(), covariance.end(), std::complex<double>(0));
+        size_t samples = 0;
+        for (auto& acq : acquisitions) {
+            if (!acq.head.flags.HasFlags(mrd::AcquisitionFlags::kIsNoiseMeasurement))
+                continue;
+            for (size_t j = 0; j < noise_channels; j++)
+                for (size_t i = 0; i < noise_channels; i++)
+                    for (size_t s = 0; s < acq.Samples(); s++)
+                        covariance(i, j) += std::conj(std::complex<double>(acq.data(s, i)))
+                            * std::complex<double>(acq.data(s, j));
+            samples += acq.Samples();
+        }
+        for (auto& v : covariance)
+            v /= double(samples - 1);
+        return covariance;
+    }
+}
+
+TEST(NoiseAdjustTest, batched_prewhitening_matches_unbatched) {
+    auto acquisitions = generate_stream(23);
+
+    auto expected = run_gadget<NoiseAdjustGadget>(acquisitions, { { "prewhitening_batch_size"s, "1"s } }, context_with_noise("noise_unbatched"));
+    auto actual = run_gadget<NoiseAdjustGadget>(acquisitions, { { "prewhitening_batch_size"s, "5"s } }, context_with_noise("noise_batched"));
+
+    ASSERT_EQ(expected.size(), 23u);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i].data.dimensions(), actual[i].data.dimensions());
+        for (size_t k = 0; k < expected[i].data.size(); k++)
+            EXPECT_NEAR(std::abs(expected[i].data[k] - actual[i].data[k]), 0.0f, 1e-5f * std::abs(expected[i].data[k]) + 1e-6f);
+    }
+}
+
+TEST(NoiseAdjustTest, prewhitened_noise_is_white) {
+    // Without dwell times the bandwidth scale factor is one, so noise whitened by its own covariance has unit covariance.
+    auto acquisitions = noise_lines(true);
+    for (auto& acq : noise_lines(false))
+        acquisitions.push_back(std::move(acq));
+
+    auto whitened = run_gadget<NoiseAdjustGadget>(acquisitions, { { "prewhitening_batch_size"s, "4"s } }, context_with_noise("noise_white"));
+    ASSERT_EQ(whitened.size(), 49u);
+    for (auto& acq : whitened)
+        acq.head.flags.SetFlags(mrd::AcquisitionFlags::kIsNoiseMeasurement);
+
+    auto covariance = direct_covariance(whitened);
+    for (size_t j = 0; j < noise_channels; j++) {
+        for (size_t i = 0; i < noise_channels; i++) {
+            EXPECT_NEAR(covariance(i, j).real(), i == j ? 1.0 : 0.0, 1e-4);
+            EXPECT_NEAR(covariance(i, j).imag(), 0.0, 1e-4);
+        }
+    }
+}
+
+TEST(NoiseAdjustTest, block_covariance_matches_direct_sum) {
+    auto acquisitions = noise_lines(true);
+    auto context = context_with_noise("noise_block_covariance");
+    auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    context.parameters["noisecovarianceout"] = path.string();
+    run_gadget<NoiseAdjustGadget>(acquisitions, {}, context);
+
+    mrd::NoiseCovariance stored;
+    {
+        std::ifstream file(path.string(), std::ios::binary);
+        ASSERT_TRUE(file.is_open());
+        mrd::binary::MrdNoiseCovarianceReader reader(file);
+        reader.ReadNoiseCovariance(stored);
+        reader.Close();
+    }
+    boost::filesystem::remove(path);
+    EXPECT_EQ(stored.sample_count, 40u * 256 + 5000 + 8 * 128);
+
+    auto expected = direct_covariance(acquisitions);
+    ASSERT_EQ(stored.matrix.get_size(0), noise_channels);
+    for (size_t j = 0; j < noise_channels; j++) {
+        for (size_t i = 0; i < noise_channels; i++) {
+            EXPECT_NEAR(stored.matrix(i, j).real(), expected(i, j).real(), 1e-4 * std::abs(expected(i, i)));
+            EXPECT_NEAR(stored.matrix(i, j).imag(), expected(i, j).imag(), 1e-4 * std::abs(expected(i, i)));
+        }
+    }
+}
@@ -0,0 +1,176 @@
+#include "../../gadgets/mri_core/NoiseAdjustGadget.h"
+#include "../../gadgets/mri_core/NoiseCovarianceCache.h"
+#include "setup_gadget.h"
+#include <random>
+#include <gtest/gtest.h>
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+namespace bf = boost::filesystem;
+
+namespace {
+    std::vector<mrd::CoilLabelType> coil_labels(std::vector<std::string> names) {
+        std::vector<mrd::CoilLabelType> labels;
+        for (size_t c = 0; c < names.size(); c++) {
+            mrd::CoilLabelType label;
+            label.coil_number = uint32_t(c);
+            label.coil_name = names[c];
+            labels.push_back(label);
+        }
+        return labels;
+    }
+
+    mrd::NoiseCovariance make_covariance(size_t channels, float scale) {
+        mrd::NoiseCovariance covariance;
+        covariance.coil_labels = coil_labels(std::vector<std::string>(channels, "coil"));
+        covariance.noise_dwell_time_us = 5.0f;
+        covariance.receiver_noise_bandwidth = 0.793f;
+        covariance.sample_count = 1024;
+        covariance.matrix = hoNDArray<std::complex<float>>(channels, channels);
+        std::fill(covariance.matrix.begin(), covariance.matrix.end(), std::complex<float>(0));
+        for (size_t c = 0; c < channels; c++)
+            covariance.matrix(c, c) = scale * float(c + 1);
+        return covariance;
+    }
+
+    Core::Context context_for(const std::string& measurement_id, const std::string& noise_dependency) {
+        auto context = generate_context();
+        context.header.measurement_information = mrd::MeasurementInformationType{};
+        context.header.measurement_information->measurement_id = measurement_id;
+        if (!noise_dependency.empty()) {
+            mrd::MeasurementDependencyType dependency;
+            dependency.dependency_type = "Noise";
+            dependency.measurement_id = noise_dependency;
+            context.header.measurement_information->measurement_dependency.push_back(dependency);
+        }
+        context.header.acquisition_system_information = mrd::AcquisitionSystemInformationType{};
+        context.header.acquisition_system_information->coil_label = coil_labels({ "a", "b", "c", "d" });
+        return context;
+    }
+
+    mrd::Acquisition line(std::mt19937& rng, size_t samples, bool noise) {
+        auto acq = random_acquisition(rng, samples, 4, 0.0f);
+        if (noise)
+            acq.head.flags.SetFlags(mrd::AcquisitionFlags::kIsNoiseMeasurement);
+        return acq;
+    }
+
+    struct TemporaryDirectory {
+        TemporaryDirectory() : path(bf::temp_directory_path() / bf::unique_path()) {}
+        ~TemporaryDirectory() {
+            boost::system::error_code error;
+            bf::remove_all(path, error);
+        }
+        bf::path path;
+    };
+}
+
+TEST(NoiseCovarianceCacheTest, key_ignores_coil_order) {
+    auto key = NoiseCovarianceCache::key("noise", coil_labels({ "a", "b", "c" }));
+    EXPECT_EQ(key, NoiseCovarianceCache::key("noise", coil_labels({ "c", "a", "b" })));
+    EXPECT_NE(key, NoiseCovarianceCache::key("noise", coil_labels({ "a", "b", "d" })));
+    EXPECT_NE(key, NoiseCovarianceCache::key("other", coil_labels({ "a", "b", "c" })));
+    EXPECT_TRUE(NoiseCovarianceCache::key("", coil_labels({ "a" })).empty());
+}
+
+TEST(NoiseCovarianceCacheTest, evicts_least_recently_used) {
+    NoiseCovarianceCache cache;
+    for (size_t i = 0; i < NoiseCovarianceCache::max_entries; i++)
+        cache.store("key" + std::to_string(i), make_covariance(2, float(i + 1)));
+
+    // Touching the oldest entry makes the second oldest the next to go.
+    ASSERT_TRUE(cache.find("key0").has_value());
+    cache.store("extra", make_covariance(2, 100.0f));
+
+    EXPECT_TRUE(cache.find("key0").has_value());
+    EXPECT_FALSE(cache.find("key1").has_value());
+    auto extra = cache.find("extra");
+    ASSERT_TRUE(extra.has_value());
+    EXPECT_EQ(extra->matrix(1, 1), std::complex<float>(200.0f));
+}
+
+TEST(NoiseCovarianceCacheTest, prewhitener_is_computed_once_per_variant) {
+    NoiseCovarianceCache cache;
+    cache.store("key", make_covariance(2, 1.0f));
+
+    size_t computed = 0;
+    auto compute = [&]() {
+        computed++;
+        return hoNDArray<std::complex<float>>(2, 2);
+    };
+
+    cache.prewhitener("key", "first", compute);
+    cache.prewhitener("key", "first", compute);
+    EXPECT_EQ(computed, 1u);
+    cache.prewhitener("key", "second", compute);
+    EXPECT_EQ(computed, 2u);
+
+    // Storing a new covariance drops the prewhiteners derived from the old one.
+    cache.store("key", make_covariance(2, 2.0f));
+    cache.prewhitener("key", "first", compute);
+    EXPECT_EQ(computed, 3u);
+
+    // Without an entry the result is computed every time.
+    cache.prewhitener("missing", "first", compute);
+    cache.prewhitener("missing", "first", compute);
+    EXPECT_EQ(computed, 5u);
+}
+
+TEST(NoiseCovarianceCacheTest, persists_to_directory) {
+    TemporaryDirectory directory;
+    {
+        NoiseCovarianceCache cache;
+        cache.store("key", make_covariance(3, 2.0f), directory.path);
+    }
+    EXPECT_TRUE(bf::exists(directory.path / "key.noise"));
+
+    NoiseCovarianceCache cache;
+    EXPECT_FALSE(cache.find("key").has_value());
+    auto loaded = cache.find("key", directory.path);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->sample_count, 1024u);
+    ASSERT_EQ(loaded->matrix.get_size(0), 3u);
+    EXPECT_EQ(loaded->matrix(2, 2), std::complex<float>(6.0f));
+
+    // Once loaded, the entry is served from memory.
+    bf::remove_all(directory.path);
+    EXPECT_TRUE(cache.find("key").has_value());
+}
+
+TEST(NoiseCovarianceCacheTest, evicts_files_beyond_limit) {
+    TemporaryDirectory directory;
+    NoiseCovarianceCache cache;
+    for (size_t i = 0; i < NoiseCovarianceCache::max_files + 3; i++)
+        cache.store("key" + std::to_string(i), make_covariance(2, 1.0f), directory.path);
+
+    size_t files = 0;
+    for (auto& entry : bf::directory_iterator(directory.path))
+        files += entry.path().extension() == ".noise";
+    EXPECT_EQ(files, NoiseCovarianceCache::max_files);
+}
+
+TEST(NoiseCovarianceCacheTest, imaging_stream_uses_noise_from_earlier_stream) {
+    std::mt19937 rng(11);
+    std::vector<mrd::Acquisition> noise;
+    for (size_t i = 0; i < 16; i++)
+        noise.push_back(line(rng, 128, true));
+    std::vector<mrd::Acquisition> data;
+    for (size_t i = 0; i < 4; i++)
+        data.push_back(line(rng, 64, false));
+
+    // Gathering noise and data in one stream is the reference.
+    auto combined = noise;
+    combined.insert(combined.end(), data.begin(), data.end());
+    auto expected = run_gadget<NoiseAdjustGadget>(combined, {}, context_for("cache_reference", ""));
+
+    EXPECT_TRUE(run_gadget<NoiseAdjustGadget>(noise, {}, context_for("cache_noise", "")).empty());
+    auto actual = run_gadget<NoiseAdjustGadget>(data, {}, context_for("cache_imaging", "cache_noise"));
+
+    ASSERT_EQ(expected.size(), data.size());
+    ASSERT_EQ(actual.size(), data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        EXPECT_FALSE(std::equal(data[i].data.begin(), data[i].data.end(), actual[i].data.begin()));
+        for (size_t k = 0; k < expected[i].data.size(); k++)
+            EXPECT_NEAR(std::abs(expected[i].data[k] - actual[i].data[k]), 0.0f, 1e-5f * std::abs(expected[i].data[k]) + 1e-6f);
+    }
+}
@@ -0,0 +1,70 @@
+#include "../../gadgets/mri_core/PCACoilGadget.h"
+#include "hoNDKLT.h"
+#include "setup_gadget.h"
+#include <random>
+#include <gtest/gtest.h>
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+
+namespace {
+    constexpr size_t channels = 8;
+    constexpr size_t samples_to_use = 16;
+
+    std::vector<mrd::Acquisition> profiles(size_t buffered, size_t after, size_t samples) {
+        std::mt19937 rng(3);
+        std::vector<mrd::Acquisition> acquisitions;
+        for (size_t p = 0; p < buffered + after; p++) {
+            auto acq = random_acquisition(rng, samples, channels, 0.5f);
+            if (p + 1 == buffered)
+                acq.head.flags.SetFlags(mrd::AcquisitionFlags::kLastInSlice);
+            acquisitions.push_back(acq);
+        }
+        return acquisitions;
+    }
+
+    // The transform PCACoilGadget computed before it batched profiles: an SVD of the central samples of the
+    // buffered profiles, mean removed, applied to each profile on its own.
+    std::vector<mrd::Acquisition> reference_pca(std::vector<mrd::Acquisition> acquisitions, size_t buffered) {
+        size_t offset = acquisitions[0].head.center_sample.value_or(0) - samples_to_use / 2;
+
+        hoNDArray<std::complex<float>> A(samples_to_use * buffered, channels);
+        for (size_t c = 0; c < channels; c++) {
+            std::complex<float> mean(0);
+            for (size_t p = 0; p < buffered; p++)
+                for (size_t s = 0; s < samples_to_use; s++)
+                    mean += acquisitions[p].data(offset + s, c);
+            mean /= std::complex<float>(float(A.get_size(0)), 0);
+
+            for (size_t p = 0; p < buffered; p++)
+                for (size_t s = 0; s < samples_to_use; s++)
+                    A(p * samples_to_use + s, c) = acquisitions[p].data(offset + s, c) - mean;
+        }
+
+        hoNDKLT<std::complex<float>> klt;
+        klt.prepare(A, (size_t)1, (size_t)0, false);
+
+        for (auto& acq : acquisitions) {
+            hoNDArray<std::complex<float>> transformed;
+            klt.transform(acq.data, transformed, 1);
+            acq.data = transformed;
+        }
+        return acquisitions;
+    }
+}
+
+TEST(PCACoilTest, batched_transform_matches_per_profile_transform) {
+    const size_t buffered = 24;
+    auto acquisitions = profiles(buffered, 5, 64);
+
+    auto expected = reference_pca(acquisitions, buffered);
+    auto actual = run_gadget<PCACoilGadget>(acquisitions);
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(actual[i].data.dimensions(), expected[i].data.dimensions());
+        for (size_t k = 0; k < expected[i].data.size(); k++)
+            EXPECT_NEAR(std::abs(expected[i].data[k] - actual[i].data[k]), 0.0f, 1e-4f * std::abs(expected[i].data[k]) + 1e-4f)
+                << "profile " << i << ", element " << k;
+    }
+}
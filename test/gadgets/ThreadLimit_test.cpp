@@ -0,0 +1,115 @@
+#include "../../gadgets/mri_core/NoiseAdjustGadget.h"
+#include "../../gadgets/mri_core/RemoveROOversamplingGadget.h"
+#include "setup_gadget.h"
+#include <gtest/gtest.h>
+#include <mutex>
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+#ifdef USE_OMP
+
+using namespace Gadgetron;
+using namespace Gadgetron::Test;
+using namespace std::string_literals;
+
+namespace {
+    constexpr int team_size = 4;
+
+    struct TeamSizes {
+        std::mutex mutex;
+        std::vector<int> sizes;
+    };
+
+    // Records the OpenMP team size of the thread pushing each message; a node pushes from inside process().
+    class TeamSizeChannel : public Core::MessageChannel {
+    public:
+        explicit TeamSizeChannel(std::shared_ptr<TeamSizes> team_sizes) : team_sizes(std::move(team_sizes)) {}
+
+    protected:
+        void push_message(Core::Message message) override {
+            {
+                std::lock_guard<std::mutex> guard(team_sizes->mutex);
+                team_sizes->sizes.push_back(omp_get_max_threads());
+            }
+            Core::MessageChannel::push_message(std::move(message));
+        }
+
+    private:
+        std::shared_ptr<TeamSizes> team_sizes;
+    };
+
+    // Constructs the gadget on the calling thread, as the stream loader does, and runs process() on a thread of its
+    // own, as the stream does. Returns the team sizes seen inside process().
+    template <class GADGET>
+    std::vector<int> team_sizes_in_process(const Core::Context& context, const Core::GadgetProperties& properties,
+        const std::vector<mrd::Acquisition>& acquisitions) {
+
+        int loader_team_size = omp_get_max_threads();
+        omp_set_num_threads(team_size);
+        auto gadget = std::make_unique<GADGET>(context, properties);
+        EXPECT_EQ(omp_get_max_threads(), team_size) << "The constructor changed the team size of the loading thread";
+        omp_set_num_threads(loader_team_size);
+
+        auto team_sizes = std::make_shared<TeamSizes>();
+        auto input = Core::make_channel();
+        auto output = Core::make_channel<TeamSizeChannel>(team_sizes);
+
+        {
+            auto push = std::move(input.output);
+            for (auto& acq : acquisitions)
+                push.push(acq);
+        }
+
+        int after_process = 0;
+        std::thread node_thread([&]() {
+            omp_set_num_threads(team_size);
+            Core::Node& node = *gadget;
+            node.process(input.input, output.output);
+            after_process = omp_get_max_threads();
+        });
+        node_thread.join();
+
+        EXPECT_EQ(after_process, team_size) << "process() did not restore the team size of its thread";
+
+        std::lock_guard<std::mutex> guard(team_sizes->mutex);
+        return team_sizes->sizes;
+    }
+}
+
+TEST(ThreadLimitTest, remove_ro_oversampling_is_single_threaded_in_process) {
+    std::vector<mrd::Acquisition> acquisitions;
+    for (size_t i = 0; i < 4; i++)
+        acquisitions.push_back(generate_acquisition(192, 4));
+
+    auto sizes = team_sizes_in_process<RemoveROOversamplingGadget>(generate_context(), {}, acquisitions);
+
+    ASSERT_EQ(sizes.size(), acquisitions.size());
+    for (auto size : sizes)
+        EXPECT_EQ(size, 1);
+}
+
+TEST(ThreadLimitTest, noise_adjust_is_single_threaded_in_process) {
+    auto context = generate_context();
+    context.header.measurement_information = mrd::MeasurementInformationType{};
+    context.header.measurement_information->measurement_id = "thread_limit";
+
+    std::vector<mrd::Acquisition> acquisitions;
+    for (size_t i = 0; i < 4; i++) {
+        auto noise = generate_acquisition(128, 4);
+        for (size_t n = 0; n < noise.data.size(); n++)
+            noise.data[n] = std::complex<float>(float(n % 5), float(n % 3) - 1.0f) * float(n % 4 + 1);
+        noise.head.flags.SetFlags(mrd::AcquisitionFlags::kIsNoiseMeasurement);
+        acquisitions.push_back(noise);
+    }
+    for (size_t i = 0; i < 3; i++)
+        acquisitions.push_back(generate_acquisition(192, 4));
+
+    auto sizes = team_sizes_in_process<NoiseAdjustGadget>(context, {}, acquisitions);
+
+    ASSERT_EQ(sizes.size(), 3u);
+    for (auto size : sizes)
+        EXPECT_EQ(size, 1);
+}
+
+#endif
@@ -8,8 +8,14 @@
 #include "Node.h"
 #include "PropertyMixin.h"
 #include <mrd/types.h>
+#include <gtest/gtest.h>
 #include <array>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
 #include <thread>
+#include <vector>
 
 namespace Gadgetron { namespace Test {
 
@@ -80,4 +86,56 @@ namespace Gadgetron { namespace Test {
         return acq;
     }
 
+    /**
+     * Acquisition of normally distributed samples, channel c scaled by c + 1. Each sample also adds
+     * correlation * c times a component common to all channels, so the channels are correlated unless
+     * correlation is zero.
+     */
+    inline mrd::Acquisition random_acquisition(std::mt19937& rng, size_t number_of_samples, size_t channels, float correlation) {
+        std::normal_distribution<float> normal;
+        auto acq = generate_acquisition(number_of_samples, channels);
+        for (size_t s = 0; s < number_of_samples; s++) {
+            std::complex<float> common(normal(rng), normal(rng));
+            for (size_t c = 0; c < channels; c++)
+                acq.data(s, c) = std::complex<float>(normal(rng), normal(rng)) * float(c + 1) + correlation * float(c) * common;
+        }
+        return acq;
+    }
+
+    /**
+     * Pushes the acquisitions through a GADGET, closes its input and collects the acquisitions it outputs.
+     * Fails the test if the gadget has not closed its output within the timeout.
+     */
+    template <class GADGET>
+    inline std::vector<mrd::Acquisition> run_gadget(const std::vector<mrd::Acquisition>& acquisitions,
+        Core::GadgetProperties properties = {}, Core::Context context = generate_context(),
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+
+        auto channels = setup_gadget<GADGET>(properties, context);
+        {
+            auto input = std::move(channels.input);
+            for (auto& acq : acquisitions)
+                input.push(acq);
+        }
+
+        // Popped on a detached thread that shares the channel, so a gadget that never closes it cannot hang the test.
+        auto output = std::make_shared<Core::GenericInputChannel>(std::move(channels.output));
+        std::vector<mrd::Acquisition> result;
+        while (true) {
+            std::packaged_task<Core::Message()> pop([output]() { return output->pop(); });
+            auto message_future = pop.get_future();
+            std::thread(std::move(pop)).detach();
+            if (message_future.wait_for(timeout) != std::future_status::ready) {
+                ADD_FAILURE() << "Gadget did not close its output";
+                break;
+            }
+            try {
+                result.push_back(Core::force_unpack<mrd::Acquisition>(message_future.get()));
+            } catch (const Core::ChannelClosed&) {
+                break;
+            }
+        }
+        return result;
+    }
+
 }}
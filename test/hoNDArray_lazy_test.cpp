@@ -0,0 +1,74 @@
+#include "complext.h"
+#include "hoNDArray_lazy.h"
+
+#include <complex>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class hoNDArray_lazy_TestCplx : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        size_t vdims[] = { 37, 49, 23, 19 }; // Using prime numbers for setup because they are messy
+        dims           = std::vector<size_t>(vdims, vdims + sizeof(vdims) / sizeof(size_t));
+        A              = hoNDArray<T>(dims);
+        B              = hoNDArray<T>(dims);
+        C              = hoNDArray<T>(dims);
+
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<typename realType<T>::Type> dist(-1, 1);
+        for (size_t i = 0; i < A.size(); i++) {
+            A[i] = T(dist(gen), dist(gen));
+            B[i] = T(dist(gen), dist(gen));
+            C[i] = T(dist(gen), dist(gen));
+        }
+    }
+    std::vector<size_t> dims;
+    hoNDArray<T> A, B, C;
+};
+
+typedef Types<std::complex<float>, std::complex<double>, float_complext, double_complext> cplxImplementations;
+TYPED_TEST_SUITE(hoNDArray_lazy_TestCplx, cplxImplementations);
+
+TYPED_TEST(hoNDArray_lazy_TestCplx, fusedExpression) {
+    using std::conj;
+    hoNDArray<TypeParam> r;
+    lazy(r) = lazy(this->A) * conj(lazy(this->B)) + this->C;
+
+    EXPECT_EQ(this->dims, r.dimensions());
+    for (size_t i = 0; i < r.size(); i += 997) {
+        TypeParam expected = this->A[i] * conj(this->B[i]) + this->C[i];
+        EXPECT_NEAR(0, abs(r[i] - expected), 1e-5);
+    }
+}
+
+TYPED_TEST(hoNDArray_lazy_TestCplx, realValuedFunctions) {
+    using std::abs;
+    hoNDArray<typename realType<TypeParam>::Type> m;
+    lazy(m) = abs(lazy(this->A)) * 2 + norm(lazy(this->B));
+
+    for (size_t i = 0; i < m.size(); i += 997) {
+        auto expected = abs(this->A[i]) * 2 + norm(this->B[i]);
+        EXPECT_NEAR(expected, m[i], 1e-5);
+    }
+}
+
+TYPED_TEST(hoNDArray_lazy_TestCplx, targetInExpression) {
+    hoNDArray<TypeParam> r(this->A);
+    lazy(r) = abs(lazy(r)) * this->B;
+    lazy(r) += this->C;
+
+    for (size_t i = 0; i < r.size(); i += 997) {
+        TypeParam expected = abs(this->A[i]) * this->B[i] + this->C[i];
+        EXPECT_NEAR(0, abs(r[i] - expected), 1e-5);
+    }
+}
+
+TYPED_TEST(hoNDArray_lazy_TestCplx, mismatchedSizesThrow) {
+    hoNDArray<TypeParam> small(37, 49);
+    hoNDArray<TypeParam> r;
+    EXPECT_THROW(lazy(r) = lazy(this->A) + small, std::runtime_error);
+    EXPECT_THROW(lazy(small) += this->A, std::runtime_error);
+}
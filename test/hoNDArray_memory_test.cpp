@@ -0,0 +1,94 @@
+#include "hoNDArray.h"
+#include "hoMemoryPool.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Gadgetron;
+
+TEST(hoNDArrayMemoryTest, aligned) {
+    for (size_t size : { 1, 3, 17, 1000, 123457 }) {
+        hoNDArray<std::complex<float>> array(size);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(array.get_data_ptr()) % MemoryPool::alignment, 0u);
+
+        hoNDArray<char> bytes(size);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(bytes.get_data_ptr()) % MemoryPool::alignment, 0u);
+    }
+}
+
+TEST(hoNDArrayMemoryTest, complexIsZeroed) {
+    std::vector<size_t> dims{ 64, 32 };
+    {
+        hoNDArray<std::complex<float>> array(dims);
+        array.fill(std::complex<float>(1, 2));
+    }
+
+    hoNDArray<std::complex<float>> array(dims);
+    for (auto& value : array)
+        EXPECT_EQ(value, std::complex<float>(0));
+}
+
+TEST(hoNDArrayMemoryTest, reuse) {
+    std::vector<size_t> dims{ 128, 128, 4 };
+    std::complex<float>* first;
+    {
+        MemoryPool::UninitializedScope scope;
+        hoNDArray<std::complex<float>> array(dims);
+        first = array.get_data_ptr();
+        array.fill(std::complex<float>(3, 4));
+    }
+
+    auto before = MemoryPool::statistics();
+    MemoryPool::UninitializedScope scope;
+    hoNDArray<std::complex<float>> array(dims);
+    auto after = MemoryPool::statistics();
+
+    EXPECT_EQ(array.get_data_ptr(), first);
+    EXPECT_EQ(array(0), std::complex<float>(3, 4));
+    EXPECT_EQ(after.reused, before.reused + 1);
+    EXPECT_EQ(after.system_allocations, before.system_allocations);
+    EXPECT_GE(after.bytes_in_use, array.get_number_of_bytes());
+}
+
+TEST(hoNDArrayMemoryTest, nonTrivialElements) {
+    MemoryPool::UninitializedScope scope;
+    hoNDArray<std::string> array(10);
+    for (auto& value : array)
+        EXPECT_TRUE(value.empty());
+    array(3) = std::string(100, 'x');
+
+    hoNDArray<std::string> copy(array);
+    EXPECT_EQ(copy(3), array(3));
+}
+
+TEST(hoNDArrayMemoryTest, crossThread) {
+    auto array = std::make_unique<hoNDArray<float>>(4096);
+    array->fill(1.0f);
+    std::thread([&]() { array.reset(); }).join();
+
+    hoNDArray<float> other(4096);
+    EXPECT_EQ(other.get_number_of_elements(), 4096u);
+}
+
+TEST(hoNDArrayMemoryTest, cacheLimit) {
+    auto limit = MemoryPool::get_cache_limit();
+    MemoryPool::set_cache_limit(0);
+    auto cached = MemoryPool::statistics().bytes_cached;
+
+    {
+        hoNDArray<double> array(1 << 16);
+    }
+    EXPECT_EQ(MemoryPool::statistics().bytes_cached, cached);
+
+    MemoryPool::set_cache_limit(limit);
+    {
+        hoNDArray<double> array(1 << 16);
+    }
+    EXPECT_GE(MemoryPool::statistics().bytes_cached, cached + (1u << 16) * sizeof(double));
+
+    MemoryPool::trim();
+}
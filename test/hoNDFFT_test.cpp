@@ -168,3 +168,44 @@ TEST(FFTshiftTest, shift3d_random){
 }
 
 
+
+TEST(FFTPlanningTest, measure_roundtrip){
+    auto array = make_random_array(32,24,4,1);
+    const auto array_copy = array;
+
+    FFT::set_planning_mode(FFT::PlanningMode::Measure);
+    for (int i = 0; i < 2; i++) {
+        hoNDFFT<float>::instance()->fft2(array);
+        hoNDFFT<float>::instance()->ifft2(array);
+    }
+    FFT::set_planning_mode(FFT::PlanningMode::Estimate);
+
+    for (size_t i = 0; i < array.size(); i++) {
+        EXPECT_NEAR(std::abs(array[i] - array_copy[i]), 0.0f, 1e-4f);
+    }
+}
+
+TEST(FFTCenteredTest, fused_matches_shifted){
+    auto array = make_random_array(16,10,6,3);
+
+    auto reference2 = array;
+    hoNDFFT<float>::instance()->ifftshift2D(reference2);
+    hoNDFFT<float>::instance()->fft2(reference2);
+    hoNDFFT<float>::instance()->fftshift2D(reference2);
+
+    auto result2 = array;
+    hoNDFFT<float>::instance()->fft2c(result2);
+
+    auto reference3 = array;
+    hoNDFFT<float>::instance()->ifftshift3D(reference3);
+    hoNDFFT<float>::instance()->ifft3(reference3);
+    hoNDFFT<float>::instance()->fftshift3D(reference3);
+
+    hoNDArray<std::complex<float>> result3;
+    hoNDFFT<float>::instance()->ifft3c(array, result3);
+
+    for (size_t i = 0; i < array.size(); i++) {
+        EXPECT_NEAR(std::abs(result2[i] - reference2[i]), 0.0f, 1e-4f);
+        EXPECT_NEAR(std::abs(result3[i] - reference3[i]), 0.0f, 1e-4f);
+    }
+}
@@ -0,0 +1,135 @@
+/** \file       hoNDKLT_test.cpp
+    \brief      Test case for the KL transform
+*/
+
+#include "hoNDKLT.h"
+#include "hoNDArray_elemwise.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename T> class hoNDKLT_test : public ::testing::Test
+{
+protected:
+    typedef typename realType<T>::Type value_type;
+
+    virtual void SetUp()
+    {
+        // correlated channels with well separated variances, so the eigen vectors are unique up to their phase
+        std::mt19937 rng(5);
+        std::normal_distribution<double> normal;
+
+        const size_t M = 512;
+        const size_t N = 8;
+
+        data_.create(M, N);
+        for (size_t m = 0; m < M; m++)
+        {
+            std::complex<double> common(normal(rng), normal(rng));
+            for (size_t n = 0; n < N; n++)
+            {
+                std::complex<double> v = std::complex<double>(normal(rng), normal(rng)) * double(n + 1) + double(n) * 0.3 * common;
+                data_(m, n) = T(v);
+            }
+        }
+
+        // C = A'*A, summed in double; only the lower triangle is used
+        covariance_.create(N, N);
+        Gadgetron::clear(covariance_);
+        for (size_t j = 0; j < N; j++)
+        {
+            for (size_t i = j; i < N; i++)
+            {
+                std::complex<double> c(0);
+                for (size_t m = 0; m < M; m++) c += std::conj(std::complex<double>(data_(m, i))) * std::complex<double>(data_(m, j));
+                covariance_(i, j) = T(c);
+            }
+        }
+    }
+
+    // the columns of two matrices are the same up to a phase each
+    void expect_same_columns(const hoNDArray<T>& a, const hoNDArray<T>& b, double tolerance)
+    {
+        ASSERT_EQ(a.get_size(0), b.get_size(0));
+        ASSERT_EQ(a.get_size(1), b.get_size(1));
+        for (size_t n = 0; n < a.get_size(1); n++)
+        {
+            std::complex<double> inner(0);
+            double norm_a = 0, norm_b = 0;
+            for (size_t m = 0; m < a.get_size(0); m++)
+            {
+                inner += std::conj(std::complex<double>(a(m, n))) * std::complex<double>(b(m, n));
+                norm_a += std::norm(std::complex<double>(a(m, n)));
+                norm_b += std::norm(std::complex<double>(b(m, n)));
+            }
+            EXPECT_NEAR(std::abs(inner), std::sqrt(norm_a * norm_b), tolerance) << "column " << n;
+        }
+    }
+
+    double tolerance() const { return std::is_same<value_type, float>::value ? 1e-4 : 1e-10; }
+
+    hoNDArray<T> data_;
+    hoNDArray<T> covariance_;
+};
+
+typedef Types< std::complex<float>, std::complex<double> > cpfloatImplementations;
+TYPED_TEST_SUITE(hoNDKLT_test, cpfloatImplementations);
+
+TYPED_TEST(hoNDKLT_test, prepare_from_covariance_matches_prepare)
+{
+    hoNDKLT<TypeParam> from_data, from_covariance;
+    from_data.prepare(this->data_, (size_t)1, (size_t)0, false);
+    from_covariance.prepare_from_covariance(this->covariance_, (size_t)0);
+
+    hoNDArray<TypeParam> E_data, E_covariance;
+    from_data.eigen_value(E_data);
+    from_covariance.eigen_value(E_covariance);
+    ASSERT_EQ(E_data.get_number_of_elements(), E_covariance.get_number_of_elements());
+    for (size_t n = 0; n < E_data.get_number_of_elements(); n++)
+    {
+        EXPECT_NEAR(std::abs(E_covariance(n) - E_data(n)), 0.0, this->tolerance() * std::abs(E_data(0))) << "eigen value " << n;
+    }
+
+    hoNDArray<TypeParam> V_data, V_covariance;
+    from_data.eigen_vector(V_data);
+    from_covariance.eigen_vector(V_covariance);
+    this->expect_same_columns(V_data, V_covariance, this->tolerance());
+
+    hoNDArray<TypeParam> M_data, M_covariance;
+    from_data.KL_transformation(M_data);
+    from_covariance.KL_transformation(M_covariance);
+    this->expect_same_columns(M_data, M_covariance, this->tolerance());
+}
+
+TYPED_TEST(hoNDKLT_test, prepare_from_covariance_keeps_untransformed_channels)
+{
+    std::vector<size_t> untransformed = { 2, 5 };
+
+    // the untransformed channels carry no data into the transform, as in PCACoilGadget
+    hoNDArray<TypeParam> data(this->data_);
+    for (size_t m = 0; m < data.get_size(0); m++)
+    {
+        for (auto n : untransformed) data(m, n) = TypeParam(0);
+    }
+
+    hoNDKLT<TypeParam> from_data, from_covariance;
+    std::vector<size_t> untransformed_data(untransformed), untransformed_covariance(untransformed);
+    from_data.prepare(data, (size_t)1, untransformed_data, (size_t)0, false);
+    from_covariance.prepare_from_covariance(this->covariance_, untransformed_covariance, (size_t)0);
+
+    hoNDArray<TypeParam> M_data, M_covariance;
+    from_data.KL_transformation(M_data);
+    from_covariance.KL_transformation(M_covariance);
+    this->expect_same_columns(M_data, M_covariance, this->tolerance());
+
+    // the untransformed channels come first, and pass through unchanged
+    for (size_t u = 0; u < untransformed.size(); u++)
+    {
+        for (size_t m = 0; m < M_covariance.get_size(0); m++)
+        {
+            EXPECT_EQ(M_covariance(m, u), TypeParam(m == untransformed[u] ? 1 : 0));
+        }
+    }
+}
@@ -3,6 +3,8 @@
 #include "hoNDArray_reductions.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNFFT.h"
+#include "hoNFFTCache.h"
+#include "hoGriddingConvolution.h"
 #include "vector_td_utilities.h"
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
@@ -151,3 +153,120 @@ TYPED_TEST(hoNFFT_2D_NC2C_BACKWARDS, randomTestOne)
 
     EXPECT_LE(v/norm_ref, 0.00001);
 }
+
+TEST(hoNFFT_cache, reuses_convolution_matrices)
+{
+    using T = float;
+
+    NFFTCache::clear();
+    NFFTCache::set_memory_budget(size_t(1) << 30);
+
+    vector_td<size_t, 2> dims(64, 64);
+    vector_td<size_t, 2> dims_os(128, 128);
+    KaiserKernel<T, 2> kernel(vector_td<unsigned int, 2>(dims), vector_td<unsigned int, 2>(dims_os), T(3));
+
+    hoNDArray<vector_td<T, 2>> traj(256, 2);
+    for (size_t n = 0; n < traj.get_number_of_elements(); n++)
+    {
+        T angle = T(n % 16) * T(0.19);
+        T radius = T(n / 16) / T(traj.get_number_of_elements() / 16) - T(0.5);
+        traj[n] = vector_td<T, 2>(radius * std::cos(angle), radius * std::sin(angle));
+    }
+
+    hoNDArray<complext<T>> image(dims_os[0], dims_os[1], 2);
+    for (size_t n = 0; n < image.get_number_of_elements(); n++)
+        image[n] = complext<T>(T(n % 7), T(n % 5));
+
+    hoNDArray<complext<T>> first(traj.dimensions());
+    hoNDArray<complext<T>> second(traj.dimensions());
+
+    hoGriddingConvolution<complext<T>, 2, KaiserKernel> conv(dims, dims_os, kernel);
+    conv.preprocess(traj);
+    conv.compute(image, first, GriddingConvolutionMode::C2NC);
+
+    auto cold = NFFTCache::get_statistics();
+    EXPECT_EQ(cold.entries, 1u);
+
+    hoGriddingConvolution<complext<T>, 2, KaiserKernel> warm(dims, dims_os, kernel);
+    warm.preprocess(traj);
+    warm.compute(image, second, GriddingConvolutionMode::C2NC);
+
+    auto stats = NFFTCache::get_statistics();
+    EXPECT_EQ(stats.hits, cold.hits + 1);
+    EXPECT_EQ(stats.entries, 1u);
+    for (size_t n = 0; n < first.get_number_of_elements(); n++)
+        EXPECT_EQ(abs(first[n] - second[n]), T(0));
+
+    // A different trajectory is a new entry, and a budget that only holds one evicts the older.
+    traj[0] = vector_td<T, 2>(T(0.1), T(0.2));
+    NFFTCache::set_memory_budget(stats.bytes + stats.bytes / 2);
+    warm.preprocess(traj);
+
+    stats = NFFTCache::get_statistics();
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.evictions, cold.evictions + 1);
+
+    NFFTCache::set_memory_budget(0);
+    EXPECT_EQ(NFFTCache::get_statistics().entries, 0u);
+
+    NFFTCache::set_memory_budget(size_t(1) << 30);
+}
+
+namespace
+{
+    // Grids a single batch, and the same data as the first of two batches, which takes the per-batch serial path.
+    template<class T>
+    void expect_single_batch_matches_batched(size_t size_os)
+    {
+        vector_td<size_t, 2> dims(size_os / 2, size_os / 2);
+        vector_td<size_t, 2> dims_os(size_os, size_os);
+        KaiserKernel<T, 2> kernel(vector_td<unsigned int, 2>(dims), vector_td<unsigned int, 2>(dims_os), T(5.5));
+
+        hoNDArray<vector_td<T, 2>> traj(4096);
+        for (size_t n = 0; n < traj.get_number_of_elements(); n++)
+        {
+            T angle = T(n % 64) * T(0.0491);
+            T radius = T(n / 64) / T(64) - T(0.5);
+            traj[n] = vector_td<T, 2>(radius * std::cos(angle), radius * std::sin(angle));
+        }
+
+        hoGriddingConvolution<complext<T>, 2, KaiserKernel> conv(dims, dims_os, kernel);
+        conv.preprocess(traj);
+
+        hoNDArray<complext<T>> image(dims_os[0], dims_os[1]);
+        hoNDArray<complext<T>> images(dims_os[0], dims_os[1], 2);
+        for (size_t n = 0; n < images.get_number_of_elements(); n++)
+            images[n] = complext<T>(T(n % 7), T(n % 5) - T(2));
+        std::copy(images.begin(), images.begin() + image.get_number_of_elements(), image.begin());
+
+        hoNDArray<complext<T>> samples(traj.get_number_of_elements());
+        hoNDArray<complext<T>> batched_samples(traj.get_number_of_elements(), 2);
+        conv.compute(image, samples, GriddingConvolutionMode::C2NC);
+        conv.compute(images, batched_samples, GriddingConvolutionMode::C2NC);
+
+        // Each sample is summed the same way on either path.
+        for (size_t n = 0; n < samples.get_number_of_elements(); n++)
+            EXPECT_EQ(abs(samples[n] - batched_samples[n]), T(0));
+
+        hoNDArray<complext<T>> grid(dims_os[0], dims_os[1]);
+        hoNDArray<complext<T>> batched_grid(dims_os[0], dims_os[1], 2);
+        conv.compute(samples, grid, GriddingConvolutionMode::NC2C);
+        conv.compute(batched_samples, batched_grid, GriddingConvolutionMode::NC2C);
+
+        // Slabs are spread in a different order, so grid points may round differently.
+        T largest = T(0);
+        for (auto& value : batched_grid)
+            largest = std::max(largest, abs(value));
+        for (size_t n = 0; n < grid.get_number_of_elements(); n++)
+            EXPECT_LE(abs(grid[n] - batched_grid[n]), std::numeric_limits<T>::epsilon() * T(16) * largest);
+    }
+}
+
+TEST(hoGriddingConvolution, single_batch_matches_batched)
+{
+    // Full slabs only, and a partial last slab that is spread serially.
+    expect_single_batch_matches_batched<float>(128);
+    expect_single_batch_matches_batched<float>(100);
+    expect_single_batch_matches_batched<double>(128);
+    expect_single_batch_matches_batched<double>(100);
+}
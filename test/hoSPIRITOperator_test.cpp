@@ -0,0 +1,158 @@
+/** \file       hoSPIRITOperator_test.cpp
+    \brief      Test case for the normal operator of the SPIRiT operators
+*/
+
+#include "hoSPIRIT2DOperator.h"
+#include "hoSPIRIT2DTOperator.h"
+#include "hoSPIRIT3DOperator.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename T> class hoSPIRITOperator_test : public ::testing::Test
+{
+protected:
+    typedef typename realType<T>::Type value_type;
+
+    virtual void SetUp()
+    {
+        RO_ = 16;
+        E1_ = 12;
+        CHA_ = 4;
+        N_ = 3;
+
+        kernel_ = random_array({ RO_, E1_, CHA_, CHA_, N_ });
+        x_ = random_array({ RO_, E1_, CHA_, N_ });
+        y_ = random_array({ RO_, E1_, CHA_, N_ });
+
+        // every third line acquired, differently in each frame
+        kspace_ = random_array({ RO_, E1_, CHA_, N_ });
+        for (size_t n = 0; n < N_; n++)
+            for (size_t c = 0; c < CHA_; c++)
+                for (size_t e1 = 0; e1 < E1_; e1++)
+                    if ((e1 + n) % 3 != 0)
+                        for (size_t ro = 0; ro < RO_; ro++)
+                            kspace_(ro, e1, c, n) = T(0);
+    }
+
+    hoNDArray<T> random_array(const std::vector<size_t>& dims)
+    {
+        std::normal_distribution<value_type> normal;
+        hoNDArray<T> a(dims);
+        for (auto& v : a) v = T(normal(rng_), normal(rng_));
+        return a;
+    }
+
+    // mult_MH_M against mult_M followed by mult_MH, both on its own and accumulated onto y_
+    void expect_normal_operator(hoSPIRITOperator<T>& op, hoNDArray<T>& x, hoNDArray<T>& y)
+    {
+        hoNDArray<T> Mx(x.dimensions()), expected(x.dimensions()), actual(x.dimensions());
+        op.mult_M(&x, &Mx);
+        op.mult_MH(&Mx, &expected);
+        op.mult_MH_M(&x, &actual);
+
+        value_type scale = 0;
+        for (auto& v : expected) scale = std::max(scale, std::abs(v));
+        const value_type tolerance = scale * std::numeric_limits<value_type>::epsilon() * 100;
+
+        for (size_t n = 0; n < expected.get_number_of_elements(); n++)
+            EXPECT_NEAR(std::abs(actual[n] - expected[n]), 0, tolerance) << n;
+
+        hoNDArray<T> accumulated(y);
+        op.mult_MH_M(&x, &accumulated, true);
+
+        for (size_t n = 0; n < expected.get_number_of_elements(); n++)
+            EXPECT_NEAR(std::abs(accumulated[n] - (y[n] + expected[n])), 0, tolerance) << n;
+    }
+
+    std::mt19937 rng_{ 7 };
+    size_t RO_, E1_, CHA_, N_;
+    hoNDArray<T> kernel_, kspace_, x_, y_;
+};
+
+typedef Types<std::complex<float>, std::complex<double>> cplxImplementations;
+
+TYPED_TEST_SUITE(hoSPIRITOperator_test, cplxImplementations);
+
+TYPED_TEST(hoSPIRITOperator_test, mult_MH_M_2D)
+{
+    const size_t RO = this->RO_, E1 = this->E1_, CHA = this->CHA_;
+
+    hoSPIRIT2DOperator<TypeParam> op(std::vector<size_t>{ RO, E1, CHA });
+    hoNDArray<TypeParam> kernel(RO, E1, CHA, CHA, this->kernel_.begin());
+    hoNDArray<TypeParam> kspace(RO, E1, CHA, this->kspace_.begin());
+    hoNDArray<TypeParam> x(RO, E1, CHA, this->x_.begin());
+    hoNDArray<TypeParam> y(RO, E1, CHA, this->y_.begin());
+
+    op.set_forward_kernel(kernel, false);
+    op.set_acquired_points(kspace);
+
+    for (bool no_null_space : { true, false })
+    {
+        SCOPED_TRACE(no_null_space ? "without null space projection" : "with null space projection");
+        op.no_null_space_ = no_null_space;
+        this->expect_normal_operator(op, x, y);
+    }
+
+    // a new forward kernel must replace the combined kernel of the previous one
+    hoNDArray<TypeParam> kernel2(RO, E1, CHA, CHA, this->kernel_.begin() + RO * E1 * CHA * CHA);
+    op.set_forward_kernel(kernel2, false);
+    this->expect_normal_operator(op, x, y);
+}
+
+TYPED_TEST(hoSPIRITOperator_test, mult_MH_M_2DT)
+{
+    const size_t RO = this->RO_, E1 = this->E1_, CHA = this->CHA_, N = this->N_;
+
+    hoSPIRIT2DTOperator<TypeParam> op(std::vector<size_t>{ RO, E1, CHA, N });
+    op.set_forward_kernel(this->kernel_, false);
+    op.set_acquired_points(this->kspace_);
+
+    for (bool no_null_space : { true, false })
+    {
+        SCOPED_TRACE(no_null_space ? "without null space projection" : "with null space projection");
+        op.no_null_space_ = no_null_space;
+        this->expect_normal_operator(op, this->x_, this->y_);
+    }
+
+    // one kernel shared by all frames, with the combined kernel computed up front
+    hoNDArray<TypeParam> kernel(RO, E1, CHA, CHA, 1, this->kernel_.begin());
+    op.set_forward_kernel(kernel, true);
+    this->expect_normal_operator(op, this->x_, this->y_);
+}
+
+TYPED_TEST(hoSPIRITOperator_test, mult_MH_M_3D)
+{
+    // the frames of the 2D+T arrays serve as the E2 dimension
+    const size_t RO = this->RO_, E1 = this->E1_, E2 = this->N_, CHA = this->CHA_;
+
+    hoSPIRIT3DOperator<TypeParam> op(std::vector<size_t>{ RO, E1, E2, CHA });
+    hoNDArray<TypeParam> kernel(RO, E1, E2, CHA, CHA, this->kernel_.begin());
+    hoNDArray<TypeParam> x(RO, E1, E2, CHA, this->x_.begin());
+    hoNDArray<TypeParam> y(RO, E1, E2, CHA, this->y_.begin());
+
+    // every third point acquired in the E1-E2 plane
+    hoNDArray<TypeParam> kspace = this->random_array({ RO, E1, E2, CHA });
+    for (size_t c = 0; c < CHA; c++)
+        for (size_t e2 = 0; e2 < E2; e2++)
+            for (size_t e1 = 0; e1 < E1; e1++)
+                if ((e1 + e2) % 3 != 0)
+                    for (size_t ro = 0; ro < RO; ro++)
+                        kspace(ro, e1, e2, c) = TypeParam(0);
+
+    op.set_forward_kernel(kernel, false);
+    op.set_acquired_points(kspace);
+
+    for (bool no_null_space : { true, false })
+    {
+        SCOPED_TRACE(no_null_space ? "without null space projection" : "with null space projection");
+        op.no_null_space_ = no_null_space;
+        this->expect_normal_operator(op, x, y);
+    }
+
+    // the combined kernel computed up front must match the one computed on first use
+    op.set_forward_kernel(kernel, true);
+    this->expect_normal_operator(op, x, y);
+}
@@ -0,0 +1,218 @@
+/** \file       hoSolverWorkspace_test.cpp
+    \brief      Test case for the reuse of solver iteration buffers across solves
+*/
+
+#include "hoCgSolver.h"
+#include "hoLsqrSolver.h"
+#include "hoPartialDerivativeOperator.h"
+#include "hoSolverUtils.h"
+#include "nlcgSolver.h"
+#include "lbfgsSolver.h"
+#include <gtest/gtest.h>
+#include <boost/make_shared.hpp>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace {
+    // Elementwise scaling by real factors, so the operator is its own adjoint
+    template<class T> class scaleOperator : public linearOperator< hoNDArray<T> >
+    {
+    public:
+        typedef typename realType<T>::Type REAL;
+
+        explicit scaleOperator(const hoNDArray<REAL>& scale) : scale_(scale) {}
+
+        virtual void mult_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false)
+        {
+            for (size_t n = 0; n < in->get_number_of_elements(); n++)
+                (*out)[n] = (accumulate ? (*out)[n] : T(0)) + scale_[n] * (*in)[n];
+        }
+
+        virtual void mult_MH(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false)
+        {
+            for (size_t n = 0; n < in->get_number_of_elements(); n++)
+                (*out)[n] = (accumulate ? (*out)[n] : T(0)) + scale_[n] * (*in)[n];
+        }
+
+    protected:
+        hoNDArray<REAL> scale_;
+    };
+}
+
+template<typename T> class hoSolverWorkspace_test : public ::testing::Test
+{
+protected:
+    typedef typename realType<T>::Type value_type;
+
+    virtual void SetUp()
+    {
+        dims_ = { 24, 20 };
+        std::mt19937 rng(9);
+        std::uniform_real_distribution<value_type> uniform(value_type(0.5), value_type(2));
+
+        // well conditioned, but far enough from the identity that the solvers take all their iterations
+        hoNDArray<value_type> scale(dims_);
+        for (auto& v : scale) v = uniform(rng);
+
+        E_ = boost::make_shared<scaleOperator<T>>(scale);
+        E_->set_domain_dimensions(dims_);
+        E_->set_codomain_dimensions(dims_);
+
+        R_ = boost::make_shared<hoPartialDerivativeOperator<T, 2>>(0);
+        R_->set_domain_dimensions(dims_);
+        R_->set_codomain_dimensions(dims_);
+        R_->set_weight(value_type(0.1));
+
+        data_.create(dims_);
+        for (auto& v : data_) v = T(uniform(rng));
+    }
+
+    void setup_cg(hoCgSolver<T>& solver)
+    {
+        solver.set_encoding_operator(E_);
+        solver.add_regularization_operator(R_);
+        solver.set_max_iterations(15);
+        solver.set_tc_tolerance(value_type(1e-12));
+        solver.set_output_mode(hoCgSolver<T>::OUTPUT_SILENT);
+    }
+
+    // A linear and an l1 regularization, so both the exact and the searched step sizes are taken
+    template<class SOLVER> void setup_gp(SOLVER& solver)
+    {
+        solver.set_encoding_operator(E_);
+        solver.add_regularization_operator(R_);
+        solver.add_regularization_operator(R_, 1);
+        solver.set_max_iterations(12);
+        solver.set_tc_tolerance(value_type(1e-12));
+        solver.set_output_mode(SOLVER::OUTPUT_SILENT);
+    }
+
+    void expect_identical(const hoNDArray<T>& expected, const hoNDArray<T>& actual)
+    {
+        ASSERT_TRUE(actual.dimensions_equal(expected.dimensions()));
+        for (size_t n = 0; n < expected.get_number_of_elements(); n++)
+            EXPECT_EQ(expected[n], actual[n]) << n;
+    }
+
+    std::vector<size_t> dims_;
+    boost::shared_ptr<scaleOperator<T>> E_;
+    boost::shared_ptr<hoPartialDerivativeOperator<T, 2>> R_;
+    hoNDArray<T> data_;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> solverImplementations;
+
+TYPED_TEST_SUITE(hoSolverWorkspace_test, solverImplementations);
+
+TYPED_TEST(hoSolverWorkspace_test, cgRepeatedSolve)
+{
+    hoCgSolver<TypeParam> solver;
+    this->setup_cg(solver);
+
+    // The first result is dropped before the second solve, so its buffer is free for reuse
+    hoNDArray<TypeParam> first = *solver.solve(&this->data_);
+    EXPECT_GT(solver.get_workspace().get_number_of_allocations(), 0u);
+
+    solver.get_workspace().reset_number_of_allocations();
+    auto second = solver.solve(&this->data_);
+
+    EXPECT_EQ(solver.get_workspace().get_number_of_allocations(), 0u);
+    this->expect_identical(first, *second);
+}
+
+TYPED_TEST(hoSolverWorkspace_test, cgRepeatedSolveWithInitialGuess)
+{
+    hoCgSolver<TypeParam> solver;
+    this->setup_cg(solver);
+    solver.set_x0(boost::make_shared<hoNDArray<TypeParam>>(this->data_));
+
+    hoNDArray<TypeParam> first = *solver.solve(&this->data_);
+
+    solver.get_workspace().reset_number_of_allocations();
+    auto second = solver.solve(&this->data_);
+
+    EXPECT_EQ(solver.get_workspace().get_number_of_allocations(), 0u);
+    this->expect_identical(first, *second);
+}
+
+TYPED_TEST(hoSolverWorkspace_test, cgKeepsResultHeldByCaller)
+{
+    hoCgSolver<TypeParam> solver;
+    this->setup_cg(solver);
+
+    auto first = solver.solve(&this->data_);
+    hoNDArray<TypeParam> expected = *first;
+
+    hoNDArray<TypeParam> other_data = this->data_;
+    other_data *= TypeParam(3);
+    auto second = solver.solve(&other_data);
+
+    EXPECT_NE(first.get(), second.get());
+    this->expect_identical(expected, *first);
+}
+
+TYPED_TEST(hoSolverWorkspace_test, lsqrRepeatedSolve)
+{
+    hoLsqrSolver<TypeParam> solver;
+    solver.set_encoding_operator(this->E_);
+    solver.set_max_iterations(15);
+    solver.set_tc_tolerance(typename TestFixture::value_type(1e-12));
+
+    hoNDArray<TypeParam> first;
+    solver.solve(&first, &this->data_);
+
+    solver.get_workspace().reset_number_of_allocations();
+    hoNDArray<TypeParam> second;
+    solver.solve(&second, &this->data_);
+
+    EXPECT_EQ(solver.get_workspace().get_number_of_allocations(), 0u);
+    this->expect_identical(first, second);
+}
+
+TYPED_TEST(hoSolverWorkspace_test, nlcgRepeatedSolve)
+{
+    nlcgSolver<hoNDArray<TypeParam>> solver;
+    this->setup_gp(solver);
+
+    hoNDArray<TypeParam> first = *solver.solve(&this->data_);
+    EXPECT_GT(solver.get_workspace().get_number_of_allocations(), 0u);
+
+    solver.get_workspace().reset_number_of_allocations();
+    auto second = solver.solve(&this->data_);
+
+    EXPECT_EQ(solver.get_workspace().get_number_of_allocations(), 0u);
+    this->expect_identical(first, *second);
+}
+
+// lbfgsSolver scales by real factors, which the host arrays only support for real element types
+template<typename T> class hoSolverWorkspaceReal_test : public hoSolverWorkspace_test<T> {};
+
+typedef Types<float, double> realSolverImplementations;
+
+TYPED_TEST_SUITE(hoSolverWorkspaceReal_test, realSolverImplementations);
+
+TYPED_TEST(hoSolverWorkspaceReal_test, lbfgsRepeatedSolve)
+{
+    // More iterations than stored pairs, so the oldest pair is recycled as well as new pair slots being filled
+    lbfgsSolver<hoNDArray<TypeParam>> solver;
+    this->setup_gp(solver);
+    solver.set_m(3);
+
+    hoNDArray<TypeParam> first = *solver.solve(&this->data_);
+    EXPECT_GT(solver.get_workspace().get_number_of_allocations(), 0u);
+
+    solver.get_workspace().reset_number_of_allocations();
+    auto second = solver.solve(&this->data_);
+
+    EXPECT_EQ(solver.get_workspace().get_number_of_allocations(), 0u);
+    this->expect_identical(first, *second);
+
+    // A third solve, after the pair slots of the second have been released again
+    solver.get_workspace().reset_number_of_allocations();
+    auto third = solver.solve(&this->data_);
+
+    EXPECT_EQ(solver.get_workspace().get_number_of_allocations(), 0u);
+    this->expect_identical(first, *third);
+}
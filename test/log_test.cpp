@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include "log.h"
+
+#include <thread>
+
+using namespace Gadgetron;
+
+namespace {
+    size_t count(const std::string& haystack, const std::string& needle) {
+        size_t n = 0;
+        for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) n++;
+        return n;
+    }
+}
+
+TEST(AsyncLogging, every_statement_is_written_or_counted_as_dropped) {
+    auto logger = GadgetronLogger::instance();
+    logger->enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+    logger->enableLogLevel(GADGETRON_LOG_LEVEL_ERROR);
+
+    testing::internal::CaptureStderr();
+    logger->enableAsyncLogging(64);
+    size_t dropped_before = logger->droppedMessages();
+
+    constexpr int threads = 4;
+    constexpr int statements = 2000;
+    std::vector<std::thread> loggers;
+    for (int t = 0; t < threads; t++) {
+        loggers.emplace_back([t]() {
+            for (int i = 0; i < statements; i++) GDEBUG("async debug %d %d\n", t, i);
+            GERROR_STREAM("async error " << t);
+        });
+    }
+    for (auto& thread : loggers) thread.join();
+
+    size_t dropped = logger->droppedMessages() - dropped_before;
+    logger->disableAsyncLogging();
+    auto output = testing::internal::GetCapturedStderr();
+
+    EXPECT_EQ(count(output, "async debug") + dropped, threads * statements);
+    EXPECT_EQ(count(output, "async error"), threads);
+    EXPECT_FALSE(logger->isAsyncLoggingEnabled());
+}
+
+TEST(AsyncLogging, respects_log_levels) {
+    auto logger = GadgetronLogger::instance();
+    logger->disableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+    logger->enableLogLevel(GADGETRON_LOG_LEVEL_INFO);
+
+    testing::internal::CaptureStderr();
+    logger->enableAsyncLogging();
+    GDEBUG("masked statement\n");
+    GINFO_STREAM("visible " << 42);
+    logger->flush();
+    auto output = testing::internal::GetCapturedStderr();
+    logger->disableAsyncLogging();
+    logger->enableLogLevel(GADGETRON_LOG_LEVEL_DEBUG);
+
+    EXPECT_EQ(count(output, "masked statement"), 0);
+    EXPECT_EQ(count(output, "visible 42"), 1);
+}
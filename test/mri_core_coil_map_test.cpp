@@ -0,0 +1,179 @@
+/** \file       mri_core_coil_map_test.cpp
+    \brief      Test case for the Inati coil map estimation
+*/
+
+#include "mri_core_coil_map_estimation.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+namespace
+{
+    // Inati coil map of every pixel computed directly from its window, in double: the data matrix D of the window,
+    // power iterations on D^H D from the normalized channel sums, and the phase of the sum of D V1.
+    template <typename T>
+    hoNDArray< std::complex<double> > direct_coil_map_2d_Inati(const hoNDArray<T>& data, size_t ks, size_t power)
+    {
+        typedef std::complex<double> Z;
+
+        const long long RO = data.get_size(0);
+        const long long E1 = data.get_size(1);
+        const long long CHA = data.get_size(2);
+        const long long halfKs = (long long)ks / 2;
+        const long long K = (long long)(ks*ks);
+
+        hoNDArray<Z> coilMap(RO, E1, CHA);
+
+        std::vector<Z> D(K*CHA), R(CHA*CHA), V1(CHA), V(CHA);
+
+        auto normalize = [](std::vector<Z>& v)
+        {
+            double sum = 0;
+            for (auto& x : v) sum += std::norm(x);
+            for (auto& x : v) x /= std::sqrt(sum);
+        };
+
+        for (long long e1 = 0; e1 < E1; e1++)
+        {
+            for (long long ro = 0; ro < RO; ro++)
+            {
+                for (long long cha = 0; cha < CHA; cha++)
+                {
+                    long long k = 0;
+                    for (long long ke1 = -halfKs; ke1 <= halfKs; ke1++)
+                    {
+                        for (long long kro = -halfKs; kro <= halfKs; kro++, k++)
+                        {
+                            long long de1 = (e1 + ke1 + E1) % E1;
+                            long long dro = (ro + kro + RO) % RO;
+                            D[cha*K + k] = Z(data(dro, de1, cha));
+                        }
+                    }
+                }
+
+                for (long long cha = 0; cha < CHA; cha++)
+                {
+                    V1[cha] = Z(0);
+                    for (long long k = 0; k < K; k++) V1[cha] += D[cha*K + k];
+                }
+                normalize(V1);
+
+                for (long long c2 = 0; c2 < CHA; c2++)
+                {
+                    for (long long c1 = 0; c1 < CHA; c1++)
+                    {
+                        R[c1 + c2*CHA] = Z(0);
+                        for (long long k = 0; k < K; k++) R[c1 + c2*CHA] += std::conj(D[c1*K + k]) * D[c2*K + k];
+                    }
+                }
+
+                for (size_t po = 0; po < power; po++)
+                {
+                    for (long long c1 = 0; c1 < CHA; c1++)
+                    {
+                        V[c1] = Z(0);
+                        for (long long c2 = 0; c2 < CHA; c2++) V[c1] += R[c1 + c2*CHA] * V1[c2];
+                    }
+                    V1 = V;
+                    normalize(V1);
+                }
+
+                Z phase(0);
+                for (long long cha = 0; cha < CHA; cha++)
+                    for (long long k = 0; k < K; k++) phase += D[cha*K + k] * V1[cha];
+                phase /= std::abs(phase);
+
+                for (long long cha = 0; cha < CHA; cha++) coilMap(ro, e1, cha) = std::conj(V1[cha]) * phase;
+            }
+        }
+
+        return coilMap;
+    }
+
+    // a bright ellipse with smooth coil sensitivities, on a faint noisy background
+    template <typename T>
+    hoNDArray<T> phantom(size_t RO, size_t E1, size_t CHA, double object, double background)
+    {
+        std::mt19937 rng(17);
+        std::normal_distribution<double> noise(0, background);
+
+        hoNDArray<T> data(RO, E1, CHA);
+        for (size_t cha = 0; cha < CHA; cha++)
+        {
+            double angle = 2 * M_PI * cha / CHA;
+            for (size_t e1 = 0; e1 < E1; e1++)
+            {
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    double x = (ro - RO / 2.0) / (RO / 3.0);
+                    double y = (e1 - E1 / 2.0) / (E1 / 3.0);
+                    std::complex<double> value(noise(rng), noise(rng));
+                    if (x*x + y*y < 1)
+                    {
+                        double sensitivity = std::exp(-((x - std::cos(angle))*(x - std::cos(angle)) + (y - std::sin(angle))*(y - std::sin(angle))));
+                        value += object * sensitivity * std::polar(1.0, angle + 0.5*x - 0.3*y);
+                    }
+                    data(ro, e1, cha) = T(value);
+                }
+            }
+        }
+        return data;
+    }
+}
+
+template<typename T> class mri_core_coil_map_test : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+    }
+};
+
+typedef Types< std::complex<float>, std::complex<double> > cpfloatImplementations;
+TYPED_TEST_SUITE(mri_core_coil_map_test, cpfloatImplementations);
+
+TYPED_TEST(mri_core_coil_map_test, inati_matches_direct_computation)
+{
+    // the window slides from an object five orders of magnitude brighter than the background
+    hoNDArray<TypeParam> data = phantom<TypeParam>(192, 96, 8, 1e3, 1e-2);
+
+    hoNDArray<TypeParam> coilMap;
+    coil_map_2d_Inati(data, coilMap, 7, 3);
+    hoNDArray< std::complex<double> > expected = direct_coil_map_2d_Inati(data, 7, 3);
+
+    // power iterations amplify rounding at pixels where the leading eigenvalues are close, in either precision
+    ASSERT_TRUE(data.dimensions_equal(coilMap));
+    for (size_t n = 0; n < coilMap.get_number_of_elements(); n++)
+    {
+        EXPECT_NEAR(std::abs(std::complex<double>(coilMap[n]) - expected[n]), 0.0, 1e-4) << "at " << n;
+    }
+}
+
+TYPED_TEST(mri_core_coil_map_test, inati_zero_signal_is_nan)
+{
+    hoNDArray<TypeParam> data = phantom<TypeParam>(48, 40, 4, 1.0, 1e-2);
+
+    // no signal at all in the windows around the centre of the block
+    for (size_t cha = 0; cha < 4; cha++)
+        for (size_t e1 = 10; e1 < 30; e1++)
+            for (size_t ro = 12; ro < 36; ro++) data(ro, e1, cha) = TypeParam(0);
+
+    hoNDArray<TypeParam> coilMap;
+    coil_map_2d_Inati(data, coilMap, 5, 3);
+    hoNDArray< std::complex<double> > expected = direct_coil_map_2d_Inati(data, 5, 3);
+
+    size_t undefined = 0;
+    for (size_t n = 0; n < coilMap.get_number_of_elements(); n++)
+    {
+        bool expected_nan = std::isnan(expected[n].real());
+        EXPECT_EQ(std::isnan(coilMap[n].real()), expected_nan) << "at " << n;
+        if (expected_nan)
+            undefined++;
+        else
+            EXPECT_NEAR(std::abs(std::complex<double>(coilMap[n]) - expected[n]), 0.0, 1e-4) << "at " << n;
+    }
+    EXPECT_EQ(undefined, 4u * (36 - 12 - 4) * (30 - 10 - 4));
+}
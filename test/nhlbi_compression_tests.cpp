@@ -6,6 +6,7 @@
 #include <string>
 
 #include "NHLBICompression.h"
+#include "CompressedAcquisition.h"
 
 #define TESTSAMPLES 10000000
 
@@ -306,4 +307,32 @@ TEST(NHLBICompression, Deserialize)
     {
         ASSERT_FLOAT_EQ(compressor->getValue(i), decompressor->getValue(i));
     }
-}
\ No newline at end of file
+}
+
+TEST(NHLBICompression, CompressedAcquisition)
+{
+    std::vector<float> noise(2 * 256 * 8);
+    fill_random(noise);
+
+    mrd::Acquisition acq;
+    acq.head.scan_counter = 7;
+    acq.data.create(256, 8);
+    std::copy(noise.begin(), noise.end(), reinterpret_cast<float*>(acq.data.get_data_ptr()));
+
+    const float tolerance = 0.1f;
+    Gadgetron::CompressedAcquisition compressed(acq, tolerance);
+    ASSERT_TRUE(compressed.is_compressed());
+    EXPECT_LT(compressed.compressed_bytes(), compressed.uncompressed_bytes() / 2);
+
+    auto decompressed = compressed.decompress();
+    EXPECT_EQ(decompressed.head.scan_counter, acq.head.scan_counter);
+    ASSERT_EQ(decompressed.data.dimensions(), acq.data.dimensions());
+    for (size_t i = 0; i < acq.data.size(); i++)
+    {
+        ASSERT_LE(std::abs(decompressed.data[i].real() - acq.data[i].real()), tolerance);
+        ASSERT_LE(std::abs(decompressed.data[i].imag() - acq.data[i].imag()), tolerance);
+    }
+
+    Gadgetron::CompressedAcquisition zeros(mrd::Acquisition{}, tolerance);
+    EXPECT_FALSE(zeros.is_compressed());
+}
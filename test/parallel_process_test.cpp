@@ -0,0 +1,156 @@
+#include "nodes/ParallelProcess.h"
+#include "PureGadget.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Main;
+using namespace std::chrono_literals;
+
+namespace {
+
+    struct Recorder {
+        std::mutex m;
+        size_t running = 0;
+        size_t max_running = 0;
+    };
+
+    // Passes ints through after a delay chosen per value, recording how many run at once.
+    class DelayGadget : public PureGadget<int, int> {
+    public:
+        DelayGadget(Recorder& recorder, std::function<std::chrono::milliseconds(int)> delay, int throw_on = -1)
+            : PureGadget<int, int>(Context{}, GadgetProperties{}), recorder{recorder}, delay{std::move(delay)},
+              throw_on{throw_on} {}
+
+        int process_function(int value) const override {
+            {
+                std::lock_guard<std::mutex> guard(recorder.m);
+                recorder.max_running = std::max(recorder.max_running, ++recorder.running);
+            }
+            std::this_thread::sleep_for(delay(value));
+            {
+                std::lock_guard<std::mutex> guard(recorder.m);
+                recorder.running--;
+            }
+            if (value == throw_on) throw std::runtime_error("failed on " + std::to_string(value));
+            return value;
+        }
+
+    private:
+        Recorder& recorder;
+        std::function<std::chrono::milliseconds(int)> delay;
+        int throw_on;
+    };
+
+    class RecordingReporter : public ErrorReporter {
+    public:
+        void operator()(const std::string& location, const std::string& message) override {
+            std::lock_guard<std::mutex> guard(m);
+            errors.push_back(message);
+        }
+
+        std::mutex m;
+        std::vector<std::string> errors;
+    };
+
+    Config::ParallelProcess config(size_t workers, size_t max_in_flight, bool ordered) {
+        Config::ParallelProcess conf;
+        conf.workers = workers;
+        conf.max_in_flight = max_in_flight;
+        conf.ordered = ordered;
+        return conf;
+    }
+
+    std::vector<int> run(Nodes::ParallelProcess& node, int messages, ErrorReporter& reporter) {
+        auto input = make_channel();
+        auto output = make_channel();
+        for (int i = 0; i < messages; i++) input.output.push(i);
+        { auto closer = std::move(input.output); }
+
+        ErrorHandler error_handler{reporter, "test"};
+        node.process(std::move(input.input), std::move(output.output), error_handler);
+
+        std::vector<int> values;
+        for (auto message : output.input) values.push_back(force_unpack<int>(std::move(message)));
+        return values;
+    }
+
+    Nodes::ParallelProcess make_node(const Config::ParallelProcess& conf, Recorder& recorder,
+                                     std::function<std::chrono::milliseconds(int)> delay, int throw_on = -1) {
+        std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+        gadgets.push_back(std::make_unique<DelayGadget>(recorder, std::move(delay), throw_on));
+        return Nodes::ParallelProcess(conf, Nodes::PureStream(std::move(gadgets)));
+    }
+}
+
+TEST(ParallelProcessTest, ordered_output_follows_input) {
+    // Later messages finish first, so only the ordering keeps them in input order.
+    constexpr int messages = 24;
+    Recorder recorder;
+    RecordingReporter reporter;
+    auto node = make_node(config(4, 0, true), recorder, [](int value) { return std::chrono::milliseconds(messages - value); });
+
+    auto values = run(node, messages, reporter);
+
+    std::vector<int> expected(messages);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(values, expected);
+    EXPECT_TRUE(reporter.errors.empty());
+}
+
+TEST(ParallelProcessTest, unordered_output_does_not_wait_for_slow_message) {
+    constexpr int messages = 16;
+    Recorder recorder;
+    RecordingReporter reporter;
+    auto node = make_node(config(4, 0, false), recorder, [](int value) { return value == 0 ? 200ms : 1ms; });
+
+    auto values = run(node, messages, reporter);
+
+    ASSERT_EQ(values.size(), size_t(messages));
+    EXPECT_NE(values.front(), 0);
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < messages; i++) EXPECT_EQ(values[i], i);
+}
+
+TEST(ParallelProcessTest, window_limits_work_in_flight) {
+    constexpr int messages = 32;
+    RecordingReporter reporter;
+
+    for (bool ordered : { true, false }) {
+        Recorder recorder;
+        auto node = make_node(config(8, 2, ordered), recorder, [](int) { return 5ms; });
+        auto values = run(node, messages, reporter);
+
+        EXPECT_EQ(values.size(), size_t(messages));
+        EXPECT_LE(recorder.max_running, 2u) << (ordered ? "ordered" : "unordered");
+    }
+
+    // Without a window, the same work spreads over more of the workers.
+    Recorder unbounded;
+    auto node = make_node(config(8, 0, true), unbounded, [](int) { return 5ms; });
+    run(node, messages, reporter);
+    EXPECT_GT(unbounded.max_running, 2u);
+    EXPECT_TRUE(reporter.errors.empty());
+}
+
+TEST(ParallelProcessTest, worker_exception_is_reported) {
+#if !defined(NDEBUG)
+    GTEST_SKIP() << "Debug builds let exceptions escape the error handler";
+#endif
+    for (bool ordered : { true, false }) {
+        Recorder recorder;
+        RecordingReporter reporter;
+        auto node = make_node(config(4, 4, ordered), recorder, [](int) { return 1ms; }, 5);
+
+        auto values = run(node, 16, reporter);
+
+        ASSERT_EQ(reporter.errors.size(), 1u) << (ordered ? "ordered" : "unordered");
+        EXPECT_EQ(reporter.errors.front(), "failed on 5");
+        EXPECT_EQ(std::count(values.begin(), values.end(), 5), 0);
+        EXPECT_LT(values.size(), 16u);
+    }
+}
@@ -5,6 +5,9 @@
 #include <gtest/gtest.h>
 #include "ThreadPool.h"
 
+#include <array>
+#include <numeric>
+
 using namespace Gadgetron::Core;
 
 TEST(ThreadPoolTest,VoidTest){
@@ -25,3 +28,56 @@ TEST(ThreadPoolTest,moveTest){
     pool.join();
 
 }
+
+TEST(ThreadPoolTest,exceptionTest){
+    ThreadPool pool{2};
+    auto return_value = pool.async([](){ throw std::runtime_error("failed"); });
+    EXPECT_THROW(return_value.get(), std::runtime_error);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,largeClosureTest){
+    ThreadPool pool{2};
+    std::array<double, 32> values{};
+    values.fill(1.0);
+    auto return_value = pool.async([values](){ return std::accumulate(values.begin(), values.end(), 0.0); });
+    EXPECT_EQ(return_value.get(), 32.0);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,parallelForTest){
+    ThreadPool pool{4};
+    std::vector<int> values(10000, 0);
+    pool.parallel_for(0, values.size(), [&](size_t i){ values[i] = int(i); });
+    for (size_t i = 0; i < values.size(); i++) EXPECT_EQ(values[i], int(i));
+    pool.join();
+}
+
+TEST(ThreadPoolTest,nestedTest){
+    ThreadPool pool{2};
+    std::vector<Future<int>> outer;
+    for (int i = 0; i < 8; i++) {
+        outer.push_back(pool.async([&pool](int i){
+            auto inner = pool.async([](int j){ return 2*j; }, i);
+            return inner.get();
+        }, i));
+    }
+    for (int i = 0; i < 8; i++) EXPECT_EQ(outer[i].get(), 2*i);
+    pool.join();
+}
+
+TEST(ThreadPoolTest,globalTest){
+    std::atomic<int> counter{0};
+    ThreadPool::global().parallel_for(0, 100, [&](size_t){ counter++; });
+    EXPECT_EQ(counter.load(), 100);
+}
+
+TEST(ThreadPoolTest,postExceptionTest){
+    ThreadPool pool{2};
+    std::atomic<int> counter{0};
+    pool.post([](){ throw std::runtime_error("failed"); });
+    // The workers survive the exception and keep running other work.
+    for (int i = 0; i < 16; i++) pool.post([&](){ counter++; });
+    EXPECT_THROW(pool.join(), std::runtime_error);
+    EXPECT_EQ(counter.load(), 16);
+}
@@ -0,0 +1,189 @@
+/** \file   cmr_batched_fitting.h
+    \brief  Fit two-parameter exponential models to many pixels at once
+            Pixels are fitted in lanes of a batch, with the samples of all lanes for one time point stored
+            contiguously, so that every step of the fit is a loop over lanes the compiler can vectorize.
+    \author Hui Xue
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Gadgetron {
+
+    /// T2 decay, y = A * exp(-t/T2)
+    template <typename T>
+    struct ExpDecayModel
+    {
+        static inline void evaluate(T t, T A, T rb, T& y, T& dA, T& dB)
+        {
+            T val = std::exp(-t * rb);
+            y = A * val;
+            dA = val;
+            dB = A * val * t * rb * rb;
+        }
+    };
+
+    /// T1 saturation recovery, y = A * ( 1-exp(-t/T1) )
+    template <typename T>
+    struct ExpRecoveryModel
+    {
+        static inline void evaluate(T t, T A, T rb, T& y, T& dA, T& dB)
+        {
+            T val = std::exp(-t * rb);
+            y = A * (1 - val);
+            dA = 1 - val;
+            dB = -A * val * t * rb * rb;
+        }
+    };
+
+    /// Least squares fit of y = MODEL(t; A, B) for the W pixels of a batch, by Levenberg-Marquardt
+    /// ti: [num_ti], yi: [num_ti W], samples of one time point contiguous
+    /// A, B: [W], initial guess on input, fitted parameters on output
+    /// sd_A, sd_B: [W], SD of the fitted parameters; not computed if null
+    /// The SD is computed as in CmrParametricMapping::compute_sd_impl, from the Hessian scaled by a robust estimate
+    /// of the noise, the median of the absolute residuals after the smallest ones are dropped
+    template <typename T, typename MODEL, size_t W>
+    void fit_two_parameter_batch(const T* ti, size_t num_ti, const T* yi, T* A, T* B, size_t max_iter, T* sd_A, T* sd_B)
+    {
+        const T tolerance = 16 * std::numeric_limits<T>::epsilon();
+        const T max_lambda = T(1e8);
+
+        // cost and normal equations at the current parameters (suffix c) and at the trial parameters (suffix t)
+        alignas(64) T cost_c[W], h00_c[W], h01_c[W], h11_c[W], g0_c[W], g1_c[W];
+        alignas(64) T cost_t[W], h00_t[W], h01_t[W], h11_t[W], g0_t[W], g1_t[W];
+        alignas(64) T A_t[W], B_t[W], lambda[W];
+        alignas(64) int active[W];
+
+        auto normal_equations = [&](const T* pA, const T* pB, T* cost, T* h00, T* h01, T* h11, T* g0, T* g1)
+        {
+            #pragma omp simd
+            for (size_t l = 0; l < W; l++)
+            {
+                cost[l] = 0; h00[l] = 0; h01[l] = 0; h11[l] = 0; g0[l] = 0; g1[l] = 0;
+            }
+
+            for (size_t n = 0; n < num_ti; n++)
+            {
+                const T t = ti[n];
+                const T* y = yi + n * W;
+
+                #pragma omp simd
+                for (size_t l = 0; l < W; l++)
+                {
+                    T b = pB[l];
+                    T rb = 1 / ((std::abs(b) < FLT_EPSILON) ? (b < 0 ? -FLT_EPSILON : FLT_EPSILON) : b);
+
+                    T f, dA, dB;
+                    MODEL::evaluate(t, pA[l], rb, f, dA, dB);
+
+                    T r = f - y[l];
+                    cost[l] += r * r;
+                    h00[l] += dA * dA;
+                    h01[l] += dA * dB;
+                    h11[l] += dB * dB;
+                    g0[l] += dA * r;
+                    g1[l] += dB * r;
+                }
+            }
+        };
+
+        normal_equations(A, B, cost_c, h00_c, h01_c, h11_c, g0_c, g1_c);
+
+        #pragma omp simd
+        for (size_t l = 0; l < W; l++)
+        {
+            lambda[l] = T(1e-3);
+            active[l] = std::isfinite(cost_c[l]);
+        }
+
+        for (size_t iter = 0; iter < max_iter; iter++)
+        {
+            // Marquardt step, solving (H + lambda diag(H)) delta = -g
+            #pragma omp simd
+            for (size_t l = 0; l < W; l++)
+            {
+                T d00 = h00_c[l] * (1 + lambda[l]);
+                T d11 = h11_c[l] * (1 + lambda[l]);
+                T det = d00 * d11 - h01_c[l] * h01_c[l];
+                T inv_det = (det > 0) ? 1 / det : T(0);
+
+                A_t[l] = A[l] - (d11 * g0_c[l] - h01_c[l] * g1_c[l]) * inv_det;
+                B_t[l] = B[l] - (d00 * g1_c[l] - h01_c[l] * g0_c[l]) * inv_det;
+            }
+
+            normal_equations(A_t, B_t, cost_t, h00_t, h01_t, h11_t, g0_t, g1_t);
+
+            int any_active = 0;
+
+            #pragma omp simd reduction(|:any_active)
+            for (size_t l = 0; l < W; l++)
+            {
+                bool accept = active[l] && B_t[l] > 0 && cost_t[l] < cost_c[l];
+
+                T step = std::max(std::abs(A_t[l] - A[l]) / (std::abs(A[l]) + FLT_EPSILON),
+                                  std::abs(B_t[l] - B[l]) / (std::abs(B[l]) + FLT_EPSILON));
+
+                if (accept)
+                {
+                    A[l] = A_t[l]; B[l] = B_t[l];
+                    cost_c[l] = cost_t[l];
+                    h00_c[l] = h00_t[l]; h01_c[l] = h01_t[l]; h11_c[l] = h11_t[l];
+                    g0_c[l] = g0_t[l]; g1_c[l] = g1_t[l];
+                }
+
+                lambda[l] = accept ? std::max(lambda[l] * T(0.1), T(1e-7)) : lambda[l] * 10;
+
+                // converged once steps no longer change the parameters, or no step reduces the cost
+                if (step < tolerance || lambda[l] > max_lambda || cost_c[l] == 0) active[l] = 0;
+
+                any_active |= active[l];
+            }
+
+            if (!any_active) break;
+        }
+
+        if (sd_A == nullptr || sd_B == nullptr) return;
+
+        const size_t N = 2;
+        const size_t rank = num_ti - (N - 1);
+
+        std::vector<T> res(num_ti);
+
+        normal_equations(A, B, cost_c, h00_c, h01_c, h11_c, g0_c, g1_c);
+
+        for (size_t l = 0; l < W; l++)
+        {
+            sd_A[l] = 0;
+            sd_B[l] = 0;
+
+            if (num_ti < N) continue;
+
+            T rb = 1 / ((std::abs(B[l]) < FLT_EPSILON) ? (B[l] < 0 ? -FLT_EPSILON : FLT_EPSILON) : B[l]);
+            for (size_t n = 0; n < num_ti; n++)
+            {
+                T f, dA, dB;
+                MODEL::evaluate(ti[n], A[l], rb, f, dA, dB);
+                res[n] = std::abs(f - yi[n * W + l]);
+            }
+            std::sort(res.begin(), res.end());
+
+            const T* res_trunc = res.data() + N - 1;
+            T std = (rank % 2 == 0) ? (res_trunc[rank / 2] + res_trunc[rank / 2 - 1]) / 2 / T(0.6745)
+                                    : res_trunc[rank / 2] / T(0.6745);
+
+            if (std::abs(std) < FLT_EPSILON) continue; // deviation is too small to compute sd
+
+            T scale = 1 / (std * std);
+            T det = (h00_c[l] * h11_c[l] - h01_c[l] * h01_c[l]) * scale * scale;
+            if (!(det > 0)) continue;
+
+            sd_A[l] = std::sqrt(h11_c[l] * scale / det);
+            sd_B[l] = std::sqrt(h00_c[l] * scale / det);
+        }
+    }
+}
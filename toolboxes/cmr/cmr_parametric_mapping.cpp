@@ -20,8 +20,125 @@
 
 #include <boost/math/special_functions/sign.hpp>
 
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+
 namespace Gadgetron {
 
+namespace
+{
+    /// normalized signals over a grid of map values
+    template <typename T>
+    struct MappingDictionary
+    {
+        /// [num_ti K], every atom of unit norm
+        hoNDArray<T> atoms;
+        /// map value and norm of the signal before normalization, for every atom
+        std::vector<T> map_values;
+        std::vector<T> norms;
+    };
+
+    /// dictionaries are kept per model, timing and grid; only a few are in use at any time
+    template <typename T>
+    std::shared_ptr<const MappingDictionary<T>> get_dictionary(const CmrParametricMapping<T>& mapper)
+    {
+        static std::mutex m;
+        static std::list<std::pair<std::string, std::shared_ptr<const MappingDictionary<T>>>> cache;
+        const size_t max_dictionaries = 16;
+
+        const auto& ti = mapper.ti_;
+        const size_t K = mapper.dictionary_size_;
+        const T min_v = mapper.dictionary_min_map_value_;
+        const T max_v = mapper.max_map_value_;
+
+        GADGET_CHECK_THROW(K > 1 && min_v > 0 && max_v > min_v);
+
+        std::string key = typeid(mapper).name();
+        key.append(reinterpret_cast<const char*>(ti.data()), ti.size() * sizeof(T));
+        for (T v : { T(K), min_v, max_v }) key.append(reinterpret_cast<const char*>(&v), sizeof(T));
+
+        std::lock_guard<std::mutex> guard(m);
+
+        for (auto it = cache.begin(); it != cache.end(); it++)
+        {
+            if (it->first == key)
+            {
+                cache.splice(cache.begin(), cache, it);
+                return cache.front().second;
+            }
+        }
+
+        auto dictionary = std::make_shared<MappingDictionary<T>>();
+        dictionary->atoms.create(ti.size(), K);
+        dictionary->map_values.resize(K);
+        dictionary->norms.resize(K);
+
+        for (size_t k = 0; k < K; k++)
+        {
+            T v = min_v * std::pow(max_v / min_v, T(k) / T(K - 1));
+            T* atom = &dictionary->atoms(0, k);
+
+            mapper.compute_dictionary_atom(ti, v, atom);
+
+            T norm(0);
+            for (size_t n = 0; n < ti.size(); n++) norm += atom[n] * atom[n];
+            norm = std::sqrt(norm);
+
+            for (size_t n = 0; n < ti.size(); n++) atom[n] = (norm > 0) ? atom[n] / norm : T(0);
+
+            dictionary->map_values[k] = v;
+            dictionary->norms[k] = norm;
+        }
+
+        cache.emplace_front(key, dictionary);
+        if (cache.size() > max_dictionaries) cache.pop_back();
+
+        return dictionary;
+    }
+
+    /// find the best matching atom for every lane of yi [num_ti W], by a single GEMM against the dictionary
+    /// bi: [2 W], amplitude and map value of the match
+    template <typename T, size_t W>
+    void match_dictionary(const MappingDictionary<T>& dictionary, T* yi, hoNDArray<T>& correlation, T* bi)
+    {
+        size_t num_ti = dictionary.atoms.get_size(0);
+        size_t K = dictionary.atoms.get_size(1);
+
+        hoNDArray<T> y(W, num_ti, yi);
+        Gadgetron::gemm(correlation, y, false, dictionary.atoms, false);
+
+        alignas(64) T best[W];
+        alignas(64) size_t index[W];
+        for (size_t l = 0; l < W; l++)
+        {
+            best[l] = -std::numeric_limits<T>::max();
+            index[l] = 0;
+        }
+
+        const T* c = correlation.get_data_ptr();
+        for (size_t k = 0; k < K; k++)
+        {
+            for (size_t l = 0; l < W; l++)
+            {
+                if (c[l + k*W] > best[l])
+                {
+                    best[l] = c[l + k*W];
+                    index[l] = k;
+                }
+            }
+        }
+
+        for (size_t l = 0; l < W; l++)
+        {
+            bi[l] = (best[l] > 0) ? best[l] / dictionary.norms[index[l]] : T(0);
+            bi[W + l] = dictionary.map_values[index[l]];
+        }
+    }
+}
+
 template <typename T>
 void perform_hole_filling(hoNDArray<T>& map, T hole, size_t max_size_of_holes, bool is_8_connected)
 {
@@ -185,6 +302,13 @@ CmrParametricMapping<T>::CmrParametricMapping()
 
     compute_SD_maps_ = false;;
 
+    batched_fitting_ = false;
+
+    dictionary_matching_ = false;
+    dictionary_size_ = 1000;
+    dictionary_min_map_value_ = 1;
+    dictionary_refinement_iter_ = 5;
+
     max_iter_ = 50;
     max_fun_eval_ = 100;
     thres_fun_ = 1e-5;
@@ -264,6 +388,16 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
 
         long long ro, e1;
 
+        bool matching = this->dictionary_matching_ && this->supports_dictionary_matching();
+        bool batched = matching || (this->batched_fitting_ && this->supports_batched_fitting());
+
+        std::shared_ptr<const MappingDictionary<T>> dictionary;
+        if (matching)
+        {
+            GADGET_CHECK_THROW(NUM == 2);
+            dictionary = get_dictionary(*this);
+        }
+
         for (slc = 0; slc < SLC; slc++)
         {
             for (s = 0; s < S; s++)
@@ -287,6 +421,76 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
                     pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
                 }
 
+                if (batched)
+                {
+                    // pixels to map, fitted batch_size at a time
+                    std::vector<size_t> pixels;
+                    pixels.reserve(RO*E1);
+                    for (size_t offset = 0; offset < RO*E1; offset++)
+                    {
+                        if (pMaskCurr == NULL || pMaskCurr[offset] > 0) pixels.push_back(offset);
+                    }
+
+                    long long num_batches = (long long)((pixels.size() + batch_size - 1) / batch_size);
+                    long long b;
+
+#pragma omp parallel private(b, n) shared(pixels, num_batches, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM, dictionary)
+                    {
+                        std::vector<T> yi(num_ti*batch_size), bi(NUM*batch_size), sd(NUM*batch_size);
+                        std::vector<T> map_v(batch_size), map_sd(batch_size);
+                        hoNDArray<T> correlation;
+
+#pragma omp for schedule(dynamic)
+                        for (b = 0; b < num_batches; b++)
+                        {
+                            size_t first = b*batch_size;
+                            size_t num_pixels = std::min(batch_size, pixels.size() - first);
+
+                            // unused lanes repeat the first pixel
+                            for (n = 0; n < num_ti; n++)
+                            {
+                                for (size_t l = 0; l < batch_size; l++)
+                                {
+                                    size_t offset = pixels[first + (l < num_pixels ? l : 0)];
+                                    yi[n*batch_size + l] = pData[offset + n*RO*E1];
+                                }
+                            }
+
+                            if (matching)
+                            {
+                                match_dictionary<T, batch_size>(*dictionary, yi.data(), correlation, bi.data());
+                                this->refine_map_batch(ti_, yi.data(), num_pixels, dictionary_refinement_iter_, bi.data(), map_v.data(), sd.data(), map_sd.data());
+                            }
+                            else
+                            {
+                                this->compute_map_batch(ti_, yi.data(), num_pixels, bi.data(), map_v.data(), sd.data(), map_sd.data());
+                            }
+
+                            for (size_t l = 0; l < num_pixels; l++)
+                            {
+                                size_t offset = pixels[first + l];
+
+                                pMap[offset] = map_v[l];
+                                for (n = 0; n < NUM; n++)
+                                {
+                                    pPara[offset + n*RO*E1] = bi[n*batch_size + l];
+                                }
+
+                                if (this->compute_SD_maps_)
+                                {
+                                    pMapSD[offset] = map_sd[l];
+                                    for (n = 0; n < NUM; n++)
+                                    {
+                                        pParaSD[offset + n*RO*E1] = sd[n*batch_size + l];
+                                    }
+                                }
+                            }
+                        }
+                    } // openmp
+
+                    continue;
+                }
+
 #pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
                 {
                     std::vector<T> yi(num_ti, 0);
@@ -524,6 +728,36 @@ size_t CmrParametricMapping<T>::get_num_of_paras() const
     return 1;
 }
 
+template <typename T>
+bool CmrParametricMapping<T>::supports_batched_fitting() const
+{
+    return false;
+}
+
+template <typename T>
+void CmrParametricMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    GADGET_THROW("CmrParametricMapping<T>::compute_map_batch(...) is not implemented for this model ... ");
+}
+
+template <typename T>
+void CmrParametricMapping<T>::refine_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, size_t max_iter, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    GADGET_THROW("CmrParametricMapping<T>::refine_map_batch(...) is not implemented for this model ... ");
+}
+
+template <typename T>
+bool CmrParametricMapping<T>::supports_dictionary_matching() const
+{
+    return false;
+}
+
+template <typename T>
+void CmrParametricMapping<T>::compute_dictionary_atom(const VectorType& ti, T map_v, T* signal) const
+{
+    GADGET_THROW("CmrParametricMapping<T>::compute_dictionary_atom(...) is not implemented for this model ... ");
+}
+
 // ------------------------------------------------------------
 // Instantiation
 // ------------------------------------------------------------
@@ -63,6 +63,22 @@ namespace Gadgetron {
         /// whether to compute SD maps
         bool compute_SD_maps_;
 
+        /// whether to fit batch_size pixels at a time with compute_map_batch, if the model supports it
+        /// otherwise every pixel is fitted on its own with compute_map
+        bool batched_fitting_;
+
+        /// number of pixels fitted together by compute_map_batch
+        static constexpr size_t batch_size = 16;
+
+        /// whether to match every pixel against a dictionary of precomputed signals instead of fitting it, if the model supports it
+        /// the best matching atom, by normalized inner product, gives the initial parameters for dictionary_refinement_iter_ iterations of refine_map_batch
+        bool dictionary_matching_;
+        /// number of atoms, spaced logarithmically from dictionary_min_map_value_ to max_map_value_
+        size_t dictionary_size_;
+        T dictionary_min_map_value_;
+        /// if 0, the map is the value of the matched atom
+        size_t dictionary_refinement_iter_;
+
         /// mask for mapping, pixels used for mapping is marked as >0
         /// if empty, every pixel is inputted for mapping
         hoNDArray<T> mask_for_mapping_;
@@ -139,5 +155,23 @@ namespace Gadgetron {
 
         /// return number of parameters, including the map itself
         virtual size_t get_num_of_paras() const;
+
+        /// whether compute_map_batch is implemented
+        virtual bool supports_batched_fitting() const;
+
+        /// compute map values for a batch of num_pixels <= batch_size pixels, including the SD if compute_SD_maps_ is set
+        /// yi: [num_ti batch_size], samples of one time point contiguous; lanes beyond num_pixels hold copies of valid pixels
+        /// bi, sd: [NUM batch_size]; map_v, map_sd: [batch_size]
+        virtual void compute_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, T* bi, T* map_v, T* sd, T* map_sd);
+
+        /// as compute_map_batch, but starting from the parameters in bi and with at most max_iter iterations
+        virtual void refine_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, size_t max_iter, T* bi, T* map_v, T* sd, T* map_sd);
+
+        /// whether compute_dictionary_atom is implemented; requires refine_map_batch
+        /// for dictionary matching, the parameters are [amplitude, map value] and the signal is proportional to the amplitude
+        virtual bool supports_dictionary_matching() const;
+
+        /// signal for unit amplitude and the given map value, [num_ti]
+        virtual void compute_dictionary_atom(const VectorType& ti, T map_v, T* signal) const;
     };
 }
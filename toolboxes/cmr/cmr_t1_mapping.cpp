@@ -13,6 +13,7 @@
 #include "simplexLagariaSolver.h"
 #include "twoParaExpRecoveryOperator.h"
 #include "curveFittingCostFunction.h"
+#include "cmr_batched_fitting.h"
 
 #include <boost/math/special_functions/sign.hpp>
 
@@ -149,6 +150,85 @@ void CmrT1SRMapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, c
     }
 }
 
+template <typename T>
+bool CmrT1SRMapping<T>::supports_batched_fitting() const
+{
+    return true;
+}
+
+template <typename T>
+void CmrT1SRMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    size_t num = ti.size();
+    size_t l, n;
+
+    T* A = bi;
+    T* B = bi + batch_size;
+
+    // same initial guess as get_initial_guess
+    for (l = 0; l < batch_size; l++)
+    {
+        A[l] = 500;
+        B[l] = 1200;
+
+        if (num > 0)
+        {
+            A[l] = yi[l];
+            for (n = 1; n < num; n++) A[l] = std::max(A[l], yi[n*batch_size + l]);
+
+            B[l] = ti[num / 2];
+        }
+    }
+
+    this->refine_map_batch(ti, yi, num_pixels, max_iter_, bi, map_v, sd, map_sd);
+}
+
+template <typename T>
+void CmrT1SRMapping<T>::refine_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, size_t max_iter, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    size_t l;
+
+    T* A = bi;
+    T* B = bi + batch_size;
+
+    fit_two_parameter_batch<T, ExpRecoveryModel<T>, batch_size>(ti.data(), ti.size(), yi, A, B, max_iter,
+        compute_SD_maps_ ? sd : nullptr, compute_SD_maps_ ? sd + batch_size : nullptr);
+
+    for (l = 0; l < batch_size; l++)
+    {
+        map_v[l] = 0;
+        if (A[l] > 0 && B[l] > 0)
+        {
+            map_v[l] = B[l];
+            if (map_v[l] >= max_map_value_) map_v[l] = hole_marking_value_;
+            if (map_v[l] <= min_map_value_) map_v[l] = hole_marking_value_;
+        }
+
+        if (compute_SD_maps_)
+        {
+            map_sd[l] = sd[batch_size + l];
+            if (map_sd[l] > max_map_value_) map_sd[l] = this->hole_marking_value_;
+        }
+    }
+}
+
+template <typename T>
+bool CmrT1SRMapping<T>::supports_dictionary_matching() const
+{
+    return true;
+}
+
+template <typename T>
+void CmrT1SRMapping<T>::compute_dictionary_atom(const VectorType& ti, T map_v, T* signal) const
+{
+    T rb = 1 / map_v;
+    T dA, dB;
+    for (size_t n = 0; n < ti.size(); n++)
+    {
+        ExpRecoveryModel<T>::evaluate(ti[n], T(1), rb, signal[n], dA, dB);
+    }
+}
+
 template <typename T>
 size_t CmrT1SRMapping<T>::get_num_of_paras() const
 {
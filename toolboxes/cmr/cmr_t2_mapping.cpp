@@ -14,6 +14,7 @@
 #include "simplexLagariaSolver.h"
 #include "twoParaExpDecayOperator.h"
 #include "curveFittingCostFunction.h"
+#include "cmr_batched_fitting.h"
 
 #include <boost/math/special_functions/sign.hpp>
 
@@ -186,6 +187,113 @@ void CmrT2Mapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, con
     }
 }
 
+template <typename T>
+bool CmrT2Mapping<T>::supports_batched_fitting() const
+{
+    return true;
+}
+
+template <typename T>
+void CmrT2Mapping<T>::compute_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    size_t num = ti.size();
+    GADGET_CHECK_THROW(num>0);
+
+    size_t l, n;
+
+    T* A = bi;
+    T* B = bi + batch_size;
+
+    // same initial guess as get_initial_guess: a log linear fit, unless a sample is not positive
+    for (l = 0; l < batch_size; l++)
+    {
+        T default_A = yi[l];
+        for (n = 1; n < num; n++) default_A = std::max(default_A, yi[n*batch_size + l]);
+        T default_T2 = ti[num / 2];
+
+        A[l] = default_A;
+        B[l] = default_T2;
+
+        T sx(0), sy(0), sxx(0), sxy(0);
+        bool positive = true;
+        for (n = 0; n < num; n++)
+        {
+            T y = yi[n*batch_size + l];
+            if (y <= 0)
+            {
+                positive = false;
+                break;
+            }
+
+            T log_y = std::log(y);
+            sx += ti[n];
+            sy += log_y;
+            sxx += ti[n] * ti[n];
+            sxy += ti[n] * log_y;
+        }
+
+        T den = num * sxx - sx * sx;
+        if (!positive || den == 0) continue;
+
+        T a = (num * sxy - sx * sy) / den;
+        T b = (sy - a * sx) / num;
+
+        if (-1 / a > 0)
+        {
+            A[l] = std::exp(b);
+            B[l] = -1 / a;
+        }
+    }
+
+    this->refine_map_batch(ti, yi, num_pixels, max_iter_, bi, map_v, sd, map_sd);
+}
+
+template <typename T>
+void CmrT2Mapping<T>::refine_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, size_t max_iter, T* bi, T* map_v, T* sd, T* map_sd)
+{
+    size_t l;
+
+    T* A = bi;
+    T* B = bi + batch_size;
+
+    fit_two_parameter_batch<T, ExpDecayModel<T>, batch_size>(ti.data(), ti.size(), yi, A, B, max_iter,
+        compute_SD_maps_ ? sd : nullptr, compute_SD_maps_ ? sd + batch_size : nullptr);
+
+    for (l = 0; l < batch_size; l++)
+    {
+        map_v[l] = 0;
+        if (A[l] > 0 && B[l] > 0)
+        {
+            map_v[l] = B[l];
+            if (map_v[l] >= max_map_value_) map_v[l] = hole_marking_value_;
+            if (map_v[l] <= min_map_value_) map_v[l] = hole_marking_value_;
+        }
+
+        if (compute_SD_maps_)
+        {
+            map_sd[l] = sd[batch_size + l];
+            if (map_sd[l] > max_map_value_) map_sd[l] = this->hole_marking_value_;
+        }
+    }
+}
+
+template <typename T>
+bool CmrT2Mapping<T>::supports_dictionary_matching() const
+{
+    return true;
+}
+
+template <typename T>
+void CmrT2Mapping<T>::compute_dictionary_atom(const VectorType& ti, T map_v, T* signal) const
+{
+    T rb = 1 / map_v;
+    T dA, dB;
+    for (size_t n = 0; n < ti.size(); n++)
+    {
+        ExpDecayModel<T>::evaluate(ti[n], T(1), rb, signal[n], dA, dB);
+    }
+}
+
 template <typename T>
 size_t CmrT2Mapping<T>::get_num_of_paras() const
 {
@@ -49,6 +49,15 @@ public:
     /// compute SD values for every parameters in bi
     virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
+    /// fit a batch of pixels by Levenberg-Marquardt, see cmr_batched_fitting.h
+    virtual bool supports_batched_fitting() const;
+    virtual void compute_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, T* bi, T* map_v, T* sd, T* map_sd);
+    virtual void refine_map_batch(const VectorType& ti, const T* yi, size_t num_pixels, size_t max_iter, T* bi, T* map_v, T* sd, T* map_sd);
+
+    /// dictionary atoms are the signal for A = 1
+    virtual bool supports_dictionary_matching() const;
+    virtual void compute_dictionary_atom(const VectorType& ti, T map_v, T* signal) const;
+
     /// two parameters, A, T1
     virtual size_t get_num_of_paras() const;
 
@@ -60,6 +69,12 @@ public:
     using BaseClass::max_size_of_holes_;
     using BaseClass::hole_marking_value_;
     using BaseClass::compute_SD_maps_;
+    using BaseClass::batched_fitting_;
+    using BaseClass::batch_size;
+    using BaseClass::dictionary_matching_;
+    using BaseClass::dictionary_size_;
+    using BaseClass::dictionary_min_map_value_;
+    using BaseClass::dictionary_refinement_iter_;
     using BaseClass::mask_for_mapping_;
     using BaseClass::ti_;
     using BaseClass::data_;
@@ -0,0 +1,354 @@
+#include "hoMemoryPool.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Gadgetron::MemoryPool {
+
+    namespace {
+
+        /**
+         * Bookkeeping stored in front of every block. It occupies exactly one alignment unit, so the
+         * payload stays aligned. The links are only used while the block is cached.
+         */
+        struct alignas(alignment) Header {
+            size_t requested;
+            size_t size_class;
+            Header* lru_prev;
+            Header* lru_next;
+            Header* class_prev;
+            Header* class_next;
+        };
+
+        static_assert(sizeof(Header) == alignment);
+
+        // Four size classes per power of two, starting at 256 bytes, bounds the rounding waste to 25%.
+        constexpr size_t smallest_class_log2 = 8;
+        constexpr size_t classes_per_octave = 4;
+        constexpr size_t largest_allocation_log2 = 48;
+        constexpr size_t number_of_classes = classes_per_octave * (largest_allocation_log2 - smallest_class_log2) + 1;
+
+        // Blocks up to this size may be kept in the allocating thread's cache.
+        constexpr size_t thread_cache_max_block = size_t(1) << 20;
+        constexpr size_t thread_cache_max_blocks = 8;
+        constexpr size_t thread_cache_max_bytes = size_t(16) << 20;
+
+        constexpr size_t default_cache_limit = size_t(1) << 30;
+
+        size_t floor_log2(size_t value) {
+            size_t result = 0;
+            while (value >>= 1)
+                result++;
+            return result;
+        }
+
+        size_t size_class(size_t bytes) {
+            if (bytes <= (size_t(1) << smallest_class_log2))
+                return 0;
+            size_t octave = floor_log2(bytes - 1);
+            size_t base = size_t(1) << octave;
+            size_t quarter = base / classes_per_octave;
+            size_t step = (bytes - base + quarter - 1) / quarter;
+            return (octave - smallest_class_log2) * classes_per_octave + step;
+        }
+
+        size_t class_bytes(size_t size_class) {
+            size_t octave = size_class / classes_per_octave + smallest_class_log2;
+            size_t step = size_class % classes_per_octave;
+            return ((classes_per_octave + step) << octave) / classes_per_octave;
+        }
+
+        struct Counters {
+            std::atomic<size_t> allocations{ 0 };
+            std::atomic<size_t> deallocations{ 0 };
+            std::atomic<size_t> reused{ 0 };
+            std::atomic<size_t> system_allocations{ 0 };
+            std::atomic<size_t> bytes_in_use{ 0 };
+            std::atomic<size_t> peak_bytes_in_use{ 0 };
+            std::atomic<size_t> bytes_cached{ 0 };
+            std::atomic<size_t> cache_limit{ default_cache_limit };
+        };
+
+        Counters& counters() {
+            static Counters instance;
+            return instance;
+        }
+
+        void update_peak(size_t in_use) {
+            auto& peak = counters().peak_bytes_in_use;
+            size_t current = peak.load(std::memory_order_relaxed);
+            while (current < in_use && !peak.compare_exchange_weak(current, in_use, std::memory_order_relaxed)) {}
+        }
+
+        Header* system_allocate(size_t size_class) {
+            auto block = std::aligned_alloc(alignment, sizeof(Header) + class_bytes(size_class));
+            if (block)
+                counters().system_allocations.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<Header*>(block);
+        }
+
+        void system_free(Header* header) {
+            std::free(header);
+        }
+
+        /**
+         * Process-wide pool of free blocks. Blocks are linked both into a list per size class, for reuse,
+         * and into a single recency list, so the oldest blocks are released first when over the limit.
+         */
+        class SharedPool {
+        public:
+            Header* take(size_t size_class) {
+                std::lock_guard<std::mutex> guard(m);
+                Header* header = classes[size_class];
+                if (!header)
+                    return nullptr;
+                unlink(header);
+                return header;
+            }
+
+            void put(Header* header) {
+                const size_t limit = counters().cache_limit.load(std::memory_order_relaxed);
+                const size_t size = class_bytes(header->size_class);
+                if (size > limit) {
+                    system_free(header);
+                    return;
+                }
+
+                std::vector<Header*> evicted;
+                {
+                    std::lock_guard<std::mutex> guard(m);
+                    link(header);
+                    while (bytes > limit) {
+                        Header* oldest = lru_tail;
+                        unlink(oldest);
+                        evicted.push_back(oldest);
+                    }
+                }
+                for (auto block : evicted)
+                    system_free(block);
+            }
+
+            void release() {
+                std::lock_guard<std::mutex> guard(m);
+                while (lru_tail) {
+                    Header* oldest = lru_tail;
+                    unlink(oldest);
+                    system_free(oldest);
+                }
+            }
+
+        private:
+            void link(Header* header) {
+                header->class_prev = nullptr;
+                header->class_next = classes[header->size_class];
+                if (header->class_next)
+                    header->class_next->class_prev = header;
+                classes[header->size_class] = header;
+
+                header->lru_prev = nullptr;
+                header->lru_next = lru_head;
+                if (lru_head)
+                    lru_head->lru_prev = header;
+                lru_head = header;
+                if (!lru_tail)
+                    lru_tail = header;
+
+                const size_t size = class_bytes(header->size_class);
+                bytes += size;
+                counters().bytes_cached.fetch_add(size, std::memory_order_relaxed);
+            }
+
+            void unlink(Header* header) {
+                if (header->class_prev)
+                    header->class_prev->class_next = header->class_next;
+                else
+                    classes[header->size_class] = header->class_next;
+                if (header->class_next)
+                    header->class_next->class_prev = header->class_prev;
+
+                if (header->lru_prev)
+                    header->lru_prev->lru_next = header->lru_next;
+                else
+                    lru_head = header->lru_next;
+                if (header->lru_next)
+                    header->lru_next->lru_prev = header->lru_prev;
+                else
+                    lru_tail = header->lru_prev;
+
+                const size_t size = class_bytes(header->size_class);
+                bytes -= size;
+                counters().bytes_cached.fetch_sub(size, std::memory_order_relaxed);
+            }
+
+            std::mutex m;
+            std::array<Header*, number_of_classes> classes{};
+            Header* lru_head = nullptr;
+            Header* lru_tail = nullptr;
+            size_t bytes = 0;
+        };
+
+        SharedPool& shared_pool() {
+            // Never destroyed; thread caches flush into it from thread_local destructors, which may run after
+            // static destruction has started.
+            static auto pool = new SharedPool();
+            return *pool;
+        }
+
+        /**
+         * Per-thread cache of small blocks, which are reused without taking the shared pool's lock.
+         */
+        class ThreadCache {
+        public:
+            ~ThreadCache() {
+                flush();
+                destroyed = true;
+            }
+
+            Header* take(size_t size_class) {
+                Header* header = classes[size_class];
+                if (!header)
+                    return nullptr;
+                classes[size_class] = header->class_next;
+                counts[size_class]--;
+                bytes -= class_bytes(size_class);
+                counters().bytes_cached.fetch_sub(class_bytes(size_class), std::memory_order_relaxed);
+                return header;
+            }
+
+            bool put(Header* header) {
+                const size_t size = class_bytes(header->size_class);
+                if (destroyed || size > thread_cache_max_block || counts[header->size_class] >= thread_cache_max_blocks ||
+                    bytes + size > thread_cache_max_bytes ||
+                    bytes + size > counters().cache_limit.load(std::memory_order_relaxed))
+                    return false;
+
+                header->class_next = classes[header->size_class];
+                classes[header->size_class] = header;
+                counts[header->size_class]++;
+                bytes += size;
+                counters().bytes_cached.fetch_add(size, std::memory_order_relaxed);
+                return true;
+            }
+
+            void flush() {
+                for (size_t size_class = 0; size_class < number_of_classes; size_class++) {
+                    while (auto header = take(size_class))
+                        shared_pool().put(header);
+                }
+            }
+
+        private:
+            std::array<Header*, number_of_classes> classes{};
+            std::array<unsigned char, number_of_classes> counts{};
+            size_t bytes = 0;
+            bool destroyed = false;
+        };
+
+        thread_local ThreadCache thread_cache;
+        thread_local size_t uninitialized_depth = 0;
+        thread_local size_t thread_bytes_allocated = 0;
+
+        Header* header_of(const void* ptr) {
+            return static_cast<Header*>(const_cast<void*>(ptr)) - 1;
+        }
+    }
+
+    void* allocate(size_t bytes) {
+        if (bytes > (size_t(1) << largest_allocation_log2))
+            throw std::bad_alloc();
+
+        const size_t size_class = MemoryPool::size_class(bytes);
+
+        Header* header = thread_cache.take(size_class);
+        if (!header)
+            header = shared_pool().take(size_class);
+
+        if (header) {
+            counters().reused.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            header = system_allocate(size_class);
+            if (!header) {
+                // Free blocks of other sizes may be what stands between us and success.
+                trim();
+                header = system_allocate(size_class);
+            }
+            if (!header)
+                throw std::bad_alloc();
+        }
+
+        header->requested = bytes;
+        header->size_class = size_class;
+
+        auto& stats = counters();
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        update_peak(stats.bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        thread_bytes_allocated += bytes;
+
+        return header + 1;
+    }
+
+    void deallocate(void* ptr) {
+        if (!ptr)
+            return;
+
+        Header* header = header_of(ptr);
+        auto& stats = counters();
+        stats.deallocations.fetch_add(1, std::memory_order_relaxed);
+        stats.bytes_in_use.fetch_sub(header->requested, std::memory_order_relaxed);
+
+        if (!thread_cache.put(header))
+            shared_pool().put(header);
+    }
+
+    size_t allocated_size(const void* ptr) {
+        return ptr ? header_of(ptr)->requested : 0;
+    }
+
+    void set_cache_limit(size_t bytes) {
+        counters().cache_limit.store(bytes, std::memory_order_relaxed);
+        if (counters().bytes_cached.load(std::memory_order_relaxed) > bytes)
+            trim();
+    }
+
+    size_t get_cache_limit() {
+        return counters().cache_limit.load(std::memory_order_relaxed);
+    }
+
+    void trim() {
+        thread_cache.flush();
+        shared_pool().release();
+    }
+
+    Statistics statistics() {
+        auto& stats = counters();
+        return Statistics{
+            stats.allocations.load(std::memory_order_relaxed),
+            stats.deallocations.load(std::memory_order_relaxed),
+            stats.reused.load(std::memory_order_relaxed),
+            stats.system_allocations.load(std::memory_order_relaxed),
+            stats.bytes_in_use.load(std::memory_order_relaxed),
+            stats.peak_bytes_in_use.load(std::memory_order_relaxed),
+            stats.bytes_cached.load(std::memory_order_relaxed)
+        };
+    }
+
+    size_t thread_allocated_bytes() {
+        return thread_bytes_allocated;
+    }
+
+    bool initialize_allocations() {
+        return uninitialized_depth == 0;
+    }
+
+    UninitializedScope::UninitializedScope() {
+        uninitialized_depth++;
+    }
+
+    UninitializedScope::~UninitializedScope() {
+        uninitialized_depth--;
+    }
+}
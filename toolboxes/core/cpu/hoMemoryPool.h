@@ -0,0 +1,83 @@
+/** \file hoMemoryPool.h
+    \brief Aligned, pooled storage backend for hoNDArray.
+
+    Every block is aligned to MemoryPool::alignment bytes, which suits FFTW and wide SIMD loads. Freed
+    blocks are rounded to a size class and kept for reuse: small blocks in a per-thread cache, larger
+    ones in a process-wide pool which releases the least recently freed blocks once the cache limit is
+    exceeded. Reused blocks are already faulted in, so large k-space buffers allocated for every series
+    avoid both the page faults and the trip through the system allocator.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace Gadgetron::MemoryPool {
+
+    constexpr size_t alignment = 64;
+
+    struct Statistics {
+        size_t allocations;
+        size_t deallocations;
+        /** Allocations served from the thread cache or the shared pool. */
+        size_t reused;
+        /** Allocations that had to go to the system allocator. */
+        size_t system_allocations;
+        size_t bytes_in_use;
+        size_t peak_bytes_in_use;
+        /** Bytes held in free blocks, available for reuse. */
+        size_t bytes_cached;
+    };
+
+    /**
+     * Allocates at least bytes of storage aligned to alignment. Throws std::bad_alloc on failure.
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * Returns storage obtained from allocate to the pool. Null pointers are ignored.
+     */
+    void deallocate(void* ptr);
+
+    /**
+     * Size in bytes requested when ptr was allocated.
+     */
+    size_t allocated_size(const void* ptr);
+
+    /**
+     * Upper bound on the bytes kept in free blocks. Setting it to zero disables pooling.
+     */
+    void set_cache_limit(size_t bytes);
+    size_t get_cache_limit();
+
+    /**
+     * Releases the free blocks of the shared pool and of the calling thread's cache to the system.
+     */
+    void trim();
+
+    Statistics statistics();
+
+    /**
+     * Total bytes allocated by the calling thread since it started, for attributing allocations to the work it does.
+     */
+    size_t thread_allocated_bytes();
+
+    /**
+     * Whether hoNDArray should default-construct the elements of new arrays; false inside an UninitializedScope.
+     */
+    bool initialize_allocations();
+
+    /**
+     * While alive, arrays of trivially copyable element types (including std::complex and complext) created on
+     * the calling thread are left uninitialized rather than zeroed. Use it for buffers that are fully overwritten
+     * right after allocation.
+     */
+    class UninitializedScope {
+    public:
+        UninitializedScope();
+        ~UninitializedScope();
+
+        UninitializedScope(const UninitializedScope&) = delete;
+        UninitializedScope& operator=(const UninitializedScope&) = delete;
+    };
+}
@@ -7,8 +7,12 @@
 #include "NDArray.h"
 #include "complext.h"
 #include "vector_td.h"
+#include "hoMemoryPool.h"
 #include <type_traits>
 #include <boost/shared_ptr.hpp>
+#include <limits>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <type_traits>
 
@@ -279,15 +283,38 @@ namespace Gadgetron{
 
     // Generic allocator / deallocator
     //
+    // Storage comes from the aligned MemoryPool. Elements are default-constructed as with new X[], except
+    // for trivially copyable types inside a MemoryPool::UninitializedScope, which are left uninitialized.
 
     template<class X> void _allocate_memory( size_t size, X** data )
     {
-      *data = new X[size];
+      static_assert(alignof(X) <= MemoryPool::alignment, "hoNDArray element type is over-aligned");
+
+      if (size > std::numeric_limits<size_t>::max() / sizeof(X))
+        throw std::bad_array_new_length();
+
+      X* memory = static_cast<X*>(MemoryPool::allocate(size * sizeof(X)));
+
+      if constexpr (!std::is_trivially_default_constructible_v<X>) {
+        constexpr bool may_skip = std::is_trivially_copyable_v<X> && std::is_trivially_destructible_v<X>;
+        if (!may_skip || MemoryPool::initialize_allocations()) {
+          try {
+            std::uninitialized_default_construct_n(memory, size);
+          } catch (...) {
+            MemoryPool::deallocate(memory);
+            throw;
+          }
+        }
+      }
+
+      *data = memory;
     }
 
     template<class X> void _deallocate_memory( X* data )
     {
-      delete [] data;
+      if constexpr (!std::is_trivially_destructible_v<X>)
+        std::destroy_n(data, MemoryPool::allocated_size(data) / sizeof(X));
+      MemoryPool::deallocate(data);
     }
 
 
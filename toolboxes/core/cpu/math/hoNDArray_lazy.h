@@ -0,0 +1,271 @@
+/** \file   hoNDArray_lazy.h
+    \brief  Lazily evaluated element-wise expressions on the hoNDArray class.
+
+    The functions of hoNDArray_elemwise.h each make a pass over memory and most of them allocate their result, so
+    an expression like a * conj(b) + c makes three passes and two temporary arrays. Here the same expression is
+    written
+
+        lazy(r) = lazy(a) * conj(lazy(b)) + c;
+
+    Nothing is computed until the expression is assigned to lazy(r); it is then evaluated in a single OpenMP
+    parallel loop over the elements, without temporaries. Arrays and scalars combined with an expression are wrapped
+    automatically, so only one operand of each operator needs to be lazy. The functions conj, abs, norm, real, imag,
+    arg, sqrt and exp take expressions; called on a plain hoNDArray they are the eager ones.
+
+    All arrays in an expression must have the same number of elements; unlike the operators of hoNDArray_elemwise.h
+    there is no batching over trailing dimensions. lazy(r) = ... creates r with the dimensions of the first array in
+    the expression if it holds a different number of elements; r may appear in the expression itself.
+    An expression refers to its arrays, so it must not outlive them.
+ */
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "complext.h"
+
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Gadgetron {
+
+    namespace Lazy {
+
+        // std::complex is evaluated as complext, whose arithmetic the compiler vectorizes
+        template <class T> struct internal_type { typedef T type; };
+        template <class T> struct internal_type<std::complex<T>> { typedef complext<T> type; };
+        template <class T> using internal_type_t = typename internal_type<T>::type;
+
+        struct ExpressionBase {};
+
+        template <class E> struct Expression : ExpressionBase {
+            const E& self() const { return static_cast<const E&>(*this); }
+        };
+
+        template <class T> constexpr bool is_expression_v = std::is_base_of_v<ExpressionBase, T>;
+
+        template <class T> class Array : public Expression<Array<T>> {
+        public:
+            typedef internal_type_t<T> value_type;
+
+            explicit Array(const hoNDArray<T>& array)
+                : array(&array), values(reinterpret_cast<const value_type*>(array.get_data_ptr())) {}
+
+            value_type operator[](size_t i) const { return values[i]; }
+
+            /// Dimensions of the first array in the expression, null if it holds none.
+            const std::vector<size_t>* dimensions() const { return &array->dimensions(); }
+
+            bool has_size(size_t size) const { return array->get_number_of_elements() == size; }
+
+        protected:
+            const hoNDArray<T>* array;
+            const value_type* values;
+        };
+
+        template <class T> class Scalar : public Expression<Scalar<T>> {
+        public:
+            typedef internal_type_t<T> value_type;
+
+            explicit Scalar(const T& value) : value(value) {}
+
+            value_type operator[](size_t) const { return value; }
+
+            const std::vector<size_t>* dimensions() const { return nullptr; }
+
+            bool has_size(size_t) const { return true; }
+
+        private:
+            value_type value;
+        };
+
+        template <class F, class E> class Unary : public Expression<Unary<F, E>> {
+        public:
+            typedef std::decay_t<std::invoke_result_t<F, typename E::value_type>> value_type;
+
+            explicit Unary(const E& e) : e(e) {}
+
+            value_type operator[](size_t i) const { return F{}(e[i]); }
+
+            const std::vector<size_t>* dimensions() const { return e.dimensions(); }
+
+            bool has_size(size_t size) const { return e.has_size(size); }
+
+        private:
+            E e;
+        };
+
+        template <class F, class L, class R> class Binary : public Expression<Binary<F, L, R>> {
+        public:
+            typedef std::decay_t<std::invoke_result_t<F, typename L::value_type, typename R::value_type>> value_type;
+
+            Binary(const L& l, const R& r) : l(l), r(r) {}
+
+            value_type operator[](size_t i) const { return F{}(l[i], r[i]); }
+
+            const std::vector<size_t>* dimensions() const {
+                auto dims = l.dimensions();
+                return dims ? dims : r.dimensions();
+            }
+
+            bool has_size(size_t size) const { return l.has_size(size) && r.has_size(size); }
+
+        private:
+            L l;
+            R r;
+        };
+
+        // Operands of an expression: expressions as they are, arrays wrapped in Array, anything else a Scalar
+        template <class T, class = void> struct operand_type { typedef Scalar<T> type; };
+        template <class T> struct operand_type<T, std::enable_if_t<is_expression_v<T>>> { typedef T type; };
+        template <class T> struct operand_type<hoNDArray<T>> { typedef Array<T> type; };
+        template <class T> using operand_type_t = typename operand_type<T>::type;
+
+        template <class T> operand_type_t<T> operand(const T& value) { return operand_type_t<T>(value); }
+
+        template <class L, class R>
+        constexpr bool is_expression_operands_v = is_expression_v<L> || is_expression_v<R>;
+
+        template <class L, class R, class = std::enable_if_t<is_expression_operands_v<L, R>>>
+        auto operator+(const L& l, const R& r) {
+            return Binary<std::plus<>, operand_type_t<L>, operand_type_t<R>>(operand(l), operand(r));
+        }
+
+        template <class L, class R, class = std::enable_if_t<is_expression_operands_v<L, R>>>
+        auto operator-(const L& l, const R& r) {
+            return Binary<std::minus<>, operand_type_t<L>, operand_type_t<R>>(operand(l), operand(r));
+        }
+
+        template <class L, class R, class = std::enable_if_t<is_expression_operands_v<L, R>>>
+        auto operator*(const L& l, const R& r) {
+            return Binary<std::multiplies<>, operand_type_t<L>, operand_type_t<R>>(operand(l), operand(r));
+        }
+
+        template <class L, class R, class = std::enable_if_t<is_expression_operands_v<L, R>>>
+        auto operator/(const L& l, const R& r) {
+            return Binary<std::divides<>, operand_type_t<L>, operand_type_t<R>>(operand(l), operand(r));
+        }
+
+        template <class E> auto operator-(const Expression<E>& e) { return Unary<std::negate<>, E>(e.self()); }
+
+        namespace Functions {
+            struct Conj {
+                template <class T> auto operator()(const T& x) const { using Gadgetron::conj; return conj(x); }
+            };
+            struct Abs {
+                template <class T> auto operator()(const T& x) const { using std::abs; using Gadgetron::abs; return abs(x); }
+            };
+            struct Norm {
+                template <class T> auto operator()(const T& x) const { using Gadgetron::norm; return norm(x); }
+            };
+            struct Real {
+                template <class T> auto operator()(const T& x) const { using Gadgetron::real; return real(x); }
+            };
+            struct Imag {
+                template <class T> auto operator()(const T& x) const { using Gadgetron::imag; return imag(x); }
+            };
+            struct Arg {
+                template <class T> auto operator()(const T& x) const { using std::arg; using Gadgetron::arg; return arg(x); }
+            };
+            struct Sqrt {
+                template <class T> auto operator()(const T& x) const { using std::sqrt; using Gadgetron::sqrt; return sqrt(x); }
+            };
+            struct Exp {
+                template <class T> auto operator()(const T& x) const { using std::exp; using Gadgetron::exp; return exp(x); }
+            };
+        }
+
+        template <class E> auto conj(const Expression<E>& e) { return Unary<Functions::Conj, E>(e.self()); }
+        template <class E> auto abs(const Expression<E>& e) { return Unary<Functions::Abs, E>(e.self()); }
+        template <class E> auto norm(const Expression<E>& e) { return Unary<Functions::Norm, E>(e.self()); }
+        template <class E> auto real(const Expression<E>& e) { return Unary<Functions::Real, E>(e.self()); }
+        template <class E> auto imag(const Expression<E>& e) { return Unary<Functions::Imag, E>(e.self()); }
+        template <class E> auto arg(const Expression<E>& e) { return Unary<Functions::Arg, E>(e.self()); }
+        template <class E> auto sqrt(const Expression<E>& e) { return Unary<Functions::Sqrt, E>(e.self()); }
+        template <class E> auto exp(const Expression<E>& e) { return Unary<Functions::Exp, E>(e.self()); }
+
+        /**
+         * An array an expression is assigned to. It is an expression itself, so it may appear on both sides.
+         */
+        template <class T> class Target : public Array<T> {
+        public:
+            typedef internal_type_t<T> value_type;
+
+            explicit Target(hoNDArray<T>& array) : Array<T>(array), target(&array) {}
+
+            Target(const Target&) = default;
+
+            Target& operator=(const Target& other) {
+                assign(other, [](value_type& y, const auto& v) { y = v; }, true);
+                return *this;
+            }
+
+            template <class X> Target& operator=(const X& x) {
+                assign(operand(x), [](value_type& y, const auto& v) { y = v; }, true);
+                return *this;
+            }
+
+            template <class X> Target& operator+=(const X& x) {
+                assign(operand(x), [](value_type& y, const auto& v) { y += v; }, false);
+                return *this;
+            }
+
+            template <class X> Target& operator-=(const X& x) {
+                assign(operand(x), [](value_type& y, const auto& v) { y -= v; }, false);
+                return *this;
+            }
+
+            template <class X> Target& operator*=(const X& x) {
+                assign(operand(x), [](value_type& y, const auto& v) { y *= v; }, false);
+                return *this;
+            }
+
+            template <class X> Target& operator/=(const X& x) {
+                assign(operand(x), [](value_type& y, const auto& v) { y /= v; }, false);
+                return *this;
+            }
+
+        private:
+            template <class E, class OP> void assign(const E& e, OP op, bool resize) {
+                const std::vector<size_t>* dims = e.dimensions();
+                size_t size = target->get_number_of_elements();
+                if (dims) {
+                    size = 1;
+                    for (auto d : *dims) size *= d;
+                }
+
+                if (!e.has_size(size))
+                    throw std::runtime_error("lazy: arrays in the expression have different numbers of elements");
+
+                if (target->get_number_of_elements() != size) {
+                    if (!resize)
+                        throw std::runtime_error("lazy: target and expression have different numbers of elements");
+                    target->create(*dims);
+                }
+
+                value_type* values = reinterpret_cast<value_type*>(target->get_data_ptr());
+                long long N = (long long)size;
+
+#pragma omp parallel for simd if (N > 64 * 1024)
+                for (long long n = 0; n < N; n++) {
+                    op(values[n], e[n]);
+                }
+            }
+
+            hoNDArray<T>* target;
+        };
+    }
+
+    /**
+     * Wraps an array as the start of a lazily evaluated expression.
+     */
+    template <class T> Lazy::Array<T> lazy(const hoNDArray<T>& array) { return Lazy::Array<T>(array); }
+
+    /**
+     * Wraps an array so that an expression can be assigned to it, or used in one.
+     */
+    template <class T> Lazy::Target<T> lazy(hoNDArray<T>& array) { return Lazy::Target<T>(array); }
+}
@@ -3,6 +3,7 @@
 #include "vector_td_utilities.h"
 #include <GadgetronTimer.h>
 #include "hoArmadillo.h"
+#include <algorithm>
 #include <numeric>
 
 namespace Gadgetron {
@@ -36,23 +37,69 @@ namespace Gadgetron {
             };
 
 
+            /**
+             * The patches most similar to the patch of (kx, ky), among the patches centred in its search window, as
+             * (distance, index of the patch centre) pairs sorted by distance.
+             *
+             * Only pixels still in the mask get here, typically around a tenth of the image, so the distances are summed
+             * straight from the image rather than through the summed-area tables non-local means uses for every pixel.
+             */
             template<class T>
-            std::vector<ImagePatch<T>>
-            create_patches(const hoNDArray<T> &image, int kx, int ky, int patch_size, int search_window,
-                           const vector_td<int, 2> &image_dims) {
+            std::vector<std::pair<float, int>>
+            find_nearest_patches(const hoNDArray<T> &image, int kx, int ky, int patch_size, int search_window,
+                                 int n_patches, const vector_td<int, 2> &image_dims) {
 
-                std::vector<ImagePatch<T>> result;
-                result.reserve(search_window);
+                const arma::Col<T> reference = get_patch(image, kx, ky, patch_size, image_dims);
+
+                std::vector<std::pair<float, int>> nearest;
+                nearest.reserve(n_patches);
 
                 for (int dy = std::max(ky - search_window / 2, 0);
                      dy < std::min(search_window / 2 + ky, image_dims[1]); dy++) {
                     for (int dx = std::max(kx - search_window / 2, 0);
                          dx < std::min(search_window / 2 + kx, image_dims[0]); dx++) {
 
-                        result.push_back(ImagePatch<T>{get_patch(image, dx, dy, patch_size, image_dims), dx, dy});
+                        float distance = 0;
+                        for (int py = 0; py < patch_size; py++) {
+                            const T *row = &image(0, ((py - patch_size / 2) + dy + image_dims[1]) % image_dims[1]);
+                            for (int px = 0; px < patch_size; px++)
+                                distance += std::norm(reference[px + py * patch_size] -
+                                                      row[((px - patch_size / 2) + dx + image_dims[0]) % image_dims[0]]);
+                        }
+
+                        auto candidate = std::make_pair(distance, dx + dy * image_dims[0]);
+                        if (int(nearest.size()) < n_patches) {
+                            nearest.push_back(candidate);
+                            std::push_heap(nearest.begin(), nearest.end());
+                        } else if (candidate.first < nearest.front().first) {
+                            std::pop_heap(nearest.begin(), nearest.end());
+                            nearest.back() = candidate;
+                            std::push_heap(nearest.begin(), nearest.end());
+                        }
                     }
                 }
 
+                std::sort_heap(nearest.begin(), nearest.end());
+                return nearest;
+            }
+
+
+            template<class T>
+            std::vector<ImagePatch<T>>
+            create_patches(const hoNDArray<T> &image, int kx, int ky, int patch_size, int search_window, int n_patches,
+                           const vector_td<int, 2> &image_dims) {
+
+                auto nearest = find_nearest_patches(image, kx, ky, patch_size, search_window, n_patches, image_dims);
+
+                std::vector<ImagePatch<T>> result;
+                result.reserve(nearest.size());
+
+                for (auto &candidate : nearest) {
+                    int dx = candidate.second % image_dims[0];
+                    int dy = candidate.second / image_dims[0];
+                    result.push_back(ImagePatch<T>{get_patch(image, dx, dy, patch_size, image_dims), dx, dy});
+                }
+
                 return result;
 
             };
@@ -75,17 +122,6 @@ namespace Gadgetron {
             };
 
 
-            template<class T>
-            float distance(const arma::Col<T> &patch1, const arma::Col<T> &patch2) {
-                arma::Col<T> diff = patch1 - patch2;
-
-                float result = 0;
-                for (auto d : diff) result += std::norm(d);
-
-                result /= patch1.size() * patch1.size();
-                return result;
-            };
-
             template<class T>
             arma::Col<T> get_mean_patch(const std::vector<ImagePatch<T>> &patches) {
 
@@ -115,30 +151,6 @@ namespace Gadgetron {
             }
 
 
-            template<class T>
-            void
-            filter_patches(std::vector<ImagePatch<T>> &patches, int max_n_patches, const arma::Col<T> &reference_patch) {
-
-                auto distances = std::vector<float>(patches.size());
-                transform(patches.begin(), patches.end(), distances.begin(),
-                          [&](auto patch) { return distance(patch.patch, reference_patch); });
-
-                std::vector<size_t> patch_indices(patches.size());
-                std::iota(patch_indices.begin(), patch_indices.end(), 0);
-
-                sort(patch_indices.begin(), patch_indices.end(),
-                     [&](auto v1, auto v2) { return distances[v1] < distances[v2]; });
-
-                int n_patches = std::min<int>(patches.size(),max_n_patches);
-                std::vector<ImagePatch<T>> best_patches(n_patches);
-
-                for (int i = 0; i < n_patches; i++) {
-                    best_patches[i] = std::move(patches[patch_indices[i]]);
-                }
-
-                patches = std::move(best_patches);
-            }
-
             template<class T>
             bool is_homogenous_area(std::vector<ImagePatch<T>> &patches, float noise_std) {
 
@@ -199,14 +211,13 @@ namespace Gadgetron {
                 );
 
 #pragma omp parallel for num_threads(4)
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
+                for (int ky = 0; ky < image_dims[1]; ky++) {
+                    for (int kx = 0; kx < image_dims[0]; kx++) {
 
                         if (mask(kx, ky)) {
-                            auto reference_patch = get_patch(image, kx, ky, patch_size, image_dims);
-                            auto patches = create_patches(image, kx, ky, patch_size, search_window, image_dims);
+                            auto patches = create_patches(image, kx, ky, patch_size, search_window, n_patches,
+                                                          image_dims);
 
-                            filter_patches(patches, n_patches, reference_patch);
                             denoise_patches(patches, noise_std);
 
                             for (auto &patch : patches) {
@@ -237,13 +248,11 @@ namespace Gadgetron {
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                hoNDArray<T> result_view;
-                result_view.create(image_dims);
                 #pragma omp parallel for
                 for (int i = 0; i < n_images; i++) {
 
                     auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
+                    auto result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
 
                     memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
                 }
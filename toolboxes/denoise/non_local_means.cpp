@@ -2,9 +2,12 @@
 // Created by dchansen on 6/19/18.
 //
 
-#include <vector_td_utilities.h>
 #include <GadgetronTimer.h>
 #include "non_local_means.h"
+#include "patch_distances.h"
+
+#include <algorithm>
+#include <cmath>
 
 
 namespace Gadgetron {
@@ -13,56 +16,56 @@ namespace Gadgetron {
         namespace {
 
 
-            template<class T, int D>
-            vector_td<T, D * D> get_patch(const hoNDArray<T> &image, int x, int y,
-                                          const vector_td<int, 2> &image_dims) {
-
-                constexpr int N = D * D;
-                vector_td<T, N> window;
-                for (int ky = 0; ky < D; ky++) {
-                    for (int kx = 0; kx < D; kx++) {
-                        window[kx + ky * D] = image(((kx - D / 2) + x + image_dims[0]) % image_dims[0],
-                                                    ((ky - D / 2) + y + image_dims[1]) % image_dims[1]);
-
-                    }
-                }
-                return window;
-            };
-
-
             template<class T>
             hoNDArray<T> non_local_means_single_image(const hoNDArray<T> &image, float noise_std, int search_radius) {
 
                 constexpr int D = 5;
+                constexpr int strip_height = 16;
 
                 hoNDArray<T> result(image.dimensions());
                 const float noise_std2 = noise_std * noise_std;
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions()));
-
-#pragma omp parallel for
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
-                        float sum_weight = 0;
-                        T sum_value = 0;
-                        auto window = get_patch<T, D>(image, kx, ky, image_dims);
-
-                        for (int dy = -int(search_radius); dy < search_radius; dy++) {
-                            for (int dx = -int(search_radius); dx < search_radius; dx++) {
-
-                                auto window2 = get_patch<T, D>(image, kx + dx, ky + dy, image_dims);
-                                auto diff = window - window2;
-                                auto weight = std::exp(-norm_squared(diff) / (noise_std2 * D * D));
-
-                                sum_weight += weight;
-                                sum_value += weight * window2[D / 2 + D * (D / 2)];
-
+                const int width = image.get_size(0);
+                const int height = image.get_size(1);
+                const int n_strips = (height + strip_height - 1) / strip_height;
+
+                // Each strip of rows accumulates the weights of all offsets in the search window for its own pixels
+#pragma omp parallel for schedule(dynamic)
+                for (int strip = 0; strip < n_strips; strip++) {
+                    const int y_begin = strip * strip_height;
+                    const int y_end = std::min(y_begin + strip_height, height);
+                    const size_t strip_elements = size_t(y_end - y_begin) * width;
+
+                    PatchDistances<T> patch_distances(image, D, y_begin, y_end);
+                    std::vector<float> sum_weight(strip_elements, 0.0f);
+                    std::vector<T> sum_value(strip_elements, T(0));
+                    std::vector<float> weights(width);
+                    std::vector<int> shifted_x(width);
+
+                    for (int dy = -search_radius; dy < search_radius; dy++) {
+                        for (int dx = -search_radius; dx < search_radius; dx++) {
+
+                            const float* distances = patch_distances.compute(dx, dy);
+                            for (int kx = 0; kx < width; kx++)
+                                shifted_x[kx] = PatchDistances<T>::wrap(kx + dx, width);
+
+                            for (int ky = y_begin; ky < y_end; ky++) {
+                                const size_t offset = size_t(ky - y_begin) * width;
+                                const T* shifted_row =
+                                    image.get_data_ptr() + size_t(PatchDistances<T>::wrap(ky + dy, height)) * width;
+
+                                for (int kx = 0; kx < width; kx++)
+                                    weights[kx] = std::exp(-distances[offset + kx] / (noise_std2 * D * D));
+
+                                for (int kx = 0; kx < width; kx++) {
+                                    sum_weight[offset + kx] += weights[kx];
+                                    sum_value[offset + kx] += weights[kx] * shifted_row[shifted_x[kx]];
+                                }
                             }
                         }
-
-                        result(kx, ky) = sum_value / sum_weight;
-
                     }
+
+                    for (size_t i = 0; i < strip_elements; i++)
+                        result[size_t(y_begin) * width + i] = sum_value[i] / sum_weight[i];
                 }
 
                 return result;
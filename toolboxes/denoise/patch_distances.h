@@ -0,0 +1,87 @@
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <complex>
+#include <vector>
+
+namespace Gadgetron {
+    namespace Denoise {
+
+        /**
+         * Distances between the patches of a 2D image and the same patches shifted by an offset, for a strip of rows.
+         * Patches are square, centred on their pixel, and wrap around the edges of the image.
+         *
+         * For each offset the squared difference image is computed once and summed into a summed-area table, from which
+         * the distance of every patch in the strip is read with four lookups. A distance then costs O(1) rather than
+         * O(patch_size^2), and the lookups are vectorized along the rows.
+         */
+        template <class T> class PatchDistances {
+        public:
+            PatchDistances(const hoNDArray<T>& image, int patch_size, int y_begin, int y_end)
+                : image(image.get_data_ptr()), width(int(image.get_size(0))), height(int(image.get_size(1))),
+                  patch_size(patch_size), y_begin(y_begin), y_end(y_end), padded_rows(y_end - y_begin + patch_size - 1),
+                  padded_cols(width + patch_size - 1), columns(padded_cols), shifted_columns(padded_cols),
+                  differences(padded_cols), table(size_t(padded_rows + 1) * (padded_cols + 1), 0.0),
+                  distances(size_t(y_end - y_begin) * width) {
+
+                for (int j = 0; j < padded_cols; j++)
+                    columns[j] = wrap(j - patch_size / 2, width);
+            }
+
+            /// Sum of squared differences between the patches at (x, y) and (x + dx, y + dy), for all x and
+            /// y_begin <= y < y_end. The distance of (x, y) is at index x + (y - y_begin) * width.
+            const float* compute(int dx, int dy) {
+
+                const size_t stride = padded_cols + 1;
+
+                for (int j = 0; j < padded_cols; j++)
+                    shifted_columns[j] = wrap(j - patch_size / 2 + dx, width);
+
+                for (int i = 0; i < padded_rows; i++) {
+                    int y = wrap(y_begin - patch_size / 2 + i, height);
+                    const T* row = image + size_t(y) * width;
+                    const T* shifted_row = image + size_t(wrap(y + dy, height)) * width;
+
+                    for (int j = 0; j < padded_cols; j++)
+                        differences[j] = std::norm(row[columns[j]] - shifted_row[shifted_columns[j]]);
+
+                    const double* previous = table.data() + i * stride;
+                    double* current = table.data() + (i + 1) * stride;
+                    double row_sum = 0;
+                    for (int j = 0; j < padded_cols; j++) {
+                        row_sum += differences[j];
+                        current[j + 1] = previous[j + 1] + row_sum;
+                    }
+                }
+
+                for (int r = 0; r < y_end - y_begin; r++) {
+                    const double* top = table.data() + r * stride;
+                    const double* bottom = table.data() + (r + patch_size) * stride;
+                    float* result = distances.data() + size_t(r) * width;
+                    for (int x = 0; x < width; x++)
+                        result[x] = float(bottom[x + patch_size] - top[x + patch_size] - bottom[x] + top[x]);
+                }
+
+                return distances.data();
+            }
+
+            static int wrap(int i, int n) {
+                i %= n;
+                return i < 0 ? i + n : i;
+            }
+
+        private:
+            const T* image;
+            int width, height;
+            int patch_size;
+            int y_begin, y_end;
+            int padded_rows, padded_cols;
+
+            std::vector<int> columns, shifted_columns;
+            std::vector<float> differences;
+            std::vector<double> table;
+            std::vector<float> distances;
+        };
+    }
+}
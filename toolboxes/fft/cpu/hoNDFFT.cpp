@@ -1,9 +1,12 @@
 
 // Include for Visual studio, 'cos reasons.
 #define _USE_MATH_DEFINES
+#include <atomic>
 #include <cmath>
 #include <numeric>
 #include <set>
+#include <shared_mutex>
+#include <unordered_map>
 #include <omp.h>
 
 #include "hoMatrix.h"
@@ -33,6 +36,11 @@ namespace Gadgetron {
             static constexpr auto plan_dft     = fftwf_plan_dft;
             static constexpr auto execute_dft  = fftwf_execute_dft;
             static constexpr auto destroy_plan = fftwf_destroy_plan;
+            static constexpr auto malloc       = fftwf_malloc;
+            static constexpr auto free         = fftwf_free;
+            static constexpr auto alignment_of = fftwf_alignment_of;
+            static constexpr auto import_wisdom = fftwf_import_wisdom_from_filename;
+            static constexpr auto export_wisdom = fftwf_export_wisdom_to_filename;
         };
 
         template <> struct fftw_types<double> {
@@ -42,36 +50,97 @@ namespace Gadgetron {
             static constexpr auto plan_dft     = fftw_plan_dft;
             static constexpr auto execute_dft  = fftw_execute_dft;
             static constexpr auto destroy_plan = fftw_destroy_plan;
+            static constexpr auto malloc       = fftw_malloc;
+            static constexpr auto free         = fftw_free;
+            static constexpr auto alignment_of = fftw_alignment_of;
+            static constexpr auto import_wisdom = fftw_import_wisdom_from_filename;
+            static constexpr auto export_wisdom = fftw_export_wisdom_to_filename;
         };
         class FFTLock {
         protected:
             static std::mutex lock;
         };
         std::mutex FFTLock::lock;
-        template <class T> class SingleFFTPlan : FFTLock {
+
+        std::atomic<FFT::PlanningMode> planning_mode{ FFT::PlanningMode::Estimate };
+
+        unsigned planning_flags(FFT::PlanningMode mode) {
+            switch (mode) {
+            case FFT::PlanningMode::Measure: return FFTW_MEASURE;
+            case FFT::PlanningMode::Patient: return FFTW_PATIENT;
+            default: return FFTW_ESTIMATE;
+            }
+        }
+
+        /**
+         * Identifies a plan: the transform geometry, direction, placement and alignment. The precision is
+         * implied by the cache the key is used with.
+         */
+        struct PlanKey {
+            std::vector<int64_t> geometry; // (n, input stride, output stride) per transformed dimension.
+            bool forward;
+            bool in_place;
+            bool aligned;
+            unsigned flags;
+
+            bool operator==(const PlanKey& other) const {
+                return geometry == other.geometry && forward == other.forward && in_place == other.in_place &&
+                       aligned == other.aligned && flags == other.flags;
+            }
+        };
+
+        struct PlanKeyHash {
+            size_t operator()(const PlanKey& key) const {
+                size_t seed = std::hash<unsigned>{}(key.flags);
+                auto combine = [&](size_t value) { seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2); };
+                for (auto value : key.geometry) combine(std::hash<int64_t>{}(value));
+                combine(key.forward);
+                combine(key.in_place);
+                combine(key.aligned);
+                return seed;
+            }
+        };
+
+        /**
+         * An FFTW plan, created on scratch buffers so that planning with FFTW_MEASURE or FFTW_PATIENT never touches
+         * user data. It is executed on new arrays through the new-array execute interface, which is thread-safe.
+         */
+        template <class T> class FFTPlan : FFTLock {
         public:
             using FFTWComplex = typename fftw_types<T>::complex;
 
-            SingleFFTPlan(int dimension, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output,
-                bool forward) {
+            explicit FFTPlan(const PlanKey& key) {
+                auto dimensions = std::vector<fftw_iodim64>(key.geometry.size() / 3);
+                size_t input_extent = 1, output_extent = 1;
+                for (size_t i = 0; i < dimensions.size(); i++) {
+                    dimensions[i] = { key.geometry[3 * i], key.geometry[3 * i + 1], key.geometry[3 * i + 2] };
+                    input_extent += (dimensions[i].n - 1) * dimensions[i].is;
+                    output_extent += (dimensions[i].n - 1) * dimensions[i].os;
+                }
+
                 std::lock_guard<std::mutex> guard(lock);
 
-                const auto& dimensions = input.dimensions();
-                size_t stride
-                    = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
+                auto input  = (FFTWComplex*)fftw_types<T>::malloc(input_extent * sizeof(FFTWComplex));
+                auto output = key.in_place ? input : (FFTWComplex*)fftw_types<T>::malloc(output_extent * sizeof(FFTWComplex));
 
-                auto fftw_dimensions = fftw_iodim64{ static_cast<ptrdiff_t>(dimensions[dimension]), static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) };
+                plan = fftw_types<T>::plan_guru(int(dimensions.size()), dimensions.data(), 0, nullptr, input, output,
+                    key.forward ? FFTW_FORWARD : FFTW_BACKWARD, key.flags | (key.aligned ? 0 : FFTW_UNALIGNED));
 
-                plan = fftw_types<T>::plan_guru(1, &fftw_dimensions, 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                if (!key.in_place) fftw_types<T>::free(output);
+                fftw_types<T>::free(input);
+
+                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
             }
 
-            ~SingleFFTPlan() {
+            ~FFTPlan() {
                 std::lock_guard<std::mutex> guard(lock);
                 fftw_types<T>::destroy_plan(plan);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
+            FFTPlan(const FFTPlan&) = delete;
+            FFTPlan& operator=(const FFTPlan&) = delete;
+
+            void execute(const std::complex<T>* input, std::complex<T>* output) const {
                 fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
             }
 
@@ -79,42 +148,114 @@ namespace Gadgetron {
             typename fftw_types<T>::plan* plan;
         };
 
-        template <class T> class ContigousFFTPlan : FFTLock {
+        /**
+         * Process-wide cache of FFT plans. Lookups of existing plans only take a shared lock; the FFTW planner lock
+         * is only taken when a new geometry is seen. Least recently used plans are evicted beyond max_plans; plans
+         * are reference counted, so a plan in use by another thread outlives its eviction.
+         */
+        template <class T> class FFTPlanCache {
         public:
-            using FFTWComplex = typename fftw_types<T>::complex;
-            ContigousFFTPlan(
-                int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
-
-                const auto& dimensions = input.dimensions();
+            static FFTPlanCache& instance() {
+                static FFTPlanCache cache;
+                return cache;
+            }
 
-                auto strides = std::vector<size_t>(rank + 1, 1);
-                std::partial_sum(
-                    dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+            std::shared_ptr<const FFTPlan<T>> get(const PlanKey& key) {
+                {
+                    std::shared_lock<std::shared_mutex> guard(m);
+                    auto it = plans.find(key);
+                    if (it != plans.end()) {
+                        it->second.last_used.store(++clock, std::memory_order_relaxed);
+                        return it->second.plan;
+                    }
+                }
 
-                auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+                auto plan = std::make_shared<const FFTPlan<T>>(key);
 
-                for (int i = 0; i < rank; i++) {
-                    fftw_dimensions[i] = { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] };
-                }
-                std::reverse(fftw_dimensions.begin(),fftw_dimensions.end());
-                plan = fftw_types<T>::plan_guru(rank, fftw_dimensions.data(), 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                std::unique_lock<std::shared_mutex> guard(m);
+                auto [it, inserted] = plans.try_emplace(key, plan, ++clock);
+                if (inserted && plans.size() > max_plans) evict_least_recently_used();
+                return it->second.plan;
+            }
 
-                if (plan == nullptr) throw std::runtime_error("Illegal FFT plan created");
+        private:
+            static constexpr size_t max_plans = 256;
+
+            struct Entry {
+                Entry(std::shared_ptr<const FFTPlan<T>> plan, size_t last_used) : plan{ std::move(plan) }, last_used{ last_used } {}
+                std::shared_ptr<const FFTPlan<T>> plan;
+                std::atomic<size_t> last_used;
+            };
+
+            void evict_least_recently_used() {
+                auto oldest = std::min_element(plans.begin(), plans.end(), [](const auto& a, const auto& b) {
+                    return a.second.last_used.load(std::memory_order_relaxed) < b.second.last_used.load(std::memory_order_relaxed);
+                });
+                plans.erase(oldest);
             }
-            ~ContigousFFTPlan() {
-                std::lock_guard<std::mutex> guard(lock);
-                fftw_types<T>::destroy_plan(plan);
+
+            std::shared_mutex m;
+            std::atomic<size_t> clock{ 0 };
+            std::unordered_map<PlanKey, Entry, PlanKeyHash> plans;
+        };
+
+        template <class T> bool is_simd_aligned(const std::complex<T>* data, std::initializer_list<size_t> offsets) {
+            for (auto offset : offsets) {
+                if (fftw_types<T>::alignment_of((T*)(data + offset)) != 0) return false;
             }
+            return true;
+        }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
-                fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
+        /**
+         * Plans for transforming all batches of a[...] into r[...]; batches start at the given element offsets,
+         * which decide whether the plan may assume SIMD alignment.
+         */
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> get_plan(const std::vector<fftw_iodim64>& dimensions,
+            const hoNDArray<std::complex<T>>& input, const hoNDArray<std::complex<T>>& output, bool forward,
+            std::initializer_list<size_t> batch_offsets) {
+
+            PlanKey key;
+            for (auto& dimension : dimensions) key.geometry.insert(key.geometry.end(), { dimension.n, dimension.is, dimension.os });
+            key.forward  = forward;
+            key.in_place = input.data() == output.data();
+            key.aligned  = is_simd_aligned(input.data(), batch_offsets) && is_simd_aligned(output.data(), batch_offsets);
+            key.flags    = planning_flags(planning_mode.load(std::memory_order_relaxed));
+
+            return FFTPlanCache<T>::instance().get(key);
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> single_fft_plan(int dimension, const hoNDArray<std::complex<T>>& input,
+            hoNDArray<std::complex<T>>& output, bool forward) {
+            const auto& dimensions = input.dimensions();
+            size_t stride
+                = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
+            size_t outer_batchsize = stride * dimensions[dimension];
+
+            auto fftw_dimensions = std::vector<fftw_iodim64>{ { static_cast<ptrdiff_t>(dimensions[dimension]),
+                static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) } };
+
+            return get_plan(fftw_dimensions, input, output, forward,
+                { 0, stride > 1 ? size_t(1) : size_t(0), outer_batchsize });
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> contigous_fft_plan(int rank, const hoNDArray<std::complex<T>>& input,
+            hoNDArray<std::complex<T>>& output, bool forward) {
+            const auto& dimensions = input.dimensions();
+
+            auto strides = std::vector<size_t>(rank + 1, 1);
+            std::partial_sum(dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+
+            auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+            for (int i = 0; i < rank; i++) {
+                fftw_dimensions[i] = { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] };
             }
+            std::reverse(fftw_dimensions.begin(), fftw_dimensions.end());
 
-        private:
-            typename fftw_types<T>::plan* plan;
-        };
+            return get_plan(fftw_dimensions, input, output, forward, { 0, strides[rank] });
+        }
 
 
         int contigous_rank(const boost::container::flat_set<int>& dimensions) {
@@ -131,7 +272,7 @@ namespace Gadgetron {
         static void contigous_fftn(const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, int rank,
             bool forward, bool normalize) {
 
-            auto plan = ContigousFFTPlan<T>(rank, input, output, forward);
+            auto plan = contigous_fft_plan<T>(rank, input, output, forward);
             size_t batch_size
                 = std::accumulate(input.dimensions().begin(), input.dimensions().begin() + rank, 1, std::multiplies<>());
             size_t batches = input.size() / batch_size;
@@ -139,18 +280,87 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan,  input, output, batches, batch_size)
             for (long long i = 0; i < batches; i++) {
 
-                plan.execute(input.data() + i * batch_size, output.data() + i * batch_size);
+                plan->execute(input.data() + i * batch_size, output.data() + i * batch_size);
             }
 
             if (normalize)
                 output *= T(1) / std::sqrt<T>(batch_size);
         }
 
+        /**
+         * Multiplies a batch by the checkerboard (-1)^(n0+n1+...) over its first rank dimensions, and by scale.
+         */
+        template <typename T>
+        static void checkerboard(const std::complex<T>* input, std::complex<T>* output,
+            const std::vector<size_t>& dimensions, int rank, T scale) {
+            const size_t nx = dimensions[0];
+            const size_t lines
+                = std::accumulate(dimensions.begin() + 1, dimensions.begin() + rank, size_t(1), std::multiplies<>());
+
+            for (size_t line = 0; line < lines; line++) {
+                size_t parity = 0;
+                size_t index  = line;
+                for (int d = 1; d < rank; d++) {
+                    parity += index % dimensions[d];
+                    index /= dimensions[d];
+                }
+                const T sign                = (parity % 2) ? -scale : scale;
+                const std::complex<T>* from = input + line * nx;
+                std::complex<T>* to         = output + line * nx;
+                for (size_t x = 0; x < nx; x += 2) {
+                    to[x]     = from[x] * sign;
+                    to[x + 1] = from[x + 1] * (-sign);
+                }
+            }
+        }
+
+        template <typename T> static bool has_even_dimensions(const hoNDArray<std::complex<T>>& input, int rank) {
+            if (input.get_number_of_dimensions() < size_t(rank))
+                return false;
+            const auto& dimensions = input.dimensions();
+            return std::all_of(dimensions.begin(), dimensions.begin() + rank, [](auto n) { return n % 2 == 0; });
+        }
+
+        /**
+         * Centered, normalized FFT over the first rank dimensions, all of which must be even.
+         *
+         * For even N, fftshift(fft(ifftshift(x)))[k] = (-1)^(k + N/2) fft((-1)^n x[n])[k], so the shifts reduce to
+         * modulating each batch before and after an in-place transform. The modulation, transform and normalization
+         * are applied batch by batch while the batch is in cache, instead of as separate passes over the whole array.
+         */
+        template <typename T>
+        static void centered_contigous_fftn(
+            const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, int rank, bool forward) {
+
+            if (!output.dimensions_equal(input))
+                output.create(input.dimensions());
+
+            auto plan = contigous_fft_plan<T>(rank, output, output, forward);
+
+            const auto& dimensions = input.dimensions();
+            size_t batch_size
+                = std::accumulate(dimensions.begin(), dimensions.begin() + rank, size_t(1), std::multiplies<>());
+            size_t batches = input.size() / batch_size;
+
+            size_t half_sum = 0;
+            for (int d = 0; d < rank; d++)
+                half_sum += dimensions[d] / 2;
+            const T output_scale = (half_sum % 2 ? T(-1) : T(1)) / std::sqrt(T(batch_size));
+
+#pragma omp parallel for default(none) shared(plan, input, output, batches, batch_size, dimensions, rank, output_scale)
+            for (long long i = 0; i < batches; i++) {
+                auto batch = output.data() + i * batch_size;
+                checkerboard(input.data() + i * batch_size, batch, dimensions, rank, T(1));
+                plan->execute(batch, batch);
+                checkerboard(batch, batch, dimensions, rank, output_scale);
+            }
+        }
+
         template <typename T>
         static void single_fft(int dimension, const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r,
             bool forward, bool normalize) {
             assert(dimension >= 0);
-            auto plan              = SingleFFTPlan<T>(dimension, a, r, forward);
+            auto plan              = single_fft_plan<T>(dimension, a, r, forward);
             const auto& dimensions = a.dimensions();
             size_t inner_batches
                 = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
@@ -161,7 +371,7 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan, a, r , outer_batches, inner_batches, outer_batchsize ) collapse(2)
             for (long long outer = 0; outer < outer_batches; outer++) {
                 for (long long inner = 0; inner < inner_batches; inner++) {
-                    plan.execute(
+                    plan->execute(
                         a.data() + inner + outer * outer_batchsize, r.data() + inner + outer * outer_batchsize);
                 }
             }
@@ -508,24 +718,40 @@ namespace Gadgetron {
     }
 
     template <typename T> inline void hoNDFFT<T>::fft1c(hoNDArray<ComplexType>& a) {
+        if (has_even_dimensions(a, 1)) {
+            centered_contigous_fftn(a, a, 1, true);
+            return;
+        }
         ifftshift1D(a);
         fft1(a);
         fftshift1D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft1c(hoNDArray<ComplexType>& a) {
+        if (has_even_dimensions(a, 1)) {
+            centered_contigous_fftn(a, a, 1, false);
+            return;
+        }
         ifftshift1D(a);
         ifft1(a);
         fftshift1D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::fft1c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (has_even_dimensions(a, 1)) {
+            centered_contigous_fftn(a, r, 1, true);
+            return;
+        }
         ifftshift1D(a, r);
         fft1(r);
         fftshift1D(r);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft1c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (has_even_dimensions(a, 1)) {
+            centered_contigous_fftn(a, r, 1, false);
+            return;
+        }
         ifftshift1D(a, r);
         ifft1(r);
         fftshift1D(r);
@@ -534,6 +760,10 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::fft1c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (has_even_dimensions(a, 1)) {
+            centered_contigous_fftn(a, r, 1, true);
+            return;
+        }
         ifftshift1D(a, r);
         fft1(r, buf);
         fftshift1D(buf, r);
@@ -542,6 +772,10 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::ifft1c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (has_even_dimensions(a, 1)) {
+            centered_contigous_fftn(a, r, 1, false);
+            return;
+        }
         ifftshift1D(a, r);
         ifft1(r, buf);
         fftshift1D(buf, r);
@@ -574,24 +808,40 @@ namespace Gadgetron {
     }
 
     template <typename T> inline void hoNDFFT<T>::fft2c(hoNDArray<ComplexType>& a) {
+        if (has_even_dimensions(a, 2)) {
+            centered_contigous_fftn(a, a, 2, true);
+            return;
+        }
         ifftshift2D(a);
         fft2(a);
         fftshift2D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft2c(hoNDArray<ComplexType>& a) {
+        if (has_even_dimensions(a, 2)) {
+            centered_contigous_fftn(a, a, 2, false);
+            return;
+        }
         ifftshift2D(a);
         ifft2(a);
         fftshift2D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::fft2c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (has_even_dimensions(a, 2)) {
+            centered_contigous_fftn(a, r, 2, true);
+            return;
+        }
         ifftshift2D(a, r);
         fft2(r);
         fftshift2D(r);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft2c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (has_even_dimensions(a, 2)) {
+            centered_contigous_fftn(a, r, 2, false);
+            return;
+        }
         ifftshift2D(a, r);
         ifft2(r);
         fftshift2D(r);
@@ -600,6 +850,10 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::fft2c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (has_even_dimensions(a, 2)) {
+            centered_contigous_fftn(a, r, 2, true);
+            return;
+        }
         ifftshift2D(a, r);
         fft2(r, buf);
         fftshift2D(buf, r);
@@ -608,6 +862,10 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::ifft2c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (has_even_dimensions(a, 2)) {
+            centered_contigous_fftn(a, r, 2, false);
+            return;
+        }
         ifftshift2D(a, r);
         ifft2(r, buf);
         fftshift2D(buf, r);
@@ -640,24 +898,40 @@ namespace Gadgetron {
     }
 
     template <typename T> inline void hoNDFFT<T>::fft3c(hoNDArray<ComplexType>& a) {
+        if (has_even_dimensions(a, 3)) {
+            centered_contigous_fftn(a, a, 3, true);
+            return;
+        }
         ifftshift3D(a);
         fft3(a);
         fftshift3D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft3c(hoNDArray<ComplexType>& a) {
+        if (has_even_dimensions(a, 3)) {
+            centered_contigous_fftn(a, a, 3, false);
+            return;
+        }
         ifftshift3D(a);
         ifft3(a);
         fftshift3D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::fft3c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (has_even_dimensions(a, 3)) {
+            centered_contigous_fftn(a, r, 3, true);
+            return;
+        }
         ifftshift3D(a, r);
         fft3(r);
         fftshift3D(r);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft3c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (has_even_dimensions(a, 3)) {
+            centered_contigous_fftn(a, r, 3, false);
+            return;
+        }
         ifftshift3D(a, r);
         ifft3(r);
         fftshift3D(r);
@@ -666,6 +940,10 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::fft3c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (has_even_dimensions(a, 3)) {
+            centered_contigous_fftn(a, r, 3, true);
+            return;
+        }
         ifftshift3D(a, r);
         fft3(r, buf);
         fftshift3D(buf, r);
@@ -674,6 +952,10 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::ifft3c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (has_even_dimensions(a, 3)) {
+            centered_contigous_fftn(a, r, 3, false);
+            return;
+        }
         ifftshift3D(a, r);
         ifft3(r, buf);
         fftshift3D(buf, r);
@@ -813,6 +1095,44 @@ namespace Gadgetron {
     }
 
 
+    void FFT::set_planning_mode(PlanningMode mode) {
+        planning_mode.store(mode);
+    }
+
+    FFT::PlanningMode FFT::get_planning_mode() {
+        return planning_mode.load();
+    }
+
+    namespace {
+        template <class T> struct WisdomFile : FFTLock {
+            static std::string path(const std::string& directory) {
+                return directory + (std::is_same_v<T, float> ? "/fftwf_wisdom" : "/fftw_wisdom");
+            }
+
+            static bool import_from(const std::string& directory) {
+                std::lock_guard<std::mutex> guard(lock);
+                return fftw_types<T>::import_wisdom(path(directory).c_str()) != 0;
+            }
+
+            static bool export_to(const std::string& directory) {
+                std::lock_guard<std::mutex> guard(lock);
+                return fftw_types<T>::export_wisdom(path(directory).c_str()) != 0;
+            }
+        };
+    }
+
+    bool FFT::import_wisdom(const std::string& directory) {
+        bool imported_float  = WisdomFile<float>::import_from(directory);
+        bool imported_double = WisdomFile<double>::import_from(directory);
+        return imported_float || imported_double;
+    }
+
+    bool FFT::export_wisdom(const std::string& directory) {
+        bool exported_float  = WisdomFile<float>::export_to(directory);
+        bool exported_double = WisdomFile<double>::export_to(directory);
+        return exported_float && exported_double;
+    }
+
     template <class ComplexType, class ENABLER>
     void FFT::fft(hoNDArray<ComplexType>& data, std::vector<size_t> dimensions) {
         std::sort(dimensions.begin(), dimensions.end());
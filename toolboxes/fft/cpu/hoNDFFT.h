@@ -106,6 +106,31 @@ template <class ComplexType,
           class ENABLER = std::enable_if_t<is_complex_type_v<ComplexType>>>
 hoNDArray<ComplexType> ifft3c(const hoNDArray<ComplexType> &data);
 
+/**
+ * How much effort FFTW spends finding a fast plan. Plans are cached per geometry, so the cost of Measure or
+ * Patient planning is paid once per transform size; wisdom can be used to carry it across processes.
+ */
+enum class PlanningMode { Estimate, Measure, Patient };
+
+/**
+ * Sets the planning mode used for plans created from now on. Plans already cached are kept.
+ */
+void set_planning_mode(PlanningMode mode);
+
+PlanningMode get_planning_mode();
+
+/**
+ * Imports FFTW wisdom for both single and double precision from the given directory.
+ * @return true if wisdom was found and imported for at least one precision
+ */
+bool import_wisdom(const std::string &directory);
+
+/**
+ * Exports the accumulated FFTW wisdom for both precisions to the given directory, which must exist.
+ * @return true if the wisdom for both precisions was written
+ */
+bool export_wisdom(const std::string &directory);
+
 }
 
 
@@ -437,6 +437,105 @@ void hoNDKLT<T>::prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_
     }
 }
 
+template<typename T>
+void hoNDKLT<T>::compute_eigen_vector_from_covariance(const hoNDArray<T>& C)
+{
+    size_t N = C.get_size(0);
+    GADGET_CHECK_THROW(C.get_size(1) == N);
+
+    hoNDArray<T> A(C);
+    hoNDArray<value_type> D;
+    Gadgetron::heev(A, D);
+
+    // heev returns the eigen values in ascending order
+    V_.create(N, N);
+    E_.create(N, 1);
+
+    size_t n;
+    for (n = 0; n < N; n++)
+    {
+        memcpy(V_.begin() + n*N, A.begin() + (N - 1 - n)*N, sizeof(T)*N);
+        E_(n) = D(N - 1 - n);
+    }
+}
+
+template<typename T>
+void hoNDKLT<T>::prepare_from_covariance(const hoNDArray<T>& C, size_t output_length)
+{
+    try
+    {
+        GADGET_CHECK_THROW(C.get_number_of_dimensions() == 2);
+
+        size_t N = C.get_size(0);
+
+        if (output_length > 0 && output_length <= N)
+        {
+            output_length_ = output_length;
+        }
+        else
+        {
+            output_length_ = N;
+        }
+
+        this->compute_eigen_vector_from_covariance(C);
+
+        M_.create(N, output_length_, V_.begin());
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::prepare_from_covariance(...) ... ");
+    }
+}
+
+template<typename T>
+void hoNDKLT<T>::prepare_from_covariance(const hoNDArray<T>& C, std::vector<size_t>& untransformed, size_t output_length)
+{
+    try
+    {
+        GADGET_CHECK_THROW(C.get_number_of_dimensions() == 2);
+
+        size_t N = C.get_size(0);
+
+        size_t unN = untransformed.size();
+        GADGET_CHECK_THROW(unN<N);
+        if (output_length > 0)
+        {
+            GADGET_CHECK_THROW(output_length >= unN);
+        }
+
+        if (unN > 0)
+        {
+            // remove the rows and columns of the untransformed slots
+            hoNDArray<T> rowsCropped, CCropped;
+            this->exclude_untransformed(C, 0, untransformed, rowsCropped);
+            this->exclude_untransformed(rowsCropped, 1, untransformed, CCropped);
+
+            if (output_length > 0)
+            {
+                this->prepare_from_covariance(CCropped, output_length - unN);
+            }
+            else
+            {
+                this->prepare_from_covariance(CCropped, (size_t)0);
+            }
+
+            this->copy_and_reset_transform(N, untransformed);
+
+            output_length_ += unN;
+
+            M_.create(N, output_length_, V_.begin());
+        }
+        else
+        {
+            this->prepare_from_covariance(C, output_length);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::prepare_from_covariance(untransformed, ...) ... ");
+    }
+}
+
 template<typename T>
 void hoNDKLT<T>::transform(const hoNDArray<T>& in, hoNDArray<T>& out, size_t dim) const
 {
@@ -52,6 +52,13 @@ namespace Gadgetron{
         void prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, size_t output_length = 0, bool remove_mean = true);
         void prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, value_type thres = (value_type)0.001, bool remove_mean = true);
 
+        /// Calculates the KLT transform matrix from the covariance matrix C = A'*A of the data along the transformed dimension,
+        /// e.g. accumulated as the data arrive, instead of from the data themselves
+        /// C: [N N] Hermitian matrix, only its lower triangle is used; any mean must already be removed from it
+        /// the eigen vectors are computed with a Hermitian eigen solver, the eigen values are the same as from prepare
+        void prepare_from_covariance(const hoNDArray<T>& C, size_t output_length = 0);
+        void prepare_from_covariance(const hoNDArray<T>& C, std::vector<size_t>& untransformed, size_t output_length = 0);
+
         /// apply the transform
         /// The input array size must meet in.get_size(dim) == M.get_size(0)
         /// out array will have out.get_size(dim)==out_length
@@ -90,6 +97,9 @@ namespace Gadgetron{
         /// compute eigen vector and values
         void compute_eigen_vector(const hoNDArray<T>& data, bool remove_mean);
 
+        /// compute eigen vector and values from the covariance matrix
+        void compute_eigen_vector_from_covariance(const hoNDArray<T>& C);
+
         /// exclude untransformed data
         void exclude_untransformed(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, hoNDArray<T>& dataCropped);
 
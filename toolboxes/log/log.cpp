@@ -6,10 +6,220 @@
 #include <time.h>
 #include <cstring>
 #include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <thread>
 
 
 namespace Gadgetron
 {
+  namespace
+  {
+    struct LogRecord
+    {
+      GadgetronLogLevel level;
+      const char* filename;
+      int lineno;
+      std::chrono::system_clock::time_point time;
+      std::string text; //Keeps its capacity when the slot is reused
+    };
+
+    /**
+       Fixed size queue of log records, written by a single thread and read by whoever holds the drain lock.
+     */
+    class LogRing
+    {
+    public:
+      explicit LogRing(size_t capacity) : records_(capacity) {}
+
+      ///Slot to fill in next, or nullptr if the ring is full
+      LogRecord* back()
+      {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == records_.size()) return nullptr;
+        return &records_[head % records_.size()];
+      }
+
+      void push()
+      {
+        // Sequentially consistent, so that a stopping backend either sees this record or the pusher sees it stopping.
+        head_.store(head_.load(std::memory_order_relaxed) + 1);
+      }
+
+      LogRecord* front()
+      {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+        return &records_[tail % records_.size()];
+      }
+
+      void pop()
+      {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      size_t size() const
+      {
+        return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed);
+      }
+
+      size_t capacity() const { return records_.size(); }
+
+    private:
+      std::vector<LogRecord> records_;
+      alignas(64) std::atomic<size_t> head_{0};
+      alignas(64) std::atomic<size_t> tail_{0};
+    };
+  }
+
+  /**
+     Every logging thread queues its records in its own LogRing. A background thread periodically
+     takes the records from all rings, adds their prefixes and writes them to stderr in time order.
+   */
+  class AsyncLogBackend
+  {
+  public:
+    AsyncLogBackend(GadgetronLogger& logger, size_t capacity)
+      : logger_(logger), capacity_(capacity), flusher_([this]() { run(); }) {}
+
+    ///Queues a record; returns false if the backend has been stopped, leaving args untouched
+    bool log(GadgetronLogLevel LEVEL, const char* filename, int lineno, const char* cformatting, va_list args)
+    {
+      if (!running_.load()) return false;
+
+      LogRing& ring = local_ring();
+      LogRecord* record = ring.back();
+      while (!record) {
+        if (LEVEL != GADGETRON_LOG_LEVEL_WARNING && LEVEL != GADGETRON_LOG_LEVEL_ERROR) {
+          dropped_++;
+          return true;
+        }
+        if (!running_.load()) return false;
+        wake_.notify_one();
+        std::this_thread::yield();
+        record = ring.back();
+      }
+
+      record->level = LEVEL;
+      record->filename = filename;
+      record->lineno = lineno;
+      record->time = std::chrono::system_clock::now();
+
+      std::string& text = record->text;
+      text.resize(std::max<size_t>(text.capacity(), 128));
+      va_list retry;
+      va_copy(retry, args);
+      int length = vsnprintf(&text[0], text.size() + 1, cformatting, args);
+      if (length > 0 && size_t(length) > text.size()) {
+        text.resize(length);
+        vsnprintf(&text[0], text.size() + 1, cformatting, retry);
+      }
+      va_end(retry);
+      text.resize(std::max(length, 0));
+
+      ring.push();
+
+      if (!running_.load()) flush();
+      else if (ring.size() > ring.capacity() / 2) wake_.notify_one();
+      return true;
+    }
+
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(drain_mutex_);
+
+      std::vector<std::shared_ptr<LogRing>> rings;
+      {
+        std::unique_lock<std::mutex> rings_lock(rings_mutex_);
+        rings = rings_;
+      }
+
+      std::vector<std::pair<std::chrono::system_clock::time_point, std::string>> lines;
+      for (auto& ring : rings) {
+        while (LogRecord* record = ring->front()) {
+          lines.emplace_back(record->time, logger_.prefix(record->level, record->filename, record->lineno, record->time) + record->text);
+          ring->pop();
+        }
+      }
+
+      size_t dropped = dropped_.load();
+      if (dropped != reported_) {
+        auto now = std::chrono::system_clock::now();
+        lines.emplace_back(now, logger_.prefix(GADGETRON_LOG_LEVEL_WARNING, __FILE__, __LINE__, now)
+                                  + std::to_string(dropped - reported_) + " log statements dropped; the log queue was full\n");
+        reported_ = dropped;
+      }
+
+      std::stable_sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+      for (auto& line : lines) fputs(line.second.c_str(), stderr);
+      if (!lines.empty()) fflush(stderr);
+
+      // Forget the rings of threads that have exited, once they are empty
+      rings.clear();
+      std::unique_lock<std::mutex> rings_lock(rings_mutex_);
+      rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                  [](const auto& ring) { return ring.use_count() == 1 && ring->size() == 0; }),
+                   rings_.end());
+    }
+
+    void stop()
+    {
+      {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+      }
+      running_.store(false);
+      wake_.notify_one();
+      if (flusher_.joinable()) flusher_.join();
+      flush();
+    }
+
+    size_t dropped() const { return dropped_.load(); }
+
+  private:
+    LogRing& local_ring()
+    {
+      thread_local std::shared_ptr<LogRing> ring;
+      thread_local AsyncLogBackend* owner = nullptr;
+      if (owner != this) {
+        ring = std::make_shared<LogRing>(capacity_);
+        owner = this;
+        std::unique_lock<std::mutex> lock(rings_mutex_);
+        rings_.push_back(ring);
+      }
+      return *ring;
+    }
+
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      while (!stopping_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(20));
+        lock.unlock();
+        flush();
+        lock.lock();
+      }
+    }
+
+    GadgetronLogger& logger_;
+    const size_t capacity_;
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+
+    std::mutex drain_mutex_;
+    size_t reported_ = 0;
+    std::atomic<size_t> dropped_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::atomic<bool> running_{true};
+
+    std::thread flusher_;
+  };
+
   GadgetronLogger* GadgetronLogger::instance()
   {
     if (!instance_) instance_ = new GadgetronLogger();
@@ -22,6 +232,12 @@ namespace Gadgetron
     : level_mask_(GADGETRON_LOG_LEVEL_MAX,false)
     , print_mask_(GADGETRON_LOG_PRINT_MAX, false)
   {
+    char* log_async = getenv(GADGETRON_LOG_ASYNC_ENVIRONMENT);
+    if (log_async != NULL && *log_async && strcmp(log_async, "0") != 0) {
+      size_t capacity = strtoul(log_async, NULL, 10);
+      enableAsyncLogging(capacity > 1 ? capacity : 4096);
+    }
+
     char* log_mask = getenv(GADGETRON_LOG_MASK_ENVIRONMENT);
     if ( log_mask != NULL) {
 
@@ -82,20 +298,36 @@ namespace Gadgetron
     //Check if we should log this message
     if (!isLevelEnabled(LEVEL)) return;
 
+    if (AsyncLogBackend* async = async_.load(std::memory_order_acquire)) {
+      va_list args;
+      va_start (args, cformatting);
+      bool queued = async->log(LEVEL, filename, lineno, cformatting, args);
+      va_end (args);
+      if (queued) return;
+    }
+
     std::unique_lock<std::mutex> lock(m);
-    const char* fmt = cformatting;
+    fputs(prefix(LEVEL, filename, lineno, std::chrono::system_clock::now()).c_str(), stderr);
+
+    va_list args;
+    va_start (args, cformatting);
+    vfprintf(stderr, cformatting, args);
+    va_end (args);
+    fflush(stderr);
+  }
+
+  std::string GadgetronLogger::prefix(GadgetronLogLevel LEVEL, const char* filename, int lineno, std::chrono::system_clock::time_point time)
+  {
     std::string fmt_str;
-    bool append_cformatting_needed = false; //Will be set to true if we add any additional labels
 
     if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_DATETIME)) {
       time_t rawtime;
       struct tm * timeinfo;
 
-      auto curtime= std::chrono::system_clock::now();
-      rawtime = std::chrono::system_clock::to_time_t(curtime);
+      rawtime = std::chrono::system_clock::to_time_t(time);
       timeinfo = localtime ( &rawtime );
 
-      auto duration = curtime.time_since_epoch();
+      auto duration = time.time_since_epoch();
       int micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count() % 1000000;
 
       //Time the format MM-DD HH:MM:SS.uuu
@@ -104,7 +336,6 @@ namespace Gadgetron
                                 timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec, micros/1000);
 
       fmt_str += std::string(timestr);
-      append_cformatting_needed = true;
     }
 
     if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_LEVEL)) {
@@ -124,7 +355,6 @@ namespace Gadgetron
       default:
 	;
       }
-      append_cformatting_needed = true;
     }
 
     if (isOutputOptionEnabled(GADGETRON_LOG_PRINT_FILELOC)) {
@@ -145,21 +375,46 @@ namespace Gadgetron
       char linenostr[8];snprintf(linenostr, 8, "%d", lineno);
       fmt_str += std::string(":") + std::string(linenostr);
       fmt_str += std::string("] ");
-      append_cformatting_needed = true;
     }
 
-    if (append_cformatting_needed) {
-      fmt_str += std::string(cformatting);
-      fmt = fmt_str.c_str();
-    }
+    return fmt_str;
+  }
 
-    va_list args;
-    va_start (args, cformatting);
-    vfprintf(stderr, fmt, args);
-    va_end (args);
+  void GadgetronLogger::enableAsyncLogging(size_t capacity)
+  {
+    std::unique_lock<std::mutex> lock(m);
+    if (async_.load() || capacity == 0) return;
+
+    static std::once_flag exit_flag;
+    std::call_once(exit_flag, []() { std::atexit([]() { GadgetronLogger::instance()->disableAsyncLogging(); }); });
+
+    async_.store(new AsyncLogBackend(*this, capacity), std::memory_order_release);
+  }
+
+  void GadgetronLogger::disableAsyncLogging()
+  {
+    AsyncLogBackend* async = async_.exchange(nullptr);
+    // Other threads may still be queueing statements, so the backend is stopped but never deleted.
+    if (async) async->stop();
+  }
+
+  bool GadgetronLogger::isAsyncLoggingEnabled()
+  {
+    return async_.load() != nullptr;
+  }
+
+  void GadgetronLogger::flush()
+  {
+    if (AsyncLogBackend* async = async_.load()) async->flush();
     fflush(stderr);
   }
 
+  size_t GadgetronLogger::droppedMessages()
+  {
+    AsyncLogBackend* async = async_.load();
+    return async ? async->dropped() : 0;
+  }
+
   void GadgetronLogger::enableLogLevel(GadgetronLogLevel LEVEL)
   {
     if (LEVEL < level_mask_.size()) {
@@ -5,9 +5,13 @@
 
 #include <sstream>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
 
 #define GADGETRON_LOG_MASK_ENVIRONMENT "GADGETRON_LOG_MASK"
 #define GADGETRON_LOG_FILE_ENVIRONMENT "GADGETRON_LOG_FILE"
+#define GADGETRON_LOG_ASYNC_ENVIRONMENT "GADGETRON_LOG_ASYNC"
 
 namespace Gadgetron
 {
@@ -84,7 +88,17 @@ namespace Gadgetron
 
      Any (or no) seperator is allowed between the levels and ourput options.
 
+     By default every statement is written to stderr before the macro returns. With @enableAsyncLogging,
+     or by setting the environment variable GADGETRON_LOG_ASYNC to the number of statements each thread
+     may queue (e.g. export GADGETRON_LOG_ASYNC=4096), statements are instead queued in a lock free ring
+     buffer owned by the logging thread and written by a background thread. Only the message itself is
+     formatted by the logging thread; time, level and file location are added when writing. Debug, info
+     and verbose statements are dropped, and counted, when the queue of a thread is full. Warnings and
+     errors wait for space. The log level and output masks apply as in synchronous mode.
+
    */
+  class AsyncLogBackend;
+
   class GadgetronLogger
   {
   public:
@@ -106,12 +120,27 @@ namespace Gadgetron
     void enableAllOutputOptions();
     void disableAllOutputOptions();
 
+    ///Queue log statements for a background thread to write, allowing each thread to queue up to capacity statements
+    void enableAsyncLogging(size_t capacity = 4096);
+    ///Write everything queued so far, and log synchronously from here on
+    void disableAsyncLogging();
+    bool isAsyncLoggingEnabled();
+    ///Blocks until every statement queued so far has been written
+    void flush();
+    ///Number of statements dropped because the queue of the logging thread was full
+    size_t droppedMessages();
+
   protected:
     GadgetronLogger();
     static GadgetronLogger* instance_;
     std::vector<bool> level_mask_;
     std::vector<bool> print_mask_;
     std::mutex m;
+    std::atomic<AsyncLogBackend*> async_{nullptr};
+
+    std::string prefix(GadgetronLogLevel LEVEL, const char* filename, int lineno, std::chrono::system_clock::time_point time);
+
+    friend class AsyncLogBackend;
   };
 }
 
@@ -11,209 +11,402 @@
 #include "hoNDArray_reductions.h"
 #include "complext.h"
 #include "GadgetronTimer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
 #ifdef USE_OMP
     #include <omp.h>
 #endif // USE_OMP
 
 namespace Gadgetron
 {
-
-template<typename T> 
-void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+namespace
 {
-    try
+    // Inati coil map estimation with the local covariances computed by separable box filters.
+    //
+    // Every pixel carries CHA + CHA*(CHA+1)/2 complex fields: the channel values x, and the upper triangle of
+    // conj(x) x^T. Summed over the ks*ks*kz window, they give the window sum of every channel, which is the initial
+    // guess of the power iteration and sets the phase, and the local covariance D^H D. The sums are running sums
+    // along RO, E1 and E2 with periodic boundaries, so their cost per pixel does not depend on the kernel size.
+    // They are kept in double: in a float window that slides off a bright object onto background, the rounding
+    // error of the object's terms would swamp the background covariance. A last row counts the pixels with signal,
+    // so that a window without any gives NaN, as the direct computation does, rather than a rounding residue.
+    //
+    // Output is computed in blocks of E1 rows and E2 planes; a block keeps one window sum per row, and slides it
+    // from plane to plane. Fields are stored one after another, with real and imaginary parts apart, so that all
+    // loops over pixels, including the power iterations, run along RO and can be vectorized.
+    template <typename T>
+    class InatiBoxFilter
     {
+    public:
         typedef typename realType<T>::Type value_type;
-        using std::abs;
+        typedef double accum_type;
+
+        InatiBoxFilter(const T* data, T* coilMap, size_t RO, size_t E1, size_t E2, size_t CHA, size_t ks, size_t kz, size_t power, size_t block_e1)
+            : pData_(reinterpret_cast<const value_type*>(data)), pSen_(reinterpret_cast<value_type*>(coilMap))
+            , RO_(RO), E1_(E1), E2_(E2), CHA_(CHA), ks_(ks), kz_(kz), power_(power)
+            , num_fields_(CHA + CHA*(CHA + 1) / 2)
+            , line_size_((2 * num_fields_ + 1) * RO)
+            , ro_add_(RO), ro_sub_(RO)
+            , fields_(line_size_), local_(line_size_), lines_(ks*line_size_), sum_(line_size_), window_(block_e1*line_size_)
+            , v_(2 * CHA*RO), w_(2 * CHA*RO), scale_(RO)
+        {
+            const long long halfKs = (long long)ks / 2;
+            for (size_t ro = 0; ro < RO; ro++)
+            {
+                ro_add_[ro] = wrap((long long)ro + halfKs, RO);
+                ro_sub_[ro] = wrap((long long)ro - 1 - halfKs, RO);
+            }
+        }
 
-        long long RO = data.get_size(0);
-        long long E1 = data.get_size(1);
-        long long CHA = data.get_size(2);
+        // computes the coil map of rows [e1_begin, e1_end) of planes [e2_begin, e2_end)
+        void estimate(size_t e1_begin, size_t e1_end, size_t e2_begin, size_t e2_end)
+        {
+            const long long halfKz = (long long)kz_ / 2;
 
-        long long N = data.get_number_of_elements() / (RO*E1*CHA);
-        GADGET_CHECK_THROW(N == 1);
+            for (size_t e2 = e2_begin; e2 < e2_end; e2++)
+            {
+                if (e2 == e2_begin)
+                {
+                    std::fill(window_.begin(), window_.end(), accum_type(0));
+                    for (long long ke2 = -halfKz; ke2 <= halfKz; ke2++)
+                    {
+                        add_plane(wrap((long long)e2 + ke2, E2_), e1_begin, e1_end, 1);
+                    }
+                }
+                else
+                {
+                    add_plane(wrap((long long)e2 + halfKz, E2_), e1_begin, e1_end, 1);
+                    add_plane(wrap((long long)e2 - 1 - halfKz, E2_), e1_begin, e1_end, -1);
+                }
 
-        const T* pData = data.begin();
+                for (size_t e1 = e1_begin; e1 < e1_end; e1++)
+                {
+                    estimate_line(&window_[(e1 - e1_begin)*line_size_], e1, e2);
+                }
+            }
+        }
 
-        if (!data.dimensions_equal(coilMap))
+    private:
+
+        static size_t wrap(long long i, size_t n)
         {
-            coilMap = data;
+            long long r = i % (long long)n;
+            return (size_t)(r < 0 ? r + (long long)n : r);
         }
-        T* pSen = coilMap.begin();
 
-        if (ks % 2 != 1)
+        // fields of line e1 of plane e2, summed over the window along RO
+        void filter_line(size_t e1, size_t e2, accum_type* line)
         {
-            ks++;
+            const size_t RO = RO_;
+            const size_t N = RO_*E1_*E2_;
+            const value_type* x = pData_ + 2 * (e2*RO_*E1_ + e1*RO_);
+
+            value_type* f = fields_.data();
+
+            for (size_t cha = 0; cha < CHA_; cha++)
+            {
+                const value_type* pX = x + 2 * cha*N;
+                value_type* re = f + 2 * cha*RO;
+                value_type* im = re + RO;
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    re[ro] = pX[2 * ro];
+                    im[ro] = pX[2 * ro + 1];
+                }
+            }
+
+            size_t n = CHA_;
+            for (size_t c1 = 0; c1 < CHA_; c1++)
+            {
+                const value_type* ar = f + 2 * c1*RO;
+                const value_type* ai = ar + RO;
+                for (size_t c2 = c1; c2 < CHA_; c2++, n++)
+                {
+                    const value_type* br = f + 2 * c2*RO;
+                    const value_type* bi = br + RO;
+                    value_type* re = f + 2 * n*RO;
+                    value_type* im = re + RO;
+
+                    #pragma omp simd
+                    for (size_t ro = 0; ro < RO; ro++)
+                    {
+                        re[ro] = ar[ro] * br[ro] + ai[ro] * bi[ro];
+                        im[ro] = ar[ro] * bi[ro] - ai[ro] * br[ro];
+                    }
+                }
+            }
+
+            value_type* count = f + 2 * num_fields_*RO;
+            std::fill(count, count + RO, value_type(0));
+            for (size_t k = 0; k < 2 * CHA_; k++)
+            {
+                const value_type* p = f + k*RO;
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    if (p[ro] != 0) count[ro] = 1;
+                }
+            }
+
+            const long long halfKs = (long long)ks_ / 2;
+            for (size_t k = 0; k < 2 * num_fields_ + 1; k++)
+            {
+                const value_type* src = f + k*RO;
+                accum_type* dst = line + k*RO;
+
+                accum_type s(0);
+                for (long long kro = -halfKs; kro <= halfKs; kro++)
+                {
+                    s += src[wrap(kro, RO)];
+                }
+                dst[0] = s;
+
+                for (size_t ro = 1; ro < RO; ro++)
+                {
+                    s += accum_type(src[ro_add_[ro]]) - accum_type(src[ro_sub_[ro]]);
+                    dst[ro] = s;
+                }
+            }
         }
 
-        size_t kss = ks*ks;
-        long long halfKs = (long long)ks / 2;
+        // adds sign times the fields of plane e2, summed over the window along RO and E1, to the window sums of rows [e1_begin, e1_end)
+        void add_plane(size_t e2, size_t e1_begin, size_t e1_end, accum_type sign)
+        {
+            const long long halfKs = (long long)ks_ / 2;
+            const size_t L = line_size_;
+
+            // lines_ holds the ks lines in the window of the current row, line r in slot (r + halfKs - e1_begin) % ks
+            std::fill(sum_.begin(), sum_.end(), accum_type(0));
+            for (long long ke1 = -halfKs; ke1 <= halfKs; ke1++)
+            {
+                accum_type* line = &lines_[(ke1 + halfKs)*L];
+                filter_line(wrap((long long)e1_begin + ke1, E1_), e2, line);
 
-        long long e1;
+                #pragma omp simd
+                for (size_t i = 0; i < L; i++) sum_[i] += line[i];
+            }
+
+            for (size_t e1 = e1_begin; e1 < e1_end; e1++)
+            {
+                if (e1 > e1_begin)
+                {
+                    accum_type* line = &lines_[((e1 - 1 - e1_begin) % ks_)*L];
+
+                    #pragma omp simd
+                    for (size_t i = 0; i < L; i++) sum_[i] -= line[i];
+
+                    filter_line(wrap((long long)e1 + halfKs, E1_), e2, line);
+
+                    #pragma omp simd
+                    for (size_t i = 0; i < L; i++) sum_[i] += line[i];
+                }
+
+                accum_type* window = &window_[(e1 - e1_begin)*L];
+
+                #pragma omp simd
+                for (size_t i = 0; i < L; i++) window[i] += sign * sum_[i];
+            }
+        }
 
-        #pragma omp parallel private(e1) shared(ks, RO, E1, CHA, pSen, pData, halfKs, power, kss)
+        // normalizes the channel vectors of all pixels of a line
+        void normalize(value_type* v)
         {
-            hoNDArray<T> D(ks*ks, CHA);
-            T* pD = D.begin();
+            const size_t RO = RO_;
+            value_type* scale = scale_.data();
 
-            hoNDArray<T> DC(ks*ks, CHA);
-            T* pDC = DC.begin();
+            std::fill(scale_.begin(), scale_.end(), value_type(0));
+            for (size_t cha = 0; cha < CHA_; cha++)
+            {
+                const value_type* re = v + 2 * cha*RO;
+                const value_type* im = re + RO;
 
-            hoNDArray<T> DH_D(CHA, CHA);
-            Gadgetron::clear(DH_D);
+                #pragma omp simd
+                for (size_t ro = 0; ro < RO; ro++) scale[ro] += re[ro] * re[ro] + im[ro] * im[ro];
+            }
 
-            hoNDArray<T> U1(ks*ks, 1);
-            T* pU1 = U1.begin();
+            // as in the direct computation, a window without signal gives NaN
+            for (size_t ro = 0; ro < RO; ro++) scale[ro] = 1 / std::sqrt(scale[ro]);
 
-            hoNDArray<T> V1(CHA, 1);
-            T* pV1 = V1.begin();
+            for (size_t k = 0; k < 2 * CHA_; k++)
+            {
+                value_type* p = v + k*RO;
 
-            hoNDArray<T> V(CHA, 1);
+                #pragma omp simd
+                for (size_t ro = 0; ro < RO; ro++) p[ro] *= scale[ro];
+            }
+        }
 
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
+        // power iteration on the local covariance of every pixel of a line, from its window sums
+        void estimate_line(const accum_type* sums, size_t e1, size_t e2)
+        {
+            const size_t RO = RO_;
+            value_type* v = v_.data();
+            value_type* w = w_.data();
 
-            T phaseU1;
+            std::copy(sums, sums + line_size_, local_.begin());
+            const value_type* window = local_.data();
 
-            value_type v1Norm(1), u1Norm(1);
+            const accum_type* count = sums + 2 * num_fields_*RO;
+            for (size_t ro = 0; ro < RO; ro++)
+            {
+                if (count[ro] != 0) continue;
+                for (size_t k = 0; k < 2 * num_fields_; k++) local_[k*RO + ro] = value_type(0);
+            }
 
-            long long cha, ro, kro, ke1, de1, dro;
-            size_t po;
+            std::copy(window, window + 2 * CHA_*RO, v);
+            normalize(v);
 
-            #pragma omp for
-            for (e1 = 0; e1<(int)E1; e1++)
+            for (size_t po = 0; po < power_; po++)
             {
-                for (ro = 0; ro<(long long)RO; ro++)
+                std::fill(w, w + 2 * CHA_*RO, value_type(0));
+
+                size_t n = CHA_;
+                for (size_t c1 = 0; c1 < CHA_; c1++)
                 {
-                    // fill the data matrix D
-                    if (e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
-                    {
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                            {
-                                de1 = e1 + ke1;
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + ro + kro];
-                                    ind++;
-                                }
-                            }
-                        }
-                    }
-                    else
+                    value_type* w1r = w + 2 * c1*RO;
+                    value_type* w1i = w1r + RO;
+                    const value_type* v1r = v + 2 * c1*RO;
+                    const value_type* v1i = v1r + RO;
+
+                    for (size_t c2 = c1; c2 < CHA_; c2++, n++)
                     {
-                        for (cha = 0; cha<CHA; cha++)
+                        const value_type* rr = window + 2 * n*RO;
+                        const value_type* ri = rr + RO;
+                        value_type* w2r = w + 2 * c2*RO;
+                        value_type* w2i = w2r + RO;
+                        const value_type* v2r = v + 2 * c2*RO;
+                        const value_type* v2i = v2r + RO;
+
+                        #pragma omp simd
+                        for (size_t ro = 0; ro < RO; ro++)
                         {
-                            const T* pDataCurr = pData + cha*RO*E1;
-                            int ind = 0;
-                            for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                            {
-                                de1 = e1 + ke1;
-                                if (de1 < 0) de1 += E1;
-                                if (de1 >= E1) de1 -= E1;
-
-                                for (kro = -halfKs; kro <= halfKs; kro++)
-                                {
-                                    dro = ro + kro;
-                                    if (dro < 0) dro += RO;
-                                    if (dro >= RO) dro -= RO;
-
-                                    pD[ind + cha*kss] = pDataCurr[de1*RO + dro];
-                                    ind++;
-                                }
-                            }
+                            w1r[ro] += rr[ro] * v2r[ro] - ri[ro] * v2i[ro];
+                            w1i[ro] += rr[ro] * v2i[ro] + ri[ro] * v2r[ro];
                         }
-                    }
 
-                    T* pTmp;
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pTmp = pD + cha*kss;
-                        pV1[cha] = pTmp[0];
-                        for (po = 1; po<kss; po++)
+                        if (c2 == c1) continue;
+
+                        #pragma omp simd
+                        for (size_t ro = 0; ro < RO; ro++)
                         {
-                            pV1[cha] += pTmp[po];
+                            w2r[ro] += rr[ro] * v1r[ro] + ri[ro] * v1i[ro];
+                            w2i[ro] += rr[ro] * v1i[ro] - ri[ro] * v1r[ro];
                         }
                     }
+                }
 
-                    value_type sum(0);
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        const T& c = pV1[cha];
-                        const value_type re = c.real();
-                        const value_type im = c.imag();
-                        sum += ((re*re) + (im * im));
-                    }
-                    v1Norm = std::sqrt(sum);
+                std::swap(v, w);
+                normalize(v);
+            }
 
-                    value_type v1NormInv = (value_type)1.0 / v1Norm;
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pV1[cha] *= v1NormInv;
-                    }
+            // the phase of the window sum of D V1 is the phase of the window channel sums times V1
+            value_type* pr = w;
+            value_type* pi = w + RO;
+            std::fill(pr, pr + 2 * RO, value_type(0));
+            for (size_t cha = 0; cha < CHA_; cha++)
+            {
+                const value_type* sr = window + 2 * cha*RO;
+                const value_type* si = sr + RO;
+                const value_type* vr = v + 2 * cha*RO;
+                const value_type* vi = vr + RO;
 
-                    memcpy(pDC, pD, sizeof(T)*ks*ks*CHA);
-                    gemm(DH_D, DC, true, D, false);
+                #pragma omp simd
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    pr[ro] += sr[ro] * vr[ro] - si[ro] * vi[ro];
+                    pi[ro] += sr[ro] * vi[ro] + si[ro] * vr[ro];
+                }
+            }
 
-                    for (po = 0; po<power; po++)
-                    {
-                        gemm(V, DH_D, false, V1, false);
-                        memcpy(V1.begin(), V.begin(), V.get_number_of_bytes());
+            for (size_t ro = 0; ro < RO; ro++)
+            {
+                value_type s = 1 / std::sqrt(pr[ro] * pr[ro] + pi[ro] * pi[ro]);
+                pr[ro] *= s;
+                pi[ro] *= s;
+            }
 
-                        sum = 0;
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            const T& c = pV1[cha];
-                            const value_type re = c.real();
-                            const value_type im = c.imag();
-                            sum += ((re*re) + (im * im));
-                        }
-                        v1Norm = std::sqrt(sum);
+            // put the mean object phase to coil map
+            const size_t N = RO_*E1_*E2_;
+            value_type* pSen = pSen_ + 2 * (e2*RO_*E1_ + e1*RO_);
+            for (size_t cha = 0; cha < CHA_; cha++)
+            {
+                const value_type* vr = v + 2 * cha*RO;
+                const value_type* vi = vr + RO;
+                value_type* pS = pSen + 2 * cha*N;
 
-                        value_type v1NormInv = (value_type)1.0 / v1Norm;
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            pV1[cha] *= v1NormInv;
-                        }
-                    }
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    pS[2 * ro] = vr[ro] * pr[ro] + vi[ro] * pi[ro];
+                    pS[2 * ro + 1] = vr[ro] * pi[ro] - vi[ro] * pr[ro];
+                }
+            }
+        }
 
-                    gemm(U1, D, false, V1, false);
+        const value_type* pData_;
+        value_type* pSen_;
 
-                    phaseU1 = pU1[0];
-                    for (po = 1; po<kss; po++)
-                    {
-                        phaseU1 += pU1[po];
-                    }
-                    phaseU1 /= abs(phaseU1);
+        size_t RO_, E1_, E2_, CHA_, ks_, kz_, power_;
+        size_t num_fields_, line_size_;
 
-                    const value_type c = phaseU1.real();
-                    const value_type d = phaseU1.imag();
+        std::vector<size_t> ro_add_, ro_sub_;
 
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        const T& v = pV1[cha];
-                        const value_type a = v.real();
-                        const value_type b = v.imag();
+        std::vector<value_type> fields_, local_;
+        std::vector<accum_type> lines_, sum_, window_;
+        std::vector<value_type> v_, w_, scale_;
+    };
 
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[0] = a*c + b*d;
-                        reinterpret_cast< value_type(&)[2] >(pV1[cha])[1] = a*d - b*c;
-                    }
+    template <typename T>
+    void coil_map_Inati_box_filter(const T* pData, T* pSen, size_t RO, size_t E1, size_t E2, size_t CHA, size_t ks, size_t kz, size_t power)
+    {
+        // blocks of rows and planes; rows at the edge of a block are filtered again by the neighbouring block
+        const size_t block_e1 = std::min(E1, (size_t)8);
+        const size_t block_e2 = std::min(E2, (size_t)16);
 
-                    for (cha = 0; cha<CHA; cha++)
-                    {
-                        pSen[cha*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                    }
-                }
+        const long long num_e1 = (long long)((E1 + block_e1 - 1) / block_e1);
+        const long long num_e2 = (long long)((E2 + block_e2 - 1) / block_e2);
+
+        long long n;
+
+        #pragma omp parallel private(n) shared(pData, pSen, RO, E1, E2, CHA, ks, kz, power)
+        {
+            InatiBoxFilter<T> filter(pData, pSen, RO, E1, E2, CHA, ks, kz, power, block_e1);
+
+            #pragma omp for schedule(dynamic)
+            for (n = 0; n < num_e1*num_e2; n++)
+            {
+                size_t e1 = (size_t)(n % num_e1) * block_e1;
+                size_t e2 = (size_t)(n / num_e1) * block_e2;
+
+                filter.estimate(e1, std::min(E1, e1 + block_e1), e2, std::min(E2, e2 + block_e2));
             }
         }
     }
+}
+
+template<typename T> 
+void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t CHA = data.get_size(2);
+
+        size_t N = data.get_number_of_elements() / (RO*E1*CHA);
+        GADGET_CHECK_THROW(N == 1);
+
+        if (!data.dimensions_equal(coilMap))
+        {
+            coilMap = data;
+        }
+
+        if (ks % 2 != 1)
+        {
+            ks++;
+        }
+
+        coil_map_Inati_box_filter(data.begin(), coilMap.begin(), RO, E1, 1, CHA, ks, 1, power);
+    }
     catch (...)
     {
         GERROR_STREAM("Errors in coil_map_2d_Inati(...) ... ");
@@ -233,24 +426,18 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
 {
     try
     {
-        typedef typename realType<T>::Type value_type;
-        using std::abs;
-
-        long long RO = data.get_size(0);
-        long long E1 = data.get_size(1);
-        long long E2 = data.get_size(2);
-        long long CHA = data.get_size(3);
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t E2 = data.get_size(2);
+        size_t CHA = data.get_size(3);
 
-        long long N = data.get_number_of_elements() / (RO*E1*E2*CHA);
+        size_t N = data.get_number_of_elements() / (RO*E1*E2*CHA);
         GADGET_CHECK_THROW(N == 1);
 
-        const T* pData = data.begin();
-
         if (!data.dimensions_equal(coilMap))
         {
             coilMap = data;
         }
-        T* pSen = coilMap.begin();
 
         if (ks % 2 != 1)
         {
@@ -262,134 +449,7 @@ void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t k
             kz++;
         }
 
-        size_t kss = ks*ks*kz;
-        long long halfKs = (long long)ks / 2;
-        long long halfKz = (long long)kz / 2;
-
-        long long e2;
-
-        #pragma omp parallel default(none) private(e2) shared(ks, kz, RO, E1, E2, CHA, pSen, pData, halfKs, halfKz, power, kss)
-        {
-            hoMatrix<T> D(kss, CHA);
-            hoMatrix<T> DC(kss, CHA);
-            hoMatrix<T> DH_D(CHA, CHA);
-
-            hoMatrix<T> U1(kss, 1);
-            hoMatrix<T> V1(CHA, 1);
-            hoMatrix<T> V(CHA, 1);
-
-            Gadgetron::clear(D);
-            Gadgetron::clear(DC);
-            Gadgetron::clear(DH_D);
-            Gadgetron::clear(U1);
-            Gadgetron::clear(V1);
-            Gadgetron::clear(V);
-
-            T phaseU1;
-
-            value_type v1Norm(1);
-
-            long long cha, ro, e1, kro, dro, ke1, de1, ke2, de2;
-            size_t po;
-
-            #pragma omp for
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                for (e1 = 0; e1<(long long)E1; e1++)
-                {
-                    for (ro = 0; ro<(long long)RO; ro++)
-                    {
-                        // fill the data matrix D
-                        if (e2 >= halfKz && e2<E2 - halfKz && e1 >= halfKs && e1<E1 - halfKs && ro >= halfKs && ro<RO - halfKs)
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKz; ke2 <= halfKz; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + ro + kro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (cha = 0; cha<CHA; cha++)
-                            {
-                                const T* pDataCurr = pData + cha*RO*E1*E2;
-                                long long ind = 0;
-                                for (ke2 = -halfKz; ke2 <= halfKz; ke2++)
-                                {
-                                    de2 = e2 + ke2;
-                                    if (de2 < 0) de2 += E2;
-                                    if (de2 >= E2) de2 -= E2;
-
-                                    for (ke1 = -halfKs; ke1 <= halfKs; ke1++)
-                                    {
-                                        de1 = e1 + ke1;
-                                        if (de1 < 0) de1 += E1;
-                                        if (de1 >= E1) de1 -= E1;
-
-                                        for (kro = -halfKs; kro <= halfKs; kro++)
-                                        {
-                                            dro = ro + kro;
-                                            if (dro < 0) dro += RO;
-                                            if (dro >= RO) dro -= RO;
-
-                                            D(ind++, cha) = pDataCurr[de2*RO*E1 + de1*RO + dro];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        // compute V1
-                        D.sumOverCol(V1);
-                        v1Norm = nrm2(V1);
-                        scal((value_type)1.0 / v1Norm, V1);
-
-                        memcpy(DC.begin(), D.begin(), sizeof(T)*kss*CHA);
-                        gemm(DH_D, DC, true, D, false);
-                        // gemm(DH_D, D, true, D, false);
-
-                        for (po = 0; po<power; po++)
-                        {
-                            gemm(V, DH_D, false, V1, false);
-                            V1 = V;
-                            v1Norm = nrm2(V1);
-                            scal((value_type)1.0 / v1Norm, V1);
-                        }
-
-                        // compute U1
-                        gemm(U1, D, false, V1, false);
-
-                        phaseU1 = U1(0, 0);
-                        for (po = 1; po<kss; po++)
-                        {
-                            phaseU1 += U1(po, 0);
-                        }
-                        phaseU1 /= abs(phaseU1);
-
-                        // put the mean object phase to coil map
-                        conjugate(V1, V1);
-                        scal(phaseU1, V1);
-
-                        for (cha = 0; cha<CHA; cha++)
-                        {
-                            pSen[cha*RO*E1*E2 + e2*RO*E1 + e1*RO + ro] = V1(cha, 0);
-                        }
-                    }
-                }
-            }
-        }
+        coil_map_Inati_box_filter(data.begin(), coilMap.begin(), RO, E1, E2, CHA, ks, kz, power);
     }
     catch (...)
     {
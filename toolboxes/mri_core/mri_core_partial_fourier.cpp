@@ -8,6 +8,7 @@
 #include "mri_core_kspace_filter.h"
 #include "hoNDFFT.h"
 #include "hoNDArray_elemwise.h"
+#include "hoNDArray_lazy.h"
 #include "hoNDArray_linalg.h"
 #include "hoNDArray_reductions.h"
 #include "ho2DArray.h"
@@ -313,7 +314,6 @@ namespace Gadgetron
             hoNDArray<T> kspaceIter(kspace);
             // magnitude of complex images
             hoNDArray<typename realType<T>::Type> mag(kspace.dimensions());
-            hoNDArray<T> magComplex(kspace.dimensions());
 
             // kspace filter
             hoNDArray<T> buffer_partial_fourier(kspaceIter), buffer(kspaceIter);
@@ -336,8 +336,7 @@ namespace Gadgetron
             // get the complex image phase for the filtered kspace
             Gadgetron::abs(buffer_partial_fourier, mag);
             Gadgetron::addEpsilon(mag);
-            magComplex.copyFrom(mag);
-            Gadgetron::divide(buffer_partial_fourier, magComplex, buffer);
+            lazy(buffer) = lazy(buffer_partial_fourier) / mag;
 
             // complex images, initialized as not filtered complex image
             hoNDArray<T> complexIm(kspaceIter);
@@ -359,9 +358,7 @@ namespace Gadgetron
             size_t ii;
             for (ii = 0; ii<iter; ii++)
             {
-                Gadgetron::abs(complexImPOCS, mag);
-                magComplex.copyFrom(mag);
-                Gadgetron::multiply(magComplex, buffer, complexImPOCS);
+                lazy(complexImPOCS) = abs(lazy(complexImPOCS)) * buffer;
 
                 // go back to kspace
                 if (is3D)
@@ -92,5 +92,6 @@ namespace Gadgetron
 
     mrd::ImageHeader image_header_from_acquisition(const mrd::AcquisitionHeader& acq_header, const mrd::Header& header);
 
+    void add_stats_to_bucket(mrd::EncodingLimitsType& stats, const mrd::Acquisition& acq);
     void add_acquisition_to_bucket(mrd::AcquisitionBucket& bucket, mrd::Acquisition acq);
 }
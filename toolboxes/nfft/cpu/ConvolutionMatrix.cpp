@@ -4,9 +4,10 @@
 #include "ConvolutionMatrix.h"
 
 #include <GadgetronTimer.h>
+#include <algorithm>
+#include <limits>
 #include <numeric>
 #include "vector_td_utilities.h"
-#include <boost/range/irange.hpp>
 
 namespace
 {
@@ -15,28 +16,31 @@ namespace
     template<int N>
     struct iteration_counter { };
 
+    // Grid points per side of the tiles the rows are sorted by.
+    constexpr size_t tile_size = 8;
+
     template<class REAL, unsigned int D, template<class, unsigned int> class K>
     void iterate_body(
         const vector_td<REAL, D> &point,
         const vector_td<size_t, D> &matrix_size,
-        std::vector<size_t> &indices,
-        std::vector<REAL> &weights,
+        uint32_t *&indices,
+        REAL *&weights,
         vector_td<REAL, D> &image_point,
         size_t index,
         const ConvolutionKernel<REAL, D, K>& kernel,
         iteration_counter<-1>)
     {
         auto delta = abs(image_point - point);
-        indices.push_back(index);
-        weights.push_back(kernel.get(delta));
+        *indices++ = uint32_t(index);
+        *weights++ = kernel.get(delta);
     }
 
     template<class REAL, unsigned int D, template<class, unsigned int> class K, int N>
     void iterate_body(
         const vector_td<REAL, D> &point,
         const vector_td<size_t, D> &matrix_size,
-        std::vector<size_t> &indices,
-        std::vector<REAL> &weights,
+        uint32_t *&indices,
+        REAL *&weights,
         vector_td<REAL, D> &image_point,
         size_t index,
         const ConvolutionKernel<REAL, D, K>& kernel,
@@ -56,24 +60,35 @@ namespace
         }
     }
 
+    // Number of grid points within the kernel radius of point; the number iterate_body visits.
     template<class REAL, unsigned int D, template<class, unsigned int> class K>
-    std::tuple<std::vector<size_t>, std::vector<REAL>> get_indices(
+    size_t count_indices(
         const vector_td<REAL, D> &point,
-        const vector_td<size_t, D> &matrix_size,
         const ConvolutionKernel<REAL, D, K>& kernel)
     {
-        std::vector<size_t> indices;
-        indices.reserve(size_t(std::pow(std::ceil(kernel.get_width()), D)));
-
-        std::vector<REAL> weights;
-        weights.reserve(size_t(std::pow(std::ceil(kernel.get_width()), D)));
-
-        vector_td<REAL, D> image_point;
-        size_t index = 0;
-        iterate_body(point, matrix_size, indices, weights, image_point, index,
-                     kernel, iteration_counter<D - 1>());
+        size_t count = 1;
+        for (unsigned int d = 0; d < D; d++)
+        {
+            int first = std::ceil(point[d] - kernel.get_radius());
+            int last = std::floor(point[d] + kernel.get_radius());
+            count *= size_t(std::max(last - first + 1, 0));
+        }
+        return count;
+    }
 
-        return std::make_tuple(std::move(indices), std::move(weights));
+    template<class REAL, unsigned int D>
+    size_t tile_of(const vector_td<REAL, D> &point, const vector_td<size_t, D> &matrix_size)
+    {
+        size_t tile = 0;
+        size_t stride = 1;
+        for (unsigned int d = 0; d < D; d++)
+        {
+            size_t tiles = (matrix_size[d] + tile_size - 1) / tile_size;
+            auto wrapped = size_t(std::floor(point[d]) + matrix_size[d]) % matrix_size[d];
+            tile += stride * (wrapped / tile_size);
+            stride *= tiles;
+        }
+        return tile;
     }
 }
 
@@ -85,55 +100,67 @@ Gadgetron::ConvInternal::make_conv_matrix(
     const Gadgetron::vector_td<size_t, D> &matrix_size,
     const ConvolutionKernel<REAL, D, K>& kernel)
 {
-    ConvolutionMatrix<REAL> matrix(trajectory.get_number_of_elements(),
-                                   prod(matrix_size));
-    
-    #pragma omp parallel for 
-    for (int i = 0; i < (int)trajectory.get_number_of_elements(); i++)
-    {
-        std::tie(matrix.indices[i], matrix.weights[i]) = get_indices(
-            trajectory[i], matrix_size, kernel);
-    }
-
-    return matrix;
-}
-
+    const size_t n_samples = trajectory.get_number_of_elements();
 
-template<class REAL>
-Gadgetron::ConvInternal::ConvolutionMatrix<REAL>
-Gadgetron::ConvInternal::transpose(const Gadgetron::ConvInternal::ConvolutionMatrix<REAL> &matrix) {
+    if (prod(matrix_size) > std::numeric_limits<uint32_t>::max() ||
+        n_samples > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Gridding matrix or trajectory too large for 32-bit convolution matrix indices");
 
-    auto work_index = boost::irange(size_t(0),matrix.n_cols);
+    ConvolutionMatrix<REAL> matrix(n_samples, prod(matrix_size));
 
-    ConvolutionMatrix<REAL> transposed(matrix.n_rows, matrix.n_cols);
+    // Order the rows by grid tile, so that consecutive rows read and write nearby grid points.
+    std::vector<size_t> tiles(n_samples);
+    #pragma omp parallel for
+    for (long long i = 0; i < (long long)n_samples; i++)
+    {
+        tiles[i] = tile_of(trajectory[i], matrix_size);
+    }
 
-    std::vector<int> counts(matrix.n_rows, 0);
+    std::iota(matrix.sample_order.begin(), matrix.sample_order.end(), uint32_t(0));
+    std::stable_sort(matrix.sample_order.begin(), matrix.sample_order.end(),
+                     [&](uint32_t a, uint32_t b) { return tiles[a] < tiles[b]; });
 
-    for (size_t i : work_index)
+    // Slabs two apart are independent if the kernel fits in a tile. An even number of full slabs keeps that true
+    // across the periodic boundary; the remainder is left to a serial pass.
+    if (2 * kernel.get_radius() <= REAL(tile_size))
     {
-        auto &rows = matrix.indices[i];
-        for (auto &row : rows)
-            counts[row]++;
+        size_t slab_stride = 1;
+        for (unsigned int d = 0; d + 1 < D; d++)
+            slab_stride *= (matrix_size[d] + tile_size - 1) / tile_size;
+
+        size_t parallel_slabs = (matrix_size[D - 1] / tile_size) & ~size_t(1);
+        if (parallel_slabs >= 2)
+        {
+            matrix.slab_offsets.resize(parallel_slabs + 1);
+            for (size_t s = 0; s <= parallel_slabs; s++)
+            {
+                matrix.slab_offsets[s] = std::partition_point(
+                    matrix.sample_order.begin(), matrix.sample_order.end(),
+                    [&](uint32_t i) { return tiles[i] / slab_stride < s; }) - matrix.sample_order.begin();
+            }
+        }
     }
 
-    for (size_t i = 0; i < counts.size(); i++)
+    for (size_t k = 0; k < n_samples; k++)
     {
-        transposed.indices[i].reserve(counts[i]);
-        transposed.weights[i].reserve(counts[i]);
+        matrix.offsets[k + 1] = matrix.offsets[k] + count_indices(trajectory[matrix.sample_order[k]], kernel);
     }
 
-    for (size_t i : work_index )
+    matrix.indices.resize(matrix.offsets.back());
+    matrix.weights.resize(matrix.offsets.back());
+
+    #pragma omp parallel for
+    for (long long k = 0; k < (long long)n_samples; k++)
     {
-        auto &rows = matrix.indices[i];
-        auto &weights = matrix.weights[i];
-        for (size_t n = 0; n < rows.size(); n++)
-        {
-            transposed.indices[rows[n]].push_back(i);
-            transposed.weights[rows[n]].push_back(weights[n]);
-        }
+        uint32_t *indices = matrix.indices.data() + matrix.offsets[k];
+        REAL *weights = matrix.weights.data() + matrix.offsets[k];
+
+        vector_td<REAL, D> image_point;
+        iterate_body(trajectory[matrix.sample_order[k]], matrix_size, indices, weights, image_point, size_t(0),
+                     kernel, iteration_counter<int(D) - 1>());
     }
 
-    return transposed;
+    return matrix;
 }
 
 
@@ -232,12 +259,3 @@ Gadgetron::ConvInternal::make_conv_matrix<double, 4, Gadgetron::JincKernel>(
     const Gadgetron::hoNDArray<Gadgetron::vector_td<double, 4>> trajectory,
     const Gadgetron::vector_td<size_t, 4> &matrix_size,
     const ConvolutionKernel<double, 4, Gadgetron::JincKernel>& kernel);
-
-template Gadgetron::ConvInternal::ConvolutionMatrix<float>
-Gadgetron::ConvInternal::transpose(
-    const Gadgetron::ConvInternal::ConvolutionMatrix<float> &matrix);
-
-template Gadgetron::ConvInternal::ConvolutionMatrix<double>
-Gadgetron::ConvInternal::transpose(
-        const Gadgetron::ConvInternal::ConvolutionMatrix<double> &matrix);
-
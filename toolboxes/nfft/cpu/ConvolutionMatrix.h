@@ -2,6 +2,8 @@
 
 #include "hoArmadillo.h"
 #include "hoNDArray.h"
+
+#include <cstdint>
 #include "vector_td.h"
 
 #include "ConvolutionKernel.h"
@@ -10,6 +12,12 @@ namespace Gadgetron
 {
     namespace ConvInternal
     {
+        /**
+         * Sparse convolution matrix in compressed row storage, one row per non-Cartesian sample.
+         *
+         * Rows are stored in the order of the grid tiles their samples fall in, so that consecutive rows touch
+         * neighbouring grid points; sample_order maps each row back to its sample. Grid indices are 32-bit.
+         */
         template<class REAL>
         struct ConvolutionMatrix
         {
@@ -21,19 +29,28 @@ namespace Gadgetron
             ConvolutionMatrix(size_t cols, size_t rows)
               : n_cols(cols),n_rows(rows)
             {
-                weights = std::vector<std::vector<REAL>>(n_cols);
-                indices = std::vector<std::vector<size_t>>(n_cols);
+                offsets = std::vector<size_t>(n_cols + 1, 0);
+                sample_order = std::vector<uint32_t>(n_cols);
             }
 
-            std::vector<std::vector<REAL>> weights;
-            std::vector<std::vector<size_t>> indices;
+            /** Row k holds entries offsets[k] to offsets[k+1]. */
+            std::vector<size_t> offsets;
+            /** Sample of each row. */
+            std::vector<uint32_t> sample_order;
+            /** Grid index of each entry. */
+            std::vector<uint32_t> indices;
+            std::vector<REAL> weights;
+            /**
+             * Rows falling in each of the leading slabs of tiles along the last dimension; slab s holds rows
+             * slab_offsets[s] to slab_offsets[s+1]. Slabs two apart write disjoint grid points, so the even and
+             * then the odd slabs can be spread concurrently. Rows past slab_offsets.back() are spread serially.
+             * Empty if the kernel is wider than a tile.
+             */
+            std::vector<size_t> slab_offsets;
             size_t n_cols, n_rows;
         };
 
 
-        template<class REAL> ConvolutionMatrix<REAL> transpose(
-            const ConvolutionMatrix<REAL>& matrix);
-
         template<class REAL, unsigned int D, template<class, unsigned int> class K>
         ConvolutionMatrix<REAL> make_conv_matrix(
             const hoNDArray<vector_td<REAL, D>> trajectory,
@@ -5,6 +5,7 @@
 #include "NDArray_utils.h"
 
 #include "ConvolutionMatrix.h"
+#include "hoNFFTCache.h"
 
 namespace Gadgetron
 {
@@ -47,59 +48,142 @@ namespace Gadgetron
         GriddingConvolutionBase<hoNDArray, T, D, K>::preprocess(
             trajectory, prep_mode);
 
-        auto scaled_trajectory = trajectory;
-        auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os_);
-        std::transform(scaled_trajectory.begin(),
-                       scaled_trajectory.end(),
-                       scaled_trajectory.begin(),
-                       [matrix_size_os_real](auto point)
-                       { return (point + REAL(0.5)) * matrix_size_os_real; });
+        auto key = NFFTCache::Key(typeid(K<REAL, D>));
+        key.add(this->matrix_size_).add(this->matrix_size_os_).add(this->kernel_.get_width()).add(trajectory);
 
-        conv_matrix_.reserve(this->num_frames_);
-        conv_matrix_T_.reserve(this->num_frames_);
-
-        for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(
-                            scaled_trajectory, 0))
+        auto build = [&]()
         {
-            conv_matrix_.push_back(ConvInternal::make_conv_matrix(
-                traj, this->matrix_size_os_, this->kernel_));
+            auto scaled_trajectory = trajectory;
+            auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os_);
+            std::transform(scaled_trajectory.begin(),
+                           scaled_trajectory.end(),
+                           scaled_trajectory.begin(),
+                           [matrix_size_os_real](auto point)
+                           { return (point + REAL(0.5)) * matrix_size_os_real; });
+
+            std::vector<ConvInternal::ConvolutionMatrix<REAL>> matrices;
+            matrices.reserve(this->num_frames_);
+
+            // The same matrix serves both directions, so prep_mode makes no difference here.
+            for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(
+                                scaled_trajectory, 0))
+            {
+                matrices.push_back(ConvInternal::make_conv_matrix(
+                    traj, this->matrix_size_os_, this->kernel_));
+            }
+            return matrices;
+        };
 
-            if (prep_mode == GriddingConvolutionPrepMode::NC2C ||
-                prep_mode == GriddingConvolutionPrepMode::ALL)
+        auto bytes = [](const std::vector<ConvInternal::ConvolutionMatrix<REAL>>& matrices)
+        {
+            size_t total = 0;
+            for (auto& matrix : matrices)
             {
-                conv_matrix_T_.push_back(ConvInternal::transpose(conv_matrix_.back()));
+                total += (matrix.offsets.capacity() + matrix.slab_offsets.capacity()) * sizeof(size_t)
+                       + (matrix.sample_order.capacity() + matrix.indices.capacity()) * sizeof(uint32_t)
+                       + matrix.weights.capacity() * sizeof(REAL);
             }
-        }
+            return total;
+        };
+
+        conv_matrix_ = NFFTCache::get<std::vector<ConvInternal::ConvolutionMatrix<REAL>>>(key, build, bytes);
     }
 
 
     namespace
     {   
         /**
-         * \brief Matrix-vector multiplication.
+         * \brief Interpolates the samples from the grid (gather).
          * 
          * \tparam T Value type. Can be real or complex.
          * \param[in] matrix Convolution matrix.
-         * \param[in] vector Vector.
-         * \param[out] result Operation result.
+         * \param[in] image Cartesian grid.
+         * \param[out] samples Non-Cartesian samples, added to.
+         * \param[in] parallel Whether to split the samples between threads.
          */
         template<class T>
-        void mvm(
+        void gather(
             const ConvInternal::ConvolutionMatrix<realType_t<T>>& matrix,
-            const T* vector,
-            T* result)
+            const T* __restrict__ image,
+            T* __restrict__ samples,
+            bool parallel)
         {
-            for (size_t i = 0; i < matrix.n_cols; i++)
+            const size_t* offsets = matrix.offsets.data();
+            const uint32_t* indices = matrix.indices.data();
+            const realType_t<T>* weights = matrix.weights.data();
+
+            #pragma omp parallel for if (parallel)
+            for (long long k = 0; k < (long long)matrix.n_cols; k++)
             {
-                auto &row_indices = matrix.indices[i];
-                auto &weights = matrix.weights[i];
+                T sum = T(0);
+                for (size_t n = offsets[k]; n < offsets[k + 1]; n++)
+                {
+                    sum += image[indices[n]] * weights[n];
+                }
+                samples[matrix.sample_order[k]] += sum;
+            }
+        }
 
-                for (size_t n = 0; n < row_indices.size(); n++)
+        /**
+         * \brief Spreads a range of rows onto the grid (scatter); the adjoint of gather.
+         * 
+         * \tparam T Value type. Can be real or complex.
+         * \param[in] matrix Convolution matrix.
+         * \param[in] samples Non-Cartesian samples.
+         * \param[out] image Cartesian grid, added to.
+         * \param[in] begin First row.
+         * \param[in] end One past the last row.
+         */
+        template<class T>
+        void scatter(
+            const ConvInternal::ConvolutionMatrix<realType_t<T>>& matrix,
+            const T* __restrict__ samples,
+            T* __restrict__ image,
+            size_t begin,
+            size_t end)
+        {
+            const size_t* offsets = matrix.offsets.data();
+            const uint32_t* indices = matrix.indices.data();
+            const realType_t<T>* weights = matrix.weights.data();
+
+            for (size_t k = begin; k < end; k++)
+            {
+                const T sample = samples[matrix.sample_order[k]];
+                for (size_t n = offsets[k]; n < offsets[k + 1]; n++)
                 {
-                    result[i] += vector[row_indices[n]] * weights[n];
+                    image[indices[n]] += sample * weights[n];
                 }
             }
         }
+
+        /**
+         * \brief Spreads all samples onto the grid, splitting the slabs of the matrix between threads.
+         * 
+         * \tparam T Value type. Can be real or complex.
+         * \param[in] matrix Convolution matrix.
+         * \param[in] samples Non-Cartesian samples.
+         * \param[out] image Cartesian grid, added to.
+         */
+        template<class T>
+        void scatter_slabs(
+            const ConvInternal::ConvolutionMatrix<realType_t<T>>& matrix,
+            const T* __restrict__ samples,
+            T* __restrict__ image)
+        {
+            const auto& slabs = matrix.slab_offsets;
+            const long long parallel_slabs = slabs.empty() ? 0 : (long long)slabs.size() - 1;
+
+            for (long long parity = 0; parity < 2; parity++)
+            {
+                #pragma omp parallel for schedule(dynamic)
+                for (long long s = parity; s < parallel_slabs; s += 2)
+                {
+                    scatter(matrix, samples, image, slabs[s], slabs[s + 1]);
+                }
+            }
+
+            scatter(matrix, samples, image, slabs.empty() ? 0 : slabs.back(), matrix.n_cols);
+        }
     }
 
 
@@ -109,18 +193,26 @@ namespace Gadgetron
         hoNDArray<T> &samples,
         bool accumulate)
     {
-        size_t nbatches = image.get_number_of_elements() / conv_matrix_.front().n_rows;
-        assert(nbatches == samples.get_number_of_elements() / conv_matrix_.front().n_cols);
+        size_t nbatches = image.get_number_of_elements() / conv_matrix_->front().n_rows;
+        assert(nbatches == samples.get_number_of_elements() / conv_matrix_->front().n_cols);
 
         if (!accumulate) clear(&samples);
 
+        // A single batch is split between threads by sample instead; this must not run inside the batch loop's
+        // parallel region, where it would get a team of one.
+        if (nbatches == 1)
+        {
+            gather(conv_matrix_->front(), image.get_data_ptr(), samples.get_data_ptr(), true);
+            return;
+        }
+
         #pragma omp parallel for
         for (int b = 0; b < (int)nbatches; b++)
         {
-            const T* image_view = image.get_data_ptr() + b * conv_matrix_.front().n_rows;
-            T* samples_view = samples.get_data_ptr() + b * conv_matrix_.front().n_cols;
-            size_t matrix_index = b % conv_matrix_.size();
-            mvm(conv_matrix_[matrix_index], image_view, samples_view);
+            const T* image_view = image.get_data_ptr() + b * conv_matrix_->front().n_rows;
+            T* samples_view = samples.get_data_ptr() + b * conv_matrix_->front().n_cols;
+            size_t matrix_index = b % conv_matrix_->size();
+            gather((*conv_matrix_)[matrix_index], image_view, samples_view, false);
         }
     }
 
@@ -131,18 +223,26 @@ namespace Gadgetron
         hoNDArray<T> &image,
         bool accumulate)
     {
-        size_t nbatches = image.get_number_of_elements() / conv_matrix_.front().n_rows;
-        assert(nbatches == samples.get_number_of_elements() / conv_matrix_.front().n_cols);
+        size_t nbatches = image.get_number_of_elements() / conv_matrix_->front().n_rows;
+        assert(nbatches == samples.get_number_of_elements() / conv_matrix_->front().n_cols);
 
         if (!accumulate) clear(&image);
 
+        // A single batch is split between threads by slab of grid tiles.
+        if (nbatches == 1)
+        {
+            scatter_slabs(conv_matrix_->front(), samples.get_data_ptr(), image.get_data_ptr());
+            return;
+        }
+
         #pragma omp parallel for
         for (int b = 0; b < (int)nbatches; b++)
         {
-            T* image_view = image.get_data_ptr() + b * conv_matrix_.front().n_rows;
-            const T* samples_view = samples.get_data_ptr() + b * conv_matrix_.front().n_cols;
-            size_t matrix_index = b % conv_matrix_.size();
-            mvm(conv_matrix_T_[matrix_index], samples_view, image_view);
+            T* image_view = image.get_data_ptr() + b * conv_matrix_->front().n_rows;
+            const T* samples_view = samples.get_data_ptr() + b * conv_matrix_->front().n_cols;
+            size_t matrix_index = b % conv_matrix_->size();
+            const auto& matrix = (*conv_matrix_)[matrix_index];
+            scatter(matrix, samples_view, image_view, 0, matrix.n_cols);
         }
     }
 }
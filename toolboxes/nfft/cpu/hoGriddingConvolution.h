@@ -6,6 +6,8 @@
 
 #include "ConvolutionMatrix.h"
 
+#include <memory>
+
 namespace Gadgetron
 {
     /**
@@ -49,6 +51,9 @@ namespace Gadgetron
         /**
          * \brief Prepare gridding convolution.
          * 
+         * The convolution matrices are looked up in the NFFT cache (hoNFFTCache.h) and only computed for a
+         * trajectory not seen before.
+         * 
          * \param trajectory Trajectory, normalized to [-0.5, 0.5].
          * \param prep_mode Preparation mode.
          */
@@ -82,8 +87,7 @@ namespace Gadgetron
                            hoNDArray<T> &image,
                            bool accumulate) override;
 
-        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_;
-        std::vector<ConvInternal::ConvolutionMatrix<REAL>> conv_matrix_T_;
+        std::shared_ptr<const std::vector<ConvInternal::ConvolutionMatrix<REAL>>> conv_matrix_;
     };
 
     /**
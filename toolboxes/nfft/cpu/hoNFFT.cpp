@@ -24,6 +24,7 @@
 #include "NDArray_utils.h"
 
 #include "hoGriddingConvolution.h"
+#include "hoNFFTCache.h"
 
 using namespace std;
 
@@ -154,21 +155,7 @@ namespace Gadgetron {
         REAL W)
       : NFFT_plan<hoNDArray,REAL,D>(matrix_size,matrix_size_os,W)
     {
-        this->deapodization_filter_IFFT = compute_deapodization_filter(
-            this->matrix_size_os_, this->conv_->get_kernel());
-        this->deapodization_filter_FFT = deapodization_filter_IFFT;
-
-        FFTD<std::complex<REAL>,D>::fft(
-            deapodization_filter_IFFT, NFFT_fft_mode::BACKWARDS, true);
-        FFTD<std::complex<REAL>,D>::fft(
-            deapodization_filter_FFT, NFFT_fft_mode::FORWARDS, true);
-
-        boost::transform(deapodization_filter_IFFT,
-                         deapodization_filter_IFFT.begin(),
-                         [](auto val) { return REAL(1)/val; });
-        boost::transform(deapodization_filter_FFT,
-                         deapodization_filter_FFT.begin(),
-                         [](auto val) { return REAL(1)/val; });
+        deapodization_filters_ = deapodization_filters(true);
     }
 
 
@@ -179,21 +166,44 @@ namespace Gadgetron {
         REAL W)
       : NFFT_plan<hoNDArray, REAL, D>(matrix_size, oversampling_factor, W)
     {
-        this->deapodization_filter_IFFT = compute_deapodization_filter(
-            this->matrix_size_os_, this->conv_->get_kernel());
-        this->deapodization_filter_FFT = deapodization_filter_IFFT;
-
-        FFTD<std::complex<REAL>, D>::fft(
-            deapodization_filter_IFFT, NFFT_fft_mode::BACKWARDS, false);
-        FFTD<std::complex<REAL>, D>::fft(
-            deapodization_filter_FFT, NFFT_fft_mode::FORWARDS, false);
-        
-        boost::transform(deapodization_filter_IFFT,
-                         deapodization_filter_IFFT.begin(),
-                         [](auto val) { return REAL(1) / val; });
-        boost::transform(deapodization_filter_FFT,
-                         deapodization_filter_FFT.begin(),
-                         [](auto val) { return REAL(1) / val; });
+        deapodization_filters_ = deapodization_filters(false);
+    }
+
+
+    template<class REAL, unsigned int D>
+    auto hoNFFT_plan<REAL, D>::deapodization_filters(bool do_scale) const
+        -> std::shared_ptr<const DeapodizationFilters>
+    {
+        auto key = NFFTCache::Key(typeid(DeapodizationFilters));
+        key.add(this->matrix_size_).add(this->matrix_size_os_).add(this->width_).add(do_scale);
+
+        auto build = [&]()
+        {
+            DeapodizationFilters filters;
+            filters.IFFT = compute_deapodization_filter(
+                this->matrix_size_os_, this->conv_->get_kernel());
+            filters.FFT = filters.IFFT;
+
+            FFTD<std::complex<REAL>, D>::fft(
+                filters.IFFT, NFFT_fft_mode::BACKWARDS, do_scale);
+            FFTD<std::complex<REAL>, D>::fft(
+                filters.FFT, NFFT_fft_mode::FORWARDS, do_scale);
+
+            boost::transform(filters.IFFT,
+                             filters.IFFT.begin(),
+                             [](auto val) { return REAL(1) / val; });
+            boost::transform(filters.FFT,
+                             filters.FFT.begin(),
+                             [](auto val) { return REAL(1) / val; });
+            return filters;
+        };
+
+        auto bytes = [](const DeapodizationFilters& filters)
+        {
+            return filters.IFFT.get_number_of_bytes() + filters.FFT.get_number_of_bytes();
+        };
+
+        return NFFTCache::get<DeapodizationFilters>(key, build, bytes);
     }
 
 
@@ -274,9 +284,9 @@ namespace Gadgetron {
             bool fourierDomain
     ) {
         if (fourierDomain){
-            d *= deapodization_filter_FFT;
+            d *= deapodization_filters_->FFT;
         } else {
-            d *= deapodization_filter_IFFT;
+            d *= deapodization_filters_->IFFT;
         }
     }
 
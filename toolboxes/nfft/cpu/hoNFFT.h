@@ -21,6 +21,8 @@
 #include <boost/shared_ptr.hpp>
 #include "hoArmadillo.h"
 
+#include <memory>
+
 namespace Gadgetron{
 
     /**
@@ -145,8 +147,16 @@ namespace Gadgetron{
 
         private:
 
-            hoNDArray<ComplexType> deapodization_filter_IFFT;
-            hoNDArray<ComplexType> deapodization_filter_FFT;
+            struct DeapodizationFilters
+            {
+                hoNDArray<ComplexType> IFFT;
+                hoNDArray<ComplexType> FFT;
+            };
+
+            /** Inverse deapodization filters, shared through the NFFT cache by plans of the same geometry. */
+            std::shared_ptr<const DeapodizationFilters> deapodization_filters(bool do_scale) const;
+
+            std::shared_ptr<const DeapodizationFilters> deapodization_filters_;
 
     };
 
@@ -0,0 +1,116 @@
+#include "hoNFFTCache.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Gadgetron::NFFTCache {
+
+    namespace {
+        struct KeyHash {
+            size_t operator()(const Key& key) const { return key.hash(); }
+        };
+
+        class Cache {
+        public:
+            static Cache& instance() {
+                static Cache cache;
+                return cache;
+            }
+
+            std::shared_ptr<const void> find(const Key& key) {
+                std::lock_guard<std::mutex> guard(m);
+                auto it = index.find(key);
+                if (it == index.end()) {
+                    misses++;
+                    return nullptr;
+                }
+                hits++;
+                order.splice(order.begin(), order, it->second.position);
+                return it->second.value;
+            }
+
+            void insert(const Key& key, std::shared_ptr<const void> value, size_t size) {
+                std::lock_guard<std::mutex> guard(m);
+                if (size > budget)
+                    return;
+
+                auto [it, inserted] = index.try_emplace(key, Entry{ std::move(value), size, {} });
+                if (!inserted)
+                    return;
+                order.push_front(&it->first);
+                it->second.position = order.begin();
+                bytes += size;
+                evict();
+            }
+
+            void set_budget(size_t new_budget) {
+                std::lock_guard<std::mutex> guard(m);
+                budget = new_budget;
+                evict();
+            }
+
+            size_t get_budget() {
+                std::lock_guard<std::mutex> guard(m);
+                return budget;
+            }
+
+            Statistics statistics() {
+                std::lock_guard<std::mutex> guard(m);
+                return { hits, misses, evictions, index.size(), bytes };
+            }
+
+            void clear() {
+                std::lock_guard<std::mutex> guard(m);
+                order.clear();
+                index.clear();
+                bytes = 0;
+            }
+
+        private:
+            static constexpr size_t default_budget = size_t(1) << 30;
+
+            struct Entry {
+                std::shared_ptr<const void> value;
+                size_t size;
+                std::list<const Key*>::iterator position;
+            };
+
+            void evict() {
+                while (bytes > budget) {
+                    auto oldest = index.find(*order.back());
+                    bytes -= oldest->second.size;
+                    order.pop_back();
+                    index.erase(oldest);
+                    evictions++;
+                }
+            }
+
+            std::mutex m;
+            std::unordered_map<Key, Entry, KeyHash> index;
+            std::list<const Key*> order; // Keys of index, most recently used first.
+            size_t budget = default_budget;
+            size_t bytes = 0;
+            size_t hits = 0, misses = 0, evictions = 0;
+        };
+    }
+
+    size_t Key::hash() const {
+        size_t seed = type.hash_code();
+        return seed ^ (std::hash<std::string>{}(data) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
+    void set_memory_budget(size_t bytes) { Cache::instance().set_budget(bytes); }
+
+    size_t get_memory_budget() { return Cache::instance().get_budget(); }
+
+    Statistics get_statistics() { return Cache::instance().statistics(); }
+
+    void clear() { Cache::instance().clear(); }
+
+    std::shared_ptr<const void> find(const Key& key) { return Cache::instance().find(key); }
+
+    void insert(const Key& key, std::shared_ptr<const void> value, size_t bytes) {
+        Cache::instance().insert(key, std::move(value), bytes);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+
+#include "hoNDArray.h"
+
+namespace Gadgetron::NFFTCache {
+
+    /**
+     * Process-wide cache of the parts of an NFFT plan that depend only on its geometry and trajectory: the gridding
+     * convolution matrices and the deapodization filters. In real-time radial and spiral imaging the same
+     * trajectory comes back every frame, or every few frames, so after the first occurrence preprocessing is a
+     * lookup. FFT plans are cached separately, by hoNDFFT.
+     *
+     * Entries are evicted least recently used first once the memory budget is exceeded. Cached values are
+     * reference counted, so a plan still holding an evicted entry keeps it until it is done with it.
+     */
+
+    /**
+     * Sets the memory budget of the cache in bytes. A budget of zero disables caching and empties the cache.
+     */
+    void set_memory_budget(size_t bytes);
+
+    size_t get_memory_budget();
+
+    struct Statistics {
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+        size_t entries;
+        size_t bytes;
+    };
+
+    Statistics get_statistics();
+
+    void clear();
+
+    /**
+     * Identifies a cache entry by the type of what it holds and the bytes of everything it was computed from.
+     */
+    class Key {
+    public:
+        explicit Key(std::type_index type) : type(type) {}
+
+        template <class T> Key& add(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return add(&value, sizeof(T));
+        }
+
+        template <class T> Key& add(const hoNDArray<T>& array) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            add(array.get_number_of_dimensions());
+            for (auto dimension : array.dimensions()) add(dimension);
+            return add(array.get_data_ptr(), array.get_number_of_bytes());
+        }
+
+        Key& add(const void* bytes, size_t size) {
+            data.append(static_cast<const char*>(bytes), size);
+            return *this;
+        }
+
+        bool operator==(const Key& other) const { return type == other.type && data == other.data; }
+
+        size_t hash() const;
+
+        size_t size() const { return data.size(); }
+
+    private:
+        std::type_index type;
+        std::string data;
+    };
+
+    std::shared_ptr<const void> find(const Key& key);
+
+    void insert(const Key& key, std::shared_ptr<const void> value, size_t bytes);
+
+    /**
+     * Returns the cached value for key, building and caching it on a miss. bytes gives the memory held by a value.
+     */
+    template <class T, class BUILD, class BYTES>
+    std::shared_ptr<const T> get(const Key& key, BUILD&& build, BYTES&& bytes) {
+        if (auto value = find(key))
+            return std::static_pointer_cast<const T>(value);
+
+        auto value = std::make_shared<const T>(build());
+        insert(key, value, bytes(*value) + key.size());
+        return value;
+    }
+}
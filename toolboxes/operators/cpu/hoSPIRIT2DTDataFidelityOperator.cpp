@@ -46,6 +46,18 @@ void hoSPIRIT2DTDataFidelityOperator<T>::mult_MH(ARRAY_TYPE* x, ARRAY_TYPE* y, b
     }
 }
 
+template <typename T>
+void hoSPIRIT2DTDataFidelityOperator<T>::mult_MH_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
+{
+    if (!kspace_forward_.dimensions_equal(*x))
+    {
+        kspace_forward_.create(x->dimensions());
+    }
+
+    this->forward(*x, kspace_forward_);
+    this->mult_MH(&kspace_forward_, y, accumulate);
+}
+
 template <typename T>
 void hoSPIRIT2DTDataFidelityOperator<T>::forward(const ARRAY_TYPE& x, ARRAY_TYPE& y)
 {
@@ -29,10 +29,17 @@ public:
     // y = [(G-I)' + D']*x
     virtual void mult_MH(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
 
+    // y = [(G-I)' + D'][(G-I) + D]*x
+    // D is applied in kspace, so this is mult_M followed by mult_MH rather than the image domain kernel of the base class
+    virtual void mult_MH_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
+
 protected:
 
     void forward(const ARRAY_TYPE& x, ARRAY_TYPE& y);
     void adjoint(const ARRAY_TYPE& x, ARRAY_TYPE& y);
+
+    // helper memory
+    ARRAY_TYPE kspace_forward_;
 };
 
 }
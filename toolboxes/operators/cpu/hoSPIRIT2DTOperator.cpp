@@ -33,11 +33,6 @@ void hoSPIRIT2DTOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool
 
         this->adjoint_kernel_.create(RO, E1, dstCHA, srcCHA, N);
 
-        if (compute_adjoint_forward_kernel)
-        {
-            adjoint_forward_kernel_.create(RO, E1, srcCHA, srcCHA, N);
-        }
-
         size_t n;
         for (n = 0; n<N; n++)
         {
@@ -45,12 +40,16 @@ void hoSPIRIT2DTOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool
             hoNDArray<T> adjKerCurr(RO, E1, dstCHA, srcCHA, this->adjoint_kernel_.begin() + n*RO*E1*dstCHA*srcCHA);
 
             Gadgetron::spirit_image_domain_adjoint_kernel(kerCurr, adjKerCurr);
+        }
 
-            if (compute_adjoint_forward_kernel)
-            {
-                hoNDArray<T> adjFowardKerCurr(RO, E1, srcCHA, srcCHA, this->adjoint_forward_kernel_.begin() + n*RO*E1*srcCHA*srcCHA);
-                Gadgetron::spirit_adjoint_forward_kernel(adjKerCurr, kerCurr, adjFowardKerCurr);
-            }
+        if (compute_adjoint_forward_kernel)
+        {
+            this->prepare_adjoint_forward_kernel();
+        }
+        else
+        {
+            // computed on first use, for the new kernel
+            adjoint_forward_kernel_.clear();
         }
 
         // allocate the helper memory
@@ -78,6 +77,35 @@ void hoSPIRIT2DTOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool
     }
 }
 
+template <typename T>
+void hoSPIRIT2DTOperator<T>::prepare_adjoint_forward_kernel()
+{
+    try
+    {
+        size_t RO     = forward_kernel_.get_size(0);
+        size_t E1     = forward_kernel_.get_size(1);
+        size_t srcCHA = forward_kernel_.get_size(2);
+        size_t dstCHA = forward_kernel_.get_size(3);
+        size_t N      = forward_kernel_.get_size(4);
+
+        adjoint_forward_kernel_.create(RO, E1, srcCHA, srcCHA, N);
+
+        size_t n;
+        for (n = 0; n<N; n++)
+        {
+            hoNDArray<T> kerCurr(RO, E1, srcCHA, dstCHA, this->forward_kernel_.begin() + n*RO*E1*srcCHA*dstCHA);
+            hoNDArray<T> adjKerCurr(RO, E1, dstCHA, srcCHA, this->adjoint_kernel_.begin() + n*RO*E1*dstCHA*srcCHA);
+            hoNDArray<T> adjFowardKerCurr(RO, E1, srcCHA, srcCHA, this->adjoint_forward_kernel_.begin() + n*RO*E1*srcCHA*srcCHA);
+
+            Gadgetron::spirit_adjoint_forward_kernel(adjKerCurr, kerCurr, adjFowardKerCurr);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoSPIRIT2DTOperator<T>::prepare_adjoint_forward_kernel() ... ");
+    }
+}
+
 template <typename T>
 void hoSPIRIT2DTOperator<T>::apply_forward_kernel(ARRAY_TYPE& x)
 {
@@ -290,10 +318,12 @@ void hoSPIRIT2DTOperator<T>::apply_adjoint_forward_kernel(ARRAY_TYPE& x)
         GADGET_CHECK_THROW(this->adjoint_forward_kernel_.get_size(3)==srcCHA);
         size_t kernelN = this->adjoint_forward_kernel_.get_size(4);
 
+        this->res_after_apply_kernel_sum_over_dst_.create(RO, E1, srcCHA, N);
+
         long long n;
-        for (n = 0; n < (long long)N; N++)
+        for (n = 0; n < (long long)N; n++)
         {
-            hoNDArray<T> currComplexIm(RO, E1, srcCHA, this->complexIm_.begin() + n*RO*E1*srcCHA);
+            hoNDArray<T> currComplexIm(RO, E1, srcCHA, x.begin() + n*RO*E1*srcCHA);
 
             hoNDArray<T> curr_adjoint_forward_kernel;
 
@@ -318,11 +348,68 @@ void hoSPIRIT2DTOperator<T>::apply_adjoint_forward_kernel(ARRAY_TYPE& x)
     }
 }
 
+template <typename T>
+void hoSPIRIT2DTOperator<T>::mult_MH_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
+{
+    try
+    {
+        // Dc(G-I)'(G-I)Dc'x
+
+        if (adjoint_forward_kernel_.get_number_of_elements() == 0)
+        {
+            this->prepare_adjoint_forward_kernel();
+        }
+
+        if (accumulate)
+        {
+            kspace_dst_ = *y;
+        }
+
+        if (no_null_space_)
+        {
+            this->convert_to_image(*x, complexIm_);
+        }
+        else
+        {
+            Gadgetron::multiply(unacquired_points_indicator_, *x, *y);
+
+            // x to image domain
+            this->convert_to_image(*y, complexIm_);
+        }
+
+        // apply adjoint_forward kernel and sum
+        this->apply_adjoint_forward_kernel(complexIm_);
+
+        // go back to kspace
+        this->convert_to_kspace(res_after_apply_kernel_sum_over_dst_, *y);
+
+        if (!no_null_space_)
+        {
+            // apply Dc
+            Gadgetron::multiply(unacquired_points_indicator_, *y, *y);
+        }
+
+        if (accumulate)
+        {
+            Gadgetron::add(kspace_dst_, *y, *y);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoSPIRIT2DTOperator<T>::mult_MH_M(...) ... ");
+    }
+}
+
 template <typename T>
 void hoSPIRIT2DTOperator<T>::gradient(ARRAY_TYPE* x, ARRAY_TYPE* g, bool accumulate)
 {
     try
     {
+        if (adjoint_forward_kernel_.get_number_of_elements() == 0)
+        {
+            this->prepare_adjoint_forward_kernel();
+        }
+
         if (accumulate)
         {
             kspace_ = *g;
@@ -33,6 +33,8 @@ public:
     virtual void mult_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
     /// apply Dc(G-I)'
     virtual void mult_MH(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
+    /// apply Dc(G-I)'(G-I)Dc' in one round trip to image domain
+    virtual void mult_MH_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
 
     /// compute right hand side
     /// b = -(G-I)D'x
@@ -55,6 +57,9 @@ protected:
     virtual void convert_to_image(const ARRAY_TYPE& x, ARRAY_TYPE& im);
     virtual void convert_to_kspace(const ARRAY_TYPE& im, ARRAY_TYPE& x);
 
+    /// compute the adjoint_forward kernel for every 2D kernel
+    virtual void prepare_adjoint_forward_kernel();
+
     using BaseClass::forward_kernel_;
     using BaseClass::adjoint_kernel_;
     using BaseClass::adjoint_forward_kernel_;
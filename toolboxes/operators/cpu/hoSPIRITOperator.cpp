@@ -109,7 +109,12 @@ void hoSPIRITOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool co
 
         if (compute_adjoint_forward_kernel)
         {
-            GADGET_CATCH_THROW(Gadgetron::spirit_adjoint_forward_kernel(adjoint_kernel_, forward_kernel_, adjoint_forward_kernel_));
+            this->prepare_adjoint_forward_kernel();
+        }
+        else
+        {
+            // computed on first use, for the new kernel
+            adjoint_forward_kernel_.clear();
         }
 
         // allocate the helper memory
@@ -138,6 +143,12 @@ void hoSPIRITOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool co
     }
 }
 
+template <typename T>
+void hoSPIRITOperator<T>::prepare_adjoint_forward_kernel()
+{
+    GADGET_CATCH_THROW(Gadgetron::spirit_adjoint_forward_kernel(adjoint_kernel_, forward_kernel_, adjoint_forward_kernel_));
+}
+
 template<typename T>
 void hoSPIRITOperator<T>::sum_over_src_channel(const ARRAY_TYPE& x, ARRAY_TYPE& r)
 {
@@ -262,6 +273,59 @@ void hoSPIRITOperator<T>::mult_MH(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
     }
 }
 
+template <typename T>
+void hoSPIRITOperator<T>::mult_MH_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
+{
+    try
+    {
+        // Dc(G-I)'(G-I)Dc'x or if no_null_space_ == true, (G-I)'(G-I)x
+
+        if (adjoint_forward_kernel_.get_number_of_elements() == 0)
+        {
+            this->prepare_adjoint_forward_kernel();
+        }
+
+        if (accumulate)
+        {
+            kspace_ = *y;
+        }
+
+        if (no_null_space_)
+        {
+            this->convert_to_image(*x, complexIm_);
+        }
+        else
+        {
+            Gadgetron::multiply(unacquired_points_indicator_, *x, *y);
+
+            // x to image domain
+            this->convert_to_image(*y, complexIm_);
+        }
+
+        // apply combined kernel and sum
+        Gadgetron::multiply(adjoint_forward_kernel_, complexIm_, res_after_apply_kernel_);
+        this->sum_over_src_channel(res_after_apply_kernel_, res_after_apply_kernel_sum_over_);
+
+        // go back to kspace
+        this->convert_to_kspace(res_after_apply_kernel_sum_over_, *y);
+
+        if (!no_null_space_)
+        {
+            // apply Dc
+            Gadgetron::multiply(unacquired_points_indicator_, *y, *y);
+        }
+
+        if (accumulate)
+        {
+            Gadgetron::add(kspace_, *y, *y);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoSPIRITOperator<T>::mult_MH_M(...) ... ");
+    }
+}
+
 template <typename T>
 void hoSPIRITOperator<T>::compute_righ_hand_side(const ARRAY_TYPE& x, ARRAY_TYPE& b)
 {
@@ -304,6 +368,11 @@ void hoSPIRITOperator<T>::gradient(ARRAY_TYPE* x, ARRAY_TYPE* g, bool accumulate
 {
     try
     {
+        if (adjoint_forward_kernel_.get_number_of_elements() == 0)
+        {
+            this->prepare_adjoint_forward_kernel();
+        }
+
         if (accumulate)
         {
             kspace_ = *g;
@@ -40,6 +40,10 @@ public:
     /// apply Dc(G-I)'
     /// if no_null_space_==true, (G-I)'
     virtual void mult_MH(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
+    /// apply Dc(G-I)'(G-I)Dc', with the combined kernel (G-I)'(G-I) applied in image domain,
+    /// so one round trip to image domain replaces the two of mult_M followed by mult_MH
+    /// if no_null_space_==true, apply (G-I)'(G-I)
+    virtual void mult_MH_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate = false);
 
     /// compute right hand side
     /// b = -(G-I)D'x
@@ -87,6 +91,10 @@ protected:
     virtual void convert_to_image(const ARRAY_TYPE& x, ARRAY_TYPE& im) = 0;
     virtual void convert_to_kspace(const ARRAY_TYPE& im, ARRAY_TYPE& x) = 0;
 
+    /// compute adjoint_forward_kernel_ from the forward and adjoint kernels
+    /// called by set_forward_kernel if asked for, otherwise on first use
+    virtual void prepare_adjoint_forward_kernel();
+
     // G-I, [... srcCHA dstCHA]
     ARRAY_TYPE forward_kernel_;
     // (G-I)', [... dstCHA srcCHA]
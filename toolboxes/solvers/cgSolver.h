@@ -185,23 +185,23 @@ namespace Gadgetron{
       // Create result array and clear
       //
 
-      boost::shared_ptr<ARRAY_TYPE> result = boost::shared_ptr<ARRAY_TYPE>(new ARRAY_TYPE(image_dims));
+      boost::shared_ptr<ARRAY_TYPE> result = this->workspace_.get_shared(CG_RHS, image_dims);
       clear(result.get());
     
       // Create temporary array
       //
 
-      ARRAY_TYPE tmp(image_dims);
+      ARRAY_TYPE *tmp = this->workspace_.get(CG_MHM, image_dims);
 
       // Compute operator adjoint
       //
 
-      this->encoding_operator_->mult_MH( d, &tmp );
+      this->encoding_operator_->mult_MH( d, tmp );
     
       // Apply weight
       //
 
-      axpy(ELEMENT_TYPE(this->encoding_operator_->get_weight()), &tmp, result.get() );
+      axpy(ELEMENT_TYPE(this->encoding_operator_->get_weight()), tmp, result.get() );
     
       return result;
     }
@@ -213,6 +213,9 @@ namespace Gadgetron{
     // and not intended to be exposed as a public interface
     //
 
+    // Workspace slots of the iteration buffers
+    enum { CG_X, CG_R, CG_P, CG_Q, CG_MHM, CG_RHS };
+
     // Initialize solver
     //
 
@@ -228,14 +231,16 @@ namespace Gadgetron{
       // Result, x
       //
 
-      x_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(rhs->dimensions()) );
+      x_ = this->workspace_.get_shared(CG_X, rhs->dimensions());
     
     
       // Initialize r,p,x
       //
 
-      r_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*rhs) );
-      p_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*r_) );
+      r_ = this->workspace_.get_shared(CG_R, rhs->dimensions());
+      *r_ = *rhs;
+      p_ = this->workspace_.get_shared(CG_P, rhs->dimensions());
+      *p_ = *r_;
     
       if( !this->get_x0().get() ){ // no starting image provided      
 	clear(x_.get());
@@ -259,15 +264,15 @@ namespace Gadgetron{
 	
         *x_ = *(this->get_x0());
         
-        ARRAY_TYPE mhmX(rhs->dimensions());
+        ARRAY_TYPE *mhmX = this->workspace_.get(CG_Q, rhs->dimensions());
 
         if( this->output_mode_ >= solver<ARRAY_TYPE,ARRAY_TYPE>::OUTPUT_VERBOSE ) {
           GDEBUG_STREAM("Preparing guess..." << std::endl);
         }
         
-        mult_MH_M( this->get_x0().get(), &mhmX );
+        mult_MH_M( this->get_x0().get(), mhmX );
         
-        *r_ -= mhmX;
+        *r_ -= *mhmX;
         *p_ = *r_;
         
         // Apply preconditioning, twice (should change preconditioners to do this)
@@ -302,35 +307,35 @@ namespace Gadgetron{
 
     virtual void iterate( unsigned int iteration, REAL *tc_metric, bool *tc_terminate )
     {
-      ARRAY_TYPE q = ARRAY_TYPE(x_->dimensions());
+      ARRAY_TYPE *q = this->workspace_.get(CG_Q, x_->dimensions());
 
       // Perform one iteration of the solver
       //
 
-      mult_MH_M( p_.get(), &q );
+      mult_MH_M( p_.get(), q );
     
       // Update solution
       //
 
-      alpha_ = rq_/dot( p_.get(), &q );
+      alpha_ = rq_/dot( p_.get(), q );
       axpy( alpha_, p_.get(), x_.get());
 
       // Update residual
       //
 
-      axpy( -alpha_, &q, r_.get());
+      axpy( -alpha_, q, r_.get());
 
       // Apply preconditioning
       //
 
       if( precond_.get() ){
 
-        precond_->apply( r_.get(), &q );
-        precond_->apply( &q, &q );
+        precond_->apply( r_.get(), q );
+        precond_->apply( q, q );
         
-        REAL tmp_rq = real(dot( r_.get(), &q ));      
+        REAL tmp_rq = real(dot( r_.get(), q ));      
         *p_ *= ELEMENT_TYPE((tmp_rq/rq_));
-        axpy( ELEMENT_TYPE(1), &q, p_.get() );
+        axpy( ELEMENT_TYPE(1), q, p_.get() );
         rq_ = tmp_rq;
       } 
       else{
@@ -368,7 +373,7 @@ namespace Gadgetron{
       // Intermediate storage
       //
 
-      ARRAY_TYPE q = ARRAY_TYPE(in->dimensions());
+      ARRAY_TYPE *q = this->workspace_.get(CG_MHM, in->dimensions());
 
       // Start by clearing the output
       //
@@ -377,15 +382,15 @@ namespace Gadgetron{
       // Apply encoding operator
       //
 
-      this->encoding_operator_->mult_MH_M( in, &q, false );
-      axpy( ELEMENT_TYPE (this->encoding_operator_->get_weight()), &q, out );
+      this->encoding_operator_->mult_MH_M( in, q, false );
+      axpy( ELEMENT_TYPE (this->encoding_operator_->get_weight()), q, out );
 
       // Iterate over regularization operators
       //
 
       for( unsigned int i=0; i<this->regularization_operators_.size(); i++ ){      
-        this->regularization_operators_[i]->mult_MH_M( in, &q, false );
-        axpy( ELEMENT_TYPE(this->regularization_operators_[i]->get_weight()), &q, out );
+        this->regularization_operators_[i]->mult_MH_M( in, q, false );
+        axpy( ELEMENT_TYPE(this->regularization_operators_[i]->get_weight()), q, out );
       }      
     }
     
@@ -68,13 +68,14 @@ public:
 			throw std::runtime_error("Error: lbfgsSolver::compute_rhs : encoding operator has not set domain dimension" );
 		}
 
-		ARRAY_TYPE * x = new ARRAY_TYPE(image_dims); //The image. Will be returned inside a shared_ptr
+		boost::shared_ptr<ARRAY_TYPE> result = this->workspace_.get_shared(LBFGS_X,image_dims);
+		ARRAY_TYPE * x = result.get(); //The image
 
-		ARRAY_TYPE g(image_dims); //Contains the gradient of the current step
-		ARRAY_TYPE g_old(image_dims); //Contains the gradient of the previous step
+		ARRAY_TYPE& g = *this->workspace_.get(LBFGS_G,image_dims); //Contains the gradient of the current step
+		ARRAY_TYPE& g_old = *this->workspace_.get(LBFGS_G_OLD,image_dims); //Contains the gradient of the previous step
 
 
-		ARRAY_TYPE g_linear(image_dims); //Contains the linear part of the gradient;
+		ARRAY_TYPE& g_linear = *this->workspace_.get(LBFGS_G_LINEAR,image_dims); //Contains the linear part of the gradient;
 
 		//If a prior image was given, use it for the initial guess.
 		if (this->x0_.get()){
@@ -97,14 +98,14 @@ public:
 		}
 		std::vector<ARRAY_TYPE> regEnc2 = regEnc;
 
-		ARRAY_TYPE d(image_dims); //Search direction.
+		ARRAY_TYPE& d = *this->workspace_.get(LBFGS_D,image_dims); //Search direction.
 		clear(&d);
 
-		ARRAY_TYPE encoding_space(in->get_dimensions()); //Contains the encoding space, or, equivalently, the residual vector
+		ARRAY_TYPE& encoding_space = *this->workspace_.get(LBFGS_ENCODING_SPACE,in->dimensions()); //Contains the encoding space, or, equivalently, the residual vector
 
-		ARRAY_TYPE g_step(image_dims); //Linear part of the gradient of the step d will be stored here
+		ARRAY_TYPE& g_step = *this->workspace_.get(LBFGS_G_STEP,image_dims); //Linear part of the gradient of the step d will be stored here
 
-		ARRAY_TYPE encoding_space2(in->get_dimensions());
+		ARRAY_TYPE& encoding_space2 = *this->workspace_.get(LBFGS_ENCODING_SPACE2,in->dimensions());
 		REAL reg_res,data_res;
 
 
@@ -194,7 +195,7 @@ public:
 					alpha=cg_linesearch(f,alpha0,gd,old_norm);
 				if (alpha == 0) {
 					std::cerr << "Linesearch failed, returning current iteration" << std::endl;
-					return boost::shared_ptr<ARRAY_TYPE>(x);
+					return result;
 				}
 			}
 
@@ -208,7 +209,7 @@ public:
 				reg_axpy(-alpha,regEnc2,regEnc);
 				axpy(-alpha,&g_step,&g_linear);
 
-				ARRAY_TYPE x2 = *x;
+				ARRAY_TYPE& x2 = *this->workspace_.get_copy(LBFGS_X2,*x);
 				axpy(alpha,&d,&x2);
 
 				clamp_min(&x2,REAL(0));
@@ -235,7 +236,7 @@ public:
 				axpy(alpha,&d,x);
 				if (alpha == 0){
 					std::cerr << "Linesearch failed, returning current iteration" << std::endl;
-					return boost::shared_ptr<ARRAY_TYPE>(x);
+					return result;
 				}
 			} else {
 				axpy(alpha,&d,x);
@@ -263,8 +264,11 @@ public:
 				*(pair.s) = d;
 				*(pair.y) = g;
 			} else {
-				pair.s = boost::shared_ptr<ARRAY_TYPE>(new ARRAY_TYPE(d));
-				pair.y = boost::shared_ptr<ARRAY_TYPE>(new ARRAY_TYPE(g));
+				//Pairs of earlier solves are released with their subspace, so their buffers are free again
+				pair.s = this->workspace_.get_shared(LBFGS_PAIRS+2*subspace.size(),d.dimensions());
+				pair.y = this->workspace_.get_shared(LBFGS_PAIRS+2*subspace.size()+1,g.dimensions());
+				*(pair.s) = d;
+				*(pair.y) = g;
 			}
 			*(pair.s) *= alpha;
 			*(pair.y) -= g_old;
@@ -281,7 +285,7 @@ public:
 
 		}
 
-		return boost::shared_ptr<ARRAY_TYPE>(x);
+		return result;
 																																	}
 
 
@@ -358,6 +362,23 @@ protected:
 	typedef typename std::vector<boost::shared_ptr<linearOperator<ARRAY_TYPE> > >::iterator  csIterator;
 	typedef typename std::vector< std::vector<boost::shared_ptr<linearOperator<ARRAY_TYPE> > > >::iterator csGroupIterator;
 
+	// Workspace slots of the iteration buffers, followed by the s and y buffers of the BFGS pairs
+	enum {
+		LBFGS_X,
+		LBFGS_G,
+		LBFGS_G_OLD,
+		LBFGS_G_LINEAR,
+		LBFGS_D,
+		LBFGS_ENCODING_SPACE,
+		LBFGS_G_STEP,
+		LBFGS_ENCODING_SPACE2,
+		LBFGS_X2,
+		LBFGS_XTMP,
+		LBFGS_G_TMP,
+		LBFGS_LINEAR_GRADIENT,
+		LBFGS_PAIRS
+	};
+
 	virtual void iteration_callback(ARRAY_TYPE* x ,int iteration,REAL value){};
 
 
@@ -371,10 +392,10 @@ protected:
 	}
 
 	void add_linear_gradient(std::vector<ARRAY_TYPE>& elems, ARRAY_TYPE* g){
-		ARRAY_TYPE tmp(g->get_dimensions());
+		ARRAY_TYPE* tmp = this->workspace_.get(LBFGS_LINEAR_GRADIENT,g->dimensions());
 		for (int i = 0; i <elems.size(); i++){
-			this->regularization_operators_[i]->mult_MH(&elems[i],&tmp);
-			axpy(std::sqrt(this->regularization_operators_[i]->get_weight()),&tmp,g);
+			this->regularization_operators_[i]->mult_MH(&elems[i],tmp);
+			axpy(std::sqrt(this->regularization_operators_[i]->get_weight()),tmp,g);
 		}
 	}
 
@@ -444,9 +465,9 @@ protected:
 			regEnc = _regEnc;
 			regEnc_step = _regEnc_step;
 			x = _x;
-			xtmp = *x;
 			d = _d;
 			parent = _parent;
+			xtmp = parent->workspace_.get_copy(LBFGS_XTMP,*x);
 			alpha_old = 0;
 			g = _g;
 			g_step = _g_step;
@@ -460,18 +481,18 @@ protected:
 
 			axpy(alpha-alpha_old,g_step,g);
 			parent->reg_axpy(alpha-alpha_old,*regEnc_step,*regEnc);
-			axpy(alpha-alpha_old,d,&xtmp);
+			axpy(alpha-alpha_old,d,xtmp);
 
 			alpha_old = alpha;
-			REAL res = parent->functionValue(encoding_space,*regEnc,&xtmp);
+			REAL res = parent->functionValue(encoding_space,*regEnc,xtmp);
 			return res;
 
 		}
 
 		ELEMENT_TYPE dir_deriv(){
-			ARRAY_TYPE g_tmp = *g;
-			parent->add_gradient(&xtmp,&g_tmp);
-			return dot(d,&g_tmp);
+			ARRAY_TYPE* g_tmp = parent->workspace_.get_copy(LBFGS_G_TMP,*g);
+			parent->add_gradient(xtmp,g_tmp);
+			return dot(d,g_tmp);
 		}
 
 
@@ -490,7 +511,7 @@ protected:
 		ARRAY_TYPE* g, *g_step;
 
 		lbfgsSolver<ARRAY_TYPE>* parent;
-		ARRAY_TYPE xtmp;
+		ARRAY_TYPE* xtmp;
 
 
 	};
@@ -6,6 +6,7 @@
 
 #include "solver.h"
 #include "linearOperator.h"
+#include "solverWorkspace.h"
 
 #include <vector>
 #include <iostream>
@@ -61,6 +62,12 @@ namespace Gadgetron{
     {
       return regularization_operators_.size();
     }
+
+    // Iteration buffers of the solver, kept across solves
+    virtual solverWorkspace<ARRAY_TYPE>& get_workspace()
+    {
+      return workspace_;
+    }
     
   protected:
   
@@ -69,6 +76,10 @@ namespace Gadgetron{
   
     // Vector of linear regularization operators
     std::vector< boost::shared_ptr< linearOperator<ARRAY_TYPE> > > regularization_operators_;
+
+    // Iteration buffers, see solverWorkspace.h
+    solverWorkspace<ARRAY_TYPE> workspace_;
+
     typedef typename ARRAY_TYPE::element_type ELEMENT_TYPE;
     typedef typename realType<ELEMENT_TYPE>::Type REAL;
   };
@@ -61,7 +61,7 @@ public:
             int flag = 1;
 
             REAL tolb = tc_tolerance_ * n2b;
-            ARRAY_TYPE u(*b);
+            ARRAY_TYPE& u = *this->workspace_.get_copy(LSQR_U, *b);
 
             this->encoding_operator_->mult_M(x, &u);
             Gadgetron::subtract(*b, u, u);
@@ -78,7 +78,7 @@ public:
             REAL s = 0;
             REAL phibar = beta;
 
-            ARRAY_TYPE v(*x);
+            ARRAY_TYPE& v = *this->workspace_.get_copy(LSQR_V, *x);
             this->encoding_operator_->mult_MH(&u, &v);
 
             REAL alpha = Gadgetron::nrm2(&v);
@@ -87,7 +87,7 @@ public:
                 Gadgetron::scal(REAL(1.0) / alpha, v);
             }
 
-            ARRAY_TYPE d(*x);
+            ARRAY_TYPE& d = *this->workspace_.get(LSQR_D, x->dimensions());
             Gadgetron::clear(d);
 
             REAL normar;
@@ -106,17 +106,19 @@ public:
             size_t iter = iterations_;
             size_t  maxstagsteps = 3;
 
-            ARRAY_TYPE z(v), dtmp(d), ztmp(v), vt(v), utmp(u);
-            ARRAY_TYPE normaVec(3);
+            ARRAY_TYPE& dtmp = *this->workspace_.get(LSQR_DTMP, d.dimensions());
+            ARRAY_TYPE& ztmp = *this->workspace_.get(LSQR_ZTMP, v.dimensions());
+            ARRAY_TYPE& vt = *this->workspace_.get(LSQR_VT, v.dimensions());
+            ARRAY_TYPE& utmp = *this->workspace_.get(LSQR_UTMP, u.dimensions());
+            ARRAY_TYPE& normaVec = *this->workspace_.get(LSQR_NORMA, std::vector<size_t>(1, 3));
 
             REAL thet, rhot, rho, phi, tmp, tmp2;
 
             size_t ii;
             for (ii = 0; ii<iterations_; ii++)
             {
-                z = v;
-
-                this->encoding_operator_->mult_M(&z, &utmp);
+                // v is left unchanged until the end of the iteration, so it is used in place of a copy
+                this->encoding_operator_->mult_M(&v, &utmp);
                 Gadgetron::scal(alpha, u);
                 Gadgetron::subtract(utmp, u, u);
 
@@ -143,7 +145,7 @@ public:
 
                 dtmp = d;
                 Gadgetron::scal(thet, dtmp);
-                Gadgetron::subtract(z, dtmp, ztmp);
+                Gadgetron::subtract(v, dtmp, ztmp);
                 Gadgetron::scal(REAL(1.0) / rho, ztmp);
 
                 d = ztmp;
@@ -235,6 +237,9 @@ public:
 
 protected:
 
+    // Workspace slots of the iteration buffers
+    enum { LSQR_U, LSQR_V, LSQR_D, LSQR_DTMP, LSQR_ZTMP, LSQR_VT, LSQR_UTMP, LSQR_NORMA };
+
     unsigned int iterations_;
     REAL tc_tolerance_;
 };
@@ -54,12 +54,13 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
             throw std::runtime_error("Error: nlcgSolver::compute_rhs : encoding operator has not set domain dimension");
         }
 
-        ARRAY_TYPE* x = new ARRAY_TYPE(image_dims); // The image. Will be returned inside a shared_ptr
+        boost::shared_ptr<ARRAY_TYPE> result = this->workspace_.get_shared(NLCG_X, image_dims);
+        ARRAY_TYPE* x = result.get(); // The image
 
-        ARRAY_TYPE g(image_dims);     // Contains the gradient of the current step
-        ARRAY_TYPE g_old(image_dims); // Contains the gradient of the previous step
+        ARRAY_TYPE& g = *this->workspace_.get(NLCG_G, image_dims);         // Contains the gradient of the current step
+        ARRAY_TYPE& g_old = *this->workspace_.get(NLCG_G_OLD, image_dims); // Contains the gradient of the previous step
 
-        ARRAY_TYPE g_linear(image_dims); // Contains the linear part of the gradient;
+        ARRAY_TYPE& g_linear = *this->workspace_.get(NLCG_G_LINEAR, image_dims); // Contains the linear part of the gradient;
 
         // If a prior image was given, use it for the initial guess.
         if (this->x0_.get()) {
@@ -81,15 +82,16 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
         }
         std::vector<ARRAY_TYPE> regEnc2 = regEnc;
 
-        ARRAY_TYPE d(image_dims); // Search direction.
+        ARRAY_TYPE& d = *this->workspace_.get(NLCG_D, image_dims); // Search direction.
         clear(&d);
 
-        ARRAY_TYPE encoding_space(
-            in->get_dimensions()); // Contains the encoding space, or, equivalently, the residual vector
+        ARRAY_TYPE& encoding_space = *this->workspace_.get(
+            NLCG_ENCODING_SPACE, in->dimensions()); // Contains the encoding space, or, equivalently, the residual vector
 
-        ARRAY_TYPE g_step(image_dims); // Linear part of the gradient of the step d will be stored here
+        ARRAY_TYPE& g_step =
+            *this->workspace_.get(NLCG_G_STEP, image_dims); // Linear part of the gradient of the step d will be stored here
 
-        ARRAY_TYPE encoding_space2(in->get_dimensions());
+        ARRAY_TYPE& encoding_space2 = *this->workspace_.get(NLCG_ENCODING_SPACE2, in->dimensions());
         REAL reg_res, data_res;
 
         if (this->output_mode_ >= solver<ARRAY_TYPE, ARRAY_TYPE>::OUTPUT_VERBOSE) {
@@ -202,7 +204,7 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
                 // alpha=cg_linesearch(f,alpha0,gd,old_norm);
                 if (alpha == 0) {
                     std::cerr << "Linesearch failed, returning current iteration" << std::endl;
-                    return boost::shared_ptr<ARRAY_TYPE>(x);
+                    return result;
                 }
             }
 
@@ -214,7 +216,7 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
                 reg_axpy(-alpha, regEnc2, regEnc);
                 axpy(ELEMENT_TYPE(-alpha), &g_step, &g_linear);
 
-                ARRAY_TYPE x2 = *x;
+                ARRAY_TYPE& x2 = *this->workspace_.get_copy(NLCG_X2, *x);
                 axpy(ELEMENT_TYPE(alpha), &d, &x2);
 
                 clamp_min(&x2, REAL(0));
@@ -241,7 +243,7 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
                 axpy(ELEMENT_TYPE(alpha), &d, x);
                 if (alpha == 0) {
                     std::cerr << "Linesearch failed, returning current iteration" << std::endl;
-                    return boost::shared_ptr<ARRAY_TYPE>(x);
+                    return result;
                 }
             } else {
                 axpy(ELEMENT_TYPE(alpha), &d, x);
@@ -259,7 +261,7 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
                 break;
         }
 
-        return boost::shared_ptr<ARRAY_TYPE>(x);
+        return result;
     }
 
     // Set preconditioner
@@ -330,6 +332,22 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
 
   protected:
     typedef typename std::vector<boost::shared_ptr<linearOperator<ARRAY_TYPE>>>::iterator csIterator;
+
+    // Workspace slots of the iteration buffers
+    enum {
+        NLCG_X,
+        NLCG_G,
+        NLCG_G_OLD,
+        NLCG_G_LINEAR,
+        NLCG_D,
+        NLCG_ENCODING_SPACE,
+        NLCG_G_STEP,
+        NLCG_ENCODING_SPACE2,
+        NLCG_X2,
+        NLCG_XTMP,
+        NLCG_G_TMP,
+        NLCG_LINEAR_GRADIENT
+    };
     typedef typename std::vector<std::vector<boost::shared_ptr<linearOperator<ARRAY_TYPE>>>>::iterator csGroupIterator;
 
     virtual void iteration_callback(ARRAY_TYPE*, int i, REAL, REAL) {};
@@ -342,10 +360,10 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
     }
 
     void add_linear_gradient(std::vector<ARRAY_TYPE>& elems, ARRAY_TYPE* g) {
-        ARRAY_TYPE tmp(g->get_dimensions());
+        ARRAY_TYPE* tmp = this->workspace_.get(NLCG_LINEAR_GRADIENT, g->dimensions());
         for (int i = 0; i < elems.size(); i++) {
-            this->regularization_operators_[i]->mult_MH(&elems[i], &tmp);
-            axpy(ELEMENT_TYPE(std::sqrt(this->regularization_operators_[i]->get_weight())), &tmp, g);
+            this->regularization_operators_[i]->mult_MH(&elems[i], tmp);
+            axpy(ELEMENT_TYPE(std::sqrt(this->regularization_operators_[i]->get_weight())), tmp, g);
         }
     }
 
@@ -372,9 +390,9 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
             regEnc = _regEnc;
             regEnc_step = _regEnc_step;
             x = _x;
-            xtmp = *x;
             d = _d;
             parent = _parent;
+            xtmp = parent->workspace_.get_copy(NLCG_XTMP, *x);
             alpha_old = 0;
             g = _g;
             g_step = _g_step;
@@ -385,17 +403,17 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
 
             axpy(ELEMENT_TYPE(alpha - alpha_old), g_step, g);
             parent->reg_axpy(alpha - alpha_old, *regEnc_step, *regEnc);
-            axpy(ELEMENT_TYPE(alpha - alpha_old), d, &xtmp);
+            axpy(ELEMENT_TYPE(alpha - alpha_old), d, xtmp);
 
             alpha_old = alpha;
-            REAL res = parent->functionValue(encoding_space, *regEnc, &xtmp);
+            REAL res = parent->functionValue(encoding_space, *regEnc, xtmp);
             return res;
         }
 
         ELEMENT_TYPE dir_deriv() {
-            ARRAY_TYPE g_tmp = *g;
-            parent->add_gradient(&xtmp, &g_tmp);
-            return dot(d, &g_tmp);
+            ARRAY_TYPE* g_tmp = parent->workspace_.get_copy(NLCG_G_TMP, *g);
+            parent->add_gradient(xtmp, g_tmp);
+            return dot(d, g_tmp);
         }
 
       private:
@@ -408,7 +426,7 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
         ARRAY_TYPE *g, *g_step;
 
         nlcgSolver<ARRAY_TYPE>* parent;
-        ARRAY_TYPE xtmp;
+        ARRAY_TYPE* xtmp;
     };
     friend class FunctionEstimator;
 
@@ -528,8 +528,8 @@ class sbSolver : public linearOperatorSolver<ARRAY_TYPE_ELEMENT> {
 
         // Define u_k
         //
-        boost::shared_ptr<ARRAY_TYPE_ELEMENT> u_k(
-            new ARRAY_TYPE_ELEMENT(this->encoding_operator_->get_domain_dimensions()));
+        boost::shared_ptr<ARRAY_TYPE_ELEMENT> u_k =
+            this->workspace_.get_shared(SB_U_K, this->encoding_operator_->get_domain_dimensions());
 
         // Use x0 (if provided) as starting solution estimate
         //
@@ -539,7 +539,8 @@ class sbSolver : public linearOperatorSolver<ARRAY_TYPE_ELEMENT> {
             clear(u_k.get());
 
         // Normalize and _then_ initialize (the order matters)
-        boost::shared_ptr<ARRAY_TYPE_ELEMENT> f(new ARRAY_TYPE_ELEMENT(*_f));
+        boost::shared_ptr<ARRAY_TYPE_ELEMENT> f = this->workspace_.get_shared(SB_F, _f->dimensions());
+        *f = *_f;
         REAL normalization_factor = normalize_data(f.get());
         initialize(normalization_factor);
 
@@ -564,6 +565,9 @@ class sbSolver : public linearOperatorSolver<ARRAY_TYPE_ELEMENT> {
     // and not intended to be exposed as a public interface
     //
 
+    // Workspace slots of the iteration buffers, the last two used by the constrained solver (sbcSolver)
+    enum { SB_U_K, SB_F, SB_DATA, SB_F_K, SB_ENCODED_IMAGE };
+
     // Validate operator
     //
 
@@ -706,12 +710,12 @@ class sbSolver : public linearOperatorSolver<ARRAY_TYPE_ELEMENT> {
                 if (this->output_mode_ >= solver<ARRAY_TYPE_ELEMENT, ARRAY_TYPE_ELEMENT>::OUTPUT_VERBOSE)
                     GDEBUG_STREAM(std::endl << "SB inner loop iteration " << inner_iteration << std::endl << std::endl);
 
-                { // Brackets used to free 'data' below as soon as it goes out of scope
+                { // Brackets used to limit the scope of the views into 'data' below
 
                     // Setup input vector to the encoding operator container (argument to the inner solver's solve)
                     //
 
-                    ARRAY_TYPE_ELEMENT data(enc_op_container_->get_codomain_dimensions());
+                    ARRAY_TYPE_ELEMENT& data = *this->workspace_.get(SB_DATA, enc_op_container_->get_codomain_dimensions());
                     ARRAY_TYPE_ELEMENT tmp(f->dimensions(), data.get_data_ptr());
 
                     tmp = *f;
@@ -31,7 +31,7 @@ namespace Gadgetron{
 
       // Define u_k
       //
-      boost::shared_ptr<ARRAY_TYPE_ELEMENT> u_k( new ARRAY_TYPE_ELEMENT(this->encoding_operator_->get_domain_dimensions()));
+      boost::shared_ptr<ARRAY_TYPE_ELEMENT> u_k = this->workspace_.get_shared(this->SB_U_K, this->encoding_operator_->get_domain_dimensions());
 
       // Use x0 (if provided) as starting estimate
       if(this->get_x0().get())
@@ -43,9 +43,11 @@ namespace Gadgetron{
       // Normalize and _then_ initialize (the order matters)
       //
       
-      boost::shared_ptr<ARRAY_TYPE_ELEMENT> f(new ARRAY_TYPE_ELEMENT(*_f));
+      boost::shared_ptr<ARRAY_TYPE_ELEMENT> f = this->workspace_.get_shared(this->SB_F, _f->dimensions());
+      *f = *_f;
       REAL normalization_factor = this->normalize_data( f.get() );
-      boost::shared_ptr<ARRAY_TYPE_ELEMENT> f_k(new ARRAY_TYPE_ELEMENT(*f));
+      boost::shared_ptr<ARRAY_TYPE_ELEMENT> f_k = this->workspace_.get_shared(this->SB_F_K, f->dimensions());
+      *f_k = *f;
       this->initialize( normalization_factor );
         
       // Outer loop
@@ -64,7 +66,7 @@ namespace Gadgetron{
 	// Update f_k
 	//
 
-	ARRAY_TYPE_ELEMENT encoded_image(f->get_dimensions());
+	ARRAY_TYPE_ELEMENT& encoded_image = *this->workspace_.get(this->SB_ENCODED_IMAGE, f->dimensions());
 	this->encoding_operator_->mult_M( u_k.get(), &encoded_image );
 	encoded_image -= *f;
 
@@ -0,0 +1,93 @@
+/** \file solverWorkspace.h
+    \brief Iteration buffers of a solver, kept from one iteration and one solve to the next.
+
+    The iterative solvers need a handful of arrays of the size of the image or of the encoded data for each solve.
+    Rather than creating them as temporaries, which allocates (and page faults and zeroes) them again in every
+    iteration, a solver takes them from its workspace. Each buffer lives in a numbered slot and is only allocated
+    when the slot is first used or the dimensions of the problem change, so repeated solves of problems of the same
+    size, e.g. per slice or per frame, allocate nothing after the first.
+
+    The number of allocations made is counted, to check that the inner loops of a solver do not allocate.
+*/
+
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace Gadgetron{
+
+  template <class ARRAY_TYPE> class solverWorkspace
+  {
+  public:
+
+    solverWorkspace() : allocations_(0) {}
+
+    // Buffer in a slot, with the given dimensions.
+    // It is allocated if the slot is unused or held dimensions that differ; otherwise the buffer of
+    // the previous use is returned as it was left, so its content must be treated as undefined.
+    //
+
+    ARRAY_TYPE* get( size_t slot, const std::vector<size_t>& dims )
+    {
+      boost::shared_ptr<ARRAY_TYPE>& buffer = get_slot(slot);
+      if( !buffer.get() || !buffer->dimensions_equal(dims) ){
+        buffer = boost::make_shared<ARRAY_TYPE>();
+        buffer->create(dims);
+        allocations_++;
+      }
+      return buffer.get();
+    }
+
+    // Buffer in a slot, holding a copy of an array
+    //
+
+    ARRAY_TYPE* get_copy( size_t slot, const ARRAY_TYPE& array )
+    {
+      ARRAY_TYPE* buffer = get(slot, array.dimensions());
+      *buffer = array;
+      return buffer;
+    }
+
+    // Buffer in a slot, for results handed out of the solver.
+    // The buffer is reused only once nobody outside the workspace holds it any longer;
+    // a result still held by the caller is left alone and a new buffer allocated in its place.
+    //
+
+    boost::shared_ptr<ARRAY_TYPE> get_shared( size_t slot, const std::vector<size_t>& dims )
+    {
+      boost::shared_ptr<ARRAY_TYPE>& buffer = get_slot(slot);
+      if( buffer.get() && buffer.use_count() > 1 ){
+        buffer.reset();
+      }
+      get(slot, dims);
+      return buffer;
+    }
+
+    // Number of buffers allocated since construction or the last reset
+    //
+
+    size_t get_number_of_allocations() const { return allocations_; }
+    void reset_number_of_allocations() { allocations_ = 0; }
+
+    // Release all buffers
+    //
+
+    void clear() { buffers_.clear(); }
+
+  protected:
+
+    boost::shared_ptr<ARRAY_TYPE>& get_slot( size_t slot )
+    {
+      if( slot >= buffers_.size() ){
+        buffers_.resize(slot+1);
+      }
+      return buffers_[slot];
+    }
+
+    std::vector< boost::shared_ptr<ARRAY_TYPE> > buffers_;
+    size_t allocations_;
+  };
+}